@@ -26,14 +26,18 @@
 
 #include "motor.h"
 #include "sensor.h"
+#include "config_cache.h"
 
 #include "data_io/interface/data_io.h"
 #include "kalman/kalman_filters.h"
 #include "debug/data_logging.h"
+#include "async_log.h"
+#include "binary_log.h"
 #include "timing/timing.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include <string.h>
 
 
@@ -49,21 +53,83 @@ struct _ActuatorData
   size_t sensorsNumber;
   KFilter motionFilter;
   Log log;
+  BinaryLog binaryLog;
+  AsyncLog asyncLog;
+  char* name;
+  char* configString;
+  atomic_size_t referencesCount;
 };
 
 
 const char* CONTROL_MODE_NAMES[ CONTROL_VARS_NUMBER ] = { [ POSITION ] = "POSITION", [ VELOCITY ] = "VELOCITY", 
                                                           [ ACCELERATION ] = "ACCELERATION", [ FORCE ] = "FORCE" };
+const char* LOG_COLUMN_NAMES[ CONTROL_VARS_NUMBER ] = { [ POSITION ] = "position", [ VELOCITY ] = "velocity", 
+                                                        [ ACCELERATION ] = "acceleration", [ FORCE ] = "force" };
 Actuator Actuator_Init( const char* configName )
+{
+  return Actuator_Reload( NULL, configName );
+}
+
+// Actuator description JSON string (to be freed by caller) stored on binary log header: configured devices and logged variables
+static char* GetMetadataString( Actuator actuator, DataHandle configuration )
+{
+  DataHandle metadata = DataIO_CreateEmptyData();
+  DataIO_SetStringValue( metadata, KEY_ID, actuator->name );
+  DataHandle sensorsList = DataIO_AddList( metadata, KEY_SENSORS );
+  for( size_t sensorIndex = 0; sensorIndex < actuator->sensorsNumber; sensorIndex++ )
+    DataIO_SetStringValue( sensorsList, NULL, DataIO_GetStringValue( configuration, "", KEY_SENSORS ".%lu." KEY_CONFIG, sensorIndex ) );
+  DataIO_SetStringValue( metadata, KEY_MOTOR, DataIO_GetStringValue( configuration, "", KEY_MOTOR "." KEY_CONFIG ) );
+  DataIO_SetStringValue( metadata, KEY_VARIABLE, CONTROL_MODE_NAMES[ actuator->controlMode ] );
+  DataHandle variablesList = DataIO_AddList( metadata, KEY_LOG );
+  for( size_t variableIndex = 0; variableIndex < CONTROL_VARS_NUMBER; variableIndex++ )
+    DataIO_SetStringValue( variablesList, NULL, LOG_COLUMN_NAMES[ variableIndex ] );
+  
+  char* metadataString = DataIO_GetDataString( metadata );
+  DataIO_UnloadData( metadata );
+  
+  return metadataString;
+}
+
+// Checks if base actuator configuration and all its devices configurations are unchanged
+static bool HasConfig( Actuator baseActuator, const char* configName, DataHandle configuration, const char* configString )
+{
+  if( baseActuator == NULL || baseActuator->configString == NULL ) return false;
+  
+  if( strcmp( baseActuator->name, configName ) != 0 || strcmp( baseActuator->configString, configString ) != 0 ) return false;
+  
+  for( size_t sensorIndex = 0; sensorIndex < baseActuator->sensorsNumber; sensorIndex++ )
+  {
+    const char* sensorName = DataIO_GetStringValue( configuration, "", KEY_SENSORS ".%lu." KEY_CONFIG, sensorIndex );
+    if( !Sensor_HasConfig( baseActuator->sensorsList[ sensorIndex ], sensorName ) ) return false;
+  }
+  
+  return Motor_HasConfig( baseActuator->motor, DataIO_GetStringValue( configuration, "", KEY_MOTOR "." KEY_CONFIG ) );
+}
+
+Actuator Actuator_Reload( Actuator baseActuator, const char* configName )
 {
   char filePath[ DATA_IO_MAX_PATH_LENGTH ];  
   DEBUG_PRINT( "trying to create actuator %s", configName );
   sprintf( filePath, KEY_CONFIG "/" KEY_ACTUATORS "/%s", configName );
-  DataHandle configuration = DataIO_LoadStorageData( filePath );
+  DataHandle configuration = ConfigCache_Load( filePath );
   if( configuration == NULL ) return NULL;
   DEBUG_PRINT( "found actuator %s config in handle %p", configName, configuration );
+  char* configString = DataIO_GetDataString( configuration );
+  if( configString != NULL && HasConfig( baseActuator, configName, configuration, configString ) )
+  {
+    DEBUG_PRINT( "reusing actuator %s", configName );
+    free( configString );
+    ConfigCache_Unload( configuration );
+    atomic_fetch_add( &(baseActuator->referencesCount), 1 );
+    return baseActuator;
+  }
+  
   Actuator newActuator = (Actuator) malloc( sizeof(ActuatorData) );
   memset( newActuator, 0, sizeof(ActuatorData) );
+  newActuator->name = (char*) calloc( strlen( configName ) + 1, sizeof(char) );
+  strcpy( newActuator->name, configName );
+  newActuator->configString = configString;
+  atomic_init( &(newActuator->referencesCount), 1 );
   
   bool loadSuccess = true;
   DEBUG_PRINT( "found %lu sensors", DataIO_GetListSize( configuration, KEY_SENSORS ) );
@@ -75,7 +141,9 @@ Actuator Actuator_Init( const char* configName )
     for( size_t sensorIndex = 0; sensorIndex < newActuator->sensorsNumber; sensorIndex++ )
     {
       const char* sensorName = DataIO_GetStringValue( configuration, "", KEY_SENSORS ".%lu." KEY_CONFIG, sensorIndex );
-      if( (newActuator->sensorsList[ sensorIndex ] = Sensor_Init( sensorName )) == NULL ) loadSuccess = false;
+      // Unchanged sensors of previous actuator are kept running, with their offsets
+      Sensor baseSensor = ( baseActuator != NULL && sensorIndex < baseActuator->sensorsNumber ) ? baseActuator->sensorsList[ sensorIndex ] : NULL;
+      if( (newActuator->sensorsList[ sensorIndex ] = Sensor_Reload( baseSensor, sensorName )) == NULL ) loadSuccess = false;
       DEBUG_PRINT( "loading sensor %s success: %s", sensorName, loadSuccess ? "true" : "false" );
       const char* sensorType = DataIO_GetStringValue( configuration, "", KEY_SENSORS ".%lu." KEY_VARIABLE, sensorIndex );
       double measurementDeviation = DataIO_GetNumericValue( configuration, 1.0, KEY_SENSORS ".%lu." KEY_DEVIATION, sensorIndex );
@@ -86,7 +154,7 @@ Actuator Actuator_Init( const char* configName )
   }
   
   const char* motorName = DataIO_GetStringValue( configuration, "", KEY_MOTOR "." KEY_CONFIG );
-  if( (newActuator->motor = Motor_Init( motorName )) == NULL ) loadSuccess = false;
+  if( (newActuator->motor = Motor_Reload( ( baseActuator != NULL ) ? baseActuator->motor : NULL, motorName )) == NULL ) loadSuccess = false;
   DEBUG_PRINT( "loading motor %s success: %s", motorName, loadSuccess ? "true" : "false" ); 
   const char* controlModeName = DataIO_GetStringValue( configuration, (char*) CONTROL_MODE_NAMES[ 0 ], KEY_MOTOR "." KEY_VARIABLE );
   for( newActuator->controlMode = 0; newActuator->controlMode < CONTROL_VARS_NUMBER; newActuator->controlMode++ )
@@ -95,12 +163,28 @@ Actuator Actuator_Init( const char* configName )
   newActuator->setpointLimit = DataIO_GetNumericValue( configuration, -1.0, KEY_MOTOR "." KEY_LIMIT  );
   
   if( DataIO_HasKey( configuration, KEY_LOG ) )
-    newActuator->log = Log_Init( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE ) ? configName : "", 
-                                 (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION ) );
+  {
+    size_t logPrecision = (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION );
+    if( strcmp( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_FORMAT ), KEY_BINARY ) == 0 )
+    {
+      char* metadataString = GetMetadataString( newActuator, configuration );
+      newActuator->binaryLog = BinaryLog_Create( configName, metadataString, CONTROL_VARS_NUMBER, LOG_COLUMN_NAMES, BinaryLog_GetPrecisionType( logPrecision ) );
+      free( metadataString );
+      BinaryLog_SetCompression( newActuator->binaryLog, LogCodec_GetType( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_COMPRESSION ) ), logPrecision );
+    }
+    else
+      newActuator->log = Log_Init( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE ) ? configName : "", logPrecision );
+    newActuator->asyncLog = AsyncLog_Create( configName, newActuator->log, newActuator->binaryLog, CONTROL_VARS_NUMBER, 
+                                             (size_t) DataIO_GetNumericValue( configuration, ASYNC_LOG_DEFAULT_BUFFER_LENGTH, KEY_LOG "." KEY_BUFFER_LENGTH ),
+                                             AsyncLog_ParseOverflowPolicy( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_OVERFLOW ) ) );
+    AsyncLogFilter logFilter;
+    if( AsyncLog_LoadFilter( configuration, &logFilter ) ) AsyncLog_SetFilter( newActuator->asyncLog, &logFilter );
+    AsyncLog_SetState( newActuator->asyncLog, CONTROL_PASSIVE );
+  }
   //DEBUG_PRINT( "log created with handle %p", newActuator->log );
   newActuator->controlState = CONTROL_PASSIVE;
   //DEBUG_PRINT( "loading success: %s", loadSuccess ? "true" : "false" );
-  DataIO_UnloadData( configuration );
+  ConfigCache_Unload( configuration );
   //DEBUG_PRINT( "data on handle %p unloaded", configuration );
   if( !loadSuccess )
   {
@@ -117,13 +201,56 @@ void Actuator_End( Actuator actuator )
 {
   if( actuator == NULL ) return;
   
+  if( atomic_fetch_sub( &(actuator->referencesCount), 1 ) > 1 ) return;
+  
   Kalman_DiscardFilter( actuator->motionFilter );
   
   Motor_End( actuator->motor );
   for( size_t sensorIndex = 0; sensorIndex < actuator->sensorsNumber; sensorIndex++ )
     Sensor_End( actuator->sensorsList[ sensorIndex ] );
+  free( actuator->sensorsList );
   
+  AsyncLog_Discard( actuator->asyncLog );
+  BinaryLog_Discard( actuator->binaryLog );
   Log_End( actuator->log );
+  
+  free( actuator->name );
+  free( actuator->configString );
+  
+  free( actuator );
+}
+
+bool Actuator_InheritState( Actuator actuator, Actuator baseActuator )
+{
+  if( actuator == NULL || baseActuator == NULL ) return false;
+  
+  if( actuator == baseActuator ) return true;
+  
+  // New sensors or motor would still need offset acquisition
+  if( actuator->motor != baseActuator->motor || actuator->sensorsNumber != baseActuator->sensorsNumber ) return false;
+  for( size_t sensorIndex = 0; sensorIndex < actuator->sensorsNumber; sensorIndex++ )
+  {
+    if( actuator->sensorsList[ sensorIndex ] != baseActuator->sensorsList[ sensorIndex ] ) return false;
+  }
+  
+  actuator->controlState = baseActuator->controlState;
+  AsyncLog_SetState( actuator->asyncLog, actuator->controlState );
+  
+  return true;
+}
+
+void Actuator_Reset( Actuator actuator, Actuator baseActuator )
+{
+  if( actuator == NULL || actuator == baseActuator ) return;
+  
+  for( size_t sensorIndex = 0; sensorIndex < actuator->sensorsNumber; sensorIndex++ )
+  {
+    // Sensors reused from base actuator keep their offsets and processing state
+    Sensor baseSensor = ( baseActuator != NULL && sensorIndex < baseActuator->sensorsNumber ) ? baseActuator->sensorsList[ sensorIndex ] : NULL;
+    if( actuator->sensorsList[ sensorIndex ] != baseSensor ) Sensor_Reset( actuator->sensorsList[ sensorIndex ] );
+  }
+  
+  Kalman_Reset( actuator->motionFilter );
 }
 
 bool Actuator_Enable( Actuator actuator )
@@ -171,6 +298,7 @@ bool Actuator_SetControlState( Actuator actuator, enum ControlState newState )
   }
   
   actuator->controlState = newState;
+  AsyncLog_SetState( actuator->asyncLog, newState );
   
   return true;
 }
@@ -199,8 +327,11 @@ bool Actuator_GetMeasures( Actuator actuator, DoFVariables* ref_measures, double
   ref_measures->acceleration = filteredMeasures[ ACCELERATION ];
   ref_measures->force = filteredMeasures[ FORCE ];
   
-  Log_EnterNewLine( actuator->log, Time_GetExecSeconds() );
-  Log_RegisterList( actuator->log, CONTROL_VARS_NUMBER, (double*) filteredMeasures );
+  if( AsyncLog_EnterNewLine( actuator->asyncLog, Time_GetExecSeconds() ) )
+  {
+    AsyncLog_RegisterList( actuator->asyncLog, CONTROL_VARS_NUMBER, (double*) filteredMeasures );
+    AsyncLog_EndLine( actuator->asyncLog );
+  }
   
   return true;
 }
@@ -51,9 +51,22 @@
 ///     "limit": -1.0                       // [o] Absolute maximum allowed for control motor setpoint/output
 ///   },
 ///   "log": {                            // [o] Set logging of measurement and setpoint numeric data over time
+///     "format": "text",                   // [o] Log format: "text" or "binary" (columnar file with header and time index, see @ref binary_log_format)
 ///     "to_file": false,                   // [o] Save data logging to <log_dir>/[<user_name>-]<actuator_name>-<time_stamp>.log, to log file 
-///                                         //     Default value will set terminal logging
-///     "precision": 3                      // [o] Decimal precision for logged numeric values
+///                                         //     Default value will set terminal logging (binary logs are always saved to .blog file)
+///     "precision": 3,                     // [o] Decimal precision for logged numeric values
+///     "compression": "none",              // [o] Binary log column compression: "none", "delta" (quantized to given precision) or "xor" (lossless), as in log_codec.h
+///     "buffer_length": 1024,              // [o] Number of lines buffered for the (asynchronous) log writer
+///     "overflow": "drop_newest",          // [o] Lines dropped when buffer is full: "drop_newest" or "drop_oldest"
+///     "decimation": 1,                    // [o] Number of control cycles combined into each logged line
+///     "aggregation": "last",              // [o] Combination of decimated values: "last", "mean", "min" or "max"
+///     "trigger": {                        // [o] Log only while all given conditions hold
+///       "state": "operation",               // [o] Required actuator control state: "passive", "offset", "calibration", "preprocessing" or "operation"
+///       "value": 3,                         // [o] Index of logged value checked against thresholds (default is position)
+///       "above": 10.0,                      // [o] Minimum (exclusive) checked value
+///       "below": 100.0,                     // [o] Maximum (exclusive) checked value
+///       "pre_trigger": 0                    // [o] Number of (decimated) lines preceding trigger activation that are also logged
+///     }
 ///   }
 /// }
 /// @endcode
@@ -75,10 +88,27 @@ typedef ActuatorData* Actuator;                 ///< Opaque reference to actuato
 /// @return reference/pointer to newly created and initialized actuator data structure
 Actuator Actuator_Init( const char* configName );
 
-/// @brief Deallocates internal data of given actuator                        
+/// @brief Gets actuator for given configuration, reusing given (possibly running) actuator or its sensors and motor where their configurations are unchanged
+/// @param[in] baseActuator reference to existing actuator (ignored if NULL)
+/// @param[in] configName name of file containing configuration parameters, as explained at @ref actuator_config
+/// @return reference to shared base actuator (keeping its filter and control state) if no configuration changed, or to newly created actuator (NULL on errors)
+Actuator Actuator_Reload( Actuator baseActuator, const char* configName );
+
+/// @brief Releases given actuator reference, deallocating its internal data if no longer shared
 /// @param[in] actuator reference to actuator
 void Actuator_End( Actuator actuator );
 
+/// @brief Sets control state of given actuator to the one of the actuator it was reloaded from, if both share all sensors and motor (see Actuator_Reload())
+/// @param[in] actuator reference to reloaded actuator
+/// @param[in] baseActuator reference to previous actuator (not running)
+/// @return true if actuator is in the same state (and its devices were already set for it), false otherwise
+bool Actuator_InheritState( Actuator actuator, Actuator baseActuator );
+
+/// @brief Resets filtering and signal processing state, and possible device errors, of given actuator sensors not shared with base actuator (e.g. when taking over devices used by it)
+/// @param[in] actuator reference to actuator (nothing is reset if it is the base actuator itself)
+/// @param[in] baseActuator reference to actuator given one was reloaded from (NULL to reset all sensors)
+void Actuator_Reset( Actuator actuator, Actuator baseActuator );
+
 /// @brief Allows motor output on given actuator 
 /// @param[in] actuator reference to actuator
 /// @return true on enabled output, false otherwise
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#ifndef _GNU_SOURCE
+  #define _GNU_SOURCE
+#endif
+
+#include "alloc_guard.h"
+
+#ifdef ENABLE_ALLOCATION_GUARD
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define BACKTRACE_MAX_LENGTH 32
+
+// Internal glibc allocator entry points, used to avoid symbol lookups (that could allocate themselves) inside allocator wrappers
+extern void* __libc_malloc( size_t );
+extern void* __libc_calloc( size_t, size_t );
+extern void* __libc_realloc( void*, size_t );
+extern void* __libc_memalign( size_t, size_t );
+extern void __libc_free( void* );
+
+static bool isAbortEnabled = false;
+static bool isSyscallsCheckEnabled = false;
+static atomic_size_t violationsCount = 0;
+
+static _Thread_local const char* guardedSiteName = NULL;
+static _Thread_local bool isReporting = false;
+
+static int (*RealOpen)( const char*, int, ... ) = NULL;
+static FILE* (*RealFOpen)( const char*, const char* ) = NULL;
+static ssize_t (*RealRead)( int, void*, size_t ) = NULL;
+static ssize_t (*RealWrite)( int, const void*, size_t ) = NULL;
+static int (*RealFSync)( int ) = NULL;
+
+static void LoadRealFunctions( void );
+static void ReportViolation( const char*, size_t );
+
+
+void AllocGuard_Init( const char* modeString )
+{
+  if( modeString != NULL )
+  {
+    isAbortEnabled = ( strstr( modeString, "abort" ) != NULL );
+    isSyscallsCheckEnabled = ( strstr( modeString, "syscalls" ) != NULL );
+  }
+  
+  LoadRealFunctions();
+  // First backtrace call loads unwinding library, which allocates memory
+  void* framesList[ 1 ];
+  (void) backtrace( framesList, 1 );
+}
+
+void AllocGuard_Enter( const char* siteName )
+{
+  guardedSiteName = ( siteName != NULL ) ? siteName : "unnamed";
+}
+
+void AllocGuard_Exit( void )
+{
+  guardedSiteName = NULL;
+}
+
+size_t AllocGuard_GetViolationsCount( void )
+{
+  return atomic_load( &violationsCount );
+}
+
+
+void* malloc( size_t size )
+{
+  if( guardedSiteName != NULL ) ReportViolation( "malloc", size );
+  return __libc_malloc( size );
+}
+
+void* calloc( size_t elementsNumber, size_t elementSize )
+{
+  if( guardedSiteName != NULL ) ReportViolation( "calloc", elementsNumber * elementSize );
+  return __libc_calloc( elementsNumber, elementSize );
+}
+
+void* realloc( void* pointer, size_t size )
+{
+  if( guardedSiteName != NULL ) ReportViolation( "realloc", size );
+  return __libc_realloc( pointer, size );
+}
+
+void free( void* pointer )
+{
+  if( guardedSiteName != NULL && pointer != NULL ) ReportViolation( "free", 0 );
+  __libc_free( pointer );
+}
+
+void* aligned_alloc( size_t alignment, size_t size )
+{
+  if( guardedSiteName != NULL ) ReportViolation( "aligned_alloc", size );
+  return __libc_memalign( alignment, size );
+}
+
+int posix_memalign( void** ref_pointer, size_t alignment, size_t size )
+{
+  if( guardedSiteName != NULL ) ReportViolation( "posix_memalign", size );
+  *ref_pointer = __libc_memalign( alignment, size );
+  return ( *ref_pointer != NULL || size == 0 ) ? 0 : ENOMEM;
+}
+
+int open( const char* filePath, int flags, ... )
+{
+  if( isSyscallsCheckEnabled && guardedSiteName != NULL ) ReportViolation( "open", 0 );
+  if( RealOpen == NULL ) LoadRealFunctions();
+  
+  va_list arguments;
+  va_start( arguments, flags );
+  int mode = ( flags & O_CREAT ) ? va_arg( arguments, int ) : 0;
+  va_end( arguments );
+  
+  return RealOpen( filePath, flags, mode );
+}
+
+FILE* fopen( const char* filePath, const char* mode )
+{
+  if( isSyscallsCheckEnabled && guardedSiteName != NULL ) ReportViolation( "fopen", 0 );
+  if( RealFOpen == NULL ) LoadRealFunctions();
+  return RealFOpen( filePath, mode );
+}
+
+ssize_t read( int fileDescriptor, void* buffer, size_t size )
+{
+  if( isSyscallsCheckEnabled && guardedSiteName != NULL ) ReportViolation( "read", size );
+  if( RealRead == NULL ) LoadRealFunctions();
+  return RealRead( fileDescriptor, buffer, size );
+}
+
+ssize_t write( int fileDescriptor, const void* buffer, size_t size )
+{
+  if( isSyscallsCheckEnabled && guardedSiteName != NULL ) ReportViolation( "write", size );
+  if( RealWrite == NULL ) LoadRealFunctions();
+  return RealWrite( fileDescriptor, buffer, size );
+}
+
+int fsync( int fileDescriptor )
+{
+  if( isSyscallsCheckEnabled && guardedSiteName != NULL ) ReportViolation( "fsync", 0 );
+  if( RealFSync == NULL ) LoadRealFunctions();
+  return RealFSync( fileDescriptor );
+}
+
+
+static void LoadRealFunctions( void )
+{
+  RealOpen = (int (*)( const char*, int, ... )) dlsym( RTLD_NEXT, "open" );
+  RealFOpen = (FILE* (*)( const char*, const char* )) dlsym( RTLD_NEXT, "fopen" );
+  RealRead = (ssize_t (*)( int, void*, size_t )) dlsym( RTLD_NEXT, "read" );
+  RealWrite = (ssize_t (*)( int, const void*, size_t )) dlsym( RTLD_NEXT, "write" );
+  RealFSync = (int (*)( int )) dlsym( RTLD_NEXT, "fsync" );
+}
+
+static void ReportViolation( const char* callName, size_t size )
+{
+  // Allocations and writes performed by reporting itself are ignored
+  if( isReporting ) return;
+  isReporting = true;
+  
+  atomic_fetch_add( &violationsCount, 1 );
+  
+  char message[ 256 ];
+  int messageLength = snprintf( message, sizeof(message), "alloc_guard: %s (%lu bytes) called on guarded section %s\n", 
+                                callName, (unsigned long) size, guardedSiteName );
+  if( RealWrite != NULL && messageLength > 0 ) (void) RealWrite( STDERR_FILENO, message, (size_t) messageLength );
+  void* framesList[ BACKTRACE_MAX_LENGTH ];
+  int framesNumber = backtrace( framesList, BACKTRACE_MAX_LENGTH );
+  // Writes directly to file descriptor, without allocating symbols strings
+  backtrace_symbols_fd( framesList, framesNumber, STDERR_FILENO );
+  
+  isReporting = false;
+  
+  if( isAbortEnabled ) abort();
+}
+
+#endif // ENABLE_ALLOCATION_GUARD
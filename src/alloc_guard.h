@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file alloc_guard.h
+/// @brief Detection of memory allocations and blocking calls on real-time threads
+///
+/// Builds with ENABLE_ALLOCATION_GUARD definition replace the process allocator functions (malloc, calloc, realloc, free and aligned variants) 
+/// by checking wrappers, that also catch allocations made by third-party libraries and plug-ins. While a thread is guarded (e.g. the control thread 
+/// started by Robot_Enable()), any allocator call is reported to standard error output with a backtrace, and optionally aborts the process. 
+/// Blocking file system calls (open, fopen, read, write and fsync) may also be reported.
+/// Without ENABLE_ALLOCATION_GUARD, all functions are replaced by empty macros.
+
+
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+#include <stddef.h>
+
+#ifdef ENABLE_ALLOCATION_GUARD
+
+/// @brief Sets guard behaviour (not thread safe, call before any thread is guarded)
+/// @param[in] modeString "report" (default) or "abort" on first violation, optionally followed by ",syscalls" for also checking blocking calls
+void AllocGuard_Init( const char* modeString );
+
+/// @brief Starts checking allocations (and blocking calls, if enabled) performed by calling thread
+/// @param[in] siteName name of guarded code section, shown on violation reports
+void AllocGuard_Enter( const char* siteName );
+
+/// @brief Stops checking allocations performed by calling thread
+void AllocGuard_Exit( void );
+
+/// @brief Gets number of violations reported since process start
+/// @return total number of reported violations, from all threads
+size_t AllocGuard_GetViolationsCount( void );
+
+#else
+
+#define AllocGuard_Init( modeString ) do { (void) (modeString); } while( 0 )
+#define AllocGuard_Enter( siteName ) do { (void) (siteName); } while( 0 )
+#define AllocGuard_Exit() do {} while( 0 )
+#define AllocGuard_GetViolationsCount() ( (size_t) 0 )
+
+#endif
+
+
+#endif // ALLOC_GUARD_H
@@ -0,0 +1,580 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "async_log.h"
+
+#include "robot_control/robot_control.h"
+
+#include "threads/threads.h"
+#include "threads/thread_locks.h"
+#include "timing/timing.h"
+
+#include "config_keys.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define CACHE_LINE_SIZE 64
+
+const unsigned long WRITER_IDLE_DELAY_MS = 10;
+
+const char* OVERFLOW_POLICY_NAMES[ ASYNC_LOG_POLICIES_NUMBER ] = { [ ASYNC_LOG_DROP_NEWEST ] = "drop_newest", [ ASYNC_LOG_DROP_OLDEST ] = "drop_oldest" };
+const char* AGGREGATION_NAMES[ ASYNC_LOG_AGGREGATIONS_NUMBER ] = { [ ASYNC_LOG_AGGREGATE_LAST ] = "last", [ ASYNC_LOG_AGGREGATE_MEAN ] = "mean", 
+                                                                   [ ASYNC_LOG_AGGREGATE_MIN ] = "min", [ ASYNC_LOG_AGGREGATE_MAX ] = "max" };
+const char* TRIGGER_STATE_NAMES[ CONTROL_STATES_NUMBER ] = { [ CONTROL_PASSIVE ] = "passive", [ CONTROL_OFFSET ] = "offset", [ CONTROL_CALIBRATION ] = "calibration", 
+                                                             [ CONTROL_PREPROCESSING ] = "preprocessing", [ CONTROL_OPERATION ] = "operation" };
+
+// Ring slots follow a sequence protocol (as in D. Vyukov's bounded queue): 
+// a slot is free for position p when its sequence is p, and holds a line for position p when its sequence is p + 1.
+// The producer may also act as a consumer to drop the oldest line, so the read position is claimed through compare-and-swap
+typedef struct _LineSlot
+{
+  atomic_size_t sequence;
+  size_t valuesNumber;
+  double timeStamp;
+  double valuesList[];
+}
+LineSlot;
+
+struct _AsyncLogData
+{
+  char* name;
+  Log log;
+  BinaryLog binaryLog;
+  enum AsyncLogOverflowPolicy overflowPolicy;
+  unsigned char* slotsData;
+  size_t slotSize;
+  size_t lineLength;
+  size_t indexMask;
+  char consumerPadding[ CACHE_LINE_SIZE ];
+  atomic_size_t readIndex;
+  atomic_size_t writtenLinesNumber;
+  char producerPadding[ CACHE_LINE_SIZE ];      // Keep producer and consumer indexes on separate cache lines
+  size_t writeIndex;
+  LineSlot* currentSlot;
+  atomic_size_t droppedNewLinesNumber;
+  atomic_size_t droppedOldLinesNumber;
+  atomic_size_t truncatedLinesNumber;
+  // Filtered lines are first composed on producer side buffers
+  bool hasFilter;
+  AsyncLogFilter filter;
+  atomic_int state;
+  double stagingTime;
+  double* stagingValuesList;
+  size_t stagingValuesNumber;
+  double* groupValuesList;
+  size_t groupValuesNumber;
+  size_t groupLinesNumber;
+  double* historyData;
+  size_t historyStart;
+  size_t historyLinesNumber;
+  bool wasTriggered;
+};
+
+static AsyncLog* logsList = NULL;
+static size_t logsNumber = 0;
+static _Atomic(ThreadLock) logsLock = NULL;
+static _Atomic(ThreadLock) writerLock = NULL;          // Held while the writer thread is started or stopped, so that a new one never runs along with the last one
+static Thread writerThread = THREAD_INVALID_HANDLE;
+static atomic_bool isWriterRunning = false;
+
+static ThreadLock GetLock( _Atomic(ThreadLock)* );
+static void* AsyncWrite( void* );
+static size_t WritePendingLines( AsyncLog );
+static void FilterLine( AsyncLog );
+
+
+enum AsyncLogOverflowPolicy AsyncLog_ParseOverflowPolicy( const char* policyName )
+{
+  if( policyName == NULL ) return ASYNC_LOG_DROP_NEWEST;
+  
+  for( int policyIndex = 0; policyIndex < ASYNC_LOG_POLICIES_NUMBER; policyIndex++ )
+  {
+    if( strcmp( policyName, OVERFLOW_POLICY_NAMES[ policyIndex ] ) == 0 ) return (enum AsyncLogOverflowPolicy) policyIndex;
+  }
+  
+  return ASYNC_LOG_DROP_NEWEST;
+}
+
+bool AsyncLog_LoadFilter( DataHandle configuration, AsyncLogFilter* ref_filter )
+{
+  if( ref_filter == NULL ) return false;
+  
+  ref_filter->decimation = (size_t) DataIO_GetNumericValue( configuration, 1, KEY_LOG "." KEY_DECIMATION );
+  ref_filter->aggregation = ASYNC_LOG_AGGREGATE_LAST;
+  const char* aggregationName = DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_AGGREGATION );
+  for( int aggregationIndex = 0; aggregationIndex < ASYNC_LOG_AGGREGATIONS_NUMBER; aggregationIndex++ )
+  {
+    if( strcmp( aggregationName, AGGREGATION_NAMES[ aggregationIndex ] ) == 0 ) ref_filter->aggregation = (enum AsyncLogAggregation) aggregationIndex;
+  }
+  
+  ref_filter->triggerState = -1;
+  const char* stateName = DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_TRIGGER "." KEY_STATE );
+  for( int stateIndex = 0; stateIndex < CONTROL_STATES_NUMBER; stateIndex++ )
+  {
+    if( strcmp( stateName, TRIGGER_STATE_NAMES[ stateIndex ] ) == 0 ) ref_filter->triggerState = stateIndex;
+  }
+  ref_filter->triggerIndex = (size_t) DataIO_GetNumericValue( configuration, 0, KEY_LOG "." KEY_TRIGGER "." KEY_VALUE );
+  ref_filter->triggerMin = DataIO_GetNumericValue( configuration, -HUGE_VAL, KEY_LOG "." KEY_TRIGGER "." KEY_ABOVE );
+  ref_filter->triggerMax = DataIO_GetNumericValue( configuration, HUGE_VAL, KEY_LOG "." KEY_TRIGGER "." KEY_BELOW );
+  ref_filter->preTriggerLength = (size_t) DataIO_GetNumericValue( configuration, 0, KEY_LOG "." KEY_TRIGGER "." KEY_PRE_TRIGGER );
+  
+  return ( ref_filter->decimation > 1 || ref_filter->triggerState >= 0 || ref_filter->triggerMin > -HUGE_VAL || ref_filter->triggerMax < HUGE_VAL );
+}
+
+AsyncLog AsyncLog_Create( const char* name, Log log, BinaryLog binaryLog, size_t lineLength, size_t bufferLength, enum AsyncLogOverflowPolicy overflowPolicy )
+{
+  if( log == NULL && binaryLog == NULL ) return NULL;
+  
+  AsyncLog newLog = (AsyncLog) malloc( sizeof(AsyncLogData) );
+  memset( newLog, 0, sizeof(AsyncLogData) );
+  
+  newLog->name = (char*) calloc( strlen( ( name != NULL ) ? name : "" ) + 1, sizeof(char) );
+  strcpy( newLog->name, ( name != NULL ) ? name : "" );
+  newLog->log = log;
+  newLog->binaryLog = binaryLog;
+  newLog->overflowPolicy = ( overflowPolicy < ASYNC_LOG_POLICIES_NUMBER ) ? overflowPolicy : ASYNC_LOG_DROP_NEWEST;
+  newLog->lineLength = lineLength;
+  
+  size_t slotsNumber = 2;
+  while( slotsNumber < bufferLength ) slotsNumber *= 2;
+  newLog->indexMask = slotsNumber - 1;
+  
+  newLog->slotSize = sizeof(LineSlot) + lineLength * sizeof(double);
+  newLog->slotsData = (unsigned char*) calloc( slotsNumber, newLog->slotSize );
+  for( size_t slotIndex = 0; slotIndex < slotsNumber; slotIndex++ )
+    atomic_init( &(((LineSlot*) ( newLog->slotsData + slotIndex * newLog->slotSize ))->sequence), slotIndex );
+  
+  atomic_init( &(newLog->readIndex), 0 );
+  newLog->writeIndex = 0;
+  newLog->currentSlot = NULL;
+  atomic_init( &(newLog->writtenLinesNumber), 0 );
+  atomic_init( &(newLog->droppedNewLinesNumber), 0 );
+  atomic_init( &(newLog->droppedOldLinesNumber), 0 );
+  atomic_init( &(newLog->truncatedLinesNumber), 0 );
+  atomic_init( &(newLog->state), -1 );
+  
+  ThreadLock_Aquire( GetLock( &writerLock ) );
+  ThreadLock_Aquire( GetLock( &logsLock ) );
+  logsList = (AsyncLog*) realloc( logsList, ( logsNumber + 1 ) * sizeof(AsyncLog) );
+  logsList[ logsNumber++ ] = newLog;
+  if( writerThread == THREAD_INVALID_HANDLE )
+  {
+    isWriterRunning = true;
+    writerThread = Thread_Start( AsyncWrite, NULL, THREAD_JOINABLE );
+  }
+  ThreadLock_Release( logsLock );
+  ThreadLock_Release( writerLock );
+  
+  return newLog;
+}
+
+void AsyncLog_Discard( AsyncLog log )
+{
+  if( log == NULL ) return;
+  
+  Thread lastWriterThread = THREAD_INVALID_HANDLE;
+  
+  // Writer thread only accesses logs while holding the lock, so the log is not used by it after removal. 
+  // Writer lock is kept until the last writer thread exits, as it is not taken by that thread itself
+  ThreadLock_Aquire( writerLock );
+  ThreadLock_Aquire( logsLock );
+  for( size_t logIndex = 0; logIndex < logsNumber; logIndex++ )
+  {
+    if( logsList[ logIndex ] == log ) 
+    {
+      logsList[ logIndex ] = logsList[ --logsNumber ];
+      break;
+    }
+  }
+  if( logsNumber == 0 )
+  {
+    isWriterRunning = false;
+    lastWriterThread = writerThread;
+    writerThread = THREAD_INVALID_HANDLE;
+  }
+  ThreadLock_Release( logsLock );
+  
+  if( lastWriterThread != THREAD_INVALID_HANDLE ) Thread_WaitExit( lastWriterThread, 5000 );
+  ThreadLock_Release( writerLock );
+  
+  (void) WritePendingLines( log );
+  
+  AsyncLogStats stats;
+  AsyncLog_GetStats( log, &stats );
+  if( stats.droppedNewLinesNumber + stats.droppedOldLinesNumber > 0 )
+    DEBUG_PRINT( "log %p: %lu lines written, %lu new and %lu old lines dropped", log, stats.writtenLinesNumber, 
+                 stats.droppedNewLinesNumber, stats.droppedOldLinesNumber );
+  
+  free( log->slotsData );
+  
+  AsyncLog_SetFilter( log, NULL );
+  
+  free( log->name );
+  
+  free( log );
+}
+
+static inline LineSlot* GetSlot( AsyncLog log, size_t index )
+{
+  return (LineSlot*) ( log->slotsData + ( index & log->indexMask ) * log->slotSize );
+}
+
+// Claims oldest pending line, if any (consumer side, possibly called by producer)
+static LineSlot* ClaimLine( AsyncLog log, size_t* ref_index )
+{
+  size_t readIndex = atomic_load_explicit( &(log->readIndex), memory_order_relaxed );
+  while( true )
+  {
+    LineSlot* slot = GetSlot( log, readIndex );
+    size_t sequence = atomic_load_explicit( &(slot->sequence), memory_order_acquire );
+    if( sequence == readIndex + 1 )
+    {
+      if( atomic_compare_exchange_weak_explicit( &(log->readIndex), &readIndex, readIndex + 1, memory_order_relaxed, memory_order_relaxed ) )
+      {
+        *ref_index = readIndex;
+        return slot;
+      }
+    }
+    else if( sequence == readIndex ) return NULL;
+    else readIndex = atomic_load_explicit( &(log->readIndex), memory_order_relaxed );
+  }
+}
+
+static inline void ReleaseLine( AsyncLog log, LineSlot* slot, size_t index )
+{
+  atomic_store_explicit( &(slot->sequence), index + log->indexMask + 1, memory_order_release );
+}
+
+void AsyncLog_SetFilter( AsyncLog log, const AsyncLogFilter* filter )
+{
+  if( log == NULL ) return;
+  
+  free( log->stagingValuesList );
+  free( log->groupValuesList );
+  free( log->historyData );
+  log->stagingValuesList = log->groupValuesList = log->historyData = NULL;
+  log->hasFilter = false;
+  
+  if( filter == NULL ) return;
+  
+  log->filter = *filter;
+  if( log->filter.decimation == 0 ) log->filter.decimation = 1;
+  if( log->filter.aggregation >= ASYNC_LOG_AGGREGATIONS_NUMBER ) log->filter.aggregation = ASYNC_LOG_AGGREGATE_LAST;
+  log->stagingValuesList = (double*) calloc( log->lineLength, sizeof(double) );
+  log->groupValuesList = (double*) calloc( log->lineLength, sizeof(double) );
+  // History lines hold time stamp and values number, followed by values
+  log->historyData = (double*) calloc( log->filter.preTriggerLength * ( log->lineLength + 2 ), sizeof(double) );
+  log->stagingValuesNumber = log->groupValuesNumber = log->groupLinesNumber = 0;
+  log->historyStart = log->historyLinesNumber = 0;
+  log->wasTriggered = false;
+  log->hasFilter = true;
+}
+
+void AsyncLog_SetState( AsyncLog log, int state )
+{
+  if( log == NULL ) return;
+  
+  atomic_store_explicit( &(log->state), state, memory_order_relaxed );
+}
+
+// Acquires free slot for a new line, or returns NULL if line is dropped (producer side)
+static LineSlot* AcquireSlot( AsyncLog log, double timeStamp )
+{
+  LineSlot* slot = GetSlot( log, log->writeIndex );
+  if( atomic_load_explicit( &(slot->sequence), memory_order_acquire ) != log->writeIndex )
+  {
+    // Ring is full: oldest line is on the same slot, and can't be dropped if the writer already claimed it
+    if( log->overflowPolicy == ASYNC_LOG_DROP_OLDEST )
+    {
+      size_t oldestIndex = log->writeIndex - ( log->indexMask + 1 );
+      size_t readIndex = oldestIndex;
+      if( atomic_compare_exchange_strong_explicit( &(log->readIndex), &readIndex, oldestIndex + 1, memory_order_relaxed, memory_order_relaxed ) )
+      {
+        ReleaseLine( log, slot, oldestIndex );
+        atomic_fetch_add_explicit( &(log->droppedOldLinesNumber), 1, memory_order_relaxed );
+      }
+    }
+    
+    if( atomic_load_explicit( &(slot->sequence), memory_order_acquire ) != log->writeIndex )
+    {
+      atomic_fetch_add_explicit( &(log->droppedNewLinesNumber), 1, memory_order_relaxed );
+      return NULL;
+    }
+  }
+  
+  slot->timeStamp = timeStamp;
+  slot->valuesNumber = 0;
+  
+  return slot;
+}
+
+// Makes acquired slot line available to the writer thread (producer side)
+static inline void PublishSlot( AsyncLog log, LineSlot* slot )
+{
+  atomic_store_explicit( &(slot->sequence), log->writeIndex + 1, memory_order_release );
+  log->writeIndex++;
+}
+
+bool AsyncLog_EnterNewLine( AsyncLog log, double timeStamp )
+{
+  if( log == NULL ) return false;
+  
+  if( log->hasFilter )
+  {
+    log->stagingTime = timeStamp;
+    log->stagingValuesNumber = 0;
+    return true;
+  }
+  
+  log->currentSlot = AcquireSlot( log, timeStamp );
+  
+  return ( log->currentSlot != NULL );
+}
+
+void AsyncLog_RegisterList( AsyncLog log, size_t valuesNumber, const double* valuesList )
+{
+  if( log == NULL ) return;
+  
+  if( log->hasFilter )
+  {
+    if( log->stagingValuesNumber + valuesNumber > log->lineLength )
+    {
+      valuesNumber = log->lineLength - log->stagingValuesNumber;
+      atomic_fetch_add_explicit( &(log->truncatedLinesNumber), 1, memory_order_relaxed );
+    }
+    memcpy( log->stagingValuesList + log->stagingValuesNumber, valuesList, valuesNumber * sizeof(double) );
+    log->stagingValuesNumber += valuesNumber;
+    return;
+  }
+  
+  LineSlot* slot = log->currentSlot;
+  if( slot == NULL ) return;
+  
+  if( slot->valuesNumber + valuesNumber > log->lineLength )
+  {
+    valuesNumber = log->lineLength - slot->valuesNumber;
+    atomic_fetch_add_explicit( &(log->truncatedLinesNumber), 1, memory_order_relaxed );
+  }
+  
+  memcpy( slot->valuesList + slot->valuesNumber, valuesList, valuesNumber * sizeof(double) );
+  slot->valuesNumber += valuesNumber;
+}
+
+void AsyncLog_EndLine( AsyncLog log )
+{
+  if( log == NULL ) return;
+  
+  if( log->hasFilter )
+  {
+    FilterLine( log );
+    return;
+  }
+  
+  if( log->currentSlot == NULL ) return;
+  
+  PublishSlot( log, log->currentSlot );
+  log->currentSlot = NULL;
+}
+
+size_t AsyncLog_GetStatsString( char* statsString, size_t maxLength )
+{
+  if( statsString == NULL || maxLength < 3 ) return 0;
+  
+  size_t listedLogsNumber = 0;
+  size_t stringLength = (size_t) snprintf( statsString, maxLength, "{" );
+  
+  ThreadLock_Aquire( GetLock( &logsLock ) );
+  for( size_t logIndex = 0; logIndex < logsNumber; logIndex++ )
+  {
+    AsyncLogStats stats;
+    AsyncLog_GetStats( logsList[ logIndex ], &stats );
+    char entryString[ 256 ];
+    int entryLength = snprintf( entryString, sizeof(entryString), "%s\"%s\":{\"written\":%lu,\"dropped_new\":%lu,\"dropped_old\":%lu,\"truncated\":%lu}", 
+                                ( listedLogsNumber > 0 ) ? "," : "", logsList[ logIndex ]->name, (unsigned long) stats.writtenLinesNumber, 
+                                (unsigned long) stats.droppedNewLinesNumber, (unsigned long) stats.droppedOldLinesNumber, (unsigned long) stats.truncatedLinesNumber );
+    // Entries that don't fit (keeping room for the closing brace) are left out
+    if( entryLength < 0 || (size_t) entryLength >= sizeof(entryString) || stringLength + (size_t) entryLength + 2 > maxLength ) break;
+    strcpy( statsString + stringLength, entryString );
+    stringLength += (size_t) entryLength;
+    listedLogsNumber++;
+  }
+  ThreadLock_Release( logsLock );
+  
+  strcpy( statsString + stringLength, "}" );
+  
+  return listedLogsNumber;
+}
+
+void AsyncLog_GetStats( AsyncLog log, AsyncLogStats* ref_stats )
+{
+  if( log == NULL || ref_stats == NULL ) return;
+  
+  ref_stats->writtenLinesNumber = atomic_load_explicit( &(log->writtenLinesNumber), memory_order_relaxed );
+  ref_stats->droppedNewLinesNumber = atomic_load_explicit( &(log->droppedNewLinesNumber), memory_order_relaxed );
+  ref_stats->droppedOldLinesNumber = atomic_load_explicit( &(log->droppedOldLinesNumber), memory_order_relaxed );
+  ref_stats->truncatedLinesNumber = atomic_load_explicit( &(log->truncatedLinesNumber), memory_order_relaxed );
+}
+
+enum AsyncLogOverflowPolicy AsyncLog_GetOverflowPolicy( AsyncLog log )
+{
+  if( log == NULL ) return ASYNC_LOG_DROP_NEWEST;
+  
+  return log->overflowPolicy;
+}
+
+static void PushLine( AsyncLog log, double timeStamp, size_t valuesNumber, const double* valuesList )
+{
+  LineSlot* slot = AcquireSlot( log, timeStamp );
+  if( slot == NULL ) return;
+  
+  memcpy( slot->valuesList, valuesList, valuesNumber * sizeof(double) );
+  slot->valuesNumber = valuesNumber;
+  PublishSlot( log, slot );
+}
+
+static bool IsTriggered( AsyncLog log )
+{
+  if( log->filter.triggerState >= 0 && atomic_load_explicit( &(log->state), memory_order_relaxed ) != log->filter.triggerState ) return false;
+  
+  if( log->filter.triggerIndex >= log->groupValuesNumber ) return true;
+  
+  double triggerValue = log->groupValuesList[ log->filter.triggerIndex ];
+  return ( triggerValue > log->filter.triggerMin && triggerValue < log->filter.triggerMax );
+}
+
+// Decimates staged line, and registers resulting line according to trigger state (producer side)
+static void FilterLine( AsyncLog log )
+{
+  if( log->groupLinesNumber == 0 || log->filter.aggregation == ASYNC_LOG_AGGREGATE_LAST )
+  {
+    memcpy( log->groupValuesList, log->stagingValuesList, log->stagingValuesNumber * sizeof(double) );
+    log->groupValuesNumber = log->stagingValuesNumber;
+  }
+  else
+  {
+    if( log->stagingValuesNumber < log->groupValuesNumber ) log->groupValuesNumber = log->stagingValuesNumber;
+    for( size_t valueIndex = 0; valueIndex < log->groupValuesNumber; valueIndex++ )
+    {
+      double value = log->stagingValuesList[ valueIndex ];
+      double* groupValue = &(log->groupValuesList[ valueIndex ]);
+      if( log->filter.aggregation == ASYNC_LOG_AGGREGATE_MEAN ) *groupValue += value;
+      else if( log->filter.aggregation == ASYNC_LOG_AGGREGATE_MIN ) *groupValue = fmin( *groupValue, value );
+      else if( log->filter.aggregation == ASYNC_LOG_AGGREGATE_MAX ) *groupValue = fmax( *groupValue, value );
+    }
+  }
+  
+  if( ++(log->groupLinesNumber) < log->filter.decimation ) return;
+  
+  if( log->filter.aggregation == ASYNC_LOG_AGGREGATE_MEAN )
+  {
+    for( size_t valueIndex = 0; valueIndex < log->groupValuesNumber; valueIndex++ )
+      log->groupValuesList[ valueIndex ] /= log->groupLinesNumber;
+  }
+  log->groupLinesNumber = 0;
+  
+  size_t historyLineSize = log->lineLength + 2;
+  if( !IsTriggered( log ) )
+  {
+    log->wasTriggered = false;
+    if( log->filter.preTriggerLength == 0 ) return;
+    // Overwrite oldest history line when full
+    size_t historyIndex = ( log->historyStart + log->historyLinesNumber ) % log->filter.preTriggerLength;
+    if( log->historyLinesNumber < log->filter.preTriggerLength ) log->historyLinesNumber++;
+    else log->historyStart = ( log->historyStart + 1 ) % log->filter.preTriggerLength;
+    double* historyLine = log->historyData + historyIndex * historyLineSize;
+    historyLine[ 0 ] = log->stagingTime;
+    historyLine[ 1 ] = (double) log->groupValuesNumber;
+    memcpy( historyLine + 2, log->groupValuesList, log->groupValuesNumber * sizeof(double) );
+    return;
+  }
+  
+  if( !log->wasTriggered )
+  {
+    for( size_t lineIndex = 0; lineIndex < log->historyLinesNumber; lineIndex++ )
+    {
+      const double* historyLine = log->historyData + ( ( log->historyStart + lineIndex ) % log->filter.preTriggerLength ) * historyLineSize;
+      PushLine( log, historyLine[ 0 ], (size_t) historyLine[ 1 ], historyLine + 2 );
+    }
+    log->historyStart = log->historyLinesNumber = 0;
+    log->wasTriggered = true;
+  }
+  
+  PushLine( log, log->stagingTime, log->groupValuesNumber, log->groupValuesList );
+}
+
+static size_t WritePendingLines( AsyncLog log )
+{
+  size_t linesNumber = 0;
+  size_t lineIndex;
+  LineSlot* slot;
+  while( (slot = ClaimLine( log, &lineIndex )) != NULL )
+  {
+    if( log->binaryLog != NULL ) BinaryLog_WriteLine( log->binaryLog, slot->timeStamp, slot->valuesNumber, slot->valuesList );
+    else
+    {
+      Log_EnterNewLine( log->log, slot->timeStamp );
+      Log_RegisterList( log->log, slot->valuesNumber, slot->valuesList );
+    }
+    ReleaseLine( log, slot, lineIndex );
+    linesNumber++;
+  }
+  
+  atomic_fetch_add_explicit( &(log->writtenLinesNumber), linesNumber, memory_order_relaxed );
+  
+  return linesNumber;
+}
+
+// Logs may be created concurrently (e.g. by actuators loaded in parallel), so only the first created lock is kept
+static ThreadLock GetLock( _Atomic(ThreadLock)* ref_lock )
+{
+  ThreadLock currentLock = atomic_load( ref_lock );
+  if( currentLock != NULL ) return currentLock;
+  
+  ThreadLock newLock = ThreadLock_Create();
+  if( atomic_compare_exchange_strong( ref_lock, &currentLock, newLock ) ) return newLock;
+  
+  ThreadLock_Discard( newLock );
+  return currentLock;
+}
+
+static void* AsyncWrite( void* args )
+{
+  while( isWriterRunning )
+  {
+    size_t linesNumber = 0;
+    
+    ThreadLock_Aquire( logsLock );
+    for( size_t logIndex = 0; logIndex < logsNumber; logIndex++ )
+      linesNumber += WritePendingLines( logsList[ logIndex ] );
+    ThreadLock_Release( logsLock );
+    
+    // Batch lines from many control cycles when there is nothing to write
+    if( linesNumber == 0 ) Time_Delay( WRITER_IDLE_DELAY_MS );
+  }
+  
+  return NULL;
+}
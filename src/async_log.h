@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file async_log.h
+/// @brief Asynchronous (real-time safe) data logging functions
+///
+/// Numeric data lines registered from control threads are only copied to a preallocated lock-free ring of fixed-size slots. 
+/// Formatting and writing to the underlying [text data log](https://github.com/EESC-MKGroup/Simple-Data-Logging) or binary log (see binary_log.h) is performed later by a shared low-priority writer thread, that drains all registered logs in batches.
+/// When the writer falls behind and a ring gets full, lines are dropped according to the log overflow policy, and counted.
+/// Optionally, lines pass through a filter before reaching the ring: consecutive lines may be decimated (combined into one), and recording may be restricted 
+/// to periods where a trigger condition holds, keeping some history of lines preceding trigger activation.
+
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include "debug/data_logging.h"
+#include "data_io/interface/data_io.h"
+#include "binary_log.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ASYNC_LOG_DEFAULT_BUFFER_LENGTH 1024      ///< Default number of line slots for configured logs
+
+/// Action taken when a new line is registered on a full log ring
+enum AsyncLogOverflowPolicy 
+{ 
+  ASYNC_LOG_DROP_NEWEST,        ///< Discard the new line, keeping older pending ones
+  ASYNC_LOG_DROP_OLDEST,        ///< Discard the oldest pending line to make room for the new one
+  ASYNC_LOG_POLICIES_NUMBER 
+};
+
+/// Line counters of a single asynchronous log
+typedef struct _AsyncLogStats
+{
+  size_t writtenLinesNumber;        ///< Lines already passed to the underlying log
+  size_t droppedNewLinesNumber;     ///< New lines discarded on full ring (ASYNC_LOG_DROP_NEWEST policy, or oldest line being written)
+  size_t droppedOldLinesNumber;     ///< Pending lines discarded on full ring (ASYNC_LOG_DROP_OLDEST policy)
+  size_t truncatedLinesNumber;      ///< Value lists cut short for exceeding the line length (extra values are discarded)
+}
+AsyncLogStats;
+
+/// Combination of values from each group of decimated lines
+enum AsyncLogAggregation
+{
+  ASYNC_LOG_AGGREGATE_LAST,     ///< Keep values of the last line of each group
+  ASYNC_LOG_AGGREGATE_MEAN,     ///< Mean of each value over the group
+  ASYNC_LOG_AGGREGATE_MIN,      ///< Minimum of each value over the group
+  ASYNC_LOG_AGGREGATE_MAX,      ///< Maximum of each value over the group
+  ASYNC_LOG_AGGREGATIONS_NUMBER
+};
+
+/// Line filter settings, applied on producer side
+typedef struct _AsyncLogFilter
+{
+  size_t decimation;                      ///< Number of entered lines combined into each registered line (0 or 1 to register every line)
+  enum AsyncLogAggregation aggregation;   ///< Combination of decimated lines values (time stamp of each group is the one of its last line)
+  int triggerState;                       ///< Register lines only while log state (see AsyncLog_SetState()) is equal to this value (negative for any state)
+  size_t triggerIndex;                    ///< Index of line value checked against trigger thresholds
+  double triggerMin;                      ///< Register lines only while checked value is above this threshold (-HUGE_VAL for no threshold)
+  double triggerMax;                      ///< Register lines only while checked value is below this threshold (HUGE_VAL for no threshold)
+  size_t preTriggerLength;                ///< Number of (decimated) lines kept while trigger is off, and registered on its activation
+}
+AsyncLogFilter;
+
+typedef struct _AsyncLogData AsyncLogData;    ///< Single asynchronous log internal data structure
+typedef AsyncLogData* AsyncLog;               ///< Opaque reference to asynchronous log internal data structure
+
+
+/// @brief Gets overflow policy corresponding to configuration name
+/// @param[in] policyName policy name ("drop_newest" or "drop_oldest")
+/// @return corresponding overflow policy (ASYNC_LOG_DROP_NEWEST for unknown names)
+enum AsyncLogOverflowPolicy AsyncLog_ParseOverflowPolicy( const char* policyName );
+
+/// @brief Reads line filter settings from "log" field of given device configuration, as exemplified in @ref robot_config
+/// @param[in] configuration data handle of device configuration
+/// @param[out] ref_filter pointer to filter settings structure to be filled (with no filtering for missing fields)
+/// @return true if any filtering is configured, false otherwise
+bool AsyncLog_LoadFilter( DataHandle configuration, AsyncLogFilter* ref_filter );
+
+/// @brief Creates asynchronous log ring and registers it to the writer thread (not real-time safe)
+/// @param[in] name log identifier (e.g. its owner configuration name), used when listing counters (see AsyncLog_GetStatsString())
+/// @param[in] log reference to underlying text data log (not owned, should be ended after AsyncLog_Discard())
+/// @param[in] binaryLog reference to underlying binary log, used instead of text log if not NULL (not owned, should be discarded after AsyncLog_Discard())
+/// @param[in] lineLength maximum number of values (excluding time stamp) registered per line
+/// @param[in] bufferLength number of line slots in the ring (rounded up to a power of 2)
+/// @param[in] overflowPolicy action taken on full ring
+/// @return reference/pointer to newly created asynchronous log data structure (NULL if both logs are NULL)
+AsyncLog AsyncLog_Create( const char* name, Log log, BinaryLog binaryLog, size_t lineLength, size_t bufferLength, enum AsyncLogOverflowPolicy overflowPolicy );
+
+/// @brief Unregisters log from writer thread, writes its pending lines and deallocates its internal data (not real-time safe)
+/// @param[in] log reference to asynchronous log
+void AsyncLog_Discard( AsyncLog log );
+
+/// @brief Sets filter applied to following lines (not real-time safe, should be called before registering lines)
+/// @param[in] log reference to asynchronous log
+/// @param[in] filter pointer to filter settings (NULL to remove filtering)
+void AsyncLog_SetFilter( AsyncLog log, const AsyncLogFilter* filter );
+
+/// @brief Updates log state checked by filter trigger, like the control state of the log owner (safe to call from any thread)
+/// @param[in] log reference to asynchronous log
+/// @param[in] state new state value
+void AsyncLog_SetState( AsyncLog log, int state );
+
+/// @brief Starts registering a new data line (producer side, real-time safe). Only one thread may register lines on a given log
+/// @param[in] log reference to asynchronous log
+/// @param[in] timeStamp time stamp of the new line
+/// @return true if a slot was acquired for the line, false if line was dropped
+bool AsyncLog_EnterNewLine( AsyncLog log, double timeStamp );
+
+/// @brief Copies values to the line started by AsyncLog_EnterNewLine() (producer side, real-time safe)
+/// @param[in] log reference to asynchronous log
+/// @param[in] valuesNumber number of values in list
+/// @param[in] valuesList list of values to be appended to the line
+void AsyncLog_RegisterList( AsyncLog log, size_t valuesNumber, const double* valuesList );
+
+/// @brief Makes current line available to the writer thread (producer side, real-time safe)
+/// @param[in] log reference to asynchronous log
+void AsyncLog_EndLine( AsyncLog log );
+
+/// @brief Gets current line counters of given log (safe to call from any thread)
+/// @param[in] log reference to asynchronous log
+/// @param[out] ref_stats pointer to counters structure where values will be stored
+void AsyncLog_GetStats( AsyncLog log, AsyncLogStats* ref_stats );
+
+/// @brief Gets line counters of all registered logs (safe to call from any thread, not real-time safe), as a JSON-format string like:
+/// @code
+/// { "<log1_name>":{ "written":<lines>, "dropped_new":<lines>, "dropped_old":<lines>, "truncated":<lines> }, "<log2_name>":{ ... } }
+/// @endcode
+/// (see AsyncLogStats fields). Logs that don't fit in the string are left out
+/// @param[out] statsString buffer where the string will be stored
+/// @param[in] maxLength size of statsString buffer
+/// @return number of listed logs
+size_t AsyncLog_GetStatsString( char* statsString, size_t maxLength );
+
+/// @brief Gets overflow policy of given log
+/// @param[in] log reference to asynchronous log
+/// @return overflow policy set on log creation
+enum AsyncLogOverflowPolicy AsyncLog_GetOverflowPolicy( AsyncLog log );
+
+
+#endif // ASYNC_LOG_H
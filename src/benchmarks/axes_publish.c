@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Measures the cost of publishing axis measurements (control thread snapshot + message packing) for increasing axis counts.
+/// Results are printed as tab-separated columns: axes number, messages per publication, nanoseconds per snapshot and nanoseconds per packing.
+
+#include "dof_frames.h"
+#include "triple_buffer.h"
+
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t AXES_NUMBERS_LIST[] = { 1, 2, 4, 8, 16, 17, 18, 32, 64, 128, 256, 512, 1024 };
+const size_t PUBLISH_ITERATIONS_NUMBER = 20000;
+
+
+int main( int argc, char* argv[] )
+{
+  size_t iterationsNumber = ( argc > 1 ) ? (size_t) strtoul( argv[ 1 ], NULL, 10 ) : PUBLISH_ITERATIONS_NUMBER;
+  if( iterationsNumber == 0 ) iterationsNumber = PUBLISH_ITERATIONS_NUMBER;
+  
+  static Byte message[ IPC_MAX_MESSAGE_LENGTH ];
+  
+  printf( "axes\tmessages\tsnapshot_ns\tpack_ns\n" );
+  
+  for( size_t testIndex = 0; testIndex < sizeof(AXES_NUMBERS_LIST) / sizeof(size_t); testIndex++ )
+  {
+    size_t axesNumber = AXES_NUMBERS_LIST[ testIndex ];
+    
+    DoFVariables* axisMeasuresList = (DoFVariables*) calloc( axesNumber, sizeof(DoFVariables) );
+    for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+      axisMeasuresList[ axisIndex ].position = rand() / (double) RAND_MAX;
+    
+    TripleBuffer snapshotBuffer = TripleBuffer_Create( axesNumber * sizeof(DoFVariables) );
+    
+    double startTime = Time_GetExecSeconds();
+    for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    {
+      DoFVariables* snapshotList = (DoFVariables*) TripleBuffer_GetWriteData( snapshotBuffer );
+      for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+        snapshotList[ axisIndex ] = axisMeasuresList[ axisIndex ];
+      TripleBuffer_Publish( snapshotBuffer );
+    }
+    double snapshotTime = ( Time_GetExecSeconds() - startTime ) / iterationsNumber;
+    
+    size_t fragmentsNumber = DoFFrame_GetFragmentsNumber( axesNumber );
+    size_t checksum = 0;
+    startTime = Time_GetExecSeconds();
+    for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    {
+      const DoFVariables* snapshotList = (const DoFVariables*) TripleBuffer_Acquire( snapshotBuffer, NULL );
+      for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+      {
+        memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+        checksum += DoFFrame_WriteFragment( message, snapshotList, axesNumber, (uint32_t) iteration, fragmentIndex );
+      }
+    }
+    double packTime = ( Time_GetExecSeconds() - startTime ) / iterationsNumber;
+    
+    if( checksum != iterationsNumber * axesNumber ) fprintf( stderr, "packed %lu blocks, expected %lu\n", checksum, iterationsNumber * axesNumber );
+    
+    printf( "%lu\t%lu\t%.1f\t%.1f\n", axesNumber, fragmentsNumber, snapshotTime * 1e9, packTime * 1e9 );
+    
+    TripleBuffer_Discard( snapshotBuffer );
+    free( axisMeasuresList );
+  }
+  
+  return 0;
+}
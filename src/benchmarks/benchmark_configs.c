@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "benchmark_configs.h"
+
+#include "config_keys.h"
+
+#include <stdio.h>
+#include <string.h>
+#ifdef WIN32
+#include <direct.h>
+#define mkdir( dirPath ) _mkdir( dirPath )
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#define mkdir( dirPath ) mkdir( dirPath, 0755 )
+#endif
+
+#define CONFIG_PATH_MAX_LENGTH 256
+
+static char configPathsList[ BENCHMARK_CONFIGS_MAX_NUMBER ][ CONFIG_PATH_MAX_LENGTH ];
+static char configNamesList[ BENCHMARK_CONFIGS_MAX_NUMBER ][ CONFIG_PATH_MAX_LENGTH ];
+static size_t configsNumber = 0;
+
+
+const char* BenchmarkConfigs_Write( const char* category, const char* name, const char* configString )
+{
+  if( configsNumber >= BENCHMARK_CONFIGS_MAX_NUMBER ) return NULL;
+  
+  char* configPath = configPathsList[ configsNumber ];
+  snprintf( configPath, CONFIG_PATH_MAX_LENGTH, KEY_CONFIG "/%s/" BENCHMARK_DIR, category );
+  (void) mkdir( configPath );
+  snprintf( configPath, CONFIG_PATH_MAX_LENGTH, KEY_CONFIG "/%s/" BENCHMARK_DIR "/%s.json", category, name );
+  
+  FILE* configFile = fopen( configPath, "w" );
+  if( configFile == NULL ) return NULL;
+  fprintf( configFile, "%s\n", configString );
+  fclose( configFile );
+  
+  char* configName = configNamesList[ configsNumber++ ];
+  snprintf( configName, CONFIG_PATH_MAX_LENGTH, BENCHMARK_DIR "/%s", name );
+  
+  return configName;
+}
+
+void BenchmarkConfigs_RemoveAll( void )
+{
+  for( size_t configIndex = 0; configIndex < configsNumber; configIndex++ )
+  {
+    (void) remove( configPathsList[ configIndex ] );
+    // Directories are only removed when empty (e.g. after their last file)
+    *strrchr( configPathsList[ configIndex ], '/' ) = '\0';
+    (void) rmdir( configPathsList[ configIndex ] );
+  }
+  configsNumber = 0;
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file benchmark_configs.h
+/// @brief Temporary configuration files for benchmark tools
+///
+/// Benchmarks build their devices and robots from generated configurations, written to <root_dir>/config/<category>/benchmark/ (relative to 
+/// current directory) and removed before exiting.
+
+
+#ifndef BENCHMARK_CONFIGS_H
+#define BENCHMARK_CONFIGS_H
+
+#define BENCHMARK_DIR "benchmark"                 ///< Subdirectory (of each configuration category) for generated configurations
+#define BENCHMARK_CONFIGS_MAX_NUMBER 32           ///< Maximum number of configuration files written at the same time
+
+
+/// @brief Writes configuration file to <root_dir>/config/<category>/benchmark/<name>.json
+/// @param[in] category configuration category directory (e.g. KEY_SENSORS, from config_keys.h)
+/// @param[in] name configuration file name (without extension)
+/// @param[in] configString configuration (JSON) contents
+/// @return configuration name ("benchmark/<name>", valid until BenchmarkConfigs_RemoveAll()), or NULL on writing errors
+const char* BenchmarkConfigs_Write( const char* category, const char* name, const char* configString );
+
+/// @brief Removes all configuration files (and then empty directories) written with BenchmarkConfigs_Write()
+void BenchmarkConfigs_RemoveAll( void );
+
+
+#endif // BENCHMARK_CONFIGS_H
@@ -0,0 +1,315 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Measures the whole control loop (robot control thread) of generated robots with increasing number of joints, so that scaling limits of the 
+/// measuring, linearization, logging and messages packing paths can be located. Each joint actuator has the same number of DummyIO sensors, and 
+/// the PassThrough controller maps joints directly to axes, so that controller costs are negligible.
+/// The DummyIO (or SyntheticIO) and PassThrough plug-ins must be available in <root_dir>/plugins/ (benchmark configurations are written to and 
+/// removed from <root_dir>/config/*/benchmark/).
+/// Usage: ControlLoopBenchmark [--root <root_dir>] [--log <log_dir>] [--sensors <sensors_per_joint>] [--cycles <cycles_number>] 
+///                             [--time-step <seconds>] [--max-joints <joints_number>] [--log-data] [--synthetic]
+/// With zero time step, control cycles run back to back. With --log-data, robots log to binary files (in <log_dir>) as in normal operation. 
+/// With --synthetic, sensors read reproducible multi-sample blocks (sine and gaussian noise channels of the same device, sampled at 1 kHz 
+/// and summed into a noisy sine) from SyntheticIO instead of single DummyIO values.
+/// Results are printed as tab-separated columns: joints number, sensors per joint, measured cycles, mean, standard deviation, median, 99th percentile 
+/// and maximum cycle duration (in microseconds), number of cycles longer than time step, process CPU use (percentage of one core, over measured 
+/// cycles, from clock()) and mean axes message packing time (in microseconds, per published snapshot).
+
+#include "robot.h"
+#include "trace_points.h"
+#include "device_registry.h"
+#include "dof_frames.h"
+#include "binary_log.h"
+#include "config_keys.h"
+#include "benchmark_configs.h"
+
+#include "debug/data_logging.h"
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef WIN32
+#include "getopt.h"
+#include <direct.h>
+#define chdir _chdir
+#else
+#include <getopt.h>
+#include <unistd.h>
+#endif
+
+#define CONFIG_NAME_MAX_LENGTH 64
+#define DUMMY_INPUT "{ \"interface\": { \"type\": \"DummyIO\", \"config\": \"NULL\", \"channel\": 0 } }"
+#define SYNTHETIC_INPUT( channel ) "{ \"interface\": { \"type\": \"SyntheticIO\", \"config\": \"rate=1000 samples=16 sine noise:0.01\", \"channel\": " #channel " } }"
+
+const size_t DEFAULT_SENSORS_NUMBER = 2;
+const size_t DEFAULT_CYCLES_NUMBER = 2000;
+const double DEFAULT_TIME_STEP = 0.005;
+const size_t DEFAULT_MAX_JOINTS_NUMBER = 256;
+const unsigned long WARM_UP_CYCLES_NUMBER = 100;
+const unsigned long SNAPSHOT_POLL_INTERVAL_MS = 20;     // Same as robot axes publishing minimum interval
+
+const char* SENSOR_VARIABLES_LIST[] = { "POSITION", "VELOCITY", "FORCE", "ACCELERATION" };
+
+typedef struct _LoopResult
+{
+  unsigned long cyclesNumber;
+  double meanDuration, durationDeviation;
+  double medianDuration, highDuration, maxDuration;
+  size_t missesNumber;
+  double cpuUse;
+  double packingTime;
+}
+LoopResult;
+
+// Keeps results alive, so that measured calls are not optimized away
+static volatile size_t resultsSink = 0;
+
+
+static char* CreateRobotConfig( size_t, const char*, double, bool );
+static bool RunControlLoop( double*, size_t, double, LoopResult* );
+static int CompareDurations( const void*, const void* );
+
+int main( int argc, char* argv[] )
+{
+  const char* rootDirectory = ".";
+  const char* logDirectory = "./" KEY_LOGS "/";
+  size_t sensorsNumber = DEFAULT_SENSORS_NUMBER;
+  size_t cyclesNumber = DEFAULT_CYCLES_NUMBER;
+  double timeStep = DEFAULT_TIME_STEP;
+  size_t maxJointsNumber = DEFAULT_MAX_JOINTS_NUMBER;
+  bool isLogEnabled = false;
+  bool isSynthetic = false;
+  
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "root", required_argument, NULL, 'r' },
+    { "log", required_argument, NULL, 'l' },
+    { "sensors", required_argument, NULL, 's' },
+    { "cycles", required_argument, NULL, 'c' },
+    { "time-step", required_argument, NULL, 't' },
+    { "max-joints", required_argument, NULL, 'j' },
+    { "log-data", no_argument, NULL, 'd' },
+    { "synthetic", no_argument, NULL, 'y' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  int optionChar;
+  while( (optionChar = getopt_long( argc, argv, "hr:l:s:c:t:j:dy", longOptions, NULL )) != -1 )
+  {
+    if( optionChar == 'r' ) rootDirectory = optarg;
+    else if( optionChar == 'l' ) logDirectory = optarg;
+    else if( optionChar == 's' ) sensorsNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 'c' ) cyclesNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 't' ) timeStep = strtod( optarg, NULL );
+    else if( optionChar == 'j' ) maxJointsNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 'd' ) isLogEnabled = true;
+    else if( optionChar == 'y' ) isSynthetic = true;
+    else
+    {
+      printf( "usage: %s [--root <root_dir>] [--log <log_dir>] [--sensors <sensors_per_joint>] [--cycles <cycles_number>] "
+              "[--time-step <seconds>] [--max-joints <joints_number>] [--log-data] [--synthetic]\n", argv[ 0 ] );
+      return ( optionChar == 'h' ) ? 0 : -1;
+    }
+  }
+  if( sensorsNumber == 0 ) sensorsNumber = 1;
+  if( cyclesNumber == 0 ) cyclesNumber = DEFAULT_CYCLES_NUMBER;
+  if( timeStep < 0.0 ) timeStep = 0.0;
+  
+  Log_SetDirectory( logDirectory );
+  BinaryLog_SetDirectory( logDirectory );
+  if( chdir( rootDirectory ) != 0 )
+  {
+    fprintf( stderr, "could not access root directory %s\n", rootDirectory );
+    return -1;
+  }
+  
+  TracePoints_Init();
+  DeviceRegistry_Init();
+  
+  // All joints share the same actuator configuration (each one still gets its own actuator, sensors and motor)
+  const char* sensorName = BenchmarkConfigs_Write( KEY_SENSORS, "sensor", isSynthetic ? "{ \"inputs\": [ " SYNTHETIC_INPUT( 0 ) ", " SYNTHETIC_INPUT( 1 ) " ], \"output\": \"( in0 + in1 ) * 2.0 / 3.0\" }"
+                                                                                   : "{ \"inputs\": [ " DUMMY_INPUT " ], \"output\": \"in0 * 2.0 / 3.0\" }" );
+  const char* motorName = BenchmarkConfigs_Write( KEY_MOTORS, "motor", "{ \"interface\": { \"type\": \"DummyIO\", \"config\": \"NULL\", \"channel\": 0 }, "
+                                                                     "\"output\": \"set * 3.0 / 2.0\" }" );
+  char* configString = (char*) calloc( 256 + sensorsNumber * ( CONFIG_NAME_MAX_LENGTH + 64 ), sizeof(char) );
+  size_t configLength = sprintf( configString, "{ \"sensors\": [ " );
+  for( size_t sensorIndex = 0; sensorIndex < sensorsNumber; sensorIndex++ )
+  {
+    configLength += sprintf( configString + configLength, "%s{ \"variable\": \"%s\", \"config\": \"%s\", \"deviation\": 0.1 }", 
+                             ( sensorIndex > 0 ) ? ", " : "", SENSOR_VARIABLES_LIST[ sensorIndex % 4 ], sensorName );
+  }
+  sprintf( configString + configLength, " ], \"motor\": { \"variable\": \"VELOCITY\", \"config\": \"%s\" } }", motorName );
+  const char* actuatorName = BenchmarkConfigs_Write( KEY_ACTUATORS, "actuator", configString );
+  free( configString );
+  
+  if( sensorName == NULL || motorName == NULL || actuatorName == NULL )
+  {
+    fprintf( stderr, "could not write benchmark configurations\n" );
+    BenchmarkConfigs_RemoveAll();
+    return -1;
+  }
+  
+  double* durationsList = (double*) calloc( cyclesNumber, sizeof(double) );
+  
+  printf( "joints\tsensors\tcycles\tmean_us\tstddev_us\tp50_us\tp99_us\tmax_us\tmisses\tcpu_percent\tpacking_us\n" );
+  
+  for( size_t jointsNumber = 1; jointsNumber <= maxJointsNumber; jointsNumber *= 2 )
+  {
+    char robotName[ CONFIG_NAME_MAX_LENGTH ];
+    snprintf( robotName, CONFIG_NAME_MAX_LENGTH, "robot_%lu", (unsigned long) jointsNumber );
+    configString = CreateRobotConfig( jointsNumber, actuatorName, timeStep, isLogEnabled );
+    const char* robotConfigName = BenchmarkConfigs_Write( KEY_ROBOTS, robotName, configString );
+    free( configString );
+    
+    if( robotConfigName == NULL || !Robot_Init( robotConfigName ) )
+    {
+      fprintf( stderr, "could not load robot with %lu joints\n", (unsigned long) jointsNumber );
+      continue;
+    }
+    
+    LoopResult result = { 0 };
+    if( RunControlLoop( durationsList, cyclesNumber, timeStep, &result ) )
+    {
+      printf( "%lu\t%lu\t%lu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%lu\t%.1f\t%.3f\n", (unsigned long) jointsNumber, (unsigned long) sensorsNumber, 
+              result.cyclesNumber, 1e6 * result.meanDuration, 1e6 * result.durationDeviation, 1e6 * result.medianDuration, 
+              1e6 * result.highDuration, 1e6 * result.maxDuration, (unsigned long) result.missesNumber, result.cpuUse, 1e6 * result.packingTime );
+      fflush( stdout );
+    }
+    else fprintf( stderr, "could not run control loop with %lu joints\n", (unsigned long) jointsNumber );
+    
+    Robot_End();
+  }
+  
+  free( durationsList );
+  
+  BenchmarkConfigs_RemoveAll();
+  
+  DeviceRegistry_End();
+  TracePoints_End();
+  
+  return 0;
+}
+
+// Builds robot configuration with given number of joints, all with the same actuator configuration (returned string should be deallocated)
+static char* CreateRobotConfig( size_t jointsNumber, const char* actuatorName, double timeStep, bool isLogEnabled )
+{
+  size_t configMaxLength = 512 + jointsNumber * ( strlen( actuatorName ) + 4 );
+  char* configString = (char*) calloc( configMaxLength, sizeof(char) );
+  
+  size_t configLength = snprintf( configString, configMaxLength, "{ \"controller\": { \"type\": \"PassThrough\", \"config\": \"%lu\", \"time_step\": %g }, "
+                                                                 "\"actuators\": [ ", (unsigned long) jointsNumber, timeStep );
+  for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
+    configLength += snprintf( configString + configLength, configMaxLength - configLength, "%s\"%s\"", ( jointIndex > 0 ) ? ", " : "", actuatorName );
+  snprintf( configString + configLength, configMaxLength - configLength, " ]%s }", isLogEnabled ? ", \"log\": { \"format\": \"binary\", \"to_file\": true }" : "" );
+  
+  return configString;
+}
+
+// Runs control of active robot (in operation state) until given number of cycles is measured after warm-up, while packing its published snapshots 
+// as the communication thread does
+static bool RunControlLoop( double* durationsList, size_t cyclesNumber, double timeStep, LoopResult* ref_result )
+{
+  static Byte message[ IPC_MAX_MESSAGE_LENGTH ];
+  
+  size_t axesNumber = Robot_GetAxesNumber();
+  size_t fragmentsNumber = DoFFrame_GetFragmentsNumber( axesNumber );
+  
+  // Durations are stored by the control thread itself, that keeps overwriting the oldest ones until it stops
+  Robot_SetCycleDurationsBuffer( durationsList, cyclesNumber );
+  if( !Robot_Enable() ) return false;
+  (void) Robot_SetControlState( CONTROL_OPERATION );
+  
+  // Stalled control (e.g. blocked devices) is given up after 10 times the expected running time
+  double timeout = 1.0 + 10.0 * ( WARM_UP_CYCLES_NUMBER + cyclesNumber ) * timeStep;
+  double startTime = Time_GetExecSeconds();
+  
+  unsigned long cycleIndex = 0;
+  while( cycleIndex < WARM_UP_CYCLES_NUMBER && Time_GetExecSeconds() - startTime < timeout )
+  {
+    Time_Delay( 1 );
+    (void) Robot_UpdateSnapshot( &cycleIndex );
+  }
+  
+  unsigned long startCycleIndex = cycleIndex;
+  clock_t startClock = clock();
+  double measureStartTime = Time_GetExecSeconds();
+  double packingTimesSum = 0.0;
+  size_t packingsNumber = 0;
+  while( cycleIndex - startCycleIndex < cyclesNumber && Time_GetExecSeconds() - startTime < timeout )
+  {
+    Time_Delay( SNAPSHOT_POLL_INTERVAL_MS );
+    if( !Robot_UpdateSnapshot( &cycleIndex ) ) continue;
+    
+    double packingStartTime = Time_GetExecSeconds();
+    const DoFVariables* measuresList = Robot_GetAxisMeasuresList();
+    for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+    {
+      memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+      resultsSink += DoFFrame_WriteFragment( message, measuresList, axesNumber, (uint32_t) cycleIndex, fragmentIndex );
+    }
+    packingTimesSum += Time_GetExecSeconds() - packingStartTime;
+    packingsNumber++;
+  }
+  double cpuTime = (double) ( clock() - startClock ) / CLOCKS_PER_SEC;
+  double elapsedTime = Time_GetExecSeconds() - measureStartTime;
+  
+  (void) Robot_Disable();
+  Robot_SetCycleDurationsBuffer( NULL, 0 );
+  
+  (void) Robot_UpdateSnapshot( &cycleIndex );
+  if( cycleIndex - startCycleIndex < cyclesNumber ) return false;
+  
+  ref_result->cyclesNumber = cyclesNumber;
+  double durationsSum = 0.0, squaredDurationsSum = 0.0;
+  for( size_t durationIndex = 0; durationIndex < cyclesNumber; durationIndex++ )
+  {
+    durationsSum += durationsList[ durationIndex ];
+    squaredDurationsSum += durationsList[ durationIndex ] * durationsList[ durationIndex ];
+    if( timeStep > 0.0 && durationsList[ durationIndex ] > timeStep ) ref_result->missesNumber++;
+  }
+  ref_result->meanDuration = durationsSum / cyclesNumber;
+  double durationVariance = squaredDurationsSum / cyclesNumber - ref_result->meanDuration * ref_result->meanDuration;
+  ref_result->durationDeviation = ( durationVariance > 0.0 ) ? sqrt( durationVariance ) : 0.0;
+  
+  qsort( durationsList, cyclesNumber, sizeof(double), CompareDurations );
+  ref_result->medianDuration = durationsList[ cyclesNumber / 2 ];
+  ref_result->highDuration = durationsList[ (size_t) ( 0.99 * ( cyclesNumber - 1 ) ) ];
+  ref_result->maxDuration = durationsList[ cyclesNumber - 1 ];
+  
+  ref_result->cpuUse = ( elapsedTime > 0.0 ) ? 100.0 * cpuTime / elapsedTime : 0.0;
+  ref_result->packingTime = ( packingsNumber > 0 ) ? packingTimesSum / packingsNumber : 0.0;
+  
+  return true;
+}
+
+static int CompareDurations( const void* ref_duration, const void* ref_otherDuration )
+{
+  double duration = *((const double*) ref_duration);
+  double otherDuration = *((const double*) ref_otherDuration);
+  
+  return ( duration > otherDuration ) - ( duration < otherDuration );
+}
@@ -0,0 +1,385 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Measures, in isolation, the cost of each component called by the control and communication loops: sensors update (for transform expressions of 
+/// increasing complexity), motors control writing, actuators measuring (for 1 to 8 sensors), DoF impedance linearization (while filling its samples 
+/// window and after it is full), axes messages packing (for 1 to 17 axes) and numeric data logging.
+/// Devices are DummyIO channels, so the DummyIO plug-in must be available in <root_dir>/plugins/signal_io/ (benchmark configurations are written to 
+/// and removed from <root_dir>/config/*/benchmark/).
+/// Usage: HotPathBenchmark [--root <root_dir>] [--log <log_dir>] [--samples <samples_number>] [--iterations <iterations_number>]
+/// Results are printed as tab-separated columns: benchmark, case, samples number, iterations per sample, and mean, standard deviation, minimum and 
+/// maximum nanoseconds per operation (over samples).
+
+#include "sensor.h"
+#include "motor.h"
+#include "actuator.h"
+#include "async_log.h"
+#include "trace_points.h"
+#include "device_registry.h"
+#include "dof_frames.h"
+#include "triple_buffer.h"
+#include "config_keys.h"
+#include "benchmark_configs.h"
+
+#include "linearizer/system_linearizer.h"
+#include "debug/data_logging.h"
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef WIN32
+#include "getopt.h"
+#include <direct.h>
+#define chdir _chdir
+#else
+#include <getopt.h>
+#include <unistd.h>
+#endif
+
+#define CASE_NAME_MAX_LENGTH 64
+#define DUMMY_INPUT "{ \"interface\": { \"type\": \"DummyIO\", \"config\": \"NULL\", \"channel\": 0 } }"
+
+const size_t DEFAULT_SAMPLES_NUMBER = 20;
+const size_t DEFAULT_ITERATIONS_NUMBER = 10000;
+
+typedef struct _SensorCase
+{
+  const char* name;
+  size_t inputsNumber;
+  const char* expression;
+}
+SensorCase;
+
+const SensorCase SENSOR_CASES_LIST[] = { { "identity", 1, "in0" }, { "linear", 1, "in0 * 2.0 / 3.0" }, 
+                                         { "nonlinear", 1, "sqrt( in0 * in0 + 1.0 ) * sin( in0 ) + exp( -in0 ) * cos( 2.0 * in0 )" },
+                                         { "4_inputs", 4, "( in0 + in1 + in2 + in3 ) / 4.0" } };
+const size_t ACTUATOR_SENSORS_NUMBERS_LIST[] = { 1, 2, 4, 8 };
+const size_t AXES_NUMBERS_LIST[] = { 1, 2, 4, 8, 16, 17 };
+const size_t LOG_VALUES_NUMBERS_LIST[] = { 3, 7, 32 };
+const char* SENSOR_VARIABLES_LIST[] = { "POSITION", "VELOCITY", "FORCE", "ACCELERATION" };
+
+// Defined in robot.c (control thread internal function, without public declaration)
+void LinearizeDoF( DoFVariables* measures, DoFVariables* setpoints, LinearSystem linearizer );
+
+typedef void (*BenchmarkStep)( void* caseData, size_t iterationsNumber );
+typedef void (*BenchmarkSetup)( void* caseData );
+
+typedef struct _LinearizationCase
+{
+  LinearSystem linearizer;
+  DoFVariables measures;
+  DoFVariables setpoints;
+}
+LinearizationCase;
+
+typedef struct _PackingCase
+{
+  TripleBuffer snapshotBuffer;
+  size_t axesNumber;
+  size_t fragmentsNumber;
+}
+PackingCase;
+
+typedef struct _LoggingCase
+{
+  Log log;
+  AsyncLog asyncLog;
+  double* valuesList;
+  size_t valuesNumber;
+}
+LoggingCase;
+
+static size_t samplesNumber = DEFAULT_SAMPLES_NUMBER;
+static size_t iterationsNumber = DEFAULT_ITERATIONS_NUMBER;
+
+// Keeps results alive, so that measured calls are not optimized away
+static volatile double resultsSink = 0.0;
+
+
+static void RunBenchmark( const char*, const char*, BenchmarkStep, BenchmarkSetup, void*, size_t );
+
+static void UpdateSensor( void* ref_sensor, size_t iterationsNumber )
+{
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    resultsSink += Sensor_Update( (Sensor) ref_sensor );
+}
+
+static void WriteMotorControl( void* ref_motor, size_t iterationsNumber )
+{
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Motor_WriteControl( (Motor) ref_motor, 1e-3 * (double) ( iteration % 1000 ) );
+}
+
+static void GetActuatorMeasures( void* ref_actuator, size_t iterationsNumber )
+{
+  DoFVariables measures = { 0.0 };
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    (void) Actuator_GetMeasures( (Actuator) ref_actuator, &measures, 0.005 );
+    resultsSink += measures.position;
+  }
+}
+
+static void ResetLinearizer( void* ref_linearization )
+{
+  LinearizationCase* linearization = (LinearizationCase*) ref_linearization;
+  if( linearization->linearizer != NULL ) SystemLinearizer_DeleteSystem( linearization->linearizer );
+  linearization->linearizer = SystemLinearizer_CreateSystem( 3, 1, LINEARIZATION_MAX_SAMPLES );
+}
+
+static void LinearizeSamples( void* ref_linearization, size_t iterationsNumber )
+{
+  LinearizationCase* linearization = (LinearizationCase*) ref_linearization;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    // Varying (but deterministic) motion, so that identification is not degenerate
+    double phase = 1e-2 * (double) iteration;
+    linearization->measures.position = sin( phase );
+    linearization->measures.velocity = cos( phase );
+    linearization->measures.acceleration = -sin( phase );
+    linearization->measures.force = 2.0 * sin( phase ) + 0.5 * cos( phase );
+    LinearizeDoF( &(linearization->measures), &(linearization->setpoints), linearization->linearizer );
+  }
+  resultsSink += linearization->measures.stiffness;
+}
+
+static void PackAxes( void* ref_packing, size_t iterationsNumber )
+{
+  static Byte message[ IPC_MAX_MESSAGE_LENGTH ];
+  
+  PackingCase* packing = (PackingCase*) ref_packing;
+  // Same steps as measures publishing on communication thread
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    const DoFVariables* snapshotList = (const DoFVariables*) TripleBuffer_Acquire( packing->snapshotBuffer, NULL );
+    for( size_t fragmentIndex = 0; fragmentIndex < packing->fragmentsNumber; fragmentIndex++ )
+    {
+      memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+      resultsSink += DoFFrame_WriteFragment( message, snapshotList, packing->axesNumber, (uint32_t) iteration, fragmentIndex );
+    }
+  }
+}
+
+static void RegisterLogList( void* ref_logging, size_t iterationsNumber )
+{
+  LoggingCase* logging = (LoggingCase*) ref_logging;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    Log_EnterNewLine( logging->log, (double) iteration );
+    Log_RegisterList( logging->log, logging->valuesNumber, logging->valuesList );
+  }
+}
+
+static void RegisterAsyncLogList( void* ref_logging, size_t iterationsNumber )
+{
+  LoggingCase* logging = (LoggingCase*) ref_logging;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    if( AsyncLog_EnterNewLine( logging->asyncLog, (double) iteration ) )
+    {
+      AsyncLog_RegisterList( logging->asyncLog, logging->valuesNumber, logging->valuesList );
+      AsyncLog_EndLine( logging->asyncLog );
+    }
+  }
+}
+
+
+int main( int argc, char* argv[] )
+{
+  const char* rootDirectory = ".";
+  const char* logDirectory = "./" KEY_LOGS "/";
+  
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "root", required_argument, NULL, 'r' },
+    { "log", required_argument, NULL, 'l' },
+    { "samples", required_argument, NULL, 's' },
+    { "iterations", required_argument, NULL, 'i' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  int optionChar;
+  while( (optionChar = getopt_long( argc, argv, "hr:l:s:i:", longOptions, NULL )) != -1 )
+  {
+    if( optionChar == 'r' ) rootDirectory = optarg;
+    else if( optionChar == 'l' ) logDirectory = optarg;
+    else if( optionChar == 's' ) samplesNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 'i' ) iterationsNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else
+    {
+      printf( "usage: %s [--root <root_dir>] [--log <log_dir>] [--samples <samples_number>] [--iterations <iterations_number>]\n", argv[ 0 ] );
+      return ( optionChar == 'h' ) ? 0 : -1;
+    }
+  }
+  if( samplesNumber < 2 ) samplesNumber = 2;
+  if( iterationsNumber == 0 ) iterationsNumber = DEFAULT_ITERATIONS_NUMBER;
+  
+  Log_SetDirectory( logDirectory );
+  if( chdir( rootDirectory ) != 0 )
+  {
+    fprintf( stderr, "could not access root directory %s\n", rootDirectory );
+    return -1;
+  }
+  
+  TracePoints_Init();
+  DeviceRegistry_Init();
+  
+  printf( "benchmark\tcase\tsamples\titerations\tmean_ns\tstddev_ns\tmin_ns\tmax_ns\n" );
+  
+  char caseName[ CASE_NAME_MAX_LENGTH ];
+  char configString[ 2048 ];
+  
+  for( size_t caseIndex = 0; caseIndex < sizeof(SENSOR_CASES_LIST) / sizeof(SensorCase); caseIndex++ )
+  {
+    const SensorCase* sensorCase = &(SENSOR_CASES_LIST[ caseIndex ]);
+    size_t configLength = snprintf( configString, sizeof(configString), "{ \"inputs\": [ " DUMMY_INPUT );
+    for( size_t inputIndex = 1; inputIndex < sensorCase->inputsNumber; inputIndex++ )
+      configLength += snprintf( configString + configLength, sizeof(configString) - configLength, ", " DUMMY_INPUT );
+    snprintf( configString + configLength, sizeof(configString) - configLength, " ], \"output\": \"%s\" }", sensorCase->expression );
+    const char* sensorCaseName = BenchmarkConfigs_Write( KEY_SENSORS, sensorCase->name, configString );
+    if( sensorCaseName == NULL )
+    {
+      fprintf( stderr, "could not write %s sensor configuration\n", sensorCase->name );
+      continue;
+    }
+    Sensor sensor = Sensor_Init( sensorCaseName );
+    if( sensor == NULL ) fprintf( stderr, "could not load %s sensor\n", sensorCase->name );
+    else RunBenchmark( "Sensor_Update", sensorCase->name, UpdateSensor, NULL, sensor, iterationsNumber );
+    Sensor_End( sensor );
+  }
+  
+  const char* motorName = BenchmarkConfigs_Write( KEY_MOTORS, "motor", "{ \"interface\": { \"type\": \"DummyIO\", \"config\": \"NULL\", \"channel\": 0 }, "
+                                                                       "\"reference\": " DUMMY_INPUT ", \"output\": \"( set - ref * 2.0 / 3.0 ) * 3.0 / 2.0\" }" );
+  if( motorName == NULL ) fprintf( stderr, "could not write motor configuration\n" );
+  Motor motor = ( motorName != NULL ) ? Motor_Init( motorName ) : NULL;
+  if( motor == NULL ) fprintf( stderr, "could not load motor\n" );
+  else
+  {
+    Motor_SetOperation( motor );
+    RunBenchmark( "Motor_WriteControl", "reference", WriteMotorControl, NULL, motor, iterationsNumber );
+  }
+  Motor_End( motor );
+  
+  const char* sensorName = BenchmarkConfigs_Write( KEY_SENSORS, "sensor", "{ \"inputs\": [ " DUMMY_INPUT " ], \"output\": \"in0 * 2.0 / 3.0\" }" );
+  if( sensorName == NULL || motorName == NULL ) fprintf( stderr, "could not write actuator devices configurations\n" );
+  for( size_t caseIndex = 0; caseIndex < sizeof(ACTUATOR_SENSORS_NUMBERS_LIST) / sizeof(size_t) && sensorName != NULL && motorName != NULL; caseIndex++ )
+  {
+    size_t sensorsNumber = ACTUATOR_SENSORS_NUMBERS_LIST[ caseIndex ];
+    size_t configLength = snprintf( configString, sizeof(configString), "{ \"sensors\": [ " );
+    for( size_t sensorIndex = 0; sensorIndex < sensorsNumber; sensorIndex++ )
+    {
+      configLength += snprintf( configString + configLength, sizeof(configString) - configLength, "%s{ \"variable\": \"%s\", \"config\": \"%s\", \"deviation\": 0.1 }", 
+                                ( sensorIndex > 0 ) ? ", " : "", SENSOR_VARIABLES_LIST[ sensorIndex % 4 ], sensorName );
+    }
+    snprintf( configString + configLength, sizeof(configString) - configLength, " ], \"motor\": { \"variable\": \"VELOCITY\", \"config\": \"%s\" } }", motorName );
+    snprintf( caseName, CASE_NAME_MAX_LENGTH, "%lu_sensors", (unsigned long) sensorsNumber );
+    const char* actuatorName = BenchmarkConfigs_Write( KEY_ACTUATORS, caseName, configString );
+    if( actuatorName == NULL )
+    {
+      fprintf( stderr, "could not write actuator configuration with %s\n", caseName );
+      continue;
+    }
+    Actuator actuator = Actuator_Init( actuatorName );
+    if( actuator == NULL ) fprintf( stderr, "could not load actuator with %s\n", caseName );
+    else RunBenchmark( "Actuator_GetMeasures", caseName, GetActuatorMeasures, NULL, actuator, iterationsNumber );
+    Actuator_End( actuator );
+  }
+  
+  // Identification only starts when the samples window is full
+  LinearizationCase linearization = { .linearizer = NULL };
+  RunBenchmark( "LinearizeDoF", "filling_window", LinearizeSamples, ResetLinearizer, &linearization, LINEARIZATION_MAX_SAMPLES - 1 );
+  ResetLinearizer( &linearization );
+  LinearizeSamples( &linearization, LINEARIZATION_MAX_SAMPLES );
+  RunBenchmark( "LinearizeDoF", "full_window", LinearizeSamples, NULL, &linearization, iterationsNumber );
+  SystemLinearizer_DeleteSystem( linearization.linearizer );
+  
+  for( size_t caseIndex = 0; caseIndex < sizeof(AXES_NUMBERS_LIST) / sizeof(size_t); caseIndex++ )
+  {
+    PackingCase packing = { .axesNumber = AXES_NUMBERS_LIST[ caseIndex ] };
+    packing.fragmentsNumber = DoFFrame_GetFragmentsNumber( packing.axesNumber );
+    packing.snapshotBuffer = TripleBuffer_Create( packing.axesNumber * sizeof(DoFVariables) );
+    DoFVariables* snapshotList = (DoFVariables*) TripleBuffer_GetWriteData( packing.snapshotBuffer );
+    for( size_t axisIndex = 0; axisIndex < packing.axesNumber; axisIndex++ )
+      snapshotList[ axisIndex ].position = rand() / (double) RAND_MAX;
+    TripleBuffer_Publish( packing.snapshotBuffer );
+    snprintf( caseName, CASE_NAME_MAX_LENGTH, "%lu_axes", (unsigned long) packing.axesNumber );
+    RunBenchmark( "UpdateAxes_Packing", caseName, PackAxes, NULL, &packing, iterationsNumber );
+    TripleBuffer_Discard( packing.snapshotBuffer );
+  }
+  
+  for( size_t caseIndex = 0; caseIndex < sizeof(LOG_VALUES_NUMBERS_LIST) / sizeof(size_t); caseIndex++ )
+  {
+    LoggingCase logging = { .valuesNumber = LOG_VALUES_NUMBERS_LIST[ caseIndex ] };
+    logging.valuesList = (double*) calloc( logging.valuesNumber, sizeof(double) );
+    for( size_t valueIndex = 0; valueIndex < logging.valuesNumber; valueIndex++ )
+      logging.valuesList[ valueIndex ] = rand() / (double) RAND_MAX;
+    snprintf( caseName, CASE_NAME_MAX_LENGTH, "%lu_values", (unsigned long) logging.valuesNumber );
+    // Text logs are written to file, as on the asynchronous log writer thread
+    logging.log = Log_Init( BENCHMARK_DIR, 3 );
+    RunBenchmark( "Log_RegisterList", caseName, RegisterLogList, NULL, &logging, iterationsNumber );
+    logging.asyncLog = AsyncLog_Create( caseName, logging.log, NULL, logging.valuesNumber, ASYNC_LOG_DEFAULT_BUFFER_LENGTH, ASYNC_LOG_DROP_NEWEST );
+    RunBenchmark( "AsyncLog_RegisterList", caseName, RegisterAsyncLogList, NULL, &logging, iterationsNumber );
+    AsyncLog_Discard( logging.asyncLog );
+    Log_End( logging.log );
+    free( logging.valuesList );
+  }
+  
+  BenchmarkConfigs_RemoveAll();
+  
+  DeviceRegistry_End();
+  TracePoints_End();
+  
+  return 0;
+}
+
+// Times given number of step iterations per sample (after a warm-up run), printing per operation time statistics over samples
+static void RunBenchmark( const char* benchmarkName, const char* caseName, BenchmarkStep step, BenchmarkSetup setup, void* caseData, size_t stepIterationsNumber )
+{
+  if( setup != NULL ) setup( caseData );
+  step( caseData, stepIterationsNumber );
+  
+  double timesSum = 0.0, squaredTimesSum = 0.0;
+  double minTime = INFINITY, maxTime = 0.0;
+  for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+  {
+    if( setup != NULL ) setup( caseData );
+    double startTime = Time_GetExecSeconds();
+    step( caseData, stepIterationsNumber );
+    double operationTime = 1e9 * ( Time_GetExecSeconds() - startTime ) / stepIterationsNumber;
+    timesSum += operationTime;
+    squaredTimesSum += operationTime * operationTime;
+    if( operationTime < minTime ) minTime = operationTime;
+    if( operationTime > maxTime ) maxTime = operationTime;
+  }
+  
+  double meanTime = timesSum / samplesNumber;
+  double timesVariance = ( squaredTimesSum - samplesNumber * meanTime * meanTime ) / ( samplesNumber - 1 );
+  double timesDeviation = ( timesVariance > 0.0 ) ? sqrt( timesVariance ) : 0.0;
+  
+  printf( "%s\t%s\t%lu\t%lu\t%.1f\t%.1f\t%.1f\t%.1f\n", benchmarkName, caseName, (unsigned long) samplesNumber, (unsigned long) stepIterationsNumber, 
+          meanTime, timesDeviation, minTime, maxTime );
+  fflush( stdout );
+}
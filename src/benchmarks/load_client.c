@@ -0,0 +1,525 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Load generator and latency client for a running RobotControl server, connected through the same IPC layer as regular clients. Each client 
+/// streams setpoint frames for all robot axes at a fixed rate, while sending periodic configuration requests on the events connection, and measures:
+/// - setpoint to measure round-trip time: setpoints carry a sequence value (in all axes variables), recognized when echoed back in axis 0 measures. 
+///   The server robot must echo setpoints, as the PassThrough controller does with "<joints_number> loopback" configuration string
+/// - event reply time of requests (and number of requests without reply after 1 second)
+/// - received axis measure frames, and extended (fragmented) frames that could not be reassembled
+/// Clients run on separate threads, each one with its own connections. Sequence values also identify their client, so that each one only measures 
+/// its own echoes (with many clients, only setpoints not overwritten by other clients before the next control cycle are echoed).
+/// Usage: LoadClient [--addr <host>[:<channel>]] [--axes <axes_number>] [--rate <frames_per_second>] [--events <requests_per_second>] 
+///                   [--duration <seconds>] [--clients <clients_number>] [--poll <milliseconds>] [--trajectory <points_number>] [--drive-states]
+/// Axes number defaults to the one in the server robot configuration. With --drive-states, the first client enables the robot and sets it to 
+/// operation before streaming, and passivates and disables it afterwards. The default zero poll interval keeps clients busy waiting for messages.
+/// With --trajectory, setpoints of each axis are sent as trajectory blocks of the given number of points (all carrying the frame sequence value), 
+/// spread over the frame interval, so that the server trajectory queues are also loaded. Event replies are matched on their request code, 
+/// ignoring notifications broadcast to all clients.
+/// Results are printed as tab-separated columns, one line per client: client index, axes number, sent and echoed setpoint frames, round-trip mean, 
+/// median, 99th percentile and maximum (milliseconds), sent and lost event requests, reply mean, median, 99th percentile and maximum (milliseconds), 
+/// received measure frames and incomplete extended frames.
+
+#include "shared_robot_control.h"
+#include "dof_frames.h"
+
+#include "ipc/interface/ipc.h"
+#include "threads/threads.h"
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include "getopt.h"
+#else
+#include <getopt.h>
+#endif
+
+#define SEND_TIMES_NUMBER 4096                // Sent frames kept for echo matching (older echoes are ignored)
+#define SEQUENCE_MAX_VALUE 16777216           // Largest integer exactly represented by single precision message values
+
+const double DEFAULT_FRAMES_RATE = 100.0;
+const double DEFAULT_EVENTS_RATE = 10.0;
+const double DEFAULT_DURATION = 10.0;
+const double EVENT_REPLY_TIMEOUT = 1.0;
+const size_t MAX_CLIENTS_NUMBER = 256;
+
+typedef struct _LatencyStats
+{
+  double* samplesList;
+  size_t samplesNumber;
+  size_t maxSamplesNumber;
+}
+LatencyStats;
+
+typedef struct _LoadClient
+{
+  size_t index;
+  IPCConnection eventsConnection;
+  IPCConnection axesConnection;
+  DoFFrameAssembler measuresAssembler;
+  DoFVariables* setpointsList;
+  double sendTimesList[ SEND_TIMES_NUMBER ];
+  unsigned long framesSent;
+  unsigned long lastEchoSequence;
+  LatencyStats roundTrips;
+  unsigned long eventsSent;
+  unsigned long eventsLost;
+  LatencyStats replies;
+  unsigned long measureFrames;
+  unsigned long fragmentedFrames;
+  unsigned long assembledFrames;
+  uint32_t lastFragmentFrameID;
+}
+LoadClient;
+
+static const char* connectionHost = "127.0.0.1";
+static const char* connectionChannel = NULL;
+static size_t axesNumber = 0;
+static double framesRate = DEFAULT_FRAMES_RATE;
+static double eventsRate = DEFAULT_EVENTS_RATE;
+static double duration = DEFAULT_DURATION;
+static size_t clientsNumber = 1;
+static unsigned long pollInterval = 0;
+static size_t trajectoryPointsNumber = 0;
+static bool isDrivingStates = false;
+
+
+static bool OpenClient( LoadClient*, size_t );
+static void CloseClient( LoadClient* );
+static void* RunClient( void* );
+static void SendTrajectoryFrame( LoadClient*, Byte*, double );
+static bool RequestEvent( LoadClient*, Byte, Byte* );
+static bool IsEventReply( Byte, const Byte* );
+static void ReadMeasures( LoadClient*, const Byte*, double );
+static void AddLatency( LatencyStats*, double );
+static void PrintLatency( LatencyStats* );
+static size_t GetConfigAxesNumber( const char* );
+
+int main( int argc, char* argv[] )
+{
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "addr", required_argument, NULL, 'a' },
+    { "axes", required_argument, NULL, 'x' },
+    { "rate", required_argument, NULL, 'r' },
+    { "events", required_argument, NULL, 'e' },
+    { "duration", required_argument, NULL, 'd' },
+    { "clients", required_argument, NULL, 'c' },
+    { "poll", required_argument, NULL, 'p' },
+    { "trajectory", required_argument, NULL, 't' },
+    { "drive-states", no_argument, NULL, 's' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  char* connectionAddress = NULL;
+  int optionChar;
+  while( (optionChar = getopt_long( argc, argv, "ha:x:r:e:d:c:p:t:s", longOptions, NULL )) != -1 )
+  {
+    if( optionChar == 'a' ) connectionAddress = optarg;
+    else if( optionChar == 'x' ) axesNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 'r' ) framesRate = strtod( optarg, NULL );
+    else if( optionChar == 'e' ) eventsRate = strtod( optarg, NULL );
+    else if( optionChar == 'd' ) duration = strtod( optarg, NULL );
+    else if( optionChar == 'c' ) clientsNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 'p' ) pollInterval = strtoul( optarg, NULL, 10 );
+    else if( optionChar == 't' ) trajectoryPointsNumber = (size_t) strtoul( optarg, NULL, 10 );
+    else if( optionChar == 's' ) isDrivingStates = true;
+    else
+    {
+      printf( "usage: %s [--addr <host>[:<channel>]] [--axes <axes_number>] [--rate <frames_per_second>] [--events <requests_per_second>] "
+              "[--duration <seconds>] [--clients <clients_number>] [--poll <milliseconds>] [--trajectory <points_number>] [--drive-states]\n", argv[ 0 ] );
+      return ( optionChar == 'h' ) ? 0 : -1;
+    }
+  }
+  if( connectionAddress != NULL )
+  {
+    connectionHost = connectionAddress;
+    char* channelSeparator = strrchr( connectionAddress, ':' );
+    if( channelSeparator != NULL ) 
+    {
+      *channelSeparator = '\0';
+      connectionChannel = channelSeparator + 1;
+    }
+  }
+  if( framesRate <= 0.0 ) framesRate = DEFAULT_FRAMES_RATE;
+  if( duration <= 0.0 ) duration = DEFAULT_DURATION;
+  if( clientsNumber == 0 ) clientsNumber = 1;
+  if( clientsNumber > MAX_CLIENTS_NUMBER ) clientsNumber = MAX_CLIENTS_NUMBER;
+  // Each trajectory block (with 1 byte points number) should fit in a single extended frame fragment
+  size_t maxTrajectoryPointsNumber = ( IPC_MAX_MESSAGE_LENGTH - DOF_EXTENDED_HEADER_SIZE - DOF_EXTENDED_INDEX_SIZE - 1 ) / DOF_TRAJECTORY_POINT_SIZE;
+  if( maxTrajectoryPointsNumber > UINT8_MAX ) maxTrajectoryPointsNumber = UINT8_MAX;
+  if( trajectoryPointsNumber > maxTrajectoryPointsNumber ) trajectoryPointsNumber = maxTrajectoryPointsNumber;
+  
+  LoadClient* clientsList = (LoadClient*) calloc( clientsNumber, sizeof(LoadClient) );
+  
+  // First client also gets server robot configuration and drives its state, before other clients start
+  if( !OpenClient( &(clientsList[ 0 ]), 0 ) )
+  {
+    fprintf( stderr, "could not connect to server at %s\n", connectionHost );
+    free( clientsList );
+    return -1;
+  }
+  
+  Byte reply[ IPC_MAX_MESSAGE_LENGTH ];
+  if( !RequestEvent( &(clientsList[ 0 ]), ROBOT_REQ_GET_CONFIG, reply ) )
+  {
+    fprintf( stderr, "no reply from server at %s\n", connectionHost );
+    CloseClient( &(clientsList[ 0 ]) );
+    free( clientsList );
+    return -1;
+  }
+  reply[ IPC_MAX_MESSAGE_LENGTH - 1 ] = '\0';
+  fprintf( stderr, "server robot configuration: %s\n", (const char*) ( reply + 1 ) );
+  if( axesNumber == 0 ) axesNumber = GetConfigAxesNumber( (const char*) ( reply + 1 ) );
+  if( axesNumber == 0 )
+  {
+    fprintf( stderr, "no robot axes to stream setpoints to\n" );
+    CloseClient( &(clientsList[ 0 ]) );
+    free( clientsList );
+    return -1;
+  }
+  
+  const Byte STATE_REQUESTS_LIST[] = { ROBOT_REQ_ENABLE, ROBOT_REQ_OPERATE };
+  for( size_t requestIndex = 0; requestIndex < sizeof(STATE_REQUESTS_LIST) && isDrivingStates; requestIndex++ )
+  {
+    if( !RequestEvent( &(clientsList[ 0 ]), STATE_REQUESTS_LIST[ requestIndex ], reply ) ) reply[ 0 ] = 0x00;
+    fprintf( stderr, "state request %u reply: %u\n", STATE_REQUESTS_LIST[ requestIndex ], reply[ 0 ] );
+  }
+  
+  Thread* threadsList = (Thread*) calloc( clientsNumber, sizeof(Thread) );
+  for( size_t clientIndex = 0; clientIndex < clientsNumber; clientIndex++ )
+  {
+    threadsList[ clientIndex ] = THREAD_INVALID_HANDLE;
+    if( clientIndex > 0 && !OpenClient( &(clientsList[ clientIndex ]), clientIndex ) )
+    {
+      fprintf( stderr, "could not connect client %lu\n", (unsigned long) clientIndex );
+      continue;
+    }
+    threadsList[ clientIndex ] = Thread_Start( RunClient, &(clientsList[ clientIndex ]), THREAD_JOINABLE );
+  }
+  
+  printf( "client\taxes\tframes_sent\tframes_echoed\trtt_mean_ms\trtt_p50_ms\trtt_p99_ms\trtt_max_ms\t"
+          "events_sent\tevents_lost\treply_mean_ms\treply_p50_ms\treply_p99_ms\treply_max_ms\tmeasure_frames\tincomplete_frames\n" );
+  for( size_t clientIndex = 0; clientIndex < clientsNumber; clientIndex++ )
+  {
+    if( threadsList[ clientIndex ] == THREAD_INVALID_HANDLE ) continue;
+    
+    Thread_WaitExit( threadsList[ clientIndex ], (unsigned int) ( 1000 * ( duration + 2 * EVENT_REPLY_TIMEOUT ) ) );
+    
+    LoadClient* client = &(clientsList[ clientIndex ]);
+    printf( "%lu\t%lu\t%lu\t%lu\t", (unsigned long) clientIndex, (unsigned long) axesNumber, client->framesSent, (unsigned long) client->roundTrips.samplesNumber );
+    PrintLatency( &(client->roundTrips) );
+    printf( "\t%lu\t%lu\t", client->eventsSent, client->eventsLost );
+    PrintLatency( &(client->replies) );
+    printf( "\t%lu\t%lu\n", client->measureFrames, client->fragmentedFrames - client->assembledFrames );
+  }
+  
+  const Byte STOP_REQUESTS_LIST[] = { ROBOT_REQ_PASSIVATE, ROBOT_REQ_DISABLE };
+  for( size_t requestIndex = 0; requestIndex < sizeof(STOP_REQUESTS_LIST) && isDrivingStates; requestIndex++ )
+  {
+    if( !RequestEvent( &(clientsList[ 0 ]), STOP_REQUESTS_LIST[ requestIndex ], reply ) ) reply[ 0 ] = 0x00;
+    fprintf( stderr, "state request %u reply: %u\n", STOP_REQUESTS_LIST[ requestIndex ], reply[ 0 ] );
+  }
+  
+  for( size_t clientIndex = 0; clientIndex < clientsNumber; clientIndex++ )
+    CloseClient( &(clientsList[ clientIndex ]) );
+  free( clientsList );
+  free( threadsList );
+  
+  return 0;
+}
+
+static bool OpenClient( LoadClient* client, size_t clientIndex )
+{
+  client->index = clientIndex;
+  client->eventsConnection = IPC_OpenConnection( IPC_REQ, connectionHost, connectionChannel );
+  client->axesConnection = IPC_OpenConnection( IPC_CLIENT, connectionHost, connectionChannel );
+  client->measuresAssembler = DoFFrame_CreateAssembler();
+  
+  return ( client->eventsConnection != NULL && client->axesConnection != NULL );
+}
+
+static void CloseClient( LoadClient* client )
+{
+  if( client->eventsConnection != NULL ) IPC_CloseConnection( client->eventsConnection );
+  if( client->axesConnection != NULL ) IPC_CloseConnection( client->axesConnection );
+  DoFFrame_DiscardAssembler( client->measuresAssembler );
+  free( client->setpointsList );
+  free( client->roundTrips.samplesList );
+  free( client->replies.samplesList );
+  memset( client, 0, sizeof(LoadClient) );
+}
+
+static void* RunClient( void* ref_client )
+{
+  LoadClient* client = (LoadClient*) ref_client;
+  Byte* messageBuffer = (Byte*) calloc( IPC_MAX_MESSAGE_LENGTH, sizeof(Byte) );
+  
+  client->setpointsList = (DoFVariables*) calloc( axesNumber, sizeof(DoFVariables) );
+  client->roundTrips.maxSamplesNumber = (size_t) ( framesRate * duration ) + 1;
+  client->roundTrips.samplesList = (double*) calloc( client->roundTrips.maxSamplesNumber, sizeof(double) );
+  client->replies.maxSamplesNumber = (size_t) ( eventsRate * duration ) + 1;
+  client->replies.samplesList = (double*) calloc( client->replies.maxSamplesNumber, sizeof(double) );
+  
+  size_t fragmentsNumber = DoFFrame_GetFragmentsNumber( axesNumber );
+  double framesInterval = 1.0 / framesRate;
+  double eventsInterval = ( eventsRate > 0.0 ) ? 1.0 / eventsRate : 2 * duration;
+  
+  double startTime = Time_GetExecSeconds();
+  double nextFrameTime = startTime, nextEventTime = startTime;
+  double eventRequestTime = 0.0;
+  bool isEventPending = false;
+  double currentTime = startTime;
+  while( currentTime - startTime < duration || isEventPending )
+  {
+    // Frame values identify both sequence and client: sequence * clients number + client index
+    unsigned long frameValue = ( client->framesSent + 1 ) * clientsNumber + client->index;
+    if( currentTime >= nextFrameTime && currentTime - startTime < duration && frameValue < SEQUENCE_MAX_VALUE )
+    {
+      for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+      {
+        DoFVariables* setpoints = &(client->setpointsList[ axisIndex ]);
+        setpoints->position = setpoints->velocity = setpoints->force = setpoints->acceleration = (double) frameValue;
+      }
+      client->sendTimesList[ ++(client->framesSent) % SEND_TIMES_NUMBER ] = currentTime;
+      if( trajectoryPointsNumber > 0 ) SendTrajectoryFrame( client, messageBuffer, framesInterval );
+      else
+      {
+        for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+        {
+          memset( messageBuffer, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+          (void) DoFFrame_WriteFragment( messageBuffer, client->setpointsList, axesNumber, (uint32_t) client->framesSent, fragmentIndex );
+          IPC_WriteMessage( client->axesConnection, (const Byte*) messageBuffer );
+        }
+      }
+      nextFrameTime += framesInterval;
+      // Sending is not allowed to catch up with missed frames
+      if( nextFrameTime < currentTime ) nextFrameTime = currentTime + framesInterval;
+    }
+    
+    if( !isEventPending && currentTime >= nextEventTime && currentTime - startTime < duration )
+    {
+      memset( messageBuffer, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+      messageBuffer[ 0 ] = ROBOT_REQ_GET_CONFIG;
+      if( IPC_WriteMessage( client->eventsConnection, (const Byte*) messageBuffer ) )
+      {
+        client->eventsSent++;
+        eventRequestTime = currentTime;
+        isEventPending = true;
+      }
+      nextEventTime += eventsInterval;
+      if( nextEventTime < currentTime ) nextEventTime = currentTime + eventsInterval;
+    }
+    
+    while( IPC_ReadMessage( client->eventsConnection, messageBuffer ) )
+    {
+      if( !isEventPending || !IsEventReply( ROBOT_REQ_GET_CONFIG, messageBuffer ) ) continue;
+      AddLatency( &(client->replies), Time_GetExecSeconds() - eventRequestTime );
+      isEventPending = false;
+    }
+    if( isEventPending && currentTime - eventRequestTime > EVENT_REPLY_TIMEOUT )
+    {
+      client->eventsLost++;
+      isEventPending = false;
+    }
+    
+    while( IPC_ReadMessage( client->axesConnection, messageBuffer ) )
+      ReadMeasures( client, messageBuffer, Time_GetExecSeconds() );
+    
+    if( pollInterval > 0 ) Time_Delay( pollInterval );
+    currentTime = Time_GetExecSeconds();
+  }
+  
+  free( messageBuffer );
+  
+  return NULL;
+}
+
+// Sends setpoints of all axes as trajectory blocks, with equal points spread over the frame interval, in a single message or extended frame fragments
+static void SendTrajectoryFrame( LoadClient* client, Byte* messageBuffer, double framesInterval )
+{
+  size_t trajectorySize = 1 + trajectoryPointsNumber * DOF_TRAJECTORY_POINT_SIZE;
+  // Single messages only have 7 bits for axis indexes, besides the trajectory flag
+  bool isExtended = ( axesNumber >= DOF_TRAJECTORY_BLOCK_FLAG || 1 + axesNumber * ( 1 + trajectorySize ) > IPC_MAX_MESSAGE_LENGTH );
+  size_t fragmentMaxBlocks = isExtended ? ( IPC_MAX_MESSAGE_LENGTH - DOF_EXTENDED_HEADER_SIZE ) / ( DOF_EXTENDED_INDEX_SIZE + trajectorySize ) : axesNumber;
+  size_t fragmentsNumber = ( axesNumber + fragmentMaxBlocks - 1 ) / fragmentMaxBlocks;
+  if( fragmentsNumber > DOF_FRAME_MAX_FRAGMENTS ) return;
+  
+  uint32_t frameID = (uint32_t) client->framesSent;
+  for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+  {
+    size_t firstAxisIndex = fragmentIndex * fragmentMaxBlocks;
+    size_t blocksNumber = axesNumber - firstAxisIndex;
+    if( blocksNumber > fragmentMaxBlocks ) blocksNumber = fragmentMaxBlocks;
+    
+    memset( messageBuffer, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+    Byte* blockData = messageBuffer + 1;
+    if( isExtended )
+    {
+      // Header: marker, frame ID, fragment index, fragments number and blocks number
+      messageBuffer[ 0 ] = DOF_EXTENDED_FRAME_MARKER;
+      memcpy( messageBuffer + 1, &frameID, sizeof(uint32_t) );
+      messageBuffer[ 1 + sizeof(uint32_t) ] = (Byte) fragmentIndex;
+      messageBuffer[ 2 + sizeof(uint32_t) ] = (Byte) fragmentsNumber;
+      messageBuffer[ DOF_EXTENDED_HEADER_SIZE - 1 ] = (Byte) blocksNumber;
+      blockData = messageBuffer + DOF_EXTENDED_HEADER_SIZE;
+    }
+    else messageBuffer[ 0 ] = (Byte) blocksNumber;
+    
+    for( size_t axisIndex = firstAxisIndex; axisIndex < firstAxisIndex + blocksNumber; axisIndex++ )
+    {
+      if( isExtended )
+      {
+        uint16_t blockIndex = (uint16_t) ( axisIndex | DOF_EXTENDED_TRAJECTORY_BLOCK_FLAG );
+        memcpy( blockData, &blockIndex, DOF_EXTENDED_INDEX_SIZE );
+        blockData += DOF_EXTENDED_INDEX_SIZE;
+      }
+      else *(blockData++) = (Byte) ( axisIndex | DOF_TRAJECTORY_BLOCK_FLAG );
+      
+      *(blockData++) = (Byte) trajectoryPointsNumber;
+      for( size_t pointIndex = 0; pointIndex < trajectoryPointsNumber; pointIndex++ )
+      {
+        float timeOffset = (float) ( pointIndex * framesInterval / trajectoryPointsNumber );
+        memcpy( blockData, &timeOffset, sizeof(float) );
+        DoFFrame_WriteBlock( blockData + sizeof(float), &(client->setpointsList[ axisIndex ]) );
+        blockData += DOF_TRAJECTORY_POINT_SIZE;
+      }
+    }
+    
+    IPC_WriteMessage( client->axesConnection, (const Byte*) messageBuffer );
+  }
+}
+
+// Sends event request and waits for its reply (up to EVENT_REPLY_TIMEOUT), storing it on given buffer
+static bool RequestEvent( LoadClient* client, Byte requestCode, Byte* reply )
+{
+  memset( reply, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+  reply[ 0 ] = requestCode;
+  if( !IPC_WriteMessage( client->eventsConnection, (const Byte*) reply ) ) return false;
+  
+  double requestTime = Time_GetExecSeconds();
+  while( Time_GetExecSeconds() - requestTime < EVENT_REPLY_TIMEOUT )
+  {
+    while( IPC_ReadMessage( client->eventsConnection, reply ) )
+    {
+      if( IsEventReply( requestCode, reply ) ) return true;
+    }
+    Time_Delay( 1 );
+  }
+  
+  return false;
+}
+
+// Checks if events connection message is the reply to given request (with same or 0x00 failure code), and not a notification sent to all clients
+static bool IsEventReply( Byte requestCode, const Byte* message )
+{
+  if( message[ 0 ] == requestCode || message[ 0 ] == 0x00 ) return true;
+  
+  return ( requestCode == ROBOT_REQ_SET_CONFIG && message[ 0 ] == ROBOT_REP_CONFIG_LOADING );
+}
+
+// Counts received measure frames, matching echoed setpoint values (axis 0 position) with their send times
+static void ReadMeasures( LoadClient* client, const Byte* message, double receiveTime )
+{
+  if( message[ 0 ] == DOF_JOINTS_FRAME_MARKER ) return;
+  
+  DoFVariables axisMeasures = { 0.0 };
+  if( message[ 0 ] == DOF_EXTENDED_FRAME_MARKER )
+  {
+    uint32_t frameID;
+    memcpy( &frameID, message + 1, sizeof(uint32_t) );
+    if( client->fragmentedFrames == 0 || frameID != client->lastFragmentFrameID ) client->fragmentedFrames++;
+    client->lastFragmentFrameID = frameID;
+    
+    if( !DoFFrame_AddFragment( client->measuresAssembler, message ) ) return;
+    client->assembledFrames++;
+    // Axis 0 is the first block of first fragment
+    const Byte* firstFragment = DoFFrame_GetFragment( client->measuresAssembler, 0 );
+    DoFFrame_ReadBlock( firstFragment + DOF_EXTENDED_HEADER_SIZE + DOF_EXTENDED_INDEX_SIZE, &axisMeasures );
+  }
+  else DoFFrame_ReadBlock( message + 2, &axisMeasures );
+  
+  client->measureFrames++;
+  
+  if( axisMeasures.position < (double) clientsNumber || axisMeasures.position >= SEQUENCE_MAX_VALUE ) return;
+  unsigned long frameValue = (unsigned long) axisMeasures.position;
+  if( (double) frameValue != axisMeasures.position || frameValue % clientsNumber != client->index ) return;
+  
+  // Each sent frame is only measured on its first echo, and only while its send time is still stored
+  unsigned long sequence = frameValue / clientsNumber;
+  if( sequence <= client->lastEchoSequence || sequence > client->framesSent || client->framesSent - sequence >= SEND_TIMES_NUMBER ) return;
+  client->lastEchoSequence = sequence;
+  
+  AddLatency( &(client->roundTrips), receiveTime - client->sendTimesList[ sequence % SEND_TIMES_NUMBER ] );
+}
+
+static void AddLatency( LatencyStats* stats, double latency )
+{
+  if( stats->samplesNumber < stats->maxSamplesNumber ) stats->samplesList[ stats->samplesNumber++ ] = latency;
+}
+
+static int CompareLatencies( const void* ref_latency, const void* ref_otherLatency )
+{
+  double latency = *((const double*) ref_latency);
+  double otherLatency = *((const double*) ref_otherLatency);
+  
+  return ( latency > otherLatency ) - ( latency < otherLatency );
+}
+
+// Prints mean, median, 99th percentile and maximum latencies (in milliseconds), tab separated
+static void PrintLatency( LatencyStats* stats )
+{
+  if( stats->samplesNumber == 0 )
+  {
+    printf( "nan\tnan\tnan\tnan" );
+    return;
+  }
+  
+  double latenciesSum = 0.0;
+  for( size_t sampleIndex = 0; sampleIndex < stats->samplesNumber; sampleIndex++ )
+    latenciesSum += stats->samplesList[ sampleIndex ];
+  
+  qsort( stats->samplesList, stats->samplesNumber, sizeof(double), CompareLatencies );
+  printf( "%.3f\t%.3f\t%.3f\t%.3f", 1e3 * latenciesSum / stats->samplesNumber, 1e3 * stats->samplesList[ stats->samplesNumber / 2 ],
+          1e3 * stats->samplesList[ (size_t) ( 0.99 * ( stats->samplesNumber - 1 ) ) ], 1e3 * stats->samplesList[ stats->samplesNumber - 1 ] );
+}
+
+// Counts axis names listed in robot configuration reply, like { "id":"<robot_name>", "axes":[ "<axis1_name>", "<axis2_name>" ], ... }
+static size_t GetConfigAxesNumber( const char* configString )
+{
+  const char* axesList = strstr( configString, "\"axes\"" );
+  if( axesList == NULL ) return 0;
+  axesList = strchr( axesList, '[' );
+  if( axesList == NULL ) return 0;
+  
+  size_t quotesNumber = 0;
+  for( const char* listChar = axesList; *listChar != '\0' && *listChar != ']'; listChar++ )
+  {
+    if( *listChar == '"' ) quotesNumber++;
+  }
+  
+  return quotesNumber / 2;
+}
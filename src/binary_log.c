@@ -0,0 +1,770 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "binary_log.h"
+
+#include "log_codec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef WIN32
+#define MAP_FILES 0
+#else
+#define MAP_FILES 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define LOG_MAGIC "RSBLOG01"
+#define INDEX_MAGIC "RSBLIDX1"
+#define MAGIC_LENGTH 8
+#define FORMAT_VERSION 1
+
+#define PATH_MAX_LENGTH 512
+#define NAME_MAX_LENGTH 255
+
+enum BlockEncoding { BLOCK_ENCODING_RAW, BLOCK_ENCODING_COLUMNS, BLOCK_ENCODINGS_NUMBER };
+
+#define TIME_PRECISION 6
+
+typedef struct _BlockHeader
+{
+  uint32_t rowsNumber;
+  uint32_t dataSize;
+  uint32_t encoding;
+  uint32_t reserved;
+}
+BlockHeader;
+
+typedef struct _IndexEntry
+{
+  double firstTime;
+  double lastTime;
+  uint64_t offset;
+  uint64_t firstRow;
+}
+IndexEntry;
+
+typedef struct _IndexFooter
+{
+  uint64_t indexOffset;
+  uint64_t blocksNumber;
+  uint64_t rowsNumber;
+  char magic[ MAGIC_LENGTH ];
+}
+IndexFooter;
+
+const size_t TYPE_SIZES[ BINARY_LOG_TYPES_NUMBER ] = { [ BINARY_LOG_FLOAT32 ] = sizeof(float), [ BINARY_LOG_FLOAT64 ] = sizeof(double) };
+
+struct _BinaryLogData
+{
+  FILE* file;
+  uint64_t fileOffset;
+  enum BinaryLogType columnsType;
+  size_t columnsNumber;
+  size_t blockRowsNumber;
+  double* blockTimesList;
+  double* blockValuesTable;     // Column-major: all rows of column 0, then all rows of column 1, ...
+  size_t blockRowsCount;
+  unsigned char* blockData;
+  enum LogCodecType codecType;
+  size_t codecPrecision;
+  IndexEntry* indexList;
+  size_t blocksNumber;
+  uint64_t rowsNumber;
+};
+
+struct _BinaryLogReaderData
+{
+  const unsigned char* fileData;
+  size_t fileSize;
+  bool isMapped;
+  char* metadata;
+  size_t columnsNumber;
+  enum BinaryLogType* columnTypesList;
+  char** columnNamesList;
+  size_t blockRowsNumber;
+  IndexEntry* indexList;
+  size_t blocksNumber;
+  size_t rowsNumber;
+  size_t cachedBlockIndex;
+  double* cachedTimesList;
+  double* cachedValuesTable;
+};
+
+static char logDirectory[ PATH_MAX_LENGTH ] = "./";
+static char logBaseName[ NAME_MAX_LENGTH + 1 ] = "";
+static char logTimeStamp[ NAME_MAX_LENGTH + 1 ] = "";
+
+
+void BinaryLog_SetDirectory( const char* directoryPath )
+{
+  if( directoryPath == NULL ) return;
+  
+  strncpy( logDirectory, directoryPath, PATH_MAX_LENGTH - 2 );
+  size_t pathLength = strlen( logDirectory );
+  if( pathLength > 0 && logDirectory[ pathLength - 1 ] != '/' ) strcat( logDirectory, "/" );
+}
+
+void BinaryLog_SetBaseName( const char* baseName )
+{
+  strncpy( logBaseName, ( baseName != NULL ) ? baseName : "", NAME_MAX_LENGTH );
+}
+
+void BinaryLog_SetTimeStamp( void )
+{
+  time_t rawTime = time( NULL );
+  strftime( logTimeStamp, NAME_MAX_LENGTH, "%Y-%m-%d_%H-%M-%S", localtime( &rawTime ) );
+}
+
+enum BinaryLogType BinaryLog_GetPrecisionType( size_t precision )
+{
+  return ( precision <= 6 ) ? BINARY_LOG_FLOAT32 : BINARY_LOG_FLOAT64;
+}
+
+static void WriteData( BinaryLog log, const void* data, size_t dataSize )
+{
+  fwrite( data, 1, dataSize, log->file );
+  log->fileOffset += dataSize;
+}
+
+void BinaryLog_GetFilePath( const char* logName, char* filePath, size_t maxLength )
+{
+  snprintf( filePath, maxLength, "%s%s%s%s%s%s." BINARY_LOG_FILE_EXTENSION, logDirectory, logBaseName, ( logBaseName[ 0 ] != '\0' ) ? "-" : "", 
+            logName, ( logTimeStamp[ 0 ] != '\0' ) ? "-" : "", logTimeStamp );
+}
+
+// Writes decimal digits of given index without formatted output, as default column names may be written from signal handlers
+static size_t FormatColumnIndex( size_t columnIndex, char* indexString )
+{
+  char digitsList[ 24 ];
+  size_t digitsNumber = 0;
+  do
+  {
+    digitsList[ digitsNumber++ ] = (char) ( '0' + columnIndex % 10 );
+    columnIndex /= 10;
+  } while( columnIndex > 0 );
+  
+  for( size_t digitIndex = 0; digitIndex < digitsNumber; digitIndex++ )
+    indexString[ digitIndex ] = digitsList[ digitsNumber - digitIndex - 1 ];
+  indexString[ digitsNumber ] = '\0';
+  
+  return digitsNumber;
+}
+
+static size_t GetColumnNameLength( const char** columnNamesList, size_t columnIndex )
+{
+  if( columnNamesList == NULL || columnNamesList[ columnIndex ] == NULL )
+  {
+    char defaultName[ 24 ];
+    return FormatColumnIndex( columnIndex, defaultName );
+  }
+  
+  size_t nameLength = strlen( columnNamesList[ columnIndex ] );
+  return ( nameLength < NAME_MAX_LENGTH ) ? nameLength : NAME_MAX_LENGTH;
+}
+
+size_t BinaryLog_GetHeaderSize( size_t metadataLength, size_t columnsNumber, const char** columnNamesList )
+{
+  size_t headerSize = MAGIC_LENGTH + 4 * sizeof(uint32_t) + metadataLength;
+  for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+    headerSize += 2 * sizeof(uint8_t) + GetColumnNameLength( columnNamesList, columnIndex );
+  
+  return headerSize;
+}
+
+size_t BinaryLog_FormatHeader( unsigned char* headerData, const char* metadata, size_t columnsNumber, const char** columnNamesList, enum BinaryLogType columnsType )
+{
+  if( metadata == NULL ) metadata = "";
+  
+  unsigned char* headerEnd = headerData;
+  uint32_t headerValuesList[ 4 ] = { FORMAT_VERSION, (uint32_t) columnsNumber, (uint32_t) BINARY_LOG_DEFAULT_BLOCK_ROWS, (uint32_t) strlen( metadata ) };
+  memcpy( headerEnd, LOG_MAGIC, MAGIC_LENGTH );
+  headerEnd += MAGIC_LENGTH;
+  memcpy( headerEnd, headerValuesList, sizeof(headerValuesList) );
+  headerEnd += sizeof(headerValuesList);
+  memcpy( headerEnd, metadata, headerValuesList[ 3 ] );
+  headerEnd += headerValuesList[ 3 ];
+  for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+  {
+    char defaultName[ 24 ];
+    const char* columnName = ( columnNamesList != NULL && columnNamesList[ columnIndex ] != NULL ) ? columnNamesList[ columnIndex ] : defaultName;
+    if( columnName == defaultName ) (void) FormatColumnIndex( columnIndex, defaultName );
+    uint8_t columnInfo[ 2 ] = { (uint8_t) columnsType, (uint8_t) GetColumnNameLength( columnNamesList, columnIndex ) };
+    memcpy( headerEnd, columnInfo, sizeof(columnInfo) );
+    headerEnd += sizeof(columnInfo);
+    memcpy( headerEnd, columnName, columnInfo[ 1 ] );
+    headerEnd += columnInfo[ 1 ];
+  }
+  
+  return (size_t) ( headerEnd - headerData );
+}
+
+BinaryLog BinaryLog_Create( const char* logName, const char* metadata, size_t columnsNumber, const char** columnNamesList, enum BinaryLogType columnsType )
+{
+  if( logName == NULL || columnsType >= BINARY_LOG_TYPES_NUMBER ) return NULL;
+  
+  char filePath[ PATH_MAX_LENGTH + 3 * NAME_MAX_LENGTH ];
+  BinaryLog_GetFilePath( logName, filePath, sizeof(filePath) );
+  FILE* file = fopen( filePath, "wb" );
+  if( file == NULL ) return NULL;
+  
+  BinaryLog newLog = (BinaryLog) malloc( sizeof(BinaryLogData) );
+  memset( newLog, 0, sizeof(BinaryLogData) );
+  
+  newLog->file = file;
+  newLog->columnsType = columnsType;
+  newLog->columnsNumber = columnsNumber;
+  newLog->blockRowsNumber = BINARY_LOG_DEFAULT_BLOCK_ROWS;
+  newLog->blockTimesList = (double*) calloc( newLog->blockRowsNumber, sizeof(double) );
+  newLog->blockValuesTable = (double*) calloc( newLog->blockRowsNumber * columnsNumber, sizeof(double) );
+  // Sized for the worst case of any encoding, so that memory use stays bounded
+  newLog->blockData = (unsigned char*) malloc( ( columnsNumber + 1 ) * LogCodec_GetMaxEncodedSize( newLog->blockRowsNumber ) );
+  newLog->codecType = LOG_CODEC_RAW;
+  
+  size_t headerSize = BinaryLog_GetHeaderSize( ( metadata != NULL ) ? strlen( metadata ) : 0, columnsNumber, columnNamesList );
+  unsigned char* headerData = (unsigned char*) malloc( headerSize );
+  WriteData( newLog, headerData, BinaryLog_FormatHeader( headerData, metadata, columnsNumber, columnNamesList, columnsType ) );
+  free( headerData );
+  
+  return newLog;
+}
+
+void BinaryLog_SetCompression( BinaryLog log, enum LogCodecType codecType, size_t precision )
+{
+  if( log == NULL ) return;
+  
+  // Compression can't change inside a block
+  if( log->blockRowsCount > 0 ) return;
+  
+  log->codecType = ( codecType < LOG_CODEC_TYPES_NUMBER ) ? codecType : LOG_CODEC_RAW;
+  log->codecPrecision = precision;
+}
+
+static size_t EncodeBlock( BinaryLog log )
+{
+  size_t rowsNumber = log->blockRowsCount;
+  
+  uint8_t* blockData = (uint8_t*) log->blockData;
+  blockData += LogCodec_EncodeColumn( log->blockTimesList, rowsNumber, log->codecType, TIME_PRECISION, blockData );
+  for( size_t columnIndex = 0; columnIndex < log->columnsNumber; columnIndex++ )
+  {
+    double* columnValuesList = log->blockValuesTable + columnIndex * log->blockRowsNumber;
+    // Decoded values should match the ones of uncompressed storage type
+    if( log->columnsType == BINARY_LOG_FLOAT32 )
+    {
+      for( size_t rowIndex = 0; rowIndex < rowsNumber; rowIndex++ )
+        columnValuesList[ rowIndex ] = (double) (float) columnValuesList[ rowIndex ];
+    }
+    blockData += LogCodec_EncodeColumn( columnValuesList, rowsNumber, log->codecType, log->codecPrecision, blockData );
+  }
+  
+  return (size_t) ( blockData - (uint8_t*) log->blockData );
+}
+
+// Copies time stamps followed by each values column (with columnLength values stride on the table) to block data
+static size_t CopyRawColumns( unsigned char* blockData, size_t rowsNumber, const double* timesList, size_t columnsNumber, 
+                              const double* valuesTable, size_t columnLength, enum BinaryLogType columnsType )
+{
+  size_t typeSize = TYPE_SIZES[ columnsType ];
+  
+  unsigned char* blockEnd = blockData;
+  memcpy( blockEnd, timesList, rowsNumber * sizeof(double) );
+  blockEnd += rowsNumber * sizeof(double);
+  for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+  {
+    const double* columnValuesList = valuesTable + columnIndex * columnLength;
+    if( columnsType == BINARY_LOG_FLOAT32 )
+    {
+      for( size_t rowIndex = 0; rowIndex < rowsNumber; rowIndex++ )
+      {
+        float value = (float) columnValuesList[ rowIndex ];
+        memcpy( blockEnd + rowIndex * typeSize, &value, typeSize );
+      }
+    }
+    else memcpy( blockEnd, columnValuesList, rowsNumber * typeSize );
+    blockEnd += rowsNumber * typeSize;
+  }
+  
+  return (size_t) ( blockEnd - blockData );
+}
+
+static size_t WriteRawBlock( BinaryLog log )
+{
+  return CopyRawColumns( log->blockData, log->blockRowsCount, log->blockTimesList, log->columnsNumber, log->blockValuesTable, log->blockRowsNumber, log->columnsType );
+}
+
+size_t BinaryLog_GetRawBlockSize( size_t rowsNumber, size_t columnsNumber, enum BinaryLogType columnsType )
+{
+  return sizeof(BlockHeader) + rowsNumber * ( sizeof(double) + columnsNumber * TYPE_SIZES[ columnsType ] );
+}
+
+size_t BinaryLog_FormatRawBlock( unsigned char* blockData, size_t rowsNumber, const double* timesList, size_t columnsNumber, const double* valuesTable, enum BinaryLogType columnsType )
+{
+  if( rowsNumber == 0 ) return 0;
+  
+  size_t dataSize = CopyRawColumns( blockData + sizeof(BlockHeader), rowsNumber, timesList, columnsNumber, valuesTable, rowsNumber, columnsType );
+  BlockHeader header = { .rowsNumber = (uint32_t) rowsNumber, .dataSize = (uint32_t) dataSize, .encoding = BLOCK_ENCODING_RAW };
+  memcpy( blockData, &header, sizeof(BlockHeader) );
+  
+  return sizeof(BlockHeader) + dataSize;
+}
+
+static void WriteBlock( BinaryLog log )
+{
+  if( log->blockRowsCount == 0 ) return;
+  
+  size_t rowsNumber = log->blockRowsCount;
+  
+  bool isEncoded = ( log->codecType != LOG_CODEC_RAW );
+  size_t dataSize = isEncoded ? EncodeBlock( log ) : WriteRawBlock( log );
+  
+  log->indexList = (IndexEntry*) realloc( log->indexList, ( log->blocksNumber + 1 ) * sizeof(IndexEntry) );
+  IndexEntry* indexEntry = &(log->indexList[ log->blocksNumber++ ]);
+  indexEntry->firstTime = log->blockTimesList[ 0 ];
+  indexEntry->lastTime = log->blockTimesList[ rowsNumber - 1 ];
+  indexEntry->offset = log->fileOffset;
+  indexEntry->firstRow = log->rowsNumber;
+  
+  BlockHeader header = { .rowsNumber = (uint32_t) rowsNumber, .dataSize = (uint32_t) dataSize, .encoding = isEncoded ? BLOCK_ENCODING_COLUMNS : BLOCK_ENCODING_RAW };
+  WriteData( log, &header, sizeof(BlockHeader) );
+  WriteData( log, log->blockData, header.dataSize );
+  fflush( log->file );
+  
+  log->rowsNumber += rowsNumber;
+  log->blockRowsCount = 0;
+}
+
+void BinaryLog_Discard( BinaryLog log )
+{
+  if( log == NULL ) return;
+  
+  WriteBlock( log );
+  
+  IndexFooter footer = { .indexOffset = log->fileOffset, .blocksNumber = log->blocksNumber, .rowsNumber = log->rowsNumber };
+  memcpy( footer.magic, INDEX_MAGIC, MAGIC_LENGTH );
+  WriteData( log, log->indexList, log->blocksNumber * sizeof(IndexEntry) );
+  WriteData( log, &footer, sizeof(IndexFooter) );
+  
+  fclose( log->file );
+  
+  free( log->blockTimesList );
+  free( log->blockValuesTable );
+  free( log->blockData );
+  free( log->indexList );
+  
+  free( log );
+}
+
+void BinaryLog_WriteLine( BinaryLog log, double timeStamp, size_t valuesNumber, const double* valuesList )
+{
+  if( log == NULL ) return;
+  
+  size_t rowIndex = log->blockRowsCount;
+  log->blockTimesList[ rowIndex ] = timeStamp;
+  for( size_t columnIndex = 0; columnIndex < log->columnsNumber; columnIndex++ )
+    log->blockValuesTable[ columnIndex * log->blockRowsNumber + rowIndex ] = ( columnIndex < valuesNumber ) ? valuesList[ columnIndex ] : NAN;
+  
+  if( ++(log->blockRowsCount) >= log->blockRowsNumber ) WriteBlock( log );
+}
+
+size_t BinaryLog_GetColumnsNumber( BinaryLog log )
+{
+  if( log == NULL ) return 0;
+  
+  return log->columnsNumber;
+}
+
+static bool LoadFileData( BinaryLogReader reader, const char* filePath )
+{
+#if MAP_FILES
+  int fileDescriptor = open( filePath, O_RDONLY );
+  if( fileDescriptor < 0 ) return false;
+  struct stat fileStatus;
+  if( fstat( fileDescriptor, &fileStatus ) == 0 && fileStatus.st_size > 0 )
+  {
+    reader->fileSize = (size_t) fileStatus.st_size;
+    void* fileData = mmap( NULL, reader->fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+    if( fileData != MAP_FAILED )
+    {
+      reader->fileData = (const unsigned char*) fileData;
+      reader->isMapped = true;
+    }
+  }
+  close( fileDescriptor );
+  if( reader->isMapped ) return true;
+#endif
+  FILE* file = fopen( filePath, "rb" );
+  if( file == NULL ) return false;
+  fseek( file, 0, SEEK_END );
+  long fileSize = ftell( file );
+  fseek( file, 0, SEEK_SET );
+  if( fileSize <= 0 ) 
+  {
+    fclose( file );
+    return false;
+  }
+  reader->fileSize = (size_t) fileSize;
+  unsigned char* fileData = (unsigned char*) malloc( reader->fileSize );
+  reader->fileSize = fread( fileData, 1, reader->fileSize, file );
+  reader->fileData = fileData;
+  fclose( file );
+  
+  return true;
+}
+
+static bool ReadHeader( BinaryLogReader reader, size_t* ref_dataOffset )
+{
+  const unsigned char* fileData = reader->fileData;
+  size_t offset = MAGIC_LENGTH + 4 * sizeof(uint32_t);
+  if( reader->fileSize < offset || memcmp( fileData, LOG_MAGIC, MAGIC_LENGTH ) != 0 ) return false;
+  
+  uint32_t headerValuesList[ 4 ];
+  memcpy( headerValuesList, fileData + MAGIC_LENGTH, sizeof(headerValuesList) );
+  if( headerValuesList[ 0 ] > FORMAT_VERSION ) return false;
+  reader->columnsNumber = headerValuesList[ 1 ];
+  reader->blockRowsNumber = headerValuesList[ 2 ];
+  size_t metadataLength = headerValuesList[ 3 ];
+  if( offset + metadataLength > reader->fileSize ) return false;
+  reader->metadata = (char*) calloc( metadataLength + 1, sizeof(char) );
+  memcpy( reader->metadata, fileData + offset, metadataLength );
+  offset += metadataLength;
+  
+  reader->columnTypesList = (enum BinaryLogType*) calloc( reader->columnsNumber, sizeof(enum BinaryLogType) );
+  reader->columnNamesList = (char**) calloc( reader->columnsNumber, sizeof(char*) );
+  for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+  {
+    if( offset + 2 > reader->fileSize ) return false;
+    reader->columnTypesList[ columnIndex ] = ( fileData[ offset ] < BINARY_LOG_TYPES_NUMBER ) ? fileData[ offset ] : BINARY_LOG_FLOAT64;
+    size_t nameLength = fileData[ offset + 1 ];
+    offset += 2;
+    if( offset + nameLength > reader->fileSize ) return false;
+    reader->columnNamesList[ columnIndex ] = (char*) calloc( nameLength + 1, sizeof(char) );
+    memcpy( reader->columnNamesList[ columnIndex ], fileData + offset, nameLength );
+    offset += nameLength;
+  }
+  
+  *ref_dataOffset = offset;
+  
+  return true;
+}
+
+// Block lookups trust the stored index, so its entries must point to block headers inside the data region, in rows order
+static bool CheckIndex( const IndexEntry* indexList, const IndexFooter* footer, size_t dataOffset )
+{
+  if( footer->blocksNumber == 0 ) return ( footer->rowsNumber == 0 );
+  
+  if( footer->indexOffset < dataOffset + sizeof(BlockHeader) ) return false;
+  
+  for( size_t blockIndex = 0; blockIndex < footer->blocksNumber; blockIndex++ )
+  {
+    const IndexEntry* indexEntry = &(indexList[ blockIndex ]);
+    if( indexEntry->offset < dataOffset || indexEntry->offset > footer->indexOffset - sizeof(BlockHeader) ) return false;
+    if( indexEntry->firstRow >= footer->rowsNumber ) return false;
+    if( blockIndex == 0 && indexEntry->firstRow != 0 ) return false;
+    if( blockIndex > 0 && indexEntry->firstRow <= indexList[ blockIndex - 1 ].firstRow ) return false;
+  }
+  
+  return true;
+}
+
+// Returns false if file has an invalid time index
+static bool ReadIndex( BinaryLogReader reader, size_t dataOffset )
+{
+  IndexFooter footer;
+  if( reader->fileSize >= dataOffset + sizeof(IndexFooter) )
+  {
+    memcpy( &footer, reader->fileData + reader->fileSize - sizeof(IndexFooter), sizeof(IndexFooter) );
+    // Compared by division, as values read from a corrupt file could overflow the index size computation
+    bool isIndexValid = ( memcmp( footer.magic, INDEX_MAGIC, MAGIC_LENGTH ) == 0 && footer.indexOffset >= dataOffset && footer.indexOffset <= reader->fileSize
+                          && footer.blocksNumber <= ( reader->fileSize - footer.indexOffset ) / sizeof(IndexEntry) );
+    if( isIndexValid )
+    {
+      reader->blocksNumber = (size_t) footer.blocksNumber;
+      reader->rowsNumber = (size_t) footer.rowsNumber;
+      reader->indexList = (IndexEntry*) calloc( reader->blocksNumber + 1, sizeof(IndexEntry) );
+      memcpy( reader->indexList, reader->fileData + footer.indexOffset, reader->blocksNumber * sizeof(IndexEntry) );
+      return CheckIndex( reader->indexList, &footer, dataOffset );
+    }
+  }
+  
+  // Rebuild index from block headers, ignoring any truncated last block
+  double* timesList = (double*) calloc( reader->blockRowsNumber, sizeof(double) );
+  size_t offset = dataOffset;
+  BlockHeader header;
+  while( offset + sizeof(BlockHeader) <= reader->fileSize )
+  {
+    memcpy( &header, reader->fileData + offset, sizeof(BlockHeader) );
+    if( header.rowsNumber == 0 || header.rowsNumber > reader->blockRowsNumber || offset + sizeof(BlockHeader) + header.dataSize > reader->fileSize ) break;
+    const unsigned char* timesData = reader->fileData + offset + sizeof(BlockHeader);
+    if( header.encoding == BLOCK_ENCODING_COLUMNS )
+    {
+      if( LogCodec_DecodeColumn( timesData, header.dataSize, header.rowsNumber, timesList ) == 0 ) break;
+      timesData = (const unsigned char*) timesList;
+    }
+    else if( header.encoding != BLOCK_ENCODING_RAW || header.dataSize < header.rowsNumber * sizeof(double) ) break;
+    reader->indexList = (IndexEntry*) realloc( reader->indexList, ( reader->blocksNumber + 1 ) * sizeof(IndexEntry) );
+    IndexEntry* indexEntry = &(reader->indexList[ reader->blocksNumber++ ]);
+    memcpy( &(indexEntry->firstTime), timesData, sizeof(double) );
+    memcpy( &(indexEntry->lastTime), timesData + ( header.rowsNumber - 1 ) * sizeof(double), sizeof(double) );
+    indexEntry->offset = offset;
+    indexEntry->firstRow = reader->rowsNumber;
+    reader->rowsNumber += header.rowsNumber;
+    offset += sizeof(BlockHeader) + header.dataSize;
+  }
+  free( timesList );
+  
+  return true;
+}
+
+BinaryLogReader BinaryLog_OpenReader( const char* filePath )
+{
+  if( filePath == NULL ) return NULL;
+  
+  BinaryLogReader newReader = (BinaryLogReader) malloc( sizeof(BinaryLogReaderData) );
+  memset( newReader, 0, sizeof(BinaryLogReaderData) );
+  
+  if( !LoadFileData( newReader, filePath ) )
+  {
+    free( newReader );
+    return NULL;
+  }
+  
+  size_t dataOffset;
+  if( !ReadHeader( newReader, &dataOffset ) )
+  {
+    BinaryLog_CloseReader( newReader );
+    return NULL;
+  }
+  
+  if( !ReadIndex( newReader, dataOffset ) )
+  {
+    BinaryLog_CloseReader( newReader );
+    return NULL;
+  }
+  
+  newReader->cachedBlockIndex = SIZE_MAX;
+  newReader->cachedTimesList = (double*) calloc( newReader->blockRowsNumber, sizeof(double) );
+  newReader->cachedValuesTable = (double*) calloc( newReader->blockRowsNumber * newReader->columnsNumber, sizeof(double) );
+  
+  return newReader;
+}
+
+void BinaryLog_CloseReader( BinaryLogReader reader )
+{
+  if( reader == NULL ) return;
+  
+#if MAP_FILES
+  if( reader->isMapped ) munmap( (void*) reader->fileData, reader->fileSize );
+#endif
+  if( !reader->isMapped ) free( (void*) reader->fileData );
+  
+  free( reader->metadata );
+  for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+  {
+    if( reader->columnNamesList != NULL ) free( reader->columnNamesList[ columnIndex ] );
+  }
+  free( reader->columnNamesList );
+  free( reader->columnTypesList );
+  free( reader->indexList );
+  free( reader->cachedTimesList );
+  free( reader->cachedValuesTable );
+  
+  free( reader );
+}
+
+const char* BinaryLog_GetMetadata( BinaryLogReader reader )
+{
+  if( reader == NULL ) return "";
+  
+  return reader->metadata;
+}
+
+size_t BinaryLog_GetReaderColumnsNumber( BinaryLogReader reader )
+{
+  if( reader == NULL ) return 0;
+  
+  return reader->columnsNumber;
+}
+
+const char* BinaryLog_GetColumnName( BinaryLogReader reader, size_t columnIndex )
+{
+  if( reader == NULL ) return NULL;
+  
+  if( columnIndex >= reader->columnsNumber ) return NULL;
+  
+  return reader->columnNamesList[ columnIndex ];
+}
+
+size_t BinaryLog_GetRowsNumber( BinaryLogReader reader )
+{
+  if( reader == NULL ) return 0;
+  
+  return reader->rowsNumber;
+}
+
+size_t BinaryLog_FindRow( BinaryLogReader reader, double timeStamp )
+{
+  if( reader == NULL ) return 0;
+  
+  // Binary search for first block not entirely older than given time
+  size_t firstBlock = 0, lastBlock = reader->blocksNumber;
+  while( firstBlock < lastBlock )
+  {
+    size_t middleBlock = ( firstBlock + lastBlock ) / 2;
+    if( reader->indexList[ middleBlock ].lastTime < timeStamp ) firstBlock = middleBlock + 1;
+    else lastBlock = middleBlock;
+  }
+  
+  if( firstBlock >= reader->blocksNumber ) return reader->rowsNumber;
+  
+  size_t rowIndex = (size_t) reader->indexList[ firstBlock ].firstRow;
+  double rowTime;
+  while( BinaryLog_ReadRow( reader, rowIndex, &rowTime, NULL ) && rowTime < timeStamp ) rowIndex++;
+  
+  return rowIndex;
+}
+
+// Blocks have fixed row capacity, but partial blocks may be found on recovered files
+static size_t FindBlock( BinaryLogReader reader, size_t rowIndex )
+{
+  size_t blockIndex = rowIndex / reader->blockRowsNumber;
+  if( blockIndex >= reader->blocksNumber ) blockIndex = reader->blocksNumber - 1;
+  while( blockIndex > 0 && reader->indexList[ blockIndex ].firstRow > rowIndex ) blockIndex--;
+  while( blockIndex + 1 < reader->blocksNumber && reader->indexList[ blockIndex + 1 ].firstRow <= rowIndex ) blockIndex++;
+  
+  return blockIndex;
+}
+
+static bool LoadBlock( BinaryLogReader reader, size_t blockIndex )
+{
+  if( blockIndex == reader->cachedBlockIndex ) return true;
+  
+  BlockHeader header;
+  size_t offset = (size_t) reader->indexList[ blockIndex ].offset;
+  memcpy( &header, reader->fileData + offset, sizeof(BlockHeader) );
+  if( header.rowsNumber > reader->blockRowsNumber || header.encoding >= BLOCK_ENCODINGS_NUMBER ) return false;
+  if( offset + sizeof(BlockHeader) + header.dataSize > reader->fileSize ) return false;
+  
+  const unsigned char* blockData = reader->fileData + offset + sizeof(BlockHeader);
+  size_t rowsNumber = header.rowsNumber;
+  
+  if( header.encoding == BLOCK_ENCODING_COLUMNS )
+  {
+    size_t columnOffset = LogCodec_DecodeColumn( blockData, header.dataSize, rowsNumber, reader->cachedTimesList );
+    for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+    {
+      if( columnOffset == 0 ) break;
+      double* columnValuesList = reader->cachedValuesTable + columnIndex * reader->blockRowsNumber;
+      size_t columnSize = LogCodec_DecodeColumn( blockData + columnOffset, header.dataSize - columnOffset, rowsNumber, columnValuesList );
+      columnOffset = ( columnSize > 0 ) ? columnOffset + columnSize : 0;
+    }
+    
+    if( columnOffset == 0 ) return false;
+    
+    reader->cachedBlockIndex = blockIndex;
+    
+    return true;
+  }
+  
+  size_t rowSize = sizeof(double);
+  for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+    rowSize += TYPE_SIZES[ reader->columnTypesList[ columnIndex ] ];
+  if( header.rowsNumber * rowSize > header.dataSize ) return false;
+  
+  memcpy( reader->cachedTimesList, blockData, rowsNumber * sizeof(double) );
+  blockData += rowsNumber * sizeof(double);
+  for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+  {
+    double* columnValuesList = reader->cachedValuesTable + columnIndex * reader->blockRowsNumber;
+    if( reader->columnTypesList[ columnIndex ] == BINARY_LOG_FLOAT32 )
+    {
+      for( size_t rowIndex = 0; rowIndex < rowsNumber; rowIndex++ )
+      {
+        float value;
+        memcpy( &value, blockData + rowIndex * sizeof(float), sizeof(float) );
+        columnValuesList[ rowIndex ] = (double) value;
+      }
+    }
+    else memcpy( columnValuesList, blockData, rowsNumber * sizeof(double) );
+    blockData += rowsNumber * TYPE_SIZES[ reader->columnTypesList[ columnIndex ] ];
+  }
+  
+  reader->cachedBlockIndex = blockIndex;
+  
+  return true;
+}
+
+bool BinaryLog_ReadRow( BinaryLogReader reader, size_t rowIndex, double* ref_timeStamp, double* valuesList )
+{
+  if( reader == NULL ) return false;
+  
+  if( rowIndex >= reader->rowsNumber ) return false;
+  
+  size_t blockIndex = FindBlock( reader, rowIndex );
+  if( !LoadBlock( reader, blockIndex ) ) return false;
+  
+  size_t blockRowIndex = rowIndex - (size_t) reader->indexList[ blockIndex ].firstRow;
+  if( ref_timeStamp != NULL ) *ref_timeStamp = reader->cachedTimesList[ blockRowIndex ];
+  if( valuesList != NULL )
+  {
+    for( size_t columnIndex = 0; columnIndex < reader->columnsNumber; columnIndex++ )
+      valuesList[ columnIndex ] = reader->cachedValuesTable[ columnIndex * reader->blockRowsNumber + blockRowIndex ];
+  }
+  
+  return true;
+}
+
+size_t BinaryLog_ReadColumn( BinaryLogReader reader, size_t columnIndex, size_t firstRowIndex, size_t rowsNumber, double* timesList, double* valuesList )
+{
+  if( reader == NULL ) return 0;
+  
+  if( columnIndex >= reader->columnsNumber ) return 0;
+  
+  size_t readRowsNumber = 0;
+  while( readRowsNumber < rowsNumber && firstRowIndex + readRowsNumber < reader->rowsNumber )
+  {
+    size_t rowIndex = firstRowIndex + readRowsNumber;
+    size_t blockIndex = FindBlock( reader, rowIndex );
+    if( !LoadBlock( reader, blockIndex ) ) break;
+    
+    size_t blockFirstRow = (size_t) reader->indexList[ blockIndex ].firstRow;
+    size_t blockEndRow = ( blockIndex + 1 < reader->blocksNumber ) ? (size_t) reader->indexList[ blockIndex + 1 ].firstRow : reader->rowsNumber;
+    size_t blockRowIndex = rowIndex - blockFirstRow;
+    size_t copyRowsNumber = blockEndRow - rowIndex;
+    if( copyRowsNumber > rowsNumber - readRowsNumber ) copyRowsNumber = rowsNumber - readRowsNumber;
+    
+    if( timesList != NULL ) 
+      memcpy( timesList + readRowsNumber, reader->cachedTimesList + blockRowIndex, copyRowsNumber * sizeof(double) );
+    if( valuesList != NULL ) 
+      memcpy( valuesList + readRowsNumber, reader->cachedValuesTable + columnIndex * reader->blockRowsNumber + blockRowIndex, copyRowsNumber * sizeof(double) );
+    readRowsNumber += copyRowsNumber;
+  }
+  
+  return readRowsNumber;
+}
@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file binary_log.h
+/// @brief Binary columnar data log writing/reading functions
+///
+/// Alternative to text [data logging](https://github.com/EESC-MKGroup/Simple-Data-Logging) for long sessions at high rates: values are stored with their binary representation, 
+/// in blocks of rows where each column is contiguous, and files end with a time index of blocks, allowing fast random access through memory mapping.
+///
+/// @page binary_log_format Binary Log Format
+/// All fields are written in host (little-endian, on supported platforms) byte order. Files start with a header:
+///
+/// Magic ("RSBLOG01") | Version | Columns number | Block rows | Metadata length | Metadata | Column 1 type | Name length | Name    | Column 2 type | ...
+/// :----------------: | :-----: | :------------: | :--------: | :-------------: | :------: | :-----------: | :---------: | :-----: | :-----------: | :-:
+///       8 bytes      | 4 bytes |    4 bytes     |  4 bytes   |     4 bytes     | N bytes  |    1 byte     |   1 byte    | N bytes |    1 byte     | ...
+///
+/// Metadata is a JSON string (e.g. robot, axis and joint names). Column types are listed in BinaryLogType. Time stamps are not listed as a column.
+/// Header is followed by data blocks of up to <Block rows> rows, each one with all time stamps (as 8-byte double values) followed by all values of each column:
+///
+/// Rows number | Data size | Encoding | Reserved | Time 1  | ...  | Time N  | Column 1 value 1 | ... | Column 1 value N | Column 2 value 1 | ...
+/// :---------: | :-------: | :------: | :------: | :-----: | :--: | :-----: | :--------------: | :-: | :--------------: | :--------------: | :-:
+///   4 bytes   |  4 bytes  | 4 bytes  | 4 bytes  | 8 bytes | ...  | 8 bytes |  type size bytes | ... |  type size bytes |  type size bytes | ...
+///
+/// Blocks with encoding 1 (compressed) instead store the time stamps column followed by each values column, all encoded as described in log_codec.h (time stamps with 6 decimal places precision).
+/// Data size counts the bytes following the block header. When the log is closed, a time index is appended, with one entry per block, followed by a fixed-size footer:
+///
+/// First time | Last time | Block offset | First row | ... | Index offset | Blocks number | Rows number | Magic ("RSBLIDX1")
+/// :--------: | :-------: | :----------: | :-------: | :-: | :----------: | :-----------: | :---------: | :----------------:
+///   8 bytes  |  8 bytes  |   8 bytes    |  8 bytes  | ... |   8 bytes    |    8 bytes    |   8 bytes   |      8 bytes
+///
+/// Files without index (e.g. from interrupted sessions) can still be read, as the index is rebuilt by walking through block headers.
+
+
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log_codec.h"
+
+#define BINARY_LOG_FILE_EXTENSION "blog"          ///< File extension of binary logs
+#define BINARY_LOG_DEFAULT_BLOCK_ROWS 256         ///< Default maximum number of rows per data block
+
+/// Storage type of log column values
+enum BinaryLogType 
+{ 
+  BINARY_LOG_FLOAT32,       ///< Single precision (4 bytes) floating-point values
+  BINARY_LOG_FLOAT64,       ///< Double precision (8 bytes) floating-point values
+  BINARY_LOG_TYPES_NUMBER 
+};
+
+typedef struct _BinaryLogData BinaryLogData;              ///< Single binary log writer internal data structure
+typedef BinaryLogData* BinaryLog;                         ///< Opaque reference to binary log writer internal data structure
+
+typedef struct _BinaryLogReaderData BinaryLogReaderData;  ///< Single binary log reader internal data structure
+typedef BinaryLogReaderData* BinaryLogReader;             ///< Opaque reference to binary log reader internal data structure
+
+
+/// @brief Sets directory where following binary log files will be created
+/// @param[in] directoryPath path to log directory
+void BinaryLog_SetDirectory( const char* directoryPath );
+
+/// @brief Sets prefix (e.g. user name) of following binary log file names (not synchronized: logs should be created from the calling thread, or while it waits)
+/// @param[in] baseName file name prefix (empty or NULL for none)
+void BinaryLog_SetBaseName( const char* baseName );
+
+/// @brief Sets suffix of following binary log file names to current date and time (not synchronized, as BinaryLog_SetBaseName())
+void BinaryLog_SetTimeStamp( void );
+
+/// @brief Gets storage type appropriate to given decimal precision (as in text logs)
+/// @param[in] precision number of significant decimal places needed
+/// @return BINARY_LOG_FLOAT32 for precisions up to 6, BINARY_LOG_FLOAT64 otherwise
+enum BinaryLogType BinaryLog_GetPrecisionType( size_t precision );
+
+/// @brief Creates binary log file, named <log_dir>/[<base_name>-]<log_name>-<time_stamp>.blog, and writes its header
+/// @param[in] logName log identifier, used on file name
+/// @param[in] metadata JSON-format string stored on file header (NULL for none)
+/// @param[in] columnsNumber number of values per row (excluding time stamp)
+/// @param[in] columnNamesList list of column names (NULL for default "<column_index>" names)
+/// @param[in] columnsType storage type of all column values
+/// @return reference/pointer to newly created binary log data structure (NULL on errors)
+BinaryLog BinaryLog_Create( const char* logName, const char* metadata, size_t columnsNumber, const char** columnNamesList, enum BinaryLogType columnsType );
+
+/// @brief Gets path of the file that a log created now with given name would be written to (see BinaryLog_Create())
+/// @param[in] logName log identifier, used on file name
+/// @param[out] filePath buffer where the file path will be stored
+/// @param[in] maxLength size of filePath buffer
+void BinaryLog_GetFilePath( const char* logName, char* filePath, size_t maxLength );
+
+/// @brief Gets size of the header of a log file with given columns (see @ref binary_log_format)
+/// @param[in] metadataLength length of metadata string
+/// @param[in] columnsNumber number of values per row (excluding time stamp)
+/// @param[in] columnNamesList list of column names (NULL for default "<column_index>" names)
+/// @return header size, in bytes
+size_t BinaryLog_GetHeaderSize( size_t metadataLength, size_t columnsNumber, const char** columnNamesList );
+
+/// @brief Writes log file header to given buffer, for files written without a log data structure (async-signal-safe: no memory allocation or formatted output)
+/// @param[out] headerData buffer with at least BinaryLog_GetHeaderSize() bytes
+/// @param[in] metadata JSON-format string stored on file header (NULL for none)
+/// @param[in] columnsNumber number of values per row (excluding time stamp)
+/// @param[in] columnNamesList list of column names (NULL for default "<column_index>" names)
+/// @param[in] columnsType storage type of all column values
+/// @return number of bytes written to buffer
+size_t BinaryLog_FormatHeader( unsigned char* headerData, const char* metadata, size_t columnsNumber, const char** columnNamesList, enum BinaryLogType columnsType );
+
+/// @brief Gets size of an uncompressed data block (header included) with given dimensions
+/// @param[in] rowsNumber number of rows in block
+/// @param[in] columnsNumber number of values per row (excluding time stamp)
+/// @param[in] columnsType storage type of all column values
+/// @return block size, in bytes
+size_t BinaryLog_GetRawBlockSize( size_t rowsNumber, size_t columnsNumber, enum BinaryLogType columnsType );
+
+/// @brief Writes uncompressed data block (header included) to given buffer, as BinaryLog_FormatHeader() (async-signal-safe). Files written this way have no time index, which is rebuilt on reading
+/// @param[out] blockData buffer with at least BinaryLog_GetRawBlockSize() bytes
+/// @param[in] rowsNumber number of rows in block
+/// @param[in] timesList list of rowsNumber row time stamps
+/// @param[in] columnsNumber number of values per row (excluding time stamp)
+/// @param[in] valuesTable column-major table of values (rowsNumber values of column 0, then of column 1, ...)
+/// @param[in] columnsType storage type of all column values
+/// @return number of bytes written to buffer
+size_t BinaryLog_FormatRawBlock( unsigned char* blockData, size_t rowsNumber, const double* timesList, size_t columnsNumber, const double* valuesTable, enum BinaryLogType columnsType );
+
+/// @brief Enables compression of following data blocks (see log_codec.h). Ignored if some rows are already pending in current block
+/// @param[in] log reference to binary log
+/// @param[in] codecType encoding applied to each column (LOG_CODEC_RAW for uncompressed blocks)
+/// @param[in] precision number of decimal places kept by quantized encodings
+void BinaryLog_SetCompression( BinaryLog log, enum LogCodecType codecType, size_t precision );
+
+/// @brief Writes pending rows and time index to given log file, and deallocates its internal data
+/// @param[in] log reference to binary log
+void BinaryLog_Discard( BinaryLog log );
+
+/// @brief Appends a row of values to given log (missing values are stored as NaN, extra ones are ignored)
+/// @param[in] log reference to binary log
+/// @param[in] timeStamp time stamp of the new row
+/// @param[in] valuesNumber number of values in list
+/// @param[in] valuesList list of row values
+void BinaryLog_WriteLine( BinaryLog log, double timeStamp, size_t valuesNumber, const double* valuesList );
+
+/// @brief Gets number of columns (excluding time stamp) of given log
+/// @param[in] log reference to binary log
+/// @return number of values per row
+size_t BinaryLog_GetColumnsNumber( BinaryLog log );
+
+/// @brief Opens (memory mapping, when possible) binary log file for reading
+/// @param[in] filePath path to binary log file
+/// @return reference/pointer to newly created binary log reader data structure (NULL on errors, including a time index inconsistent with file contents)
+BinaryLogReader BinaryLog_OpenReader( const char* filePath );
+
+/// @brief Closes binary log file and deallocates reader internal data
+/// @param[in] reader reference to binary log reader
+void BinaryLog_CloseReader( BinaryLogReader reader );
+
+/// @brief Gets metadata JSON string stored on file header
+/// @param[in] reader reference to binary log reader
+/// @return pointer to metadata string (empty if none)
+const char* BinaryLog_GetMetadata( BinaryLogReader reader );
+
+/// @brief Gets number of columns (excluding time stamp) stored on file
+/// @param[in] reader reference to binary log reader
+/// @return number of values per row
+size_t BinaryLog_GetReaderColumnsNumber( BinaryLogReader reader );
+
+/// @brief Gets name of given file column
+/// @param[in] reader reference to binary log reader
+/// @param[in] columnIndex index of column (from 0, excluding time stamp)
+/// @return pointer to column name string (NULL on invalid index)
+const char* BinaryLog_GetColumnName( BinaryLogReader reader, size_t columnIndex );
+
+/// @brief Gets total number of rows stored on file
+/// @param[in] reader reference to binary log reader
+/// @return number of rows
+size_t BinaryLog_GetRowsNumber( BinaryLogReader reader );
+
+/// @brief Finds first row with time stamp equal or greater than given time, using file time index
+/// @param[in] reader reference to binary log reader
+/// @param[in] timeStamp searched time stamp
+/// @return index of found row (BinaryLog_GetRowsNumber() if all rows are older)
+size_t BinaryLog_FindRow( BinaryLogReader reader, double timeStamp );
+
+/// @brief Reads time stamp and values of given row
+/// @param[in] reader reference to binary log reader
+/// @param[in] rowIndex index of row (from 0)
+/// @param[out] ref_timeStamp pointer to variable where row time stamp will be stored (ignored if NULL)
+/// @param[out] valuesList list with at least BinaryLog_GetReaderColumnsNumber() elements, where row values will be stored (ignored if NULL)
+/// @return true if row was read, false on invalid index
+bool BinaryLog_ReadRow( BinaryLogReader reader, size_t rowIndex, double* ref_timeStamp, double* valuesList );
+
+/// @brief Reads contiguous time stamps and values of a single column, decoding each needed block only once
+/// @param[in] reader reference to binary log reader
+/// @param[in] columnIndex index of column (from 0)
+/// @param[in] firstRowIndex index of first read row (from 0)
+/// @param[in] rowsNumber maximum number of read rows
+/// @param[out] timesList list with at least rowsNumber elements, where row time stamps will be stored (ignored if NULL)
+/// @param[out] valuesList list with at least rowsNumber elements, where column values will be stored (ignored if NULL)
+/// @return number of read rows (less than rowsNumber at end of log or on invalid column)
+size_t BinaryLog_ReadColumn( BinaryLogReader reader, size_t columnIndex, size_t firstRowIndex, size_t rowsNumber, double* timesList, double* valuesList );
+
+
+#endif // BINARY_LOG_H
@@ -0,0 +1,512 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "config_cache.h"
+
+#include "config_keys.h"
+
+#include "threads/thread_locks.h"
+#include "debug/data_logging.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <direct.h>
+#define mkdir( dirName, mode ) _mkdir( dirName )
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SOURCE_FILE_EXTENSION ".json"
+#define SNAPSHOT_FILE_EXTENSION ".snapshot"
+#define SNAPSHOTS_DIRECTORY KEY_CONFIG "/" KEY_SNAPSHOTS
+
+#define SNAPSHOT_MAGIC "RSLCONF"
+#define SNAPSHOT_ALIGNMENT 8
+
+typedef struct _SnapshotHeader
+{
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t entriesNumber;
+}
+SnapshotHeader;
+
+typedef struct _SnapshotEntryHeader
+{
+  int64_t sourceTime;               // Modification time, in nanoseconds where available
+  int64_t sourceSize;
+  uint32_t pathLength;              // Including terminating null character
+  uint32_t dataLength;              // Including terminating null character
+}
+SnapshotEntryHeader;
+
+// Header followed by (non empty) path and data strings, aligned
+#define SNAPSHOT_ENTRY_MIN_SIZE ( ( sizeof(SnapshotEntryHeader) + 2 + SNAPSHOT_ALIGNMENT - 1 ) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT )
+
+typedef struct _CacheEntry
+{
+  char* filePath;
+  DataHandle data;
+  int64_t sourceTime;
+  int64_t sourceSize;
+  size_t refsCount;
+  bool isOutdated;
+}
+CacheEntry;
+
+struct _SnapshotRecord
+{
+  char* rootPath;
+  char** pathsList;
+  size_t pathsNumber;
+  char** snapshotPathsList;
+  size_t snapshotPathsNumber;
+  bool isOutdated;
+};
+
+static CacheEntry* entriesList = NULL;
+static size_t entriesNumber = 0;
+static ThreadLock cacheLock = NULL;
+
+static _Thread_local ConfigSnapshot snapshotRecord = NULL;
+
+static bool GetSourceInfo( const char*, int64_t*, int64_t* );
+static CacheEntry* FindEntry( const char* );
+static CacheEntry* AddEntry( const char*, DataHandle, int64_t, int64_t );
+static void RemoveEntry( CacheEntry* );
+static void RecordPath( const char* );
+static void GetSnapshotFilePath( const char*, char* );
+static size_t LoadSnapshot( const char*, char*** );
+static bool WriteSnapshot( SnapshotRecord* );
+
+
+void ConfigCache_Init( void )
+{
+  if( cacheLock != NULL ) return;
+  
+  cacheLock = ThreadLock_Create();
+}
+
+void ConfigCache_End( void )
+{
+  if( cacheLock == NULL ) return;
+  
+  for( size_t entryIndex = 0; entryIndex < entriesNumber; entryIndex++ )
+  {
+    DataIO_UnloadData( entriesList[ entryIndex ].data );
+    free( entriesList[ entryIndex ].filePath );
+  }
+  free( entriesList );
+  entriesList = NULL;
+  entriesNumber = 0;
+  
+  ThreadLock_Discard( cacheLock );
+  cacheLock = NULL;
+}
+
+DataHandle ConfigCache_Load( const char* filePath )
+{
+  int64_t sourceTime, sourceSize;
+  // Configurations from unknown sources are never cached (nor recorded, as they could not be validated later)
+  if( cacheLock == NULL || !GetSourceInfo( filePath, &sourceTime, &sourceSize ) ) 
+  {
+    // Recording is only possible with initialized cache
+    if( snapshotRecord != NULL ) 
+    {
+      ThreadLock_Aquire( cacheLock );
+      snapshotRecord->isOutdated = true;
+      ThreadLock_Release( cacheLock );
+    }
+    return DataIO_LoadStorageData( filePath );
+  }
+  
+  ThreadLock_Aquire( cacheLock );
+  // Recording is also protected, as the same snapshot may be shared by many loading threads
+  RecordPath( filePath );
+  CacheEntry* entry = FindEntry( filePath );
+  if( entry != NULL && ( entry->sourceTime != sourceTime || entry->sourceSize != sourceSize ) )
+  {
+    DEBUG_PRINT( "cached configuration %s is outdated", filePath );
+    entry->isOutdated = true;
+    if( entry->refsCount == 0 ) RemoveEntry( entry );
+    entry = NULL;
+  }
+  if( entry == NULL )
+  {
+    ThreadLock_Release( cacheLock );
+    DataHandle data = DataIO_LoadStorageData( filePath );
+    if( data == NULL ) return NULL;
+    ThreadLock_Aquire( cacheLock );
+    // Another thread could have loaded the same configuration meanwhile
+    if( (entry = FindEntry( filePath )) == NULL ) entry = AddEntry( filePath, data, sourceTime, sourceSize );
+    else DataIO_UnloadData( data );
+  }
+  entry->refsCount++;
+  DataHandle data = entry->data;
+  ThreadLock_Release( cacheLock );
+  
+  return data;
+}
+
+void ConfigCache_Unload( DataHandle configuration )
+{
+  if( configuration == NULL ) return;
+  
+  if( cacheLock != NULL )
+  {
+    ThreadLock_Aquire( cacheLock );
+    for( size_t entryIndex = 0; entryIndex < entriesNumber; entryIndex++ )
+    {
+      CacheEntry* entry = &(entriesList[ entryIndex ]);
+      if( entry->data != configuration ) continue;
+      // Up-to-date data is kept for later reuse
+      if( entry->refsCount > 0 ) entry->refsCount--;
+      if( entry->isOutdated && entry->refsCount == 0 ) RemoveEntry( entry );
+      ThreadLock_Release( cacheLock );
+      return;
+    }
+    ThreadLock_Release( cacheLock );
+  }
+  
+  DataIO_UnloadData( configuration );
+}
+
+bool ConfigCache_HasData( const char* filePath, const char* dataString )
+{
+  if( dataString == NULL ) return false;
+  
+  DataHandle configuration = ConfigCache_Load( filePath );
+  if( configuration == NULL ) return false;
+  
+  // Comparing parsed contents, as file could be rewritten without actual changes
+  char* currentDataString = DataIO_GetDataString( configuration );
+  bool isUnchanged = ( currentDataString != NULL && strcmp( currentDataString, dataString ) == 0 );
+  free( currentDataString );
+  
+  ConfigCache_Unload( configuration );
+  
+  return isUnchanged;
+}
+
+bool ConfigCache_BeginSnapshot( const char* rootPath )
+{
+  if( cacheLock == NULL || snapshotRecord != NULL ) return false;
+  
+  snapshotRecord = (ConfigSnapshot) calloc( 1, sizeof(SnapshotRecord) );
+  snapshotRecord->rootPath = (char*) calloc( strlen( rootPath ) + 1, sizeof(char) );
+  strcpy( snapshotRecord->rootPath, rootPath );
+  
+  snapshotRecord->snapshotPathsNumber = LoadSnapshot( rootPath, &(snapshotRecord->snapshotPathsList) );
+  DEBUG_PRINT( "loaded %lu configurations from %s snapshot", snapshotRecord->snapshotPathsNumber, rootPath );
+  
+  return ( snapshotRecord->snapshotPathsNumber > 0 );
+}
+
+ConfigSnapshot ConfigCache_GetSnapshot( void )
+{
+  return snapshotRecord;
+}
+
+ConfigSnapshot ConfigCache_SetSnapshot( ConfigSnapshot snapshot )
+{
+  ConfigSnapshot lastSnapshot = snapshotRecord;
+  snapshotRecord = snapshot;
+  
+  return lastSnapshot;
+}
+
+bool ConfigCache_EndSnapshot( bool isComplete )
+{
+  if( snapshotRecord == NULL ) return false;
+  
+  // Any dependency added, removed or changed since last snapshot
+  if( snapshotRecord->pathsNumber != snapshotRecord->snapshotPathsNumber ) snapshotRecord->isOutdated = true;
+  
+  bool isWritten = ( isComplete && snapshotRecord->isOutdated ) ? WriteSnapshot( snapshotRecord ) : false;
+  
+  for( size_t pathIndex = 0; pathIndex < snapshotRecord->pathsNumber; pathIndex++ )
+    free( snapshotRecord->pathsList[ pathIndex ] );
+  free( snapshotRecord->pathsList );
+  for( size_t pathIndex = 0; pathIndex < snapshotRecord->snapshotPathsNumber; pathIndex++ )
+    free( snapshotRecord->snapshotPathsList[ pathIndex ] );
+  free( snapshotRecord->snapshotPathsList );
+  free( snapshotRecord->rootPath );
+  free( snapshotRecord );
+  snapshotRecord = NULL;
+  
+  return isWritten;
+}
+
+
+static bool GetSourceInfo( const char* filePath, int64_t* ref_sourceTime, int64_t* ref_sourceSize )
+{
+  char sourceFilePath[ DATA_IO_MAX_PATH_LENGTH ];
+  snprintf( sourceFilePath, DATA_IO_MAX_PATH_LENGTH, "%s" SOURCE_FILE_EXTENSION, filePath );
+  
+  struct stat sourceInfo;
+  if( stat( sourceFilePath, &sourceInfo ) != 0 ) return false;
+  
+  // Whole seconds could miss edits made right after the snapshot was written
+#ifdef WIN32
+  *ref_sourceTime = (int64_t) sourceInfo.st_mtime * 1000000000;
+#else
+  *ref_sourceTime = (int64_t) sourceInfo.st_mtim.tv_sec * 1000000000 + (int64_t) sourceInfo.st_mtim.tv_nsec;
+#endif
+  *ref_sourceSize = (int64_t) sourceInfo.st_size;
+  
+  return true;
+}
+
+// Lock should be held by caller
+static CacheEntry* FindEntry( const char* filePath )
+{
+  for( size_t entryIndex = 0; entryIndex < entriesNumber; entryIndex++ )
+  {
+    if( entriesList[ entryIndex ].isOutdated ) continue;
+    if( strcmp( entriesList[ entryIndex ].filePath, filePath ) == 0 ) return &(entriesList[ entryIndex ]);
+  }
+  
+  return NULL;
+}
+
+// Lock should be held by caller
+static CacheEntry* AddEntry( const char* filePath, DataHandle data, int64_t sourceTime, int64_t sourceSize )
+{
+  entriesList = (CacheEntry*) realloc( entriesList, ( entriesNumber + 1 ) * sizeof(CacheEntry) );
+  CacheEntry* newEntry = &(entriesList[ entriesNumber++ ]);
+  newEntry->filePath = (char*) calloc( strlen( filePath ) + 1, sizeof(char) );
+  strcpy( newEntry->filePath, filePath );
+  newEntry->data = data;
+  newEntry->sourceTime = sourceTime;
+  newEntry->sourceSize = sourceSize;
+  newEntry->refsCount = 0;
+  newEntry->isOutdated = false;
+  
+  return newEntry;
+}
+
+// Lock should be held by caller
+static void RemoveEntry( CacheEntry* entry )
+{
+  DataIO_UnloadData( entry->data );
+  free( entry->filePath );
+  *entry = entriesList[ --entriesNumber ];
+}
+
+static void RecordPath( const char* filePath )
+{
+  if( snapshotRecord == NULL ) return;
+  
+  for( size_t pathIndex = 0; pathIndex < snapshotRecord->pathsNumber; pathIndex++ )
+  {
+    if( strcmp( snapshotRecord->pathsList[ pathIndex ], filePath ) == 0 ) return;
+  }
+  
+  bool isInSnapshot = false;
+  for( size_t pathIndex = 0; pathIndex < snapshotRecord->snapshotPathsNumber; pathIndex++ )
+  {
+    if( strcmp( snapshotRecord->snapshotPathsList[ pathIndex ], filePath ) == 0 ) isInSnapshot = true;
+  }
+  if( !isInSnapshot ) snapshotRecord->isOutdated = true;
+  
+  snapshotRecord->pathsList = (char**) realloc( snapshotRecord->pathsList, ( snapshotRecord->pathsNumber + 1 ) * sizeof(char*) );
+  char* newPath = (char*) calloc( strlen( filePath ) + 1, sizeof(char) );
+  strcpy( newPath, filePath );
+  snapshotRecord->pathsList[ snapshotRecord->pathsNumber++ ] = newPath;
+}
+
+// Snapshot file name is the root storage path (without leading configuration directory), with directory separators replaced
+static void GetSnapshotFilePath( const char* rootPath, char* snapshotFilePath )
+{
+  if( strncmp( rootPath, KEY_CONFIG "/", strlen( KEY_CONFIG "/" ) ) == 0 ) rootPath += strlen( KEY_CONFIG "/" );
+  
+  int pathLength = snprintf( snapshotFilePath, DATA_IO_MAX_PATH_LENGTH, SNAPSHOTS_DIRECTORY "/%s" SNAPSHOT_FILE_EXTENSION, rootPath );
+  for( int charIndex = strlen( SNAPSHOTS_DIRECTORY "/" ); charIndex < pathLength && snapshotFilePath[ charIndex ] != '\0'; charIndex++ )
+  {
+    if( snapshotFilePath[ charIndex ] == '/' || snapshotFilePath[ charIndex ] == '\\' ) snapshotFilePath[ charIndex ] = '-';
+  }
+}
+
+// Seeds cache with all valid snapshot entries, returning the list of their storage paths
+static size_t LoadSnapshot( const char* rootPath, char*** ref_pathsList )
+{
+  char snapshotFilePath[ DATA_IO_MAX_PATH_LENGTH ];
+  GetSnapshotFilePath( rootPath, snapshotFilePath );
+  
+  *ref_pathsList = NULL;
+  
+#ifdef WIN32
+  FILE* snapshotFile = fopen( snapshotFilePath, "rb" );
+  if( snapshotFile == NULL ) return 0;
+  fseek( snapshotFile, 0, SEEK_END );
+  long snapshotSize = ftell( snapshotFile );
+  fseek( snapshotFile, 0, SEEK_SET );
+  char* snapshotData = (char*) malloc( ( snapshotSize > 0 ) ? snapshotSize : 1 );
+  if( snapshotSize <= 0 || fread( snapshotData, 1, snapshotSize, snapshotFile ) != (size_t) snapshotSize ) snapshotSize = 0;
+  fclose( snapshotFile );
+#else
+  int snapshotFileDescriptor = open( snapshotFilePath, O_RDONLY );
+  if( snapshotFileDescriptor == -1 ) return 0;
+  struct stat snapshotInfo;
+  if( fstat( snapshotFileDescriptor, &snapshotInfo ) != 0 || snapshotInfo.st_size <= 0 )
+  {
+    close( snapshotFileDescriptor );
+    return 0;
+  }
+  long snapshotSize = (long) snapshotInfo.st_size;
+  char* snapshotData = (char*) mmap( NULL, snapshotSize, PROT_READ, MAP_PRIVATE, snapshotFileDescriptor, 0 );
+  close( snapshotFileDescriptor );
+  if( snapshotData == MAP_FAILED ) return 0;
+#endif
+  
+  size_t pathsNumber = 0;
+  const SnapshotHeader* header = (const SnapshotHeader*) snapshotData;
+  // Entries number is checked against file size before any allocation, as it may come from a corrupted file
+  if( (size_t) snapshotSize >= sizeof(SnapshotHeader) && memcmp( header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) ) == 0 
+      && header->version == CONFIG_SNAPSHOT_VERSION && header->entriesNumber <= ( (size_t) snapshotSize - sizeof(SnapshotHeader) ) / SNAPSHOT_ENTRY_MIN_SIZE )
+  {
+    *ref_pathsList = (char**) calloc( header->entriesNumber, sizeof(char*) );
+    size_t entryOffset = sizeof(SnapshotHeader);
+    for( uint32_t entryIndex = 0; entryIndex < header->entriesNumber; entryIndex++ )
+    {
+      if( entryOffset + sizeof(SnapshotEntryHeader) > (size_t) snapshotSize ) break;
+      const SnapshotEntryHeader* entryHeader = (const SnapshotEntryHeader*) ( snapshotData + entryOffset );
+      const char* filePath = snapshotData + entryOffset + sizeof(SnapshotEntryHeader);
+      const char* dataString = filePath + entryHeader->pathLength;
+      size_t entrySize = sizeof(SnapshotEntryHeader) + entryHeader->pathLength + entryHeader->dataLength;
+      entrySize += ( SNAPSHOT_ALIGNMENT - entrySize % SNAPSHOT_ALIGNMENT ) % SNAPSHOT_ALIGNMENT;
+      // Truncated or corrupted entry invalidates the remaining ones
+      if( entryHeader->pathLength == 0 || entryHeader->dataLength == 0 || entryOffset + entrySize > (size_t) snapshotSize 
+          || filePath[ entryHeader->pathLength - 1 ] != '\0' || dataString[ entryHeader->dataLength - 1 ] != '\0' ) break;
+      entryOffset += entrySize;
+      
+      int64_t sourceTime, sourceSize;
+      if( !GetSourceInfo( filePath, &sourceTime, &sourceSize ) ) continue;
+      if( sourceTime != entryHeader->sourceTime || sourceSize != entryHeader->sourceSize ) continue;
+      
+      ThreadLock_Aquire( cacheLock );
+      CacheEntry* entry = FindEntry( filePath );
+      if( entry != NULL && ( entry->sourceTime != sourceTime || entry->sourceSize != sourceSize ) )
+      {
+        entry->isOutdated = true;
+        if( entry->refsCount == 0 ) RemoveEntry( entry );
+        entry = NULL;
+      }
+      if( entry == NULL )
+      {
+        // Serialized data is parsed from memory, without any storage access
+        DataHandle data = DataIO_LoadStringData( dataString );
+        if( data != NULL ) entry = AddEntry( filePath, data, sourceTime, sourceSize );
+      }
+      ThreadLock_Release( cacheLock );
+      if( entry == NULL ) continue;
+      
+      (*ref_pathsList)[ pathsNumber ] = (char*) calloc( entryHeader->pathLength, sizeof(char) );
+      strcpy( (*ref_pathsList)[ pathsNumber++ ], filePath );
+    }
+  }
+  
+#ifdef WIN32
+  free( snapshotData );
+#else
+  munmap( snapshotData, snapshotSize );
+#endif
+  
+  return pathsNumber;
+}
+
+static bool WriteSnapshot( SnapshotRecord* record )
+{
+  char snapshotFilePath[ DATA_IO_MAX_PATH_LENGTH ];
+  GetSnapshotFilePath( record->rootPath, snapshotFilePath );
+  char temporaryFilePath[ DATA_IO_MAX_PATH_LENGTH + 4 ];
+  snprintf( temporaryFilePath, sizeof(temporaryFilePath), "%s.tmp", snapshotFilePath );
+  
+  (void) mkdir( SNAPSHOTS_DIRECTORY, 0755 );
+  FILE* snapshotFile = fopen( temporaryFilePath, "wb" );
+  if( snapshotFile == NULL ) return false;
+  
+  SnapshotHeader header = { .version = CONFIG_SNAPSHOT_VERSION, .entriesNumber = 0 };
+  memcpy( header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) );
+  bool isWritten = ( fwrite( &header, sizeof(SnapshotHeader), 1, snapshotFile ) == 1 );
+  
+  const char padding[ SNAPSHOT_ALIGNMENT ] = { 0 };
+  for( size_t pathIndex = 0; pathIndex < record->pathsNumber && isWritten; pathIndex++ )
+  {
+    const char* filePath = record->pathsList[ pathIndex ];
+    SnapshotEntryHeader entryHeader = { .pathLength = (uint32_t) strlen( filePath ) + 1 };
+    
+    char* dataString = NULL;
+    ThreadLock_Aquire( cacheLock );
+    CacheEntry* entry = FindEntry( filePath );
+    if( entry != NULL )
+    {
+      entryHeader.sourceTime = entry->sourceTime;
+      entryHeader.sourceSize = entry->sourceSize;
+      dataString = DataIO_GetDataString( entry->data );
+    }
+    ThreadLock_Release( cacheLock );
+    // Configuration changed while tree was built: snapshot would be outdated anyway
+    if( dataString == NULL ) 
+    {
+      isWritten = false;
+      break;
+    }
+    
+    entryHeader.dataLength = (uint32_t) strlen( dataString ) + 1;
+    size_t entrySize = sizeof(SnapshotEntryHeader) + entryHeader.pathLength + entryHeader.dataLength;
+    size_t paddingSize = ( SNAPSHOT_ALIGNMENT - entrySize % SNAPSHOT_ALIGNMENT ) % SNAPSHOT_ALIGNMENT;
+    isWritten = ( fwrite( &entryHeader, sizeof(SnapshotEntryHeader), 1, snapshotFile ) == 1 
+                  && fwrite( filePath, 1, entryHeader.pathLength, snapshotFile ) == entryHeader.pathLength
+                  && fwrite( dataString, 1, entryHeader.dataLength, snapshotFile ) == entryHeader.dataLength
+                  && fwrite( padding, 1, paddingSize, snapshotFile ) == paddingSize );
+    free( dataString );
+    header.entriesNumber++;
+  }
+  
+  if( isWritten )
+  {
+    fseek( snapshotFile, 0, SEEK_SET );
+    isWritten = ( fwrite( &header, sizeof(SnapshotHeader), 1, snapshotFile ) == 1 );
+  }
+  if( fclose( snapshotFile ) != 0 ) isWritten = false;
+  
+  // Replace previous snapshot only when the new one is complete
+  if( isWritten )
+  {
+    remove( snapshotFilePath );
+    isWritten = ( rename( temporaryFilePath, snapshotFilePath ) == 0 );
+  }
+  if( !isWritten ) remove( temporaryFilePath );
+  
+  DEBUG_PRINT( "writing %u configurations to %s success: %s", (unsigned int) header.entriesNumber, snapshotFilePath, isWritten ? "true" : "false" );
+  
+  return isWritten;
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file config_cache.h
+/// @brief Parsed configurations cache and precompiled configuration snapshots
+///
+/// Robot, actuator, sensor and motor configuration files are loaded through this cache instead of directly from storage, so that reloading a robot 
+/// (e.g. on client request, see shared_robot_control.h) reuses the already parsed data of unchanged files. Cached data is replaced whenever its source file 
+/// modification time (with nanoseconds resolution, where available) or size changes.
+///
+/// All files loaded while building a configuration tree (e.g. a robot and all its devices) are also compiled to a single versioned snapshot file, 
+/// <config_dir>/snapshots/<tree_path>.snapshot, that is memory-mapped on next cold start instead of searching, opening and reading each source file. 
+/// Snapshot entries whose source file has changed are ignored (loaded from source file again), and the snapshot is rewritten after the tree is built.
+
+
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include "data_io/interface/data_io.h"
+
+#include <stdbool.h>
+
+#define CONFIG_SNAPSHOT_VERSION 2         ///< Snapshot files format version. Files with different versions are ignored
+
+typedef struct _SnapshotRecord SnapshotRecord;    ///< Single configuration tree recording internal data structure
+typedef SnapshotRecord* ConfigSnapshot;           ///< Opaque reference to configuration tree recording internal data structure
+
+
+/// @brief Initializes configurations cache (not thread safe). Without initialization, configurations are always loaded from storage
+void ConfigCache_Init( void );
+
+/// @brief Deallocates all cached configurations data
+void ConfigCache_End( void );
+
+/// @brief Gets parsed configuration data from cache, loading (and caching) it from storage if not available or outdated (thread safe)
+/// @param[in] filePath configuration storage path, as in DataIO_LoadStorageData()
+/// @return handle to (read only) configuration data, or NULL on loading errors
+DataHandle ConfigCache_Load( const char* filePath );
+
+/// @brief Releases configuration data acquired with ConfigCache_Load() (thread safe)
+/// @param[in] configuration handle to configuration data (not cached handles are unloaded as in DataIO_UnloadData())
+void ConfigCache_Unload( DataHandle configuration );
+
+/// @brief Checks whether configuration currently stored at given path has the same contents as previously loaded data (thread safe)
+/// @param[in] filePath configuration storage path, as in ConfigCache_Load()
+/// @param[in] dataString previously loaded configuration serialized with DataIO_GetDataString()
+/// @return true if configuration is unchanged, false otherwise (or on loading errors)
+bool ConfigCache_HasData( const char* filePath, const char* dataString );
+
+/// @brief Loads snapshot of given configuration tree into cache (if valid), and starts recording loaded configurations on calling thread
+/// @param[in] rootPath storage path of configuration tree root, as in ConfigCache_Load()
+/// @return true if a valid snapshot was loaded, false otherwise
+bool ConfigCache_BeginSnapshot( const char* rootPath );
+
+/// @brief Gets configuration tree currently being recorded on calling thread
+/// @return reference to recording started with ConfigCache_BeginSnapshot(), or NULL if not recording
+ConfigSnapshot ConfigCache_GetSnapshot( void );
+
+/// @brief Sets configuration tree recorded on calling thread, so that e.g. worker threads may load parts of a tree being recorded by another one
+/// @param[in] snapshot reference to recording, as returned by ConfigCache_GetSnapshot() (NULL stops recording without ending it)
+/// @return reference to recording previously set on calling thread
+ConfigSnapshot ConfigCache_SetSnapshot( ConfigSnapshot snapshot );
+
+/// @brief Stops recording configurations on calling thread, rewriting tree snapshot if it was missing or outdated
+/// @param[in] isComplete true if configuration tree was successfully built (otherwise, no snapshot is written)
+/// @return true if snapshot was written, false otherwise
+bool ConfigCache_EndSnapshot( bool isComplete );
+
+
+#endif // CONFIG_CACHE_H
@@ -41,6 +41,26 @@
 #define KEY_LOG                   "log"
 #define KEY_LOGS                  KEY_LOG "s"
 #define KEY_FILE                  "to_file"
+#define KEY_ENABLED               "enabled"
 #define KEY_PRECISION             "precision"
+#define KEY_BUFFER_LENGTH         "buffer_length"
+#define KEY_OVERFLOW              "overflow"
+#define KEY_FORMAT                "format"
+#define KEY_BINARY                "binary"
+#define KEY_COMPRESSION           "compression"
+#define KEY_DECIMATION            "decimation"
+#define KEY_AGGREGATION           "aggregation"
+#define KEY_TRIGGER               "trigger"
+#define KEY_STATE                 "state"
+#define KEY_VALUE                 "value"
+#define KEY_ABOVE                 "above"
+#define KEY_BELOW                 "below"
+#define KEY_PRE_TRIGGER           "pre_trigger"
+#define KEY_FLIGHT_RECORDER       "flight_recorder"
+#define KEY_DURATION              "duration"
+#define KEY_DEADLINE_MISSES       "deadline_misses"
+#define KEY_MISSES_WINDOW         "misses_window"
+#define KEY_SNAPSHOTS             "snapshots"
+#define KEY_INIT_WORKERS          "init_workers"
 
 #endif // CONFIG_KEYS_H
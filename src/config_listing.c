@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "config_listing.h"
+
+#include "config_keys.h"
+
+#include "data_io/interface/data_io.h"
+#include "timing/timing.h"
+#include "debug/data_logging.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#define LISTING_PATH_MAX_LENGTH 64
+
+typedef struct _ConfigListing
+{
+  const char* category;
+  char* listString;
+  double scanTime;
+  int watchID;
+  bool isOutdated;
+}
+ConfigListing;
+
+static ConfigListing listingsList[] = { { KEY_ROBOTS }, { KEY_ACTUATORS }, { KEY_SENSORS }, { KEY_MOTORS } };
+static const size_t LISTINGS_NUMBER = sizeof(listingsList) / sizeof(ConfigListing);
+
+static int notifyFD = -1;
+
+static ConfigListing* FindListing( const char* );
+static void ReadNotifications( void );
+static void ScanListing( ConfigListing* );
+
+
+void ConfigListing_Init( void )
+{
+#ifdef __linux__
+  if( notifyFD == -1 ) notifyFD = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+#endif
+  
+  for( size_t listingIndex = 0; listingIndex < LISTINGS_NUMBER; listingIndex++ )
+  {
+    ConfigListing* listing = &(listingsList[ listingIndex ]);
+    listing->isOutdated = true;
+    listing->watchID = -1;
+#ifdef __linux__
+    if( notifyFD == -1 ) continue;
+    char directoryPath[ LISTING_PATH_MAX_LENGTH ];
+    snprintf( directoryPath, LISTING_PATH_MAX_LENGTH, "./" KEY_CONFIG "/%s/", listing->category );
+    // Only entries added, removed or renamed change listings (not contents)
+    listing->watchID = inotify_add_watch( notifyFD, directoryPath, IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF );
+#endif
+    DEBUG_PRINT( "watching %s configurations: %s", listing->category, ( listing->watchID != -1 ) ? "true" : "false" );
+  }
+}
+
+void ConfigListing_End( void )
+{
+#ifdef __linux__
+  if( notifyFD != -1 ) close( notifyFD );
+#endif
+  notifyFD = -1;
+  
+  for( size_t listingIndex = 0; listingIndex < LISTINGS_NUMBER; listingIndex++ )
+  {
+    free( listingsList[ listingIndex ].listString );
+    listingsList[ listingIndex ].listString = NULL;
+    listingsList[ listingIndex ].watchID = -1;
+  }
+}
+
+bool ConfigListing_HasCategory( const char* category )
+{
+  return ( FindListing( category ) != NULL );
+}
+
+const char* ConfigListing_GetString( const char* category )
+{
+  ConfigListing* listing = FindListing( category );
+  if( listing == NULL ) return NULL;
+  
+  ReadNotifications();
+  
+  // Directories not watched (or whose watch was removed) fall back to periodic rescans
+  if( listing->watchID == -1 && Time_GetExecSeconds() - listing->scanTime > CONFIG_LISTING_RESCAN_INTERVAL ) listing->isOutdated = true;
+  
+  if( listing->isOutdated || listing->listString == NULL ) ScanListing( listing );
+  
+  return listing->listString;
+}
+
+
+static ConfigListing* FindListing( const char* category )
+{
+  if( category == NULL ) return NULL;
+  
+  for( size_t listingIndex = 0; listingIndex < LISTINGS_NUMBER; listingIndex++ )
+  {
+    if( strcmp( listingsList[ listingIndex ].category, category ) == 0 ) return &(listingsList[ listingIndex ]);
+  }
+  
+  return NULL;
+}
+
+// Marks listings of changed directories as outdated, without blocking
+static void ReadNotifications( void )
+{
+#ifdef __linux__
+  if( notifyFD == -1 ) return;
+  
+  char eventsBuffer[ 4096 ] __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+  ssize_t readLength;
+  while( (readLength = read( notifyFD, eventsBuffer, sizeof(eventsBuffer) )) > 0 )
+  {
+    for( char* eventData = eventsBuffer; eventData < eventsBuffer + readLength; )
+    {
+      const struct inotify_event* event = (const struct inotify_event*) eventData;
+      for( size_t listingIndex = 0; listingIndex < LISTINGS_NUMBER; listingIndex++ )
+      {
+        ConfigListing* listing = &(listingsList[ listingIndex ]);
+        // Lost events could refer to any directory
+        if( event->wd != listing->watchID && !( event->mask & IN_Q_OVERFLOW ) ) continue;
+        listing->isOutdated = true;
+        if( event->mask & IN_IGNORED ) listing->watchID = -1;
+      }
+      eventData += sizeof(struct inotify_event) + event->len;
+    }
+  }
+#endif
+}
+
+static void ScanListing( ConfigListing* listing )
+{
+  char directoryPath[ LISTING_PATH_MAX_LENGTH ];
+  snprintf( directoryPath, LISTING_PATH_MAX_LENGTH, "./" KEY_CONFIG "/%s/", listing->category );
+  DEBUG_PRINT( "searching %s config in: %s", listing->category, directoryPath );
+  
+  DataHandle configsList = DataIO_CreateEmptyData();
+  DataHandle sharedConfigsList = DataIO_AddList( configsList, listing->category );
+  const char** dataList = DataIO_ListStorageDataEntries( directoryPath );
+  for( size_t dataIndex = 0; dataList != NULL && dataList[ dataIndex ] != NULL; dataIndex++ )
+    DataIO_SetStringValue( sharedConfigsList, NULL, dataList[ dataIndex ] );
+  
+  free( listing->listString );
+  listing->listString = DataIO_GetDataString( configsList );
+  DEBUG_PRINT( "%s info string: %s", listing->category, listing->listString );
+  
+  DataIO_UnloadData( configsList );
+  
+  listing->scanTime = Time_GetExecSeconds();
+  listing->isOutdated = false;
+}
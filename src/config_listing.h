@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file config_listing.h
+/// @brief Cached listings of available configuration files
+///
+/// Clients poll the available robot (and device) configurations frequently (see ROBOT_REQ_LIST_CONFIGS in shared_robot_control.h), so each listing 
+/// is kept as an already serialized reply string, only rebuilt after its configuration directory changes. Where supported (Linux inotify), changes are 
+/// detected through filesystem notifications. Otherwise (or for directories that could not be watched), listings are rescanned periodically.
+///
+/// Listings are only accessed by the calling (events) thread, so these functions are not thread safe.
+
+
+#ifndef CONFIG_LISTING_H
+#define CONFIG_LISTING_H
+
+#include <stdbool.h>
+
+#define CONFIG_LISTING_RESCAN_INTERVAL 5.0      ///< Maximum age, in seconds, of listings not updated by filesystem notifications
+
+
+/// @brief Starts watching configuration directories, relative to current working directory (robots, actuators, sensors and motors)
+void ConfigListing_Init( void );
+
+/// @brief Stops watching configuration directories and deallocates cached listings
+void ConfigListing_End( void );
+
+/// @brief Checks whether given name is a listed configuration category
+/// @param[in] category configuration category/directory name, like "robots" or "sensors"
+/// @return true if category is listed, false otherwise
+bool ConfigListing_HasCategory( const char* category );
+
+/// @brief Gets available configurations of given category, rescanning its directory only if changed since last call
+/// @param[in] category configuration category/directory name, like "robots" or "sensors"
+/// @return JSON-format string like { "<category>":[ "<config1_name>", "<config2_name>" ] } (valid until next call), or NULL for unknown categories
+const char* ConfigListing_GetString( const char* category );
+
+
+#endif // CONFIG_LISTING_H
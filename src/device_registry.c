@@ -0,0 +1,622 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "device_registry.h"
+
+#include "config_keys.h"
+
+#include "data_io/interface/data_io.h"
+#include "threads/thread_locks.h"
+#include "debug/data_logging.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+#define MAX_PENDING_BLOCKS 32
+
+typedef struct _ModuleEntry
+{
+  char* name;
+  SignalIOModule module;
+  SignalIOBlockModule blockModule;
+  bool hasBlockTransfers;
+  bool isThreadSafe;
+  ThreadLock setupLock;                 // Serializes device setup calls of plug-ins not declared thread safe
+}
+ModuleEntry;
+
+typedef struct _DeviceBlock DeviceBlock;
+
+struct _DeviceChannelData
+{
+  const ModuleEntry* moduleEntry;
+  long int deviceID;
+  DeviceBlock* block;                    // NULL for devices without block transfers
+  unsigned int channel;
+  bool isOutput;
+  size_t refsCount;
+  double* buffer;
+  size_t samplesNumber;
+  double value;
+  bool isPending;
+};
+
+// Grouped channels of a device supporting block transfers
+struct _DeviceBlock
+{
+  const ModuleEntry* moduleEntry;
+  long int deviceID;
+  size_t maxSamplesNumber;
+  ThreadLock lock;                       // Taken once per transaction, so that channels may be added or removed by robots set up meanwhile
+  DeviceChannel* channelsList;
+  size_t channelsNumber;
+  unsigned int* inputChannelsList;
+  double** inputBuffersList;
+  size_t* inputSamplesList;
+  size_t inputsNumber;
+  unsigned int* outputChannelsList;
+  double* outputValuesList;
+  atomic_ulong readBatch;              // Transfers block of last acquisition, so that inputs are only acquired once per block
+  atomic_ulong pendingBatch;
+};
+
+typedef struct _DeviceEntry
+{
+  const ModuleEntry* moduleEntry;
+  char* config;
+  long int deviceID;
+  size_t refsCount;
+  DeviceBlock* block;
+  ThreadLock initLock;                  // Held during device initialization, so that concurrent users of the same device wait for it
+}
+DeviceEntry;
+
+static ModuleEntry** modulesList = NULL;
+static size_t modulesNumber = 0;
+static DeviceEntry** devicesList = NULL;
+static size_t devicesNumber = 0;
+static ThreadLock registryLock = NULL;
+
+static atomic_ulong batchesCount = 0;
+// Transfers block (0 when not grouping) and devices with deferred writes of calling thread
+static _Thread_local unsigned long currentBatch = 0;
+static _Thread_local DeviceBlock* pendingBlocksList[ MAX_PENDING_BLOCKS ];
+static _Thread_local size_t pendingBlocksNumber = 0;
+// Plug-in being set up by calling thread, kept so that its setup lock is released without registry access
+static _Thread_local const ModuleEntry* setupModuleEntry = NULL;
+
+static void LockRegistry( void );
+static void UnlockRegistry( void );
+static const ModuleEntry* LoadModule( const char* );
+static const ModuleEntry* FindModule( const SignalIOModule* );
+static DeviceEntry* FindDevice( const SignalIOModule*, long int );
+static void DiscardDevice( DeviceEntry* );
+static DeviceBlock* CreateBlock( const ModuleEntry*, long int );
+static void DiscardBlock( DeviceBlock* );
+static void UpdateBlockLists( DeviceBlock* );
+static void FlushBlock( DeviceBlock* );
+static void BeginTransaction( const ModuleEntry* );
+static void EndTransaction( const ModuleEntry* );
+
+
+void DeviceRegistry_Init( void )
+{
+  if( registryLock != NULL ) return;
+  
+  registryLock = ThreadLock_Create();
+}
+
+void DeviceRegistry_End( void )
+{
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    DEBUG_PRINT( "ending device %s (%lu users left)", devicesList[ deviceIndex ]->config, devicesList[ deviceIndex ]->refsCount );
+    DiscardDevice( devicesList[ deviceIndex ] );
+  }
+  free( devicesList );
+  devicesList = NULL;
+  devicesNumber = 0;
+  
+  // Plug-in libraries themselves are kept loaded until process exit
+  for( size_t moduleIndex = 0; moduleIndex < modulesNumber; moduleIndex++ )
+  {
+    free( modulesList[ moduleIndex ]->name );
+    ThreadLock_Discard( modulesList[ moduleIndex ]->setupLock );
+    free( modulesList[ moduleIndex ] );
+  }
+  free( modulesList );
+  modulesList = NULL;
+  modulesNumber = 0;
+  
+  ThreadLock_Discard( registryLock );
+  registryLock = NULL;
+}
+
+long int DeviceRegistry_AcquireDevice( const char* moduleName, const char* deviceConfig, SignalIOModule* ref_module )
+{
+  if( moduleName == NULL || deviceConfig == NULL || ref_module == NULL ) return SIGNAL_IO_DEVICE_INVALID_ID;
+  
+  DeviceEntry* device = NULL;
+  
+  LockRegistry();
+  const ModuleEntry* moduleEntry = LoadModule( moduleName );
+  if( moduleEntry != NULL )
+  {
+    *ref_module = moduleEntry->module;
+    
+    for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+    {
+      if( devicesList[ deviceIndex ]->moduleEntry != moduleEntry || strcmp( devicesList[ deviceIndex ]->config, deviceConfig ) != 0 ) continue;
+      device = devicesList[ deviceIndex ];
+      break;
+    }
+    
+    // Entry is added before initialization, so that the (possibly slow) device setup is performed outside registry lock
+    if( device == NULL )
+    {
+      device = (DeviceEntry*) malloc( sizeof(DeviceEntry) );
+      memset( device, 0, sizeof(DeviceEntry) );
+      device->moduleEntry = moduleEntry;
+      device->config = (char*) calloc( strlen( deviceConfig ) + 1, sizeof(char) );
+      strcpy( device->config, deviceConfig );
+      device->deviceID = SIGNAL_IO_DEVICE_INVALID_ID;
+      device->initLock = ThreadLock_Create();
+      devicesList = (DeviceEntry**) realloc( devicesList, ( devicesNumber + 1 ) * sizeof(DeviceEntry*) );
+      devicesList[ devicesNumber++ ] = device;
+    }
+    device->refsCount++;
+  }
+  UnlockRegistry();
+  
+  if( device == NULL ) return SIGNAL_IO_DEVICE_INVALID_ID;
+  
+  ThreadLock_Aquire( device->initLock );
+  // Devices that failed initialization for a previous user are tried again
+  if( device->deviceID == SIGNAL_IO_DEVICE_INVALID_ID )
+  {
+    DeviceRegistry_BeginSetup( &(moduleEntry->module) );
+    long int newDeviceID = moduleEntry->module.InitDevice( deviceConfig );
+    DeviceBlock* newBlock = NULL;
+    if( newDeviceID != SIGNAL_IO_DEVICE_INVALID_ID && moduleEntry->hasBlockTransfers ) newBlock = CreateBlock( moduleEntry, newDeviceID );
+    DeviceRegistry_EndSetup();
+    if( newDeviceID != SIGNAL_IO_DEVICE_INVALID_ID ) DEBUG_PRINT( "initialized %s device %s with ID %ld", moduleName, deviceConfig, newDeviceID );
+    LockRegistry();
+    device->deviceID = newDeviceID;
+    device->block = newBlock;
+    UnlockRegistry();
+  }
+  long int deviceID = device->deviceID;
+  ThreadLock_Release( device->initLock );
+  
+  if( deviceID == SIGNAL_IO_DEVICE_INVALID_ID )
+  {
+    LockRegistry();
+    if( --(device->refsCount) == 0 ) DiscardDevice( device );
+    UnlockRegistry();
+  }
+  
+  return deviceID;
+}
+
+void DeviceRegistry_ReleaseDevice( const SignalIOModule* module, long int deviceID )
+{
+  if( module == NULL || deviceID == SIGNAL_IO_DEVICE_INVALID_ID ) return;
+  
+  LockRegistry();
+  DeviceEntry* device = FindDevice( module, deviceID );
+  if( device != NULL && --(device->refsCount) == 0 )
+  {
+    DEBUG_PRINT( "ending unused device %s", device->config );
+    DiscardDevice( device );
+  }
+  UnlockRegistry();
+}
+
+bool DeviceRegistry_IsShared( const SignalIOModule* module, long int deviceID )
+{
+  if( module == NULL || deviceID == SIGNAL_IO_DEVICE_INVALID_ID ) return false;
+  
+  LockRegistry();
+  DeviceEntry* device = FindDevice( module, deviceID );
+  bool isShared = ( device != NULL && device->refsCount > 1 );
+  UnlockRegistry();
+  
+  return isShared;
+}
+
+void DeviceRegistry_BeginSetup( const SignalIOModule* module )
+{
+  if( module == NULL || setupModuleEntry != NULL ) return;
+  
+  LockRegistry();
+  const ModuleEntry* moduleEntry = FindModule( module );
+  UnlockRegistry();
+  
+  if( moduleEntry == NULL || moduleEntry->isThreadSafe ) return;
+  
+  ThreadLock_Aquire( moduleEntry->setupLock );
+  setupModuleEntry = moduleEntry;
+}
+
+void DeviceRegistry_EndSetup( void )
+{
+  if( setupModuleEntry == NULL ) return;
+  
+  // Devices are ended holding registry lock before setup lock, so that the latter is never held while requesting the former
+  ThreadLock_Release( setupModuleEntry->setupLock );
+  setupModuleEntry = NULL;
+}
+
+DeviceChannel DeviceRegistry_AddChannel( const SignalIOModule* module, long int deviceID, unsigned int channel, bool isOutput )
+{
+  if( module == NULL || deviceID == SIGNAL_IO_DEVICE_INVALID_ID ) return NULL;
+  
+  LockRegistry();
+  DeviceEntry* device = FindDevice( module, deviceID );
+  const ModuleEntry* moduleEntry = ( device != NULL ) ? device->moduleEntry : NULL;
+  DeviceBlock* block = ( device != NULL ) ? device->block : NULL;
+  UnlockRegistry();
+  if( moduleEntry == NULL ) return NULL;
+  
+  DeviceChannel newChannel = NULL;
+  // Channels of devices without block transfers are not grouped, but still get their transfers serialized with plug-in setups
+  if( block == NULL )
+  {
+    newChannel = (DeviceChannel) malloc( sizeof(DeviceChannelData) );
+    memset( newChannel, 0, sizeof(DeviceChannelData) );
+    newChannel->moduleEntry = moduleEntry;
+    newChannel->deviceID = deviceID;
+    newChannel->channel = channel;
+    newChannel->isOutput = isOutput;
+    newChannel->refsCount = 1;
+    return newChannel;
+  }
+  
+
+  ThreadLock_Aquire( block->lock );
+  for( size_t channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+  {
+    DeviceChannel blockChannel = block->channelsList[ channelIndex ];
+    if( blockChannel->channel != channel || blockChannel->isOutput != isOutput ) continue;
+    blockChannel->refsCount++;
+    newChannel = blockChannel;
+    break;
+  }
+  if( newChannel == NULL )
+  {
+    newChannel = (DeviceChannel) malloc( sizeof(DeviceChannelData) );
+    memset( newChannel, 0, sizeof(DeviceChannelData) );
+    newChannel->moduleEntry = moduleEntry;
+    newChannel->deviceID = deviceID;
+    newChannel->block = block;
+    newChannel->channel = channel;
+    newChannel->isOutput = isOutput;
+    newChannel->refsCount = 1;
+    if( !isOutput ) newChannel->buffer = (double*) calloc( block->maxSamplesNumber, sizeof(double) );
+    block->channelsList = (DeviceChannel*) realloc( block->channelsList, ( block->channelsNumber + 1 ) * sizeof(DeviceChannel) );
+    block->channelsList[ block->channelsNumber++ ] = newChannel;
+    UpdateBlockLists( block );
+  }
+  ThreadLock_Release( block->lock );
+  
+  return newChannel;
+}
+
+void DeviceRegistry_RemoveChannel( DeviceChannel channel )
+{
+  if( channel == NULL ) return;
+  
+  DeviceBlock* block = channel->block;
+  if( block == NULL )
+  {
+    free( channel );
+    return;
+  }
+  
+  ThreadLock_Aquire( block->lock );
+  if( --(channel->refsCount) == 0 )
+  {
+    for( size_t channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+    {
+      if( block->channelsList[ channelIndex ] != channel ) continue;
+      block->channelsList[ channelIndex ] = block->channelsList[ --(block->channelsNumber) ];
+      break;
+    }
+    UpdateBlockLists( block );
+    free( channel->buffer );
+    free( channel );
+  }
+  ThreadLock_Release( block->lock );
+}
+
+size_t DeviceRegistry_Read( DeviceChannel channel, double* buffer )
+{
+  if( channel == NULL || buffer == NULL ) return 0;
+  
+  DeviceBlock* block = channel->block;
+  if( block == NULL || currentBatch == 0 ) 
+  {
+    BeginTransaction( channel->moduleEntry );
+    size_t samplesNumber = channel->moduleEntry->module.Read( channel->deviceID, channel->channel, buffer );
+    EndTransaction( channel->moduleEntry );
+    return samplesNumber;
+  }
+  
+  // All device inputs are acquired on the first read of this block. Repeated reads of any channel get the cached samples
+  unsigned long readBatch = atomic_load_explicit( &(block->readBatch), memory_order_acquire );
+  if( readBatch != currentBatch && atomic_compare_exchange_strong( &(block->readBatch), &readBatch, currentBatch ) )
+  {
+    ThreadLock_Aquire( block->lock );
+    BeginTransaction( block->moduleEntry );
+    if( !block->moduleEntry->blockModule.ReadChannels( block->deviceID, block->inputChannelsList, block->inputsNumber, 
+                                                       block->inputBuffersList, block->inputSamplesList ) )
+      memset( block->inputSamplesList, 0, block->inputsNumber * sizeof(size_t) );
+    EndTransaction( block->moduleEntry );
+    for( size_t inputIndex = 0, channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+    {
+      if( !block->channelsList[ channelIndex ]->isOutput ) 
+        block->channelsList[ channelIndex ]->samplesNumber = block->inputSamplesList[ inputIndex++ ];
+    }
+    ThreadLock_Release( block->lock );
+  }
+  size_t samplesNumber = ( channel->samplesNumber < block->maxSamplesNumber ) ? channel->samplesNumber : block->maxSamplesNumber;
+  memcpy( buffer, channel->buffer, samplesNumber * sizeof(double) );
+  
+  return samplesNumber;
+}
+
+bool DeviceRegistry_Write( DeviceChannel channel, double value )
+{
+  if( channel == NULL ) return false;
+  
+  DeviceBlock* block = channel->block;
+  // Devices beyond pending list capacity are written immediately
+  unsigned long pendingBatch = ( block != NULL ) ? atomic_load_explicit( &(block->pendingBatch), memory_order_relaxed ) : 0;
+  if( block == NULL || currentBatch == 0 || ( pendingBatch != currentBatch && pendingBlocksNumber >= MAX_PENDING_BLOCKS ) ) 
+  {
+    BeginTransaction( channel->moduleEntry );
+    bool isWritten = channel->moduleEntry->module.Write( channel->deviceID, channel->channel, value );
+    EndTransaction( channel->moduleEntry );
+    return isWritten;
+  }
+  
+  channel->value = value;
+  channel->isPending = true;
+  if( pendingBatch != currentBatch )
+  {
+    atomic_store_explicit( &(block->pendingBatch), currentBatch, memory_order_relaxed );
+    pendingBlocksList[ pendingBlocksNumber++ ] = block;
+  }
+  
+  return true;
+}
+
+void DeviceRegistry_BeginTransfers( void )
+{
+  if( currentBatch != 0 ) DeviceRegistry_EndTransfers();
+  
+  currentBatch = atomic_fetch_add( &batchesCount, 1 ) + 1;
+  // Skip reserved value on wrap-around
+  if( currentBatch == 0 ) currentBatch = atomic_fetch_add( &batchesCount, 1 ) + 1;
+}
+
+void DeviceRegistry_EndTransfers( void )
+{
+  for( size_t blockIndex = 0; blockIndex < pendingBlocksNumber; blockIndex++ )
+    FlushBlock( pendingBlocksList[ blockIndex ] );
+  pendingBlocksNumber = 0;
+  
+  currentBatch = 0;
+}
+
+
+static void LockRegistry( void )
+{
+  if( registryLock != NULL ) ThreadLock_Aquire( registryLock );
+}
+
+static void UnlockRegistry( void )
+{
+  if( registryLock != NULL ) ThreadLock_Release( registryLock );
+}
+
+// Registry lock should be held by caller
+static const ModuleEntry* FindModule( const SignalIOModule* module )
+{
+  for( size_t moduleIndex = 0; moduleIndex < modulesNumber; moduleIndex++ )
+  {
+    // The same plug-in always has the same function addresses
+    if( modulesList[ moduleIndex ]->module.EndDevice == module->EndDevice ) return modulesList[ moduleIndex ];
+  }
+  
+  return NULL;
+}
+
+// Registry lock should be held by caller
+static DeviceEntry* FindDevice( const SignalIOModule* module, long int deviceID )
+{
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    DeviceEntry* device = devicesList[ deviceIndex ];
+    if( device->deviceID == deviceID && device->moduleEntry->module.EndDevice == module->EndDevice ) return device;
+  }
+  
+  return NULL;
+}
+
+// Ends (if initialized) and removes device entry (registry lock should be held by caller)
+static void DiscardDevice( DeviceEntry* device )
+{
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    if( devicesList[ deviceIndex ] != device ) continue;
+    devicesList[ deviceIndex ] = devicesList[ --devicesNumber ];
+    break;
+  }
+  
+  if( device->deviceID != SIGNAL_IO_DEVICE_INVALID_ID )
+  {
+    DiscardBlock( device->block );
+    if( !device->moduleEntry->isThreadSafe ) ThreadLock_Aquire( device->moduleEntry->setupLock );
+    device->moduleEntry->module.EndDevice( device->deviceID );
+    if( !device->moduleEntry->isThreadSafe ) ThreadLock_Release( device->moduleEntry->setupLock );
+  }
+  ThreadLock_Discard( device->initLock );
+  free( device->config );
+  free( device );
+}
+
+static DeviceBlock* CreateBlock( const ModuleEntry* moduleEntry, long int deviceID )
+{
+  DeviceBlock* newBlock = (DeviceBlock*) malloc( sizeof(DeviceBlock) );
+  memset( newBlock, 0, sizeof(DeviceBlock) );
+  newBlock->moduleEntry = moduleEntry;
+  newBlock->deviceID = deviceID;
+  newBlock->maxSamplesNumber = moduleEntry->module.GetMaxInputSamplesNumber( deviceID );
+  newBlock->lock = ThreadLock_Create();
+  atomic_init( &(newBlock->readBatch), 0 );
+  atomic_init( &(newBlock->pendingBatch), 0 );
+  
+  return newBlock;
+}
+
+static void DiscardBlock( DeviceBlock* block )
+{
+  if( block == NULL ) return;
+  
+  for( size_t channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+  {
+    free( block->channelsList[ channelIndex ]->buffer );
+    free( block->channelsList[ channelIndex ] );
+  }
+  free( block->channelsList );
+  free( block->inputChannelsList );
+  free( block->inputBuffersList );
+  free( block->inputSamplesList );
+  free( block->outputChannelsList );
+  free( block->outputValuesList );
+  ThreadLock_Discard( block->lock );
+  free( block );
+}
+
+// Rebuilds transaction arguments lists (block lock should be held by caller)
+static void UpdateBlockLists( DeviceBlock* block )
+{
+  size_t channelsNumber = ( block->channelsNumber > 0 ) ? block->channelsNumber : 1;
+  block->inputChannelsList = (unsigned int*) realloc( block->inputChannelsList, channelsNumber * sizeof(unsigned int) );
+  block->inputBuffersList = (double**) realloc( block->inputBuffersList, channelsNumber * sizeof(double*) );
+  block->inputSamplesList = (size_t*) realloc( block->inputSamplesList, channelsNumber * sizeof(size_t) );
+  block->outputChannelsList = (unsigned int*) realloc( block->outputChannelsList, channelsNumber * sizeof(unsigned int) );
+  block->outputValuesList = (double*) realloc( block->outputValuesList, channelsNumber * sizeof(double) );
+  
+  block->inputsNumber = 0;
+  for( size_t channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+  {
+    DeviceChannel channel = block->channelsList[ channelIndex ];
+    if( channel->isOutput ) continue;
+    block->inputChannelsList[ block->inputsNumber ] = channel->channel;
+    block->inputBuffersList[ block->inputsNumber++ ] = channel->buffer;
+  }
+  // Force new acquisition including added channels
+  atomic_store( &(block->readBatch), 0 );
+}
+
+static void FlushBlock( DeviceBlock* block )
+{
+  ThreadLock_Aquire( block->lock );
+  size_t outputsNumber = 0;
+  for( size_t channelIndex = 0; channelIndex < block->channelsNumber; channelIndex++ )
+  {
+    DeviceChannel channel = block->channelsList[ channelIndex ];
+    if( !channel->isOutput || !channel->isPending ) continue;
+    block->outputChannelsList[ outputsNumber ] = channel->channel;
+    block->outputValuesList[ outputsNumber++ ] = channel->value;
+    channel->isPending = false;
+  }
+  if( outputsNumber > 0 ) 
+  {
+    BeginTransaction( block->moduleEntry );
+    (void) block->moduleEntry->blockModule.WriteChannels( block->deviceID, block->outputChannelsList, outputsNumber, block->outputValuesList );
+    EndTransaction( block->moduleEntry );
+  }
+  atomic_store_explicit( &(block->pendingBatch), 0, memory_order_relaxed );
+  ThreadLock_Release( block->lock );
+}
+
+// Plug-ins not declared thread safe are not called for transfers while any of their devices is being set up (e.g. by a robot loading in background)
+static void BeginTransaction( const ModuleEntry* moduleEntry )
+{
+  if( !moduleEntry->isThreadSafe ) ThreadLock_Aquire( moduleEntry->setupLock );
+}
+
+static void EndTransaction( const ModuleEntry* moduleEntry )
+{
+  if( !moduleEntry->isThreadSafe ) ThreadLock_Release( moduleEntry->setupLock );
+}
+
+static const ModuleEntry* LoadModule( const char* moduleName )
+{
+  for( size_t moduleIndex = 0; moduleIndex < modulesNumber; moduleIndex++ )
+  {
+    if( strcmp( modulesList[ moduleIndex ]->name, moduleName ) == 0 ) return modulesList[ moduleIndex ];
+  }
+  
+  ModuleEntry* newModuleEntry = (ModuleEntry*) malloc( sizeof(ModuleEntry) );
+  memset( newModuleEntry, 0, sizeof(ModuleEntry) );
+  
+  bool loadSuccess = false;
+  char filePath[ DATA_IO_MAX_PATH_LENGTH ];
+  snprintf( filePath, DATA_IO_MAX_PATH_LENGTH, KEY_MODULES "/" KEY_SIGNAL_IO "/%s", moduleName );
+  SignalIOModule* ref_module = &(newModuleEntry->module);
+  LOAD_MODULE_IMPLEMENTATION( SIGNAL_IO_INTERFACE, filePath, ref_module, &loadSuccess );
+  if( !loadSuccess )
+  {
+    DEBUG_PRINT( "failed loading signal I/O module %s", filePath );
+    free( newModuleEntry );
+    return NULL;
+  }
+  
+  // Block transfer functions are optional
+  SignalIOBlockModule* ref_blockModule = &(newModuleEntry->blockModule);
+  LOAD_MODULE_IMPLEMENTATION( SIGNAL_IO_BLOCK_INTERFACE, filePath, ref_blockModule, &(newModuleEntry->hasBlockTransfers) );
+  DEBUG_PRINT( "signal I/O module %s block transfers support: %s", moduleName, newModuleEntry->hasBlockTransfers ? "true" : "false" );
+  
+  // Plug-ins are only set up concurrently when explicitly declared thread safe
+  bool hasConcurrencyInfo = false;
+  SignalIOConcurrencyModule concurrencyModule = { 0 };
+  SignalIOConcurrencyModule* ref_concurrencyModule = &concurrencyModule;
+  LOAD_MODULE_IMPLEMENTATION( SIGNAL_IO_CONCURRENCY_INTERFACE, filePath, ref_concurrencyModule, &hasConcurrencyInfo );
+  newModuleEntry->isThreadSafe = hasConcurrencyInfo ? concurrencyModule.IsThreadSafe() : false;
+  newModuleEntry->setupLock = ThreadLock_Create();
+  DEBUG_PRINT( "signal I/O module %s thread safe setup: %s", moduleName, newModuleEntry->isThreadSafe ? "true" : "false" );
+  
+  newModuleEntry->name = (char*) calloc( strlen( moduleName ) + 1, sizeof(char) );
+  strcpy( newModuleEntry->name, moduleName );
+  // Entries are allocated individually, so that device references remain valid
+  modulesList = (ModuleEntry**) realloc( modulesList, ( modulesNumber + 1 ) * sizeof(ModuleEntry*) );
+  modulesList[ modulesNumber++ ] = newModuleEntry;
+  
+  return newModuleEntry;
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file device_registry.h
+/// @brief Shared signal I/O plug-ins and devices registry
+///
+/// Inputs and outputs acquire their [Signal I/O](https://github.com/EESC-MKGroup/Signal-IO-Interface) implementation through this process-wide registry, 
+/// that loads each plug-in module only once and shares device IDs (initialized from the same configuration string) between all its users. 
+/// A device is only ended when its last user releases it, so that e.g. many channels of a single acquisition task do not reopen the device many times.
+///
+/// Plug-ins may also export the optional SIGNAL_IO_BLOCK_INTERFACE functions (see signal_io_extensions.h). Channels of such devices are then grouped by the registry, 
+/// and, between DeviceRegistry_BeginTransfers() and DeviceRegistry_EndTransfers() calls (e.g. a control cycle), all input channels are read 
+/// in a single transaction and all written output channels are updated in another one. Outside of these calls, or for plug-ins without block 
+/// functions, the per-channel Read() and Write() functions are used. Each grouped transaction takes a per-device lock, only contended while channels 
+/// are added or removed, so that devices may be shared with robots set up or released while another one is running.
+///
+/// Devices may be acquired and set up by many threads at once (e.g. actuators loaded in parallel, or robots loaded in background, see robot.h). 
+/// Plug-ins are only called concurrently when they export the optional SIGNAL_IO_CONCURRENCY_INTERFACE function returning true. Otherwise, their 
+/// device initialization and setup calls (between DeviceRegistry_BeginSetup() and DeviceRegistry_EndSetup()) are performed one at a time, as in 
+/// sequential loading, and transfers through registry channels wait for any setup call in progress (instead of running concurrently with it).
+
+
+#ifndef DEVICE_REGISTRY_H
+#define DEVICE_REGISTRY_H
+
+#include "signal_io_extensions.h"
+
+/// Signal I/O plug-in implementation functions, copied by value to each user for direct calls
+typedef struct _SignalIOModule
+{
+  DECLARE_MODULE_INTERFACE_REF( SIGNAL_IO_INTERFACE );
+}
+SignalIOModule;
+
+/// Signal I/O plug-in optional block transfer functions
+typedef struct _SignalIOBlockModule
+{
+  DECLARE_MODULE_INTERFACE_REF( SIGNAL_IO_BLOCK_INTERFACE );
+}
+SignalIOBlockModule;
+
+/// Signal I/O plug-in optional concurrency information function
+typedef struct _SignalIOConcurrencyModule
+{
+  DECLARE_MODULE_INTERFACE_REF( SIGNAL_IO_CONCURRENCY_INTERFACE );
+}
+SignalIOConcurrencyModule;
+
+typedef struct _DeviceChannelData DeviceChannelData;      ///< Single (possibly grouped) device channel internal data structure
+typedef DeviceChannelData* DeviceChannel;                 ///< Opaque reference to device channel internal data structure
+
+
+/// @brief Initializes registry access lock (not thread safe). Without initialization, registry is not safe for concurrent loading
+void DeviceRegistry_Init( void );
+
+/// @brief Ends all remaining devices and deallocates registry data
+void DeviceRegistry_End( void );
+
+/// @brief Gets signal I/O plug-in implementation and device, loading/initializing them only if not already in use (thread safe)
+/// @param[in] moduleName signal I/O plug-in file name (without extension), inside <root_dir>/plugins/signal_io/
+/// @param[in] deviceConfig plug-in specific device configuration string, as passed to InitDevice()
+/// @param[out] ref_module pointer to structure where plug-in implementation functions will be copied
+/// @return shared device identifier, or SIGNAL_IO_DEVICE_INVALID_ID on loading/initialization errors
+long int DeviceRegistry_AcquireDevice( const char* moduleName, const char* deviceConfig, SignalIOModule* ref_module );
+
+/// @brief Releases device acquired with DeviceRegistry_AcquireDevice(), ending it if there are no remaining users (thread safe)
+/// @param[in] module pointer to plug-in implementation functions, as returned by DeviceRegistry_AcquireDevice()
+/// @param[in] deviceID shared device identifier
+void DeviceRegistry_ReleaseDevice( const SignalIOModule* module, long int deviceID );
+
+/// @brief Checks if device acquired with DeviceRegistry_AcquireDevice() has other users, that may be using it concurrently (thread safe)
+/// @param[in] module pointer to plug-in implementation functions, as returned by DeviceRegistry_AcquireDevice()
+/// @param[in] deviceID shared device identifier
+/// @return true if device was acquired more than once, false otherwise
+bool DeviceRegistry_IsShared( const SignalIOModule* module, long int deviceID );
+
+/// @brief Starts setup calls (e.g. channels checking, acquisition or reset) to device of given plug-in, waiting for setups by other threads if plug-in is not thread safe
+/// @param[in] module pointer to plug-in implementation functions, as returned by DeviceRegistry_AcquireDevice()
+void DeviceRegistry_BeginSetup( const SignalIOModule* module );
+
+/// @brief Ends setup calls started by calling thread with DeviceRegistry_BeginSetup() (setups may not be nested)
+void DeviceRegistry_EndSetup( void );
+
+/// @brief Adds input or output channel of given device, to its block transfers group if device plug-in supports block transfers (thread safe)
+/// @param[in] module pointer to plug-in implementation functions, as returned by DeviceRegistry_AcquireDevice()
+/// @param[in] deviceID shared device identifier
+/// @param[in] channel device input or output channel number
+/// @param[in] isOutput true for output channels, false for input ones
+/// @return reference to device channel, or NULL if device is not registered
+DeviceChannel DeviceRegistry_AddChannel( const SignalIOModule* module, long int deviceID, unsigned int channel, bool isOutput );
+
+/// @brief Removes channel of its device, and from its block transfers group (thread safe)
+/// @param[in] channel reference to device channel
+void DeviceRegistry_RemoveChannel( DeviceChannel channel );
+
+/// @brief Reads samples of input channel, acquiring all grouped device input channels at once on its first read inside transfers block (later reads get the same samples)
+/// @param[in] channel reference to device channel
+/// @param[out] buffer array where read samples will be stored (with at least GetMaxInputSamplesNumber() length)
+/// @return number of samples read
+size_t DeviceRegistry_Read( DeviceChannel channel, double* buffer );
+
+/// @brief Writes value to output channel, deferring it to DeviceRegistry_EndTransfers() if grouped and inside transfers block
+/// @param[in] channel reference to device channel
+/// @param[in] value value to be written
+/// @return true on successful writing or deferring, false otherwise
+bool DeviceRegistry_Write( DeviceChannel channel, double value );
+
+/// @brief Starts grouping input and output transfers performed by calling thread
+void DeviceRegistry_BeginTransfers( void );
+
+/// @brief Writes all deferred output values (one transaction per device) and stops grouping transfers performed by calling thread
+void DeviceRegistry_EndTransfers( void );
+
+
+#endif // DEVICE_REGISTRY_H
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "dof_frames.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum { HEADER_MARKER = 0, HEADER_FRAME_ID = 1, HEADER_FRAGMENT_INDEX = 5, HEADER_FRAGMENTS_NUMBER = 6, HEADER_BLOCKS_NUMBER = 7 };
+
+struct _DoFFrameAssemblerData
+{
+  Byte* fragmentsBuffer;
+  bool receivedFragmentsList[ DOF_FRAME_MAX_FRAGMENTS ];
+  size_t receivedFragmentsNumber;
+  size_t fragmentsNumber;
+  uint32_t frameID;
+  bool isComplete;
+};
+
+
+size_t DoFFrame_GetFragmentsNumber( size_t dofsNumber )
+{
+  if( dofsNumber > 0 && dofsNumber <= DOF_FRAME_SINGLE_MAX_BLOCKS ) return 1;
+  
+  return DoFFrame_GetExtendedFragmentsNumber( dofsNumber );
+}
+
+size_t DoFFrame_GetExtendedFragmentsNumber( size_t dofsNumber )
+{
+  if( dofsNumber == 0 ) return 1;
+  // Fragments number is sent as a single byte, and blocks past its limit would be silently dropped
+  if( dofsNumber > DOF_FRAME_MAX_DOFS ) return 0;
+  
+  return ( dofsNumber + DOF_FRAME_FRAGMENT_MAX_BLOCKS - 1 ) / DOF_FRAME_FRAGMENT_MAX_BLOCKS;
+}
+
+size_t DoFFrame_WriteFragment( Byte* message, const DoFVariables* dofsList, size_t dofsNumber, uint32_t frameID, size_t fragmentIndex )
+{
+  // Empty frames are sent as extended ones, as a zero DoFs number would be read as an extended frame marker
+  if( dofsNumber > 0 && dofsNumber <= DOF_FRAME_SINGLE_MAX_BLOCKS )
+  {
+    if( fragmentIndex > 0 ) return 0;
+    
+    message[ 0 ] = (Byte) dofsNumber;
+    Byte* blockData = message + 1;
+    for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+    {
+      *(blockData++) = (Byte) dofIndex;
+      DoFFrame_WriteBlock( blockData, &(dofsList[ dofIndex ]) );
+      blockData += DOF_DATA_BLOCK_SIZE;
+    }
+    
+    return dofsNumber;
+  }
+  
+  return DoFFrame_WriteExtendedFragment( message, DOF_EXTENDED_FRAME_MARKER, dofsList, dofsNumber, frameID, fragmentIndex );
+}
+
+size_t DoFFrame_WriteExtendedFragment( Byte* message, Byte marker, const DoFVariables* dofsList, size_t dofsNumber, uint32_t frameID, size_t fragmentIndex )
+{
+  size_t fragmentsNumber = DoFFrame_GetExtendedFragmentsNumber( dofsNumber );
+  if( fragmentIndex >= fragmentsNumber ) return 0;
+  
+  size_t firstDoFIndex = fragmentIndex * DOF_FRAME_FRAGMENT_MAX_BLOCKS;
+  size_t blocksNumber = dofsNumber - firstDoFIndex;
+  if( blocksNumber > DOF_FRAME_FRAGMENT_MAX_BLOCKS ) blocksNumber = DOF_FRAME_FRAGMENT_MAX_BLOCKS;
+  
+  message[ HEADER_MARKER ] = marker;
+  memcpy( message + HEADER_FRAME_ID, &frameID, sizeof(uint32_t) );
+  message[ HEADER_FRAGMENT_INDEX ] = (Byte) fragmentIndex;
+  message[ HEADER_FRAGMENTS_NUMBER ] = (Byte) fragmentsNumber;
+  message[ HEADER_BLOCKS_NUMBER ] = (Byte) blocksNumber;
+  Byte* blockData = message + DOF_EXTENDED_HEADER_SIZE;
+  for( size_t dofIndex = firstDoFIndex; dofIndex < firstDoFIndex + blocksNumber; dofIndex++ )
+  {
+    uint16_t blockIndex = (uint16_t) dofIndex;
+    memcpy( blockData, &blockIndex, DOF_EXTENDED_INDEX_SIZE );
+    blockData += DOF_EXTENDED_INDEX_SIZE;
+    DoFFrame_WriteBlock( blockData, &(dofsList[ dofIndex ]) );
+    blockData += DOF_DATA_BLOCK_SIZE;
+  }
+  
+  return blocksNumber;
+}
+
+void DoFFrame_WriteBlock( Byte* blockData, const DoFVariables* ref_dof )
+{
+  float valuesList[ DOF_FLOATS_NUMBER ];
+  
+  valuesList[ DOF_POSITION ] = (float) ref_dof->position;
+  valuesList[ DOF_VELOCITY ] = (float) ref_dof->velocity;
+  valuesList[ DOF_ACCELERATION ] = (float) ref_dof->acceleration;
+  valuesList[ DOF_FORCE ] = (float) ref_dof->force;
+  valuesList[ DOF_INERTIA ] = (float) ref_dof->inertia;
+  valuesList[ DOF_DAMPING ] = (float) ref_dof->damping;
+  valuesList[ DOF_STIFFNESS ] = (float) ref_dof->stiffness;
+  
+  memcpy( blockData, valuesList, DOF_DATA_BLOCK_SIZE );
+}
+
+void DoFFrame_ReadBlock( const Byte* blockData, DoFVariables* ref_dof )
+{
+  float valuesList[ DOF_FLOATS_NUMBER ];
+  
+  memcpy( valuesList, blockData, DOF_DATA_BLOCK_SIZE );
+  
+  ref_dof->position = valuesList[ DOF_POSITION ];
+  ref_dof->velocity = valuesList[ DOF_VELOCITY ];
+  ref_dof->acceleration = valuesList[ DOF_ACCELERATION ];
+  ref_dof->force = valuesList[ DOF_FORCE ];
+  ref_dof->inertia = valuesList[ DOF_INERTIA ];
+  ref_dof->damping = valuesList[ DOF_DAMPING ];
+  ref_dof->stiffness = valuesList[ DOF_STIFFNESS ];
+}
+
+DoFFrameAssembler DoFFrame_CreateAssembler( void )
+{
+  DoFFrameAssembler newAssembler = (DoFFrameAssembler) malloc( sizeof(DoFFrameAssemblerData) );
+  memset( newAssembler, 0, sizeof(DoFFrameAssemblerData) );
+  
+  newAssembler->fragmentsBuffer = (Byte*) calloc( DOF_FRAME_MAX_FRAGMENTS, IPC_MAX_MESSAGE_LENGTH );
+  
+  return newAssembler;
+}
+
+void DoFFrame_DiscardAssembler( DoFFrameAssembler assembler )
+{
+  if( assembler == NULL ) return;
+  
+  free( assembler->fragmentsBuffer );
+  
+  free( assembler );
+}
+
+bool DoFFrame_AddFragment( DoFFrameAssembler assembler, const Byte* message )
+{
+  if( assembler == NULL ) return false;
+  
+  if( message[ HEADER_MARKER ] != DOF_EXTENDED_FRAME_MARKER ) return false;
+  
+  uint32_t frameID;
+  memcpy( &frameID, message + HEADER_FRAME_ID, sizeof(uint32_t) );
+  size_t fragmentIndex = (size_t) message[ HEADER_FRAGMENT_INDEX ];
+  size_t fragmentsNumber = (size_t) message[ HEADER_FRAGMENTS_NUMBER ];
+  if( fragmentIndex >= fragmentsNumber ) return false;
+  
+  // Start over on new frames, dropping incomplete ones
+  if( frameID != assembler->frameID || fragmentsNumber != assembler->fragmentsNumber || assembler->receivedFragmentsNumber == 0 )
+  {
+    if( frameID == assembler->frameID && assembler->isComplete ) return false;
+    memset( assembler->receivedFragmentsList, 0, sizeof(assembler->receivedFragmentsList) );
+    assembler->receivedFragmentsNumber = 0;
+    assembler->fragmentsNumber = fragmentsNumber;
+    assembler->frameID = frameID;
+    assembler->isComplete = false;
+  }
+  
+  if( assembler->receivedFragmentsList[ fragmentIndex ] ) return false;
+  
+  memcpy( assembler->fragmentsBuffer + fragmentIndex * IPC_MAX_MESSAGE_LENGTH, message, IPC_MAX_MESSAGE_LENGTH );
+  assembler->receivedFragmentsList[ fragmentIndex ] = true;
+  
+  if( ++(assembler->receivedFragmentsNumber) < assembler->fragmentsNumber ) return false;
+  
+  assembler->isComplete = true;
+  
+  return true;
+}
+
+size_t DoFFrame_GetAssembledFragmentsNumber( DoFFrameAssembler assembler )
+{
+  if( assembler == NULL ) return 0;
+  
+  return assembler->isComplete ? assembler->fragmentsNumber : 0;
+}
+
+const Byte* DoFFrame_GetFragment( DoFFrameAssembler assembler, size_t fragmentIndex )
+{
+  if( assembler == NULL ) return NULL;
+  
+  if( !assembler->isComplete || fragmentIndex >= assembler->fragmentsNumber ) return NULL;
+  
+  return assembler->fragmentsBuffer + fragmentIndex * IPC_MAX_MESSAGE_LENGTH;
+}
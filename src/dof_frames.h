@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file dof_frames.h
+/// @brief DoF update messages encoding/decoding functions
+///
+/// Packing of DoF variables into single or fragmented update messages, and reassembly of received fragments, following the format described in shared_dof_variables.h
+
+
+#ifndef DOF_FRAMES_H
+#define DOF_FRAMES_H
+
+#include "shared_dof_variables.h"
+
+#include "robot_control/robot_control.h"
+#include "ipc/interface/ipc.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Maximum number of DoF blocks in a single (not fragmented) message
+#define DOF_FRAME_SINGLE_MAX_BLOCKS ( ( IPC_MAX_MESSAGE_LENGTH - 1 ) / ( 1 + DOF_DATA_BLOCK_SIZE ) )
+/// Maximum number of DoF blocks in each extended frame fragment
+#define DOF_FRAME_FRAGMENT_MAX_BLOCKS ( ( IPC_MAX_MESSAGE_LENGTH - DOF_EXTENDED_HEADER_SIZE ) / ( DOF_EXTENDED_INDEX_SIZE + DOF_DATA_BLOCK_SIZE ) )
+/// Maximum number of fragments in a extended frame
+#define DOF_FRAME_MAX_FRAGMENTS 255
+/// Maximum number of DoFs that can be sent in a single (possibly extended) frame
+#define DOF_FRAME_MAX_DOFS ( DOF_FRAME_MAX_FRAGMENTS * DOF_FRAME_FRAGMENT_MAX_BLOCKS )
+
+typedef struct _DoFFrameAssemblerData DoFFrameAssemblerData;    ///< Fragments reassembly internal data structure
+typedef DoFFrameAssemblerData* DoFFrameAssembler;               ///< Opaque reference to fragments reassembly internal data structure
+
+
+/// @brief Gets number of messages needed to send values of given number of DoFs
+/// @param[in] dofsNumber number of DoFs to be sent
+/// @return number of frame fragments (1 for single message frames, 0 if DoFs number exceeds DOF_FRAME_MAX_DOFS)
+size_t DoFFrame_GetFragmentsNumber( size_t dofsNumber );
+
+/// @brief Gets number of messages needed to send values of given number of DoFs, when extended format is enforced
+/// @param[in] dofsNumber number of DoFs to be sent
+/// @return number of extended frame fragments (0 if DoFs number exceeds DOF_FRAME_MAX_DOFS)
+size_t DoFFrame_GetExtendedFragmentsNumber( size_t dofsNumber );
+
+/// @brief Fills message with single frame fragment of given DoF values list (single message format is used whenever possible, except for empty lists, as zero first byte marks extended frames)
+/// @param[out] message buffer of IPC_MAX_MESSAGE_LENGTH bytes where message will be written
+/// @param[in] dofsList list of DoF values, indexed from 0
+/// @param[in] dofsNumber number of elements in dofsList
+/// @param[in] frameID identifier shared by all fragments of the same frame
+/// @param[in] fragmentIndex index of frame fragment to be written
+/// @return number of DoF blocks written to message
+size_t DoFFrame_WriteFragment( Byte* message, const DoFVariables* dofsList, size_t dofsNumber, uint32_t frameID, size_t fragmentIndex );
+
+/// @brief Fills message with single extended frame fragment of given DoF values list, regardless of DoFs number
+/// @param[out] message buffer of IPC_MAX_MESSAGE_LENGTH bytes where message will be written
+/// @param[in] marker first message byte, identifying frame type (DOF_EXTENDED_FRAME_MARKER or DOF_JOINTS_FRAME_MARKER)
+/// @param[in] dofsList list of DoF values, indexed from 0
+/// @param[in] dofsNumber number of elements in dofsList
+/// @param[in] frameID identifier shared by all fragments of the same frame
+/// @param[in] fragmentIndex index of frame fragment to be written
+/// @return number of DoF blocks written to message
+size_t DoFFrame_WriteExtendedFragment( Byte* message, Byte marker, const DoFVariables* dofsList, size_t dofsNumber, uint32_t frameID, size_t fragmentIndex );
+
+/// @brief Converts DoF variables to message (single precision) values block
+/// @param[out] blockData pointer to message position where DOF_DATA_BLOCK_SIZE bytes will be written
+/// @param[in] ref_dof pointer/reference to variables structure to be written
+void DoFFrame_WriteBlock( Byte* blockData, const DoFVariables* ref_dof );
+
+/// @brief Converts message (single precision) values block to DoF variables
+/// @param[in] blockData pointer to message position where DOF_DATA_BLOCK_SIZE bytes will be read
+/// @param[out] ref_dof pointer/reference to variables structure where values will be stored
+void DoFFrame_ReadBlock( const Byte* blockData, DoFVariables* ref_dof );
+
+/// @brief Creates and initializes extended frame reassembly data structure
+/// @return reference/pointer to newly created assembler
+DoFFrameAssembler DoFFrame_CreateAssembler( void );
+
+/// @brief Deallocates internal data of given extended frame assembler
+/// @param[in] assembler reference to assembler
+void DoFFrame_DiscardAssembler( DoFFrameAssembler assembler );
+
+/// @brief Stores received extended frame fragment. Incomplete frames are dropped once a fragment of another frame arrives
+/// @param[in] assembler reference to assembler
+/// @param[in] message received message (starting with DOF_EXTENDED_FRAME_MARKER)
+/// @return true if given fragment completed its frame, false otherwise
+bool DoFFrame_AddFragment( DoFFrameAssembler assembler, const Byte* message );
+
+/// @brief Gets fragments number of last completed frame
+/// @param[in] assembler reference to assembler
+/// @return number of fragments available through DoFFrame_GetFragment
+size_t DoFFrame_GetAssembledFragmentsNumber( DoFFrameAssembler assembler );
+
+/// @brief Gets fragment of last completed frame
+/// @param[in] assembler reference to assembler
+/// @param[in] fragmentIndex index of fragment inside frame
+/// @return pointer to stored fragment message (NULL on invalid index)
+const Byte* DoFFrame_GetFragment( DoFFrameAssembler assembler, size_t fragmentIndex );
+
+
+#endif // DOF_FRAMES_H
@@ -0,0 +1,452 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "flight_recorder.h"
+
+#include "binary_log.h"
+
+#include "debug/data_logging.h"
+#include "threads/thread_locks.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define FAULT_REASON_MAX_LENGTH 64
+#define FAULT_PATH_MAX_LENGTH 1024
+
+struct _FlightRecorderData
+{
+  char* name;
+  char* metadata;
+  char** columnNamesList;
+  size_t columnsNumber;
+  double* rowsData;
+  size_t rowLength;
+  size_t rowsNumber;
+  atomic_size_t committedRowsNumber;
+  size_t currentRowsNumber;
+  size_t currentSlotIndex;
+  double* currentRow;
+  size_t currentValuesNumber;
+  atomic_bool isFrozen;
+  const char* _Atomic freezeReason;
+  unsigned long* missCyclesList;
+  size_t missesLimit;
+  size_t missesNumber;
+  size_t missIndex;
+  unsigned long missesWindow;
+  unsigned long lastMissCycle;
+  bool isStormLatched;
+  int faultFile;                              // Fault dump file and buffers are prepared on creation, so that dumping from a signal handler only calls write()
+  char faultFilePath[ FAULT_PATH_MAX_LENGTH ];
+  char* faultMetadata;
+  size_t faultMetadataMaxLength;
+  unsigned char* faultHeaderData;
+  unsigned char* faultBlockData;
+  double* faultTimesList;
+  double* faultValuesTable;
+};
+
+static FlightRecorder* recordersList = NULL;
+static size_t recordersNumber = 0;
+static ThreadLock recordersLock = NULL;
+static size_t dumpsCount = 0;
+static size_t faultFilesCount = 0;
+
+static void LockRecorders( void );
+static void UnlockRecorders( void );
+static bool Dump( FlightRecorder );
+static size_t DumpFrozen( void );
+static void PrepareFaultDump( FlightRecorder );
+static void EndFaultDump( FlightRecorder );
+static void DumpToFaultFile( FlightRecorder );
+static size_t FormatMetadata( char*, size_t, const char*, const char* );
+
+
+void FlightRecorder_Init( void )
+{
+  if( recordersLock != NULL ) return;
+  
+  recordersLock = ThreadLock_Create();
+}
+
+void FlightRecorder_End( void )
+{
+  ThreadLock_Discard( recordersLock );
+  recordersLock = NULL;
+  
+  free( recordersList );
+  recordersList = NULL;
+  recordersNumber = 0;
+}
+
+
+FlightRecorder FlightRecorder_Create( const char* name, const char* metadata, size_t columnsNumber, const char** columnNamesList, size_t rowsNumber, 
+                                      size_t missesLimit, unsigned long missesWindow )
+{
+  if( rowsNumber == 0 ) return NULL;
+  
+  FlightRecorder newRecorder = (FlightRecorder) malloc( sizeof(FlightRecorderData) );
+  memset( newRecorder, 0, sizeof(FlightRecorderData) );
+  
+  newRecorder->name = (char*) calloc( strlen( name ) + 1, sizeof(char) );
+  strcpy( newRecorder->name, name );
+  newRecorder->metadata = (char*) calloc( strlen( metadata ) + 1, sizeof(char) );
+  strcpy( newRecorder->metadata, metadata );
+  newRecorder->columnsNumber = columnsNumber;
+  newRecorder->columnNamesList = (char**) calloc( columnsNumber, sizeof(char*) );
+  for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+  {
+    newRecorder->columnNamesList[ columnIndex ] = (char*) calloc( strlen( columnNamesList[ columnIndex ] ) + 1, sizeof(char) );
+    strcpy( newRecorder->columnNamesList[ columnIndex ], columnNamesList[ columnIndex ] );
+  }
+  
+  // Time stamp followed by values
+  newRecorder->rowLength = columnsNumber + 1;
+  newRecorder->rowsNumber = rowsNumber;
+  newRecorder->rowsData = (double*) calloc( rowsNumber * newRecorder->rowLength, sizeof(double) );
+  atomic_init( &(newRecorder->committedRowsNumber), 0 );
+  atomic_init( &(newRecorder->isFrozen), false );
+  atomic_init( &(newRecorder->freezeReason), "" );
+  
+  newRecorder->missesLimit = missesLimit;
+  newRecorder->missesWindow = missesWindow;
+  newRecorder->missCyclesList = (unsigned long*) calloc( missesLimit + 1, sizeof(unsigned long) );
+  
+  LockRecorders();
+  PrepareFaultDump( newRecorder );
+  recordersList = (FlightRecorder*) realloc( recordersList, ( recordersNumber + 1 ) * sizeof(FlightRecorder) );
+  recordersList[ recordersNumber++ ] = newRecorder;
+  UnlockRecorders();
+  
+  DEBUG_PRINT( "flight recorder %s created with %lu rows of %lu values", name, rowsNumber, columnsNumber );
+  
+  return newRecorder;
+}
+
+void FlightRecorder_Discard( FlightRecorder recorder )
+{
+  if( recorder == NULL ) return;
+  
+  LockRecorders();
+  for( size_t recorderIndex = 0; recorderIndex < recordersNumber; recorderIndex++ )
+  {
+    if( recordersList[ recorderIndex ] == recorder )
+    {
+      recordersList[ recorderIndex ] = recordersList[ --recordersNumber ];
+      break;
+    }
+  }
+  // Writer thread is already stopped, so a pending history can still be saved
+  (void) Dump( recorder );
+  UnlockRecorders();
+  
+  EndFaultDump( recorder );
+  
+  for( size_t columnIndex = 0; columnIndex < recorder->columnsNumber; columnIndex++ )
+    free( recorder->columnNamesList[ columnIndex ] );
+  free( recorder->columnNamesList );
+  free( recorder->rowsData );
+  free( recorder->missCyclesList );
+  free( recorder->metadata );
+  free( recorder->name );
+  
+  free( recorder );
+}
+
+bool FlightRecorder_EnterNewRow( FlightRecorder recorder, double timeStamp )
+{
+  if( recorder == NULL ) return false;
+  
+  recorder->currentRow = NULL;
+  
+  if( atomic_load( &(recorder->isFrozen) ) ) return false;
+  
+  recorder->currentRow = recorder->rowsData + recorder->currentSlotIndex * recorder->rowLength;
+  recorder->currentRow[ 0 ] = timeStamp;
+  recorder->currentValuesNumber = 0;
+  
+  return true;
+}
+
+void FlightRecorder_RegisterList( FlightRecorder recorder, size_t valuesNumber, const double* valuesList )
+{
+  if( recorder == NULL || recorder->currentRow == NULL ) return;
+  
+  if( valuesNumber > recorder->columnsNumber - recorder->currentValuesNumber ) valuesNumber = recorder->columnsNumber - recorder->currentValuesNumber;
+  
+  memcpy( recorder->currentRow + 1 + recorder->currentValuesNumber, valuesList, valuesNumber * sizeof(double) );
+  recorder->currentValuesNumber += valuesNumber;
+}
+
+void FlightRecorder_EndRow( FlightRecorder recorder )
+{
+  if( recorder == NULL || recorder->currentRow == NULL ) return;
+  
+  recorder->currentRow = NULL;
+  
+  if( ++(recorder->currentSlotIndex) >= recorder->rowsNumber ) recorder->currentSlotIndex = 0;
+  // Sequentially consistent with freezing, so that dumps never read a row that may still be written
+  atomic_store( &(recorder->committedRowsNumber), ++(recorder->currentRowsNumber) );
+}
+
+void FlightRecorder_RegisterDeadlineMiss( FlightRecorder recorder, unsigned long cycleIndex )
+{
+  if( recorder == NULL || recorder->missesLimit == 0 ) return;
+  
+  // Storm ends after a whole window without misses
+  if( recorder->isStormLatched && cycleIndex - recorder->lastMissCycle > recorder->missesWindow ) 
+  {
+    recorder->isStormLatched = false;
+    recorder->missesNumber = 0;
+  }
+  recorder->lastMissCycle = cycleIndex;
+  if( recorder->isStormLatched ) return;
+  
+  recorder->missCyclesList[ recorder->missIndex ] = cycleIndex;
+  recorder->missIndex = ( recorder->missIndex + 1 ) % recorder->missesLimit;
+  if( recorder->missesNumber < recorder->missesLimit ) recorder->missesNumber++;
+  
+  // Next list position holds the oldest of the last misses
+  unsigned long oldestMissCycle = recorder->missCyclesList[ recorder->missIndex ];
+  if( recorder->missesNumber >= recorder->missesLimit && cycleIndex - oldestMissCycle < recorder->missesWindow )
+  {
+    recorder->isStormLatched = true;
+    FlightRecorder_Freeze( recorder, "deadline_misses" );
+  }
+}
+
+void FlightRecorder_Freeze( FlightRecorder recorder, const char* reason )
+{
+  if( recorder == NULL ) return;
+  
+  if( atomic_load( &(recorder->isFrozen) ) ) return;
+  
+  atomic_store( &(recorder->freezeReason), reason );
+  atomic_store( &(recorder->isFrozen), true );
+}
+
+size_t FlightRecorder_FreezeAll( const char* reason )
+{
+  LockRecorders();
+  for( size_t recorderIndex = 0; recorderIndex < recordersNumber; recorderIndex++ )
+    FlightRecorder_Freeze( recordersList[ recorderIndex ], reason );
+  size_t frozenRecordersNumber = recordersNumber;
+  UnlockRecorders();
+  
+  return frozenRecordersNumber;
+}
+
+size_t FlightRecorder_DumpPending( void )
+{
+  LockRecorders();
+  size_t dumpsNumber = DumpFrozen();
+  UnlockRecorders();
+  
+  return dumpsNumber;
+}
+
+void FlightRecorder_DumpOnFault( const char* reason )
+{
+  // Faulting thread may be holding the lock
+  for( size_t recorderIndex = 0; recorderIndex < recordersNumber; recorderIndex++ )
+  {
+    FlightRecorder_Freeze( recordersList[ recorderIndex ], reason );
+    DumpToFaultFile( recordersList[ recorderIndex ] );
+  }
+}
+
+
+static void LockRecorders( void )
+{
+  if( recordersLock != NULL ) ThreadLock_Aquire( recordersLock );
+}
+
+static void UnlockRecorders( void )
+{
+  if( recordersLock != NULL ) ThreadLock_Release( recordersLock );
+}
+
+
+static size_t DumpFrozen( void )
+{
+  size_t dumpsNumber = 0;
+  for( size_t recorderIndex = 0; recorderIndex < recordersNumber; recorderIndex++ )
+  {
+    if( Dump( recordersList[ recorderIndex ] ) ) dumpsNumber++;
+  }
+  
+  return dumpsNumber;
+}
+
+static bool Dump( FlightRecorder recorder )
+{
+  if( !atomic_load( &(recorder->isFrozen) ) ) return false;
+  
+  // A row started before freezing may still be overwriting the oldest slot
+  size_t committedRowsNumber = atomic_load( &(recorder->committedRowsNumber) );
+  size_t firstRowIndex = ( committedRowsNumber >= recorder->rowsNumber ) ? committedRowsNumber - recorder->rowsNumber + 1 : 0;
+  
+  const char* reason = atomic_load( &(recorder->freezeReason) );
+  DEBUG_PRINT( "dumping %lu rows of flight recorder %s (%s)", committedRowsNumber - firstRowIndex, recorder->name, reason );
+  
+  // Dumps of the same session are numbered, as they share the log time stamp
+  size_t logNameLength = strlen( recorder->name ) + 32;
+  char* logName = (char*) calloc( logNameLength, sizeof(char) );
+  snprintf( logName, logNameLength, "%s-flight%lu", recorder->name, ++dumpsCount );
+  size_t metadataLength = strlen( recorder->metadata ) + strlen( reason ) + 32;
+  char* metadata = (char*) calloc( metadataLength, sizeof(char) );
+  (void) FormatMetadata( metadata, metadataLength, reason, recorder->metadata );
+  
+  BinaryLog dumpLog = BinaryLog_Create( logName, metadata, recorder->columnsNumber, (const char**) recorder->columnNamesList, BINARY_LOG_FLOAT64 );
+  for( size_t rowIndex = firstRowIndex; rowIndex < committedRowsNumber; rowIndex++ )
+  {
+    const double* row = recorder->rowsData + ( rowIndex % recorder->rowsNumber ) * recorder->rowLength;
+    BinaryLog_WriteLine( dumpLog, row[ 0 ], recorder->columnsNumber, row + 1 );
+  }
+  bool isDumped = ( dumpLog != NULL );
+  BinaryLog_Discard( dumpLog );
+  
+  free( logName );
+  free( metadata );
+  
+  atomic_store( &(recorder->isFrozen), false );
+  
+  return isDumped;
+}
+
+static void PrepareFaultDump( FlightRecorder recorder )
+{
+  char logName[ FAULT_PATH_MAX_LENGTH ];
+  // Recorders of reloaded robots may coexist with the previous ones
+  snprintf( logName, FAULT_PATH_MAX_LENGTH, "%s-fault%lu", recorder->name, ++faultFilesCount );
+  BinaryLog_GetFilePath( logName, recorder->faultFilePath, FAULT_PATH_MAX_LENGTH );
+  recorder->faultFile = open( recorder->faultFilePath, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644 );
+  if( recorder->faultFile < 0 ) DEBUG_PRINT( "failed to open fault dump file %s", recorder->faultFilePath );
+  
+  recorder->faultMetadataMaxLength = strlen( recorder->metadata ) + FAULT_REASON_MAX_LENGTH + 32;
+  recorder->faultMetadata = (char*) calloc( recorder->faultMetadataMaxLength, sizeof(char) );
+  size_t headerSize = BinaryLog_GetHeaderSize( recorder->faultMetadataMaxLength, recorder->columnsNumber, (const char**) recorder->columnNamesList );
+  recorder->faultHeaderData = (unsigned char*) malloc( headerSize );
+  recorder->faultBlockData = (unsigned char*) malloc( BinaryLog_GetRawBlockSize( BINARY_LOG_DEFAULT_BLOCK_ROWS, recorder->columnsNumber, BINARY_LOG_FLOAT64 ) );
+  recorder->faultTimesList = (double*) calloc( BINARY_LOG_DEFAULT_BLOCK_ROWS, sizeof(double) );
+  recorder->faultValuesTable = (double*) calloc( BINARY_LOG_DEFAULT_BLOCK_ROWS * recorder->columnsNumber, sizeof(double) );
+}
+
+static void EndFaultDump( FlightRecorder recorder )
+{
+  // File stays empty without faults
+  if( recorder->faultFile >= 0 )
+  {
+    close( recorder->faultFile );
+    unlink( recorder->faultFilePath );
+  }
+  
+  free( recorder->faultMetadata );
+  free( recorder->faultHeaderData );
+  free( recorder->faultBlockData );
+  free( recorder->faultTimesList );
+  free( recorder->faultValuesTable );
+}
+
+static bool WriteFaultData( int file, const unsigned char* data, size_t dataSize )
+{
+  while( dataSize > 0 )
+  {
+    ssize_t writtenSize = write( file, data, dataSize );
+    if( writtenSize <= 0 ) return false;
+    data += writtenSize;
+    dataSize -= (size_t) writtenSize;
+  }
+  
+  return true;
+}
+
+// Async-signal-safe version of Dump(), writing uncompressed blocks without time index (rebuilt on reading) to the prepared file
+static void DumpToFaultFile( FlightRecorder recorder )
+{
+  if( recorder == NULL || recorder->faultFile < 0 ) return;
+  
+  int faultFile = recorder->faultFile;
+  // Only dumped once, as the process is ending
+  recorder->faultFile = -1;
+  
+  size_t committedRowsNumber = atomic_load( &(recorder->committedRowsNumber) );
+  size_t firstRowIndex = ( committedRowsNumber >= recorder->rowsNumber ) ? committedRowsNumber - recorder->rowsNumber + 1 : 0;
+  
+  (void) FormatMetadata( recorder->faultMetadata, recorder->faultMetadataMaxLength, atomic_load( &(recorder->freezeReason) ), recorder->metadata );
+  size_t headerSize = BinaryLog_FormatHeader( recorder->faultHeaderData, recorder->faultMetadata, recorder->columnsNumber, 
+                                              (const char**) recorder->columnNamesList, BINARY_LOG_FLOAT64 );
+  bool isWritten = WriteFaultData( faultFile, recorder->faultHeaderData, headerSize );
+  
+  for( size_t blockRowIndex = firstRowIndex; blockRowIndex < committedRowsNumber && isWritten; blockRowIndex += BINARY_LOG_DEFAULT_BLOCK_ROWS )
+  {
+    size_t blockRowsNumber = committedRowsNumber - blockRowIndex;
+    if( blockRowsNumber > BINARY_LOG_DEFAULT_BLOCK_ROWS ) blockRowsNumber = BINARY_LOG_DEFAULT_BLOCK_ROWS;
+    for( size_t rowIndex = 0; rowIndex < blockRowsNumber; rowIndex++ )
+    {
+      const double* row = recorder->rowsData + ( ( blockRowIndex + rowIndex ) % recorder->rowsNumber ) * recorder->rowLength;
+      recorder->faultTimesList[ rowIndex ] = row[ 0 ];
+      for( size_t columnIndex = 0; columnIndex < recorder->columnsNumber; columnIndex++ )
+        recorder->faultValuesTable[ columnIndex * blockRowsNumber + rowIndex ] = row[ 1 + columnIndex ];
+    }
+    size_t blockSize = BinaryLog_FormatRawBlock( recorder->faultBlockData, blockRowsNumber, recorder->faultTimesList, 
+                                                 recorder->columnsNumber, recorder->faultValuesTable, BINARY_LOG_FLOAT64 );
+    isWritten = WriteFaultData( faultFile, recorder->faultBlockData, blockSize );
+  }
+  
+  close( faultFile );
+}
+
+static size_t AppendString( char* buffer, size_t length, size_t maxLength, const char* string, size_t stringMaxLength )
+{
+  size_t stringLength = strlen( string );
+  if( stringLength > stringMaxLength ) stringLength = stringMaxLength;
+  if( stringLength > maxLength - 1 - length ) stringLength = maxLength - 1 - length;
+  memcpy( buffer + length, string, stringLength );
+  buffer[ length + stringLength ] = '\0';
+  
+  return length + stringLength;
+}
+
+// Builds dump metadata without formatted output, as it may be called from signal handlers
+static size_t FormatMetadata( char* buffer, size_t maxLength, const char* reason, const char* sourceMetadata )
+{
+  size_t length = AppendString( buffer, 0, maxLength, "{\"reason\":\"", maxLength );
+  length = AppendString( buffer, length, maxLength, reason, FAULT_REASON_MAX_LENGTH );
+  length = AppendString( buffer, length, maxLength, "\",\"source\":", maxLength );
+  length = AppendString( buffer, length, maxLength, ( sourceMetadata[ 0 ] != '\0' ) ? sourceMetadata : "{}", maxLength );
+  return AppendString( buffer, length, maxLength, "}", maxLength );
+}
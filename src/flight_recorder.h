@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file flight_recorder.h
+/// @brief In-memory history of full rate control data, dumped on demand
+///
+/// Each recorder keeps the last rows of control cycle data in a preallocated circular buffer, filled with plain copies from the control thread. 
+/// Recording stops (buffer is frozen) on request, on a storm of control deadline misses or on a fatal error, and the frozen history is then dumped by a non real-time thread 
+/// to a binary log (see @ref binary_log_format) named <log_dir>/[<user_name>-]<recorder_name>-flight<dump_number>-<time_stamp>.blog, before recording is resumed.
+///
+/// As fatal errors are handled from signal handlers, each recorder also opens a <recorder_name>-fault<file_number> log file on creation, with all buffers needed to fill it, 
+/// so that fault dumps only copy data and call write(). That file is removed when the recorder is discarded without a fault.
+
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLIGHT_RECORDER_DEFAULT_DURATION 5.0          ///< Default recorded history length, in seconds
+#define FLIGHT_RECORDER_DEFAULT_MISSES_LIMIT 10       ///< Default number of deadline misses inside window that trigger a dump
+#define FLIGHT_RECORDER_DEFAULT_MISSES_WINDOW 100     ///< Default deadline misses window length, in control cycles
+
+typedef struct _FlightRecorderData FlightRecorderData;    ///< Single flight recorder internal data structure
+typedef FlightRecorderData* FlightRecorder;               ///< Opaque reference to flight recorder internal data structure
+
+
+/// @brief Initializes recorders list access lock (not thread safe). Without initialization, recorders may not be created or dumped concurrently
+void FlightRecorder_Init( void );
+
+/// @brief Deallocates recorders list and its access lock (call after all recorders are discarded)
+void FlightRecorder_End( void );
+
+/// @brief Creates flight recorder buffer and registers it for dumping (not real-time safe)
+/// @param[in] name recorder name, used for dump file names
+/// @param[in] metadata JSON object string stored in dump files header (see @ref binary_log_format)
+/// @param[in] columnsNumber number of values (excluding time stamp) recorded per row
+/// @param[in] columnNamesList list of columnsNumber column names
+/// @param[in] rowsNumber number of rows kept in history
+/// @param[in] missesLimit number of deadline misses inside window that freeze the recorder (0 for never)
+/// @param[in] missesWindow deadline misses window length, in cycles
+/// @return reference/pointer to newly created flight recorder data structure
+FlightRecorder FlightRecorder_Create( const char* name, const char* metadata, size_t columnsNumber, const char** columnNamesList, size_t rowsNumber, 
+                                      size_t missesLimit, unsigned long missesWindow );
+
+/// @brief Dumps pending history, unregisters recorder and deallocates its internal data (not real-time safe)
+/// @param[in] recorder reference to flight recorder
+void FlightRecorder_Discard( FlightRecorder recorder );
+
+/// @brief Starts new history row (real-time safe, single writer thread)
+/// @param[in] recorder reference to flight recorder
+/// @param[in] timeStamp row time stamp
+/// @return true if row is being recorded, false if recorder is NULL or frozen
+bool FlightRecorder_EnterNewRow( FlightRecorder recorder, double timeStamp );
+
+/// @brief Copies values list to current row (values exceeding the row length are discarded)
+/// @param[in] recorder reference to flight recorder
+/// @param[in] valuesNumber number of values in list
+/// @param[in] valuesList pointer to values array
+void FlightRecorder_RegisterList( FlightRecorder recorder, size_t valuesNumber, const double* valuesList );
+
+/// @brief Commits current row to history
+/// @param[in] recorder reference to flight recorder
+void FlightRecorder_EndRow( FlightRecorder recorder );
+
+/// @brief Counts control deadline miss, freezing recorder when misses limit is reached inside window (a single dump per misses storm)
+/// @param[in] recorder reference to flight recorder
+/// @param[in] cycleIndex index of control cycle that missed its deadline
+void FlightRecorder_RegisterDeadlineMiss( FlightRecorder recorder, unsigned long cycleIndex );
+
+/// @brief Stops history recording and marks it for dumping (real-time and signal safe)
+/// @param[in] recorder reference to flight recorder
+/// @param[in] reason static string describing dump trigger, stored in dump file metadata
+void FlightRecorder_Freeze( FlightRecorder recorder, const char* reason );
+
+/// @brief Freezes all registered recorders
+/// @param[in] reason static string describing dump trigger, stored in dump files metadata
+/// @return number of registered recorders
+size_t FlightRecorder_FreezeAll( const char* reason );
+
+/// @brief Writes dump files of all frozen recorders and resumes their recording (call from non real-time thread)
+/// @return number of written dump files
+size_t FlightRecorder_DumpPending( void );
+
+/// @brief Freezes and dumps all registered recorders to their fault files from a fatal error handler, without waiting for locks (async-signal-safe, a single time per recorder)
+/// @param[in] reason static string describing the error, stored in dump files metadata
+void FlightRecorder_DumpOnFault( const char* reason );
+
+
+#endif // FLIGHT_RECORDER_H
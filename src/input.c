@@ -22,25 +22,29 @@
 
 #include "input.h"
 
-#include "signal_io/signal_io.h"
+#include "device_registry.h"
 #include "debug/data_logging.h"
 
 #include "config_keys.h"
 
 #include <math.h>
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 struct _InputData
 {
-  DECLARE_MODULE_INTERFACE_REF( SIGNAL_IO_INTERFACE );
+  SignalIOModule io;
   long int deviceID;
   unsigned int channel;
+  DeviceChannel deviceChannel;
   double* buffer;
   double value;
   SignalProcessor processor;
+  char* configString;
+  atomic_size_t referencesCount;
 };
 
 
@@ -54,36 +58,36 @@ Input Input_Init( DataHandle configuration )
   memset( newInput, 0, sizeof(InputData) ); 
   
   newInput->deviceID = SIGNAL_IO_DEVICE_INVALID_ID;
+  newInput->configString = DataIO_GetDataString( configuration );
+  atomic_init( &(newInput->referencesCount), 1 );
   
-  bool loadSuccess;
-  char filePath[ DATA_IO_MAX_PATH_LENGTH ];
-  sprintf( filePath, KEY_MODULES "/" KEY_SIGNAL_IO "/%s", DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_TYPE ) );
-  //DEBUG_PRINT( "trying to read signal IO module %s", filePath );
-  LOAD_MODULE_IMPLEMENTATION( SIGNAL_IO_INTERFACE, filePath, newInput, &loadSuccess );
-  if( loadSuccess )
+  bool loadSuccess = false;
+  // Plug-in and device are shared with other inputs/outputs using the same configuration
+  newInput->deviceID = DeviceRegistry_AcquireDevice( DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_TYPE ), 
+                                                     DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_CONFIG ), &(newInput->io) );
+  if( newInput->deviceID != SIGNAL_IO_DEVICE_INVALID_ID )
   {
-    //PRINT_PLUGIN_FUNCTIONS( SIGNAL_IO_INTERFACE, newInput );
-    newInput->deviceID = newInput->InitDevice( DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_CONFIG ) );
-    if( newInput->deviceID != SIGNAL_IO_DEVICE_INVALID_ID )
-    {
-      newInput->channel = (unsigned int) DataIO_GetNumericValue( configuration, -1, KEY_INTERFACE "." KEY_CHANNEL );
-      loadSuccess = newInput->CheckInputChannel( newInput->deviceID, newInput->channel );
-      DEBUG_PRINT( "new device ID: %ld %p", newInput->deviceID, newInput->deviceID );
-      size_t maxInputSamplesNumber = newInput->GetMaxInputSamplesNumber( newInput->deviceID );
-      newInput->buffer = (double*) calloc( maxInputSamplesNumber, sizeof(double) );
-      
-      uint8_t signalProcessingFlags = 0x00;
-      if( DataIO_GetBooleanValue( configuration, false, KEY_SIGNAL_PROCESSING "." KEY_RECTIFIED ) ) signalProcessingFlags |= SIG_PROC_RECTIFY;
-      if( DataIO_GetBooleanValue( configuration, false, KEY_SIGNAL_PROCESSING "." KEY_NORMALIZED ) ) signalProcessingFlags |= SIG_PROC_NORMALIZE;
-      newInput->processor = SignalProcessor_Create( signalProcessingFlags );
-          
-      double relativeMinCutFrequency = DataIO_GetNumericValue( configuration, 0.0, KEY_SIGNAL_PROCESSING "." KEY_MIN_FREQUENCY );
-      SignalProcessor_SetMinFrequency( newInput->processor, relativeMinCutFrequency );
-      double relativeMaxCutFrequency = DataIO_GetNumericValue( configuration, 0.0, KEY_SIGNAL_PROCESSING "." KEY_MAX_FREQUENCY );
-      SignalProcessor_SetMaxFrequency( newInput->processor, relativeMaxCutFrequency );
+    newInput->channel = (unsigned int) DataIO_GetNumericValue( configuration, -1, KEY_INTERFACE "." KEY_CHANNEL );
+    // Devices of plug-ins not declared thread safe are set up by one input/output at a time
+    DeviceRegistry_BeginSetup( &(newInput->io) );
+    loadSuccess = newInput->io.CheckInputChannel( newInput->deviceID, newInput->channel );
+    size_t maxInputSamplesNumber = newInput->io.GetMaxInputSamplesNumber( newInput->deviceID );
+    // Devices already in use (e.g. by the running robot) are only reset when handed off to a new robot (see Input_Reset())
+    if( !DeviceRegistry_IsShared( &(newInput->io), newInput->deviceID ) ) newInput->io.Reset( newInput->deviceID );
+    DeviceRegistry_EndSetup();
+    if( loadSuccess ) newInput->deviceChannel = DeviceRegistry_AddChannel( &(newInput->io), newInput->deviceID, newInput->channel, false );
+    DEBUG_PRINT( "new device ID: %ld %p", newInput->deviceID, newInput->deviceID );
+    newInput->buffer = (double*) calloc( maxInputSamplesNumber, sizeof(double) );
+    
+    uint8_t signalProcessingFlags = 0x00;
+    if( DataIO_GetBooleanValue( configuration, false, KEY_SIGNAL_PROCESSING "." KEY_RECTIFIED ) ) signalProcessingFlags |= SIG_PROC_RECTIFY;
+    if( DataIO_GetBooleanValue( configuration, false, KEY_SIGNAL_PROCESSING "." KEY_NORMALIZED ) ) signalProcessingFlags |= SIG_PROC_NORMALIZE;
+    newInput->processor = SignalProcessor_Create( signalProcessingFlags );
       
-      newInput->Reset( newInput->deviceID );
-    }
+    double relativeMinCutFrequency = DataIO_GetNumericValue( configuration, 0.0, KEY_SIGNAL_PROCESSING "." KEY_MIN_FREQUENCY );
+    SignalProcessor_SetMinFrequency( newInput->processor, relativeMinCutFrequency );
+    double relativeMaxCutFrequency = DataIO_GetNumericValue( configuration, 0.0, KEY_SIGNAL_PROCESSING "." KEY_MAX_FREQUENCY );
+    SignalProcessor_SetMaxFrequency( newInput->processor, relativeMaxCutFrequency );
   }
   
   if( !loadSuccess )
@@ -95,15 +99,35 @@ Input Input_Init( DataHandle configuration )
   return newInput;
 }
 
+Input Input_Reload( Input baseInput, DataHandle configuration )
+{
+  if( baseInput == NULL || baseInput->configString == NULL || configuration == NULL ) return Input_Init( configuration );
+  
+  char* configString = DataIO_GetDataString( configuration );
+  bool isUnchanged = ( configString != NULL && strcmp( configString, baseInput->configString ) == 0 );
+  free( configString );
+  
+  if( !isUnchanged ) return Input_Init( configuration );
+  
+  atomic_fetch_add( &(baseInput->referencesCount), 1 );
+  
+  return baseInput;
+}
+
 void Input_End( Input input )
 {
   if( input == NULL ) return;
   
-  if( input->EndDevice != NULL ) input->EndDevice( input->deviceID );
+  if( atomic_fetch_sub( &(input->referencesCount), 1 ) > 1 ) return;
+  
+  DeviceRegistry_RemoveChannel( input->deviceChannel );
+  DeviceRegistry_ReleaseDevice( &(input->io), input->deviceID );
   
   SignalProcessor_Discard( input->processor );
   
   free( input->buffer );
+  
+  free( input->configString );
 
   free( input );
 }
@@ -112,7 +136,9 @@ double Input_Update( Input input )
 {
   if( input == NULL ) return 0.0;
   
-  size_t aquiredSamplesNumber = input->Read( input->deviceID, input->channel, input->buffer );
+  // Channels of devices supporting block transfers are read together (registry channels also wait for setups of plug-ins not declared thread safe)
+  size_t aquiredSamplesNumber = ( input->deviceChannel != NULL ) ? DeviceRegistry_Read( input->deviceChannel, input->buffer ) 
+                                                                 : input->io.Read( input->deviceID, input->channel, input->buffer );
     
   return SignalProcessor_UpdateSignal( input->processor, input->buffer, aquiredSamplesNumber );
 }
@@ -121,7 +147,7 @@ bool Input_HasError( Input input )
 {
   if( input == NULL ) return true;
   
-  return input->HasError( input->deviceID );
+  return input->io.HasError( input->deviceID );
 }
 
 void Input_Reset( Input input )
@@ -129,7 +155,9 @@ void Input_Reset( Input input )
   if( input == NULL ) return;
   
   SignalProcessor_SetState( input->processor, SIG_PROC_STATE_MEASUREMENT );
-  input->Reset( input->deviceID );
+  DeviceRegistry_BeginSetup( &(input->io) );
+  input->io.Reset( input->deviceID );
+  DeviceRegistry_EndSetup();
 }
 
 void Input_SetState( Input input, enum SigProcState newProcessingState )
@@ -44,7 +44,13 @@ typedef InputData* Input;               ///< Opaque reference to input internal
 /// @return reference/pointer to newly created and initialized input data structure
 Input Input_Init( DataHandle configuration );
 
-/// @brief Deallocates internal data of given input                        
+/// @brief Gets input for given configuration, sharing given (possibly running) input instead if it was created from the same configuration contents
+/// @param[in] baseInput reference to existing input (ignored if NULL)
+/// @param[in] configuration reference to data object containing configuration parameters, as explained at @ref sensor_config
+/// @return reference to shared base input (keeping its processing state), or to newly created input (NULL on errors)
+Input Input_Reload( Input baseInput, DataHandle configuration );
+
+/// @brief Releases given input reference, deallocating its internal data if no longer shared
 /// @param[in] input reference to input
 void Input_End( Input input );
 
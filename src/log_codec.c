@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "log_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+#define VARINT_MAX_SIZE 10
+#define QUANTIZED_MAX_VALUE 4.0e18
+
+const char* CODEC_NAMES[ LOG_CODEC_TYPES_NUMBER ] = { [ LOG_CODEC_RAW ] = "none", [ LOG_CODEC_DELTA ] = "delta", [ LOG_CODEC_XOR ] = "xor" };
+
+
+enum LogCodecType LogCodec_GetType( const char* codecName )
+{
+  if( codecName == NULL ) return LOG_CODEC_RAW;
+  
+  for( int codecIndex = 0; codecIndex < LOG_CODEC_TYPES_NUMBER; codecIndex++ )
+  {
+    if( strcmp( codecName, CODEC_NAMES[ codecIndex ] ) == 0 ) return (enum LogCodecType) codecIndex;
+  }
+  
+  return LOG_CODEC_RAW;
+}
+
+size_t LogCodec_GetMaxEncodedSize( size_t valuesNumber )
+{
+  // Worst case is 9 bytes per XOR value, or 10 bytes per varint
+  return 2 + valuesNumber * VARINT_MAX_SIZE;
+}
+
+static inline size_t WriteVarint( uint8_t* buffer, uint64_t value )
+{
+  size_t bytesNumber = 0;
+  while( value >= 0x80 )
+  {
+    buffer[ bytesNumber++ ] = (uint8_t) ( value | 0x80 );
+    value >>= 7;
+  }
+  buffer[ bytesNumber++ ] = (uint8_t) value;
+  
+  return bytesNumber;
+}
+
+static inline size_t ReadVarint( const uint8_t* data, size_t dataSize, uint64_t* ref_value )
+{
+  uint64_t value = 0;
+  for( size_t byteIndex = 0; byteIndex < dataSize && byteIndex < VARINT_MAX_SIZE; byteIndex++ )
+  {
+    value |= (uint64_t) ( data[ byteIndex ] & 0x7F ) << ( 7 * byteIndex );
+    if( !( data[ byteIndex ] & 0x80 ) ) 
+    {
+      *ref_value = value;
+      return byteIndex + 1;
+    }
+  }
+  
+  return 0;
+}
+
+static inline uint64_t GetBits( double value )
+{
+  uint64_t bits;
+  memcpy( &bits, &value, sizeof(double) );
+  return bits;
+}
+
+static inline double GetValue( uint64_t bits )
+{
+  double value;
+  memcpy( &value, &bits, sizeof(double) );
+  return value;
+}
+
+static size_t EncodeXOR( const double* valuesList, size_t valuesNumber, uint8_t* buffer )
+{
+  size_t offset = 0;
+  uint64_t lastBits = 0;
+  for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+  {
+    uint64_t bits = GetBits( valuesList[ valueIndex ] );
+    uint64_t xorBits = bits ^ lastBits;
+    lastBits = bits;
+    
+    size_t leadingBytes = 0, trailingBytes = 0;
+    while( leadingBytes < 8 && ( ( xorBits >> ( 8 * ( 7 - leadingBytes ) ) ) & 0xFF ) == 0 ) leadingBytes++;
+    while( leadingBytes + trailingBytes < 8 && ( ( xorBits >> ( 8 * trailingBytes ) ) & 0xFF ) == 0 ) trailingBytes++;
+    
+    buffer[ offset++ ] = (uint8_t) ( ( leadingBytes << 4 ) | trailingBytes );
+    for( size_t byteIndex = 7 - leadingBytes; byteIndex + 1 > trailingBytes; byteIndex-- )
+      buffer[ offset++ ] = (uint8_t) ( xorBits >> ( 8 * byteIndex ) );
+  }
+  
+  return offset;
+}
+
+size_t LogCodec_EncodeColumn( const double* valuesList, size_t valuesNumber, enum LogCodecType codecType, size_t precision, uint8_t* buffer )
+{
+  if( precision > LOG_CODEC_MAX_PRECISION ) precision = LOG_CODEC_MAX_PRECISION;
+  double scale = pow( 10.0, (double) precision );
+  
+  if( codecType == LOG_CODEC_DELTA )
+  {
+    for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+    {
+      if( !( fabs( valuesList[ valueIndex ] * scale ) < QUANTIZED_MAX_VALUE ) ) codecType = LOG_CODEC_XOR;
+    }
+  }
+  
+  size_t offset = 0;
+  buffer[ offset++ ] = (uint8_t) codecType;
+  if( codecType == LOG_CODEC_DELTA )
+  {
+    buffer[ offset++ ] = (uint8_t) precision;
+    int64_t lastValue = 0;
+    for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+    {
+      int64_t value = (int64_t) llround( valuesList[ valueIndex ] * scale );
+      int64_t delta = value - lastValue;
+      lastValue = value;
+      offset += WriteVarint( buffer + offset, ( (uint64_t) delta << 1 ) ^ (uint64_t) ( delta >> 63 ) );
+    }
+  }
+  else if( codecType == LOG_CODEC_XOR ) offset += EncodeXOR( valuesList, valuesNumber, buffer + offset );
+  else
+  {
+    memcpy( buffer + offset, valuesList, valuesNumber * sizeof(double) );
+    offset += valuesNumber * sizeof(double);
+  }
+  
+  return offset;
+}
+
+size_t LogCodec_DecodeColumn( const uint8_t* data, size_t dataSize, size_t valuesNumber, double* valuesList )
+{
+  if( dataSize < 1 ) return 0;
+  
+  size_t offset = 0;
+  enum LogCodecType codecType = (enum LogCodecType) data[ offset++ ];
+  if( codecType == LOG_CODEC_DELTA )
+  {
+    if( dataSize < 2 || data[ offset ] > LOG_CODEC_MAX_PRECISION ) return 0;
+    double scale = pow( 10.0, (double) data[ offset++ ] );
+    int64_t lastValue = 0;
+    for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+    {
+      uint64_t zigzagDelta;
+      size_t varintSize = ReadVarint( data + offset, dataSize - offset, &zigzagDelta );
+      if( varintSize == 0 ) return 0;
+      offset += varintSize;
+      lastValue += (int64_t) ( zigzagDelta >> 1 ) ^ -(int64_t) ( zigzagDelta & 1 );
+      valuesList[ valueIndex ] = lastValue / scale;
+    }
+  }
+  else if( codecType == LOG_CODEC_XOR )
+  {
+    uint64_t lastBits = 0;
+    for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+    {
+      if( offset >= dataSize ) return 0;
+      size_t leadingBytes = data[ offset ] >> 4, trailingBytes = data[ offset ] & 0x0F;
+      offset++;
+      if( leadingBytes + trailingBytes > 8 || offset + 8 - leadingBytes - trailingBytes > dataSize ) return 0;
+      uint64_t xorBits = 0;
+      for( size_t byteIndex = 7 - leadingBytes; byteIndex + 1 > trailingBytes; byteIndex-- )
+        xorBits |= (uint64_t) data[ offset++ ] << ( 8 * byteIndex );
+      lastBits ^= xorBits;
+      valuesList[ valueIndex ] = GetValue( lastBits );
+    }
+  }
+  else if( codecType == LOG_CODEC_RAW )
+  {
+    if( offset + valuesNumber * sizeof(double) > dataSize ) return 0;
+    memcpy( valuesList, data + offset, valuesNumber * sizeof(double) );
+    offset += valuesNumber * sizeof(double);
+  }
+  else return 0;
+  
+  return offset;
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file log_codec.h
+/// @brief Column compression functions for binary logs
+///
+/// Streaming (block by block) encoding of numeric log columns, suited for slowly varying signals. Each encoded column starts with its encoding code byte:
+/// - LOG_CODEC_RAW: code, followed by 8-byte double values
+/// - LOG_CODEC_DELTA: code and precision (decimal places) bytes, followed by differences between consecutive values quantized to given precision (the first one relative to 0), 
+///   as [zigzag](https://developers.google.com/protocol-buffers/docs/encoding#signed-ints) [varints](https://developers.google.com/protocol-buffers/docs/encoding#varints) (lossy, as text logs)
+/// - LOG_CODEC_XOR: code, followed by bitwise XOR of each value double representation with the previous one (the first one relative to 0), packed as a byte with the number of leading 
+///   (high nibble) and trailing (low nibble) zero bytes, followed by the remaining bytes, from most to least significant (lossless)
+
+
+#ifndef LOG_CODEC_H
+#define LOG_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Column encoding codes
+enum LogCodecType 
+{ 
+  LOG_CODEC_RAW,          ///< Uncompressed values
+  LOG_CODEC_DELTA,        ///< Precision-quantized delta + zigzag varint encoding (lossy)
+  LOG_CODEC_XOR,          ///< XOR with previous value + zero bytes packing (lossless)
+  LOG_CODEC_TYPES_NUMBER 
+};
+
+#define LOG_CODEC_MAX_PRECISION 15      ///< Maximum decimal precision for quantized (delta) encoding
+
+
+/// @brief Gets maximum size of an encoded column, for buffer allocation
+/// @param[in] valuesNumber number of column values
+/// @return maximum number of bytes written by LogCodec_EncodeColumn() for given number of values
+size_t LogCodec_GetMaxEncodedSize( size_t valuesNumber );
+
+/// @brief Encodes list of column values. LOG_CODEC_DELTA falls back to LOG_CODEC_XOR for non-finite or out-of-range values
+/// @param[in] valuesList list of column values
+/// @param[in] valuesNumber number of values in list
+/// @param[in] codecType requested encoding
+/// @param[in] precision number of decimal places kept by quantized encodings
+/// @param[out] buffer buffer with at least LogCodec_GetMaxEncodedSize() bytes, where encoded column will be written
+/// @return number of bytes written to buffer
+size_t LogCodec_EncodeColumn( const double* valuesList, size_t valuesNumber, enum LogCodecType codecType, size_t precision, uint8_t* buffer );
+
+/// @brief Decodes list of column values
+/// @param[in] data encoded column data
+/// @param[in] dataSize number of available bytes (for bounds checking)
+/// @param[in] valuesNumber number of encoded values
+/// @param[out] valuesList list with at least valuesNumber elements, where decoded values will be stored
+/// @return number of bytes read from data (0 on invalid or truncated data)
+size_t LogCodec_DecodeColumn( const uint8_t* data, size_t dataSize, size_t valuesNumber, double* valuesList );
+
+/// @brief Gets encoding corresponding to configuration name
+/// @param[in] codecName encoding name ("none", "delta" or "xor")
+/// @return corresponding encoding (LOG_CODEC_RAW for unknown names)
+enum LogCodecType LogCodec_GetType( const char* codecName );
+
+
+#endif // LOG_CODEC_H
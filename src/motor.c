@@ -24,6 +24,9 @@
 
 #include "input.h"
 #include "output.h"
+#include "trace_points.h"
+#include "async_log.h"
+#include "config_cache.h"
 #include "tinyexpr/tinyexpr.h"
 
 #include "data_io/interface/data_io.h"
@@ -34,6 +37,7 @@
 #include "config_keys.h" 
 
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
@@ -50,6 +54,11 @@ struct _MotorData
   te_expr* transformFunction;
   bool isOffsetting;
   Log log;
+  AsyncLog asyncLog;
+  TracePoint tracePoint;
+  char* name;
+  char* configString;
+  atomic_size_t referencesCount;
 };
 
 
@@ -58,11 +67,15 @@ Motor Motor_Init( const char* configName )
   char filePath[ DATA_IO_MAX_PATH_LENGTH ];
   DEBUG_PRINT( "trying to create motor %s", configName );
   sprintf( filePath, KEY_CONFIG "/" KEY_MOTORS "/%s", configName );
-  DataHandle configuration = DataIO_LoadStorageData( filePath );
+  DataHandle configuration = ConfigCache_Load( filePath );
   if( configuration == NULL ) return NULL;
   
   Motor newMotor = (Motor) malloc( sizeof(MotorData) );
   memset( newMotor, 0, sizeof(MotorData) );
+  newMotor->name = (char*) calloc( strlen( configName ) + 1, sizeof(char) );
+  strcpy( newMotor->name, configName );
+  newMotor->configString = DataIO_GetDataString( configuration );
+  atomic_init( &(newMotor->referencesCount), 1 );
 
   newMotor->output = Output_Init( configuration );
   
@@ -80,11 +93,28 @@ Motor Motor_Init( const char* configName )
   newMotor->transformFunction = te_compile( transformExpression, newMotor->inputVariables, 2, &expressionError ); 
   if( expressionError > 0 ) loadSuccess = false;
   DEBUG_PRINT( "transform function: out= %s (error: %d)", transformExpression, expressionError );
-  if( DataIO_HasKey( configuration, KEY_LOG ) )
+  // Logged on every reading, so it must be explicitly enabled
+  if( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_ENABLED ) )
+  {
     newMotor->log = Log_Init( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE ) ? configName : "", 
                               (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION ) );
+    // Setpoint, offset and output
+    newMotor->asyncLog = AsyncLog_Create( configName, newMotor->log, NULL, 3, 
+                                          (size_t) DataIO_GetNumericValue( configuration, ASYNC_LOG_DEFAULT_BUFFER_LENGTH, KEY_LOG "." KEY_BUFFER_LENGTH ),
+                                          AsyncLog_ParseOverflowPolicy( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_OVERFLOW ) ) );
+    AsyncLogFilter logFilter;
+    if( AsyncLog_LoadFilter( configuration, &logFilter ) ) 
+    {
+      // Devices have no control state to be checked
+      if( logFilter.triggerState >= 0 ) DEBUG_PRINT( "log trigger state ignored for %s", configName );
+      logFilter.triggerState = -1;
+      AsyncLog_SetFilter( newMotor->asyncLog, &logFilter );
+    }
+  }
+  
+  newMotor->tracePoint = TracePoint_Register( KEY_MOTORS, configName );
   
-  DataIO_UnloadData( configuration );
+  ConfigCache_Unload( configuration );
   
   if( !loadSuccess )
   {
@@ -95,18 +125,48 @@ Motor Motor_Init( const char* configName )
   return newMotor;
 }
 
+bool Motor_HasConfig( Motor motor, const char* configName )
+{
+  char filePath[ DATA_IO_MAX_PATH_LENGTH ];
+  
+  if( motor == NULL ) return false;
+  
+  if( strcmp( motor->name, configName ) != 0 ) return false;
+  
+  sprintf( filePath, KEY_CONFIG "/" KEY_MOTORS "/%s", configName );
+  return ConfigCache_HasData( filePath, motor->configString );
+}
+
+Motor Motor_Reload( Motor baseMotor, const char* configName )
+{
+  if( !Motor_HasConfig( baseMotor, configName ) ) return Motor_Init( configName );
+  
+  DEBUG_PRINT( "reusing motor %s", configName );
+  atomic_fetch_add( &(baseMotor->referencesCount), 1 );
+  
+  return baseMotor;
+}
+
 void Motor_End( Motor motor )
 {
   if( motor == NULL ) return;
   
+  if( atomic_fetch_sub( &(motor->referencesCount), 1 ) > 1 ) return;
+  
   Output_End( motor->output );
   
   Input_End( motor->reference );
   
   if( motor->transformFunction != NULL ) te_free( motor->transformFunction );
   
+  AsyncLog_Discard( motor->asyncLog );
   Log_End( motor->log );
   
+  TracePoint_Unregister( motor->tracePoint );
+  
+  free( motor->name );
+  free( motor->configString );
+  
   free( motor );
 }
 
@@ -160,9 +220,13 @@ void Motor_WriteControl( Motor motor, double setpoint )
   motor->setpoint = setpoint;
   //DEBUG_PRINT( "evaluating transform function %p (set=%g, ref=%g)", motor->transformFunction, *((double*) motor->inputVariables[ 0 ].address), *((double*) motor->inputVariables[ 1 ].address) );
   double outputValue = te_eval( motor->transformFunction );
-  //DEBUG_PRINT( "logging motor data to %p", motor->log );
-  //Log_EnterNewLine( motor->log, Time_GetExecSeconds() );
-  //Log_RegisterValues( motor->log, 3, motor->setpoint, motor->offset, output );
+  TRACE_POINT( motor->tracePoint, 0, NULL, 3, motor->setpoint, motor->offset, outputValue );
+  if( motor->asyncLog != NULL && AsyncLog_EnterNewLine( motor->asyncLog, Time_GetExecSeconds() ) )
+  {
+    const double logValuesList[] = { motor->setpoint, motor->offset, outputValue };
+    AsyncLog_RegisterList( motor->asyncLog, 3, logValuesList );
+    AsyncLog_EndLine( motor->asyncLog );
+  }
   //DEBUG_PRINT( "writing %g,%g -> %g to output %p", motor->setpoint, motor->offset, outputValue, motor->output );
   if( ! motor->isOffsetting ) Output_Update( motor->output, outputValue );
 }
@@ -45,9 +45,20 @@
 ///   "output": "set",                // [o] String with math expression for conversion from control setpoint ("set") and offset reference ("ref") to output
 ///                                   //     Possible operations are the ones supported by TinyExpr library: https://codeplea.com/tinyexpr
 ///   "log": {                        // [o] Set logging of setpoint, offset and output numeric data over time
+///     "enabled": false,               // [o] Log every write (disabled by default, as writes happen on every control cycle)
 ///     "to_file": false,               // [o] Save data logging to <log_dir>/[<user_name>-]<motor_name>-<time_stamp>.log, to log file 
 ///                                     //     Default value will set terminal logging
-///     "precision": 3                  // [o] Decimal precision for logged numeric values
+///     "precision": 3,                 // [o] Decimal precision for logged numeric values
+///     "buffer_length": 1024,          // [o] Number of lines buffered for the (asynchronous) log writer
+///     "overflow": "drop_newest",      // [o] Lines dropped when buffer is full: "drop_newest" or "drop_oldest"
+///     "decimation": 1,                // [o] Number of writes combined into each logged line
+///     "aggregation": "last",          // [o] Combination of decimated values: "last", "mean", "min" or "max"
+///     "trigger": {                    // [o] Log only while logged value is inside thresholds
+///       "value": 2,                     // [o] Index of logged value (setpoint, offset or output) checked against thresholds ("state" is ignored)
+///       "above": 10.0,                  // [o] Minimum (exclusive) checked value
+///       "below": 100.0,                 // [o] Maximum (exclusive) checked value
+///       "pre_trigger": 0                // [o] Number of (decimated) lines preceding trigger activation that are also logged
+///     }
 ///   }
 /// }
 /// @endcode
@@ -67,7 +78,19 @@ typedef MotorData* Motor;                  ///< Opaque reference to motor intern
 /// @return reference/pointer to newly created and initialized motor data structure
 Motor Motor_Init( const char* configName );
 
-/// @brief Deallocates internal data of given motor                        
+/// @brief Checks whether given motor was created from the current contents of specified configuration
+/// @param[in] motor reference to motor
+/// @param[in] configName name of file containing configuration parameters, as explained at @ref motor_config
+/// @return true if configuration is unchanged since motor creation, false otherwise
+bool Motor_HasConfig( Motor motor, const char* configName );
+
+/// @brief Gets motor for given configuration, sharing given (possibly running) motor instead if its configuration is unchanged (see Motor_HasConfig())
+/// @param[in] baseMotor reference to existing motor (ignored if NULL)
+/// @param[in] configName name of file containing configuration parameters, as explained at @ref motor_config
+/// @return reference to shared base motor (keeping its offset and processing state), or to newly created motor (NULL on errors)
+Motor Motor_Reload( Motor baseMotor, const char* configName );
+
+/// @brief Releases given motor reference, deallocating its internal data if no longer shared
 /// @param[in] motor reference to motor
 void Motor_End( Motor motor );
 
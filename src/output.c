@@ -22,21 +22,25 @@
 
 #include "output.h"
 
-#include "signal_io/signal_io.h"
+#include "device_registry.h"
 #include "debug/data_logging.h"
       
 #include "config_keys.h" 
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <string.h>
       
 struct _OutputData
 {
-  DECLARE_MODULE_INTERFACE_REF( SIGNAL_IO_INTERFACE );
+  SignalIOModule io;
   long int deviceID;
   unsigned int channel;
+  DeviceChannel deviceChannel;
+  char* configString;
+  atomic_size_t referencesCount;
 };
 
 
@@ -48,24 +52,21 @@ Output Output_Init( DataHandle configuration )
   memset( newOutput, 0, sizeof(OutputData) );
 
   newOutput->deviceID = SIGNAL_IO_DEVICE_INVALID_ID;
+  newOutput->configString = DataIO_GetDataString( configuration );
+  atomic_init( &(newOutput->referencesCount), 1 );
   
   bool loadSuccess = true;
-  char filePath[ DATA_IO_MAX_PATH_LENGTH ];
-  sprintf( filePath, KEY_MODULES "/" KEY_SIGNAL_IO "/%s", DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_TYPE ) );
-  //DEBUG_PRINT( "trying to read signal IO module %s", filePath );
-  LOAD_MODULE_IMPLEMENTATION( SIGNAL_IO_INTERFACE, filePath, newOutput, &loadSuccess );
-  if( loadSuccess )
+  // Plug-in and device are shared with other inputs/outputs using the same configuration
+  newOutput->deviceID = DeviceRegistry_AcquireDevice( DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_TYPE ), 
+                                                      DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_CONFIG ), &(newOutput->io) );
+  if( newOutput->deviceID != SIGNAL_IO_DEVICE_INVALID_ID ) 
   {
-    //PRINT_PLUGIN_FUNCTIONS( SIGNAL_IO_INTERFACE, newOutput );
-    newOutput->deviceID = newOutput->InitDevice( DataIO_GetStringValue( configuration, "", KEY_INTERFACE "." KEY_CONFIG ) );
-    if( newOutput->deviceID != SIGNAL_IO_DEVICE_INVALID_ID ) 
-    {
-      newOutput->channel = (unsigned int) DataIO_GetNumericValue( configuration, -1, KEY_INTERFACE "." KEY_CHANNEL );
-      //DEBUG_PRINT( "trying to aquire channel %u from interface %d", newOutput->channel, newOutput->deviceID );
-      //loadSuccess = newOutput->AcquireOutputChannel( newOutput->deviceID, newOutput->channel );
-    }
-    else loadSuccess = false;
+    newOutput->channel = (unsigned int) DataIO_GetNumericValue( configuration, -1, KEY_INTERFACE "." KEY_CHANNEL );
+    newOutput->deviceChannel = DeviceRegistry_AddChannel( &(newOutput->io), newOutput->deviceID, newOutput->channel, true );
+    //DEBUG_PRINT( "trying to aquire channel %u from interface %d", newOutput->channel, newOutput->deviceID );
+    //loadSuccess = newOutput->io.AcquireOutputChannel( newOutput->deviceID, newOutput->channel );
   }
+  else loadSuccess = false;
   
   if( !loadSuccess )
   {
@@ -76,11 +77,31 @@ Output Output_Init( DataHandle configuration )
   return newOutput;
 }
 
+Output Output_Reload( Output baseOutput, DataHandle configuration )
+{
+  if( baseOutput == NULL || baseOutput->configString == NULL || configuration == NULL ) return Output_Init( configuration );
+  
+  char* configString = DataIO_GetDataString( configuration );
+  bool isUnchanged = ( configString != NULL && strcmp( configString, baseOutput->configString ) == 0 );
+  free( configString );
+  
+  if( !isUnchanged ) return Output_Init( configuration );
+  
+  atomic_fetch_add( &(baseOutput->referencesCount), 1 );
+  
+  return baseOutput;
+}
+
 void Output_End( Output output )
 {
   if( output == NULL ) return;
   
-  if( output->EndDevice != NULL ) output->EndDevice( output->deviceID );
+  if( atomic_fetch_sub( &(output->referencesCount), 1 ) > 1 ) return;
+  
+  DeviceRegistry_RemoveChannel( output->deviceChannel );
+  DeviceRegistry_ReleaseDevice( &(output->io), output->deviceID );
+  
+  free( output->configString );
   
   free( output );
 }
@@ -89,33 +110,44 @@ bool Output_Enable( Output output )
 {
   if( output == NULL ) return false;
   DEBUG_PRINT( "acquiring output %u from interface %d", output->channel, output->deviceID );  
-  return output->AcquireOutputChannel( output->deviceID, output->channel );
+  // Devices of plug-ins not declared thread safe are set up by one input/output at a time
+  DeviceRegistry_BeginSetup( &(output->io) );
+  bool isAcquired = output->io.AcquireOutputChannel( output->deviceID, output->channel );
+  DeviceRegistry_EndSetup();
+  
+  return isAcquired;
 }
 
 void Output_Disable( Output output )
 {
   if( output == NULL ) return;
   
-  output->ReleaseOutputChannel( output->deviceID, output->channel );
+  DeviceRegistry_BeginSetup( &(output->io) );
+  output->io.ReleaseOutputChannel( output->deviceID, output->channel );
+  DeviceRegistry_EndSetup();
 }
 
 void Output_Reset( Output output )
 {
   if( output == NULL ) return;
   DEBUG_PRINT( "resetting interface %d", output->deviceID );
-  output->Reset( output->deviceID );
+  DeviceRegistry_BeginSetup( &(output->io) );
+  output->io.Reset( output->deviceID );
+  DeviceRegistry_EndSetup();
 }
 
 bool Output_HasError( Output output )
 {
   if( output == NULL ) return true;
   
-  return output->HasError( output->deviceID );
+  return output->io.HasError( output->deviceID );
 }
 
 void Output_Update( Output output, double value )
 {
   if( output == NULL ) return;
   //DEBUG_PRINT( "evaluating transform function %p", output->transformFunction );
-  output->Write( output->deviceID, output->channel, value );
+  // Channels of devices supporting block transfers may be written together later (registry channels also wait for setups of plug-ins not declared thread safe)
+  if( output->deviceChannel != NULL ) DeviceRegistry_Write( output->deviceChannel, value );
+  else output->io.Write( output->deviceID, output->channel, value );
 }
@@ -43,7 +43,13 @@ typedef OutputData* Output;                  ///< Opaque reference to output int
 /// @return reference/pointer to newly created and initialized output data structure
 Output Output_Init( DataHandle configuration );
 
-/// @brief Deallocates internal data of given output                        
+/// @brief Gets output for given configuration, sharing given (possibly running) output instead if it was created from the same configuration contents
+/// @param[in] baseOutput reference to existing output (ignored if NULL)
+/// @param[in] configuration reference to data object containing configuration parameters, as explained at @ref motor_config
+/// @return reference to shared base output (keeping its processing state), or to newly created output (NULL on errors)
+Output Output_Reload( Output baseOutput, DataHandle configuration );
+
+/// @brief Releases given output reference, deallocating its internal data if no longer shared
 /// @param[in] output reference to output
 void Output_End( Output output );
 
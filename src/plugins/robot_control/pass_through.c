@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Pass-through robot controller for any number of joints (e.g. for control loop benchmarks): axes are the joints themselves, so joint measures are 
+/// copied to axis measures and axis setpoints to joint setpoints. The configuration string is the number of joints (1 if empty or invalid), 
+/// optionally followed by "loopback", which makes axis measures echo the axis setpoints instead (e.g. for client round-trip latency measurements)
+
+#include "robot_control/robot_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DOF_NAME_MAX_LENGTH 16
+
+static char* dofNamesBuffer = NULL;
+static const char** dofNamesList = NULL;
+static size_t dofsNumber = 0;
+static bool isLoopback = false;
+
+
+DECLARE_MODULE_INTERFACE( ROBOT_CONTROL_INTERFACE );
+
+
+bool InitController( const char* configurationString ) 
+{
+  long configDoFsNumber = ( configurationString != NULL ) ? strtol( configurationString, NULL, 10 ) : 0;
+  dofsNumber = ( configDoFsNumber > 0 ) ? (size_t) configDoFsNumber : 1;
+  isLoopback = ( configurationString != NULL && strstr( configurationString, "loopback" ) != NULL );
+  
+  dofNamesBuffer = (char*) calloc( dofsNumber * DOF_NAME_MAX_LENGTH, sizeof(char) );
+  dofNamesList = (const char**) calloc( dofsNumber, sizeof(const char*) );
+  if( dofNamesBuffer == NULL || dofNamesList == NULL )
+  {
+    EndController();
+    return false;
+  }
+  
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+  {
+    char* dofName = dofNamesBuffer + dofIndex * DOF_NAME_MAX_LENGTH;
+    snprintf( dofName, DOF_NAME_MAX_LENGTH, "joint_%lu", (unsigned long) dofIndex );
+    dofNamesList[ dofIndex ] = dofName;
+  }
+  
+  return true; 
+}
+
+void EndController() 
+{ 
+  free( dofNamesList );
+  dofNamesList = NULL;
+  free( dofNamesBuffer );
+  dofNamesBuffer = NULL;
+  dofsNumber = 0;
+}
+
+size_t GetJointsNumber() { return dofsNumber; }
+
+const char** GetJointNamesList() { return dofNamesList; }
+
+size_t GetAxesNumber() { return dofsNumber; }
+
+const char** GetAxisNamesList() { return dofNamesList; }
+
+size_t GetExtraInputsNumber( void ) { return 0; }
+      
+void SetExtraInputsList( double* inputsList ) { return; }
+
+size_t GetExtraOutputsNumber( void ) { return 0; }
+         
+void GetExtraOutputsList( double* outputsList ) { return; }
+
+void SetControlState( enum ControlState newControlState ) { return; }
+
+void RunControlStep( DoFVariables** jointMeasuresList, DoFVariables** axisMeasuresList, DoFVariables** jointSetpointsList, DoFVariables** axisSetpointsList, double timeDelta )
+{
+  for( size_t dofIndex = 0; dofIndex < dofsNumber; dofIndex++ )
+  {
+    *(axisMeasuresList[ dofIndex ]) = isLoopback ? *(axisSetpointsList[ dofIndex ]) : *(jointMeasuresList[ dofIndex ]);
+    *(jointSetpointsList[ dofIndex ]) = *(axisSetpointsList[ dofIndex ]);
+  }
+}
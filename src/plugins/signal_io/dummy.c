@@ -21,10 +21,12 @@
 
 
 #include "signal_io/signal_io.h"
+#include "signal_io_extensions.h"
 
 #include <stdlib.h>
 
 DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE );
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_BLOCK_INTERFACE );
 
 long int InitDevice( const char* taskConfig )
 {
@@ -77,3 +79,16 @@ void ReleaseOutputChannel( long int taskID, unsigned int channel )
 {
   return;
 }
+
+bool ReadChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, double** buffersList, size_t* samplesCountsList )
+{
+  for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
+    samplesCountsList[ channelIndex ] = Read( taskID, channelsList[ channelIndex ], buffersList[ channelIndex ] );
+  
+  return true;
+}
+
+bool WriteChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, const double* valuesList )
+{
+  return true;
+}
@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file log_replay.c
+/// @brief Signal input plugin for playback of recorded binary logs
+///
+/// Serves each column of a binary log (see @ref binary_log_format) as an input channel (channel N reads column N), so that recorded sessions drive the whole input processing pipeline.
+/// Device configuration string is a space separated list, with the log file path followed by optional flags:
+/// @code
+/// "<log_file_path> [loop] [fast] [<samples_number>]"
+/// @endcode
+/// - loop: restart playback from first row after the last one (otherwise, channels stop delivering samples at the end of the log)
+/// - fast: deliver up to <samples_number> rows on every read, as fast as possible (default pacing follows recorded time stamps, relative to device reset time)
+/// - <samples_number>: maximum number of samples returned on each read (default 32)
+///
+/// Every channel keeps its own read position, so all samples are delivered exactly once to each channel. Devices are shared among inputs with equal configuration strings.
+/// Reads are not thread safe, as usual for inputs updated by a single control thread.
+
+
+#include "signal_io/signal_io.h"
+
+#include "binary_log.h"
+
+#include "timing/timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define DEFAULT_MAX_SAMPLES_NUMBER 32
+
+typedef struct _ReplayChannel
+{
+  size_t rowIndex;
+  size_t loopsCount;
+}
+ReplayChannel;
+
+typedef struct _ReplayDeviceData
+{
+  char* configString;
+  size_t usersNumber;
+  BinaryLogReader reader;
+  bool isLooping;
+  bool isRealTime;
+  size_t maxSamplesNumber;
+  size_t rowsNumber;
+  double firstTime;
+  double loopDuration;
+  double startTime;
+  ReplayChannel* channelsList;
+  size_t channelsNumber;
+  double* timesList;
+}
+ReplayDeviceData;
+
+typedef ReplayDeviceData* ReplayDevice;
+
+static ReplayDevice* devicesList = NULL;
+static size_t devicesNumber = 0;
+
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE );
+
+static ReplayDevice GetDevice( long int );
+static void DiscardDevice( ReplayDevice );
+
+long int InitDevice( const char* taskConfig )
+{
+  if( taskConfig == NULL ) return SIGNAL_IO_DEVICE_INVALID_ID;
+  
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    if( devicesList[ deviceIndex ] == NULL ) continue;
+    if( strcmp( devicesList[ deviceIndex ]->configString, taskConfig ) == 0 )
+    {
+      devicesList[ deviceIndex ]->usersNumber++;
+      return (long int) deviceIndex;
+    }
+  }
+  
+  ReplayDevice newDevice = (ReplayDevice) malloc( sizeof(ReplayDeviceData) );
+  memset( newDevice, 0, sizeof(ReplayDeviceData) );
+  newDevice->configString = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( newDevice->configString, taskConfig );
+  newDevice->usersNumber = 1;
+  newDevice->isRealTime = true;
+  newDevice->maxSamplesNumber = DEFAULT_MAX_SAMPLES_NUMBER;
+  
+  char* configBuffer = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( configBuffer, taskConfig );
+  const char* filePath = strtok( configBuffer, " " );
+  for( char* option = strtok( NULL, " " ); option != NULL; option = strtok( NULL, " " ) )
+  {
+    if( strcmp( option, "loop" ) == 0 ) newDevice->isLooping = true;
+    else if( strcmp( option, "fast" ) == 0 ) newDevice->isRealTime = false;
+    else if( strtoul( option, NULL, 10 ) > 0 ) newDevice->maxSamplesNumber = (size_t) strtoul( option, NULL, 10 );
+  }
+  newDevice->reader = BinaryLog_OpenReader( ( filePath != NULL ) ? filePath : "" );
+  free( configBuffer );
+  
+  newDevice->rowsNumber = BinaryLog_GetRowsNumber( newDevice->reader );
+  if( newDevice->rowsNumber == 0 )
+  {
+    DiscardDevice( newDevice );
+    return SIGNAL_IO_DEVICE_INVALID_ID;
+  }
+  
+  // Looped playback keeps recorded sampling interval between last and first rows
+  double lastTime;
+  BinaryLog_ReadRow( newDevice->reader, 0, &(newDevice->firstTime), NULL );
+  BinaryLog_ReadRow( newDevice->reader, newDevice->rowsNumber - 1, &lastTime, NULL );
+  double meanInterval = ( newDevice->rowsNumber > 1 ) ? ( lastTime - newDevice->firstTime ) / ( newDevice->rowsNumber - 1 ) : 0.0;
+  newDevice->loopDuration = lastTime - newDevice->firstTime + meanInterval;
+  
+  newDevice->channelsNumber = BinaryLog_GetReaderColumnsNumber( newDevice->reader );
+  newDevice->channelsList = (ReplayChannel*) calloc( newDevice->channelsNumber, sizeof(ReplayChannel) );
+  newDevice->timesList = (double*) calloc( newDevice->maxSamplesNumber, sizeof(double) );
+  newDevice->startTime = Time_GetExecSeconds();
+  
+  size_t deviceIndex = 0;
+  while( deviceIndex < devicesNumber && devicesList[ deviceIndex ] != NULL ) deviceIndex++;
+  if( deviceIndex == devicesNumber ) devicesList = (ReplayDevice*) realloc( devicesList, ++devicesNumber * sizeof(ReplayDevice) );
+  devicesList[ deviceIndex ] = newDevice;
+  
+  return (long int) deviceIndex;
+}
+
+void EndDevice( long int taskID )
+{
+  ReplayDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  if( --(device->usersNumber) > 0 ) return;
+  
+  DiscardDevice( device );
+  devicesList[ taskID ] = NULL;
+}
+
+size_t GetMaxInputSamplesNumber( long int taskID )
+{
+  ReplayDevice device = GetDevice( taskID );
+  if( device == NULL ) return 1;
+  
+  return device->maxSamplesNumber;
+}
+
+size_t Read( long int taskID, unsigned int channel, double* ref_value )
+{
+  ReplayDevice device = GetDevice( taskID );
+  if( device == NULL ) return 0;
+  
+  if( channel >= device->channelsNumber ) return 0;
+  
+  ReplayChannel* replayChannel = &(device->channelsList[ channel ]);
+  double playTime = Time_GetExecSeconds() - device->startTime;
+  
+  size_t samplesNumber = 0;
+  while( samplesNumber < device->maxSamplesNumber )
+  {
+    if( replayChannel->rowIndex >= device->rowsNumber )
+    {
+      if( !device->isLooping ) break;
+      replayChannel->rowIndex = 0;
+      replayChannel->loopsCount++;
+    }
+    
+    size_t readRowsNumber = BinaryLog_ReadColumn( device->reader, channel, replayChannel->rowIndex, device->maxSamplesNumber - samplesNumber, 
+                                                  device->timesList, ref_value + samplesNumber );
+    if( readRowsNumber == 0 ) break;
+    
+    // Only rows already due (relative to reset time) are delivered on real-time pacing
+    if( device->isRealTime )
+    {
+      double loopTime = device->firstTime - replayChannel->loopsCount * device->loopDuration;
+      size_t dueRowsNumber = 0;
+      while( dueRowsNumber < readRowsNumber && device->timesList[ dueRowsNumber ] - loopTime <= playTime ) dueRowsNumber++;
+      readRowsNumber = dueRowsNumber;
+    }
+    
+    samplesNumber += readRowsNumber;
+    replayChannel->rowIndex += readRowsNumber;
+    if( replayChannel->rowIndex < device->rowsNumber ) break;
+  }
+  
+  return samplesNumber;
+}
+
+bool HasError( long int taskID )
+{
+  return ( GetDevice( taskID ) == NULL );
+}
+
+void Reset( long int taskID )
+{
+  ReplayDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  // Playback is restarted for all channels, keeping them synchronized
+  memset( device->channelsList, 0, device->channelsNumber * sizeof(ReplayChannel) );
+  device->startTime = Time_GetExecSeconds();
+}
+
+bool CheckInputChannel( long int taskID, unsigned int channel )
+{
+  ReplayDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  return ( channel < device->channelsNumber );
+}
+
+bool Write( long int taskID, unsigned int channel, double value )
+{
+  return false;
+}
+
+bool AcquireOutputChannel( long int taskID, unsigned int channel )
+{
+  return false;
+}
+
+void ReleaseOutputChannel( long int taskID, unsigned int channel )
+{
+  return;
+}
+
+
+static ReplayDevice GetDevice( long int taskID )
+{
+  if( taskID < 0 || (size_t) taskID >= devicesNumber ) return NULL;
+  
+  return devicesList[ taskID ];
+}
+
+static void DiscardDevice( ReplayDevice device )
+{
+  BinaryLog_CloseReader( device->reader );
+  free( device->channelsList );
+  free( device->timesList );
+  free( device->configString );
+  free( device );
+}
@@ -0,0 +1,1208 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file rigid_body_sim.c
+/// @brief Signal I/O plugin simulating forward dynamics of OpenSim multi-body models
+///
+/// Self-contained alternative to OpenSim based plug-ins for closed loop runs: bodies, joints and coordinates of .osim model files 
+/// (both 3.x and 4.x formats) are loaded into a kinematic tree, whose forward dynamics is integrated from the generalized forces written 
+/// to output channels. Device configuration string is the model file path (relative to the configuration root directory) followed by options:
+/// @code
+/// "<model_file> [step=<seconds>] [substeps=<substeps_number>] [damping=<value>] [armature=<value>] [realtime]"
+/// @endcode
+/// - step: simulated time per control cycle (default 0.005, the default control time step)
+/// - substeps: number of integration steps per simulation step (default 5)
+/// - damping: viscous friction coefficient applied to every simulated coordinate (default 0)
+/// - armature: inertia added to every simulated coordinate, keeping massless chains solvable (default 1e-6)
+/// - realtime: advance simulation by elapsed execution time on every read, instead of stepping once per control cycle (lockstep)
+///
+/// In lockstep mode, the simulation steps on every block read or, for single channel reads, when a channel already read since the last step is 
+/// read again (so each channel is expected to be read at most once per control cycle).
+///
+/// Simulated coordinates are the unlocked model ones driving pin, slider, weld or custom (linear transform functions) joints, numbered 
+/// by order of appearance. For the k-th coordinate, input channels 4k, 4k+1, 4k+2 and 4k+3 give position, velocity, acceleration and applied 
+/// generalized force, and output channel k sets the applied generalized force. Locked coordinates are kept at their default values, 
+/// transform axes driven by other functions (e.g. splines) are kept at zero, and muscles, forces and constraints are not simulated.
+/// Devices are shared among inputs and outputs with equal configuration strings.
+
+
+#include "signal_io/signal_io.h"
+#include "signal_io_extensions.h"
+
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define DEFAULT_STEP_TIME 0.005
+#define DEFAULT_SUBSTEPS_NUMBER 5
+#define DEFAULT_ARMATURE 1e-6
+#define MAX_REALTIME_INTERVAL 0.1
+#define CONFIG_DIRECTORY "config/"
+#define NAME_MAX_LENGTH 128
+#define JOINT_COORDINATES_MAX_NUMBER 6
+#define JOINT_AXES_MAX_NUMBER 6
+
+enum { POSITION_CHANNEL, VELOCITY_CHANNEL, ACCELERATION_CHANNEL, FORCE_CHANNEL, COORDINATE_CHANNELS_NUMBER };
+
+enum LinkJointType { JOINT_FIXED, JOINT_ROTATION, JOINT_TRANSLATION };
+
+// Plücker coordinates transform: rotation from parent to child frame coordinates and child frame origin in parent frame coordinates
+typedef struct _SpatialTransform
+{
+  double rotation[ 9 ];
+  double translation[ 3 ];
+}
+SpatialTransform;
+
+// Kinematic tree link: single degree of freedom elementary joint (or fixed body frame), with transform from parent link frame
+typedef struct _SimLink
+{
+  int parentIndex;
+  SpatialTransform treeTransform;
+  enum LinkJointType jointType;
+  double axis[ 3 ];
+  int coordinateIndex;
+  double slope, offset;
+  double mass;
+  double massCenter[ 3 ];
+  double inertia[ 9 ];
+  SpatialTransform transform;
+  double velocity[ 6 ], acceleration[ 6 ], force[ 6 ];
+}
+SimLink;
+
+typedef struct _SimCoordinate
+{
+  char name[ NAME_MAX_LENGTH ];
+  double defaultValue, defaultSpeed;
+  double range[ 2 ];
+  bool isClamped, isLocked;
+  int freeIndex;
+}
+SimCoordinate;
+
+typedef struct _SimBody
+{
+  char name[ NAME_MAX_LENGTH ];
+  int linkIndex;
+}
+SimBody;
+
+typedef struct _SimDeviceData
+{
+  char* configString;
+  size_t usersNumber;
+  double stepTime;
+  size_t substepsNumber;
+  double damping;
+  double armature;
+  bool isRealTime;
+  double lastTime;
+  double gravity[ 3 ];
+  SimLink* linksList;
+  size_t linksNumber;
+  SimBody* bodiesList;
+  size_t bodiesNumber;
+  SimCoordinate* coordinatesList;
+  size_t coordinatesNumber;
+  double* positionsList;
+  double* velocitiesList;
+  double* accelerationsList;
+  double* forcesList;
+  double* biasForcesList;
+  double* unitAccelerationsList;
+  double* massMatrix;
+  bool* channelsReadList;
+}
+SimDeviceData;
+
+typedef SimDeviceData* SimDevice;
+
+typedef struct _XMLElement
+{
+  char name[ NAME_MAX_LENGTH ];
+  char id[ NAME_MAX_LENGTH ];
+  const char* content;
+  const char* contentEnd;
+  const char* end;
+}
+XMLElement;
+
+static SimDevice* devicesList = NULL;
+static size_t devicesNumber = 0;
+
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE );
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_BLOCK_INTERFACE );
+
+static SimDevice GetDevice( long int );
+static void DiscardDevice( SimDevice );
+static bool LoadModel( SimDevice, const char* );
+static bool LoadModelBodies( SimDevice, const XMLElement* );
+static bool LoadModelJoints( SimDevice, const XMLElement*, const XMLElement* );
+static bool LoadJointFrame( const XMLElement*, const char*, char*, SpatialTransform* );
+static bool AddJoint( SimDevice, const XMLElement*, int, const SpatialTransform*, const SpatialTransform*, const XMLElement* );
+static int FindBody( SimDevice, const char* );
+static void ResetState( SimDevice );
+static void Simulate( SimDevice, double );
+static void SimulateStep( SimDevice, double );
+static void UpdateTransforms( SimDevice );
+static void GetInverseDynamics( SimDevice, const double*, const double*, bool, double* );
+static bool SolveCholesky( double*, double*, size_t );
+static double GetChannelValue( SimDevice, unsigned int );
+static void GetAxisRotation( const double*, double, double* );
+static void SetIdentityTransform( SpatialTransform* );
+static void GetOffsetTransform( const double*, const double*, SpatialTransform* );
+static void ComposeTransforms( const SpatialTransform*, const SpatialTransform*, SpatialTransform* );
+static void InvertTransform( const SpatialTransform*, SpatialTransform* );
+static void TransformMotion( const SpatialTransform*, const double*, double* );
+static void AddTransposedForce( const SpatialTransform*, const double*, double* );
+static bool FindElement( const char*, const char*, const char*, XMLElement* );
+static bool FindNamedElement( const char*, const char*, const char*, const char*, XMLElement* );
+static bool GetNextChild( const char*, const char*, XMLElement* );
+static bool ParseElement( const char*, const char*, XMLElement* );
+static size_t GetNumbers( const XMLElement*, const char*, double*, size_t );
+static bool GetText( const XMLElement*, const char*, char*, size_t );
+static bool GetBool( const XMLElement*, const char*, bool );
+
+long int InitDevice( const char* taskConfig )
+{
+  if( taskConfig == NULL ) return SIGNAL_IO_DEVICE_INVALID_ID;
+  
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    if( devicesList[ deviceIndex ] == NULL ) continue;
+    if( strcmp( devicesList[ deviceIndex ]->configString, taskConfig ) == 0 )
+    {
+      devicesList[ deviceIndex ]->usersNumber++;
+      return (long int) deviceIndex;
+    }
+  }
+  
+  SimDevice newDevice = (SimDevice) malloc( sizeof(SimDeviceData) );
+  memset( newDevice, 0, sizeof(SimDeviceData) );
+  newDevice->configString = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( newDevice->configString, taskConfig );
+  newDevice->usersNumber = 1;
+  newDevice->stepTime = DEFAULT_STEP_TIME;
+  newDevice->substepsNumber = DEFAULT_SUBSTEPS_NUMBER;
+  newDevice->armature = DEFAULT_ARMATURE;
+  
+  char* modelFileName = NULL;
+  char* configBuffer = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( configBuffer, taskConfig );
+  for( char* option = strtok( configBuffer, " " ); option != NULL; option = strtok( NULL, " " ) )
+  {
+    if( strncmp( option, "step=", 5 ) == 0 ) newDevice->stepTime = strtod( option + 5, NULL );
+    else if( strncmp( option, "substeps=", 9 ) == 0 ) newDevice->substepsNumber = (size_t) strtoul( option + 9, NULL, 10 );
+    else if( strncmp( option, "damping=", 8 ) == 0 ) newDevice->damping = strtod( option + 8, NULL );
+    else if( strncmp( option, "armature=", 9 ) == 0 ) newDevice->armature = strtod( option + 9, NULL );
+    else if( strcmp( option, "realtime" ) == 0 ) newDevice->isRealTime = true;
+    else if( modelFileName == NULL ) modelFileName = option;
+  }
+  
+  bool isConfigValid = ( modelFileName != NULL && newDevice->stepTime > 0.0 && newDevice->substepsNumber > 0 );
+  if( isConfigValid ) isConfigValid = LoadModel( newDevice, modelFileName );
+  free( configBuffer );
+  
+  if( !isConfigValid || newDevice->coordinatesNumber == 0 )
+  {
+    DiscardDevice( newDevice );
+    return SIGNAL_IO_DEVICE_INVALID_ID;
+  }
+  
+  ResetState( newDevice );
+  
+  size_t deviceIndex = 0;
+  while( deviceIndex < devicesNumber && devicesList[ deviceIndex ] != NULL ) deviceIndex++;
+  if( deviceIndex == devicesNumber ) devicesList = (SimDevice*) realloc( devicesList, ++devicesNumber * sizeof(SimDevice) );
+  devicesList[ deviceIndex ] = newDevice;
+  
+  return (long int) deviceIndex;
+}
+
+void EndDevice( long int taskID )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  if( --(device->usersNumber) > 0 ) return;
+  
+  DiscardDevice( device );
+  devicesList[ taskID ] = NULL;
+}
+
+size_t GetMaxInputSamplesNumber( long int taskID )
+{
+  return 1;
+}
+
+size_t Read( long int taskID, unsigned int channel, double* ref_value )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return 0;
+  
+  if( channel >= device->coordinatesNumber * COORDINATE_CHANNELS_NUMBER ) return 0;
+  
+  // Outside of block transfers, lockstep simulation advances when a channel is read again, which starts a new control cycle
+  if( device->isRealTime ) Simulate( device, Time_GetExecSeconds() - device->lastTime );
+  else if( device->channelsReadList[ channel ] ) Simulate( device, device->stepTime );
+  device->channelsReadList[ channel ] = true;
+  
+  *ref_value = GetChannelValue( device, channel );
+  
+  return 1;
+}
+
+bool HasError( long int taskID )
+{
+  return ( GetDevice( taskID ) == NULL );
+}
+
+void Reset( long int taskID )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  ResetState( device );
+}
+
+bool CheckInputChannel( long int taskID, unsigned int channel )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  return ( channel < device->coordinatesNumber * COORDINATE_CHANNELS_NUMBER );
+}
+
+bool Write( long int taskID, unsigned int channel, double value )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  if( channel >= device->coordinatesNumber ) return false;
+  
+  device->forcesList[ channel ] = value;
+  
+  return true;
+}
+
+bool AcquireOutputChannel( long int taskID, unsigned int channel )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  return ( channel < device->coordinatesNumber );
+}
+
+void ReleaseOutputChannel( long int taskID, unsigned int channel )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  if( channel < device->coordinatesNumber ) device->forcesList[ channel ] = 0.0;
+}
+
+bool ReadChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, double** buffersList, size_t* samplesCountsList )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  // Block reads happen once per control cycle: forces written on the previous cycle are applied for a whole simulation step
+  if( device->isRealTime ) Simulate( device, Time_GetExecSeconds() - device->lastTime );
+  else Simulate( device, device->stepTime );
+  
+  for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
+  {
+    samplesCountsList[ channelIndex ] = 0;
+    if( channelsList[ channelIndex ] >= device->coordinatesNumber * COORDINATE_CHANNELS_NUMBER ) continue;
+    buffersList[ channelIndex ][ 0 ] = GetChannelValue( device, channelsList[ channelIndex ] );
+    samplesCountsList[ channelIndex ] = 1;
+  }
+  
+  return true;
+}
+
+bool WriteChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, const double* valuesList )
+{
+  SimDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
+    Write( taskID, channelsList[ channelIndex ], valuesList[ channelIndex ] );
+  
+  return true;
+}
+
+
+static SimDevice GetDevice( long int taskID )
+{
+  if( taskID < 0 || (size_t) taskID >= devicesNumber ) return NULL;
+  
+  return devicesList[ taskID ];
+}
+
+static void DiscardDevice( SimDevice device )
+{
+  free( device->linksList );
+  free( device->bodiesList );
+  free( device->coordinatesList );
+  free( device->positionsList );
+  free( device->velocitiesList );
+  free( device->accelerationsList );
+  free( device->forcesList );
+  free( device->biasForcesList );
+  free( device->unitAccelerationsList );
+  free( device->massMatrix );
+  free( device->channelsReadList );
+  free( device->configString );
+  free( device );
+}
+
+// Reads model file and builds kinematic tree and simulation state buffers (nothing is allocated while simulating)
+static bool LoadModel( SimDevice device, const char* fileName )
+{
+  // Model path is relative to the configuration root directory, as other configuration files
+  char* filePath = (char*) calloc( strlen( CONFIG_DIRECTORY ) + strlen( fileName ) + 1, sizeof(char) );
+  sprintf( filePath, CONFIG_DIRECTORY "%s", fileName );
+  FILE* modelFile = fopen( filePath, "rb" );
+  free( filePath );
+  if( modelFile == NULL ) return false;
+  
+  fseek( modelFile, 0, SEEK_END );
+  long fileLength = ftell( modelFile );
+  fseek( modelFile, 0, SEEK_SET );
+  char* modelText = (char*) calloc( ( fileLength > 0 ) ? fileLength + 1 : 1, sizeof(char) );
+  size_t textLength = ( fileLength > 0 ) ? fread( modelText, sizeof(char), fileLength, modelFile ) : 0;
+  fclose( modelFile );
+  modelText[ textLength ] = '\0';
+  
+  bool isModelValid = false;
+  XMLElement model, bodySet;
+  if( FindElement( modelText, modelText + textLength, "Model", &model ) && FindElement( model.content, model.contentEnd, "BodySet", &bodySet ) )
+  {
+    GetNumbers( &model, "gravity", device->gravity, 3 );
+    
+    device->bodiesList = (SimBody*) calloc( 1, sizeof(SimBody) );
+    strcpy( device->bodiesList[ 0 ].name, "ground" );
+    device->bodiesList[ 0 ].linkIndex = -1;
+    device->bodiesNumber = 1;
+    
+    // Version 4 models list joints separately, while older ones define them inside child bodies
+    XMLElement jointSet;
+    if( FindElement( model.content, model.contentEnd, "JointSet", &jointSet ) ) isModelValid = LoadModelJoints( device, &bodySet, &jointSet );
+    else isModelValid = LoadModelBodies( device, &bodySet );
+  }
+  free( modelText );
+  
+  if( !isModelValid ) return false;
+  
+  size_t coordinatesNumber = device->coordinatesNumber;
+  device->positionsList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->velocitiesList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->accelerationsList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->forcesList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->biasForcesList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->unitAccelerationsList = (double*) calloc( coordinatesNumber, sizeof(double) );
+  device->massMatrix = (double*) calloc( coordinatesNumber * coordinatesNumber, sizeof(double) );
+  device->channelsReadList = (bool*) calloc( coordinatesNumber * COORDINATE_CHANNELS_NUMBER, sizeof(bool) );
+  
+  return true;
+}
+
+// Version 3 models: each body holds the joint to its parent body, listed before it
+static bool LoadModelBodies( SimDevice device, const XMLElement* bodySet )
+{
+  XMLElement bodies, body;
+  if( !FindElement( bodySet->content, bodySet->contentEnd, "objects", &bodies ) ) return false;
+  
+  for( const char* cursor = bodies.content; FindElement( cursor, bodies.contentEnd, "Body", &body ); cursor = body.end )
+  {
+    XMLElement jointHolder, joint;
+    if( !FindElement( body.content, body.contentEnd, "Joint", &jointHolder ) ) continue;
+    if( !GetNextChild( jointHolder.content, jointHolder.contentEnd, &joint ) )
+    {
+      // Bodies without joint are fixed to the ground
+      if( FindBody( device, body.id ) >= 0 ) continue;
+      device->bodiesList = (SimBody*) realloc( device->bodiesList, ( device->bodiesNumber + 1 ) * sizeof(SimBody) );
+      strncpy( device->bodiesList[ device->bodiesNumber ].name, body.id, NAME_MAX_LENGTH - 1 );
+      device->bodiesList[ device->bodiesNumber ].name[ NAME_MAX_LENGTH - 1 ] = '\0';
+      device->bodiesList[ device->bodiesNumber++ ].linkIndex = -1;
+      continue;
+    }
+    
+    char parentName[ NAME_MAX_LENGTH ] = "";
+    GetText( &joint, "parent_body", parentName, NAME_MAX_LENGTH );
+    int parentBodyIndex = FindBody( device, parentName );
+    if( parentBodyIndex < 0 ) return false;
+    
+    double location[ 3 ] = { 0.0 }, orientation[ 3 ] = { 0.0 };
+    SpatialTransform parentOffset, childOffset;
+    GetNumbers( &joint, "location_in_parent", location, 3 );
+    GetNumbers( &joint, "orientation_in_parent", orientation, 3 );
+    GetOffsetTransform( location, orientation, &parentOffset );
+    memset( location, 0, sizeof(location) );
+    memset( orientation, 0, sizeof(orientation) );
+    GetNumbers( &joint, "location", location, 3 );
+    GetNumbers( &joint, "orientation", orientation, 3 );
+    GetOffsetTransform( location, orientation, &childOffset );
+    
+    if( !AddJoint( device, &joint, device->bodiesList[ parentBodyIndex ].linkIndex, &parentOffset, &childOffset, &body ) ) return false;
+  }
+  
+  return true;
+}
+
+// Version 4 models: joints connect frames attached to bodies, and may be listed in any order
+static bool LoadModelJoints( SimDevice device, const XMLElement* bodySet, const XMLElement* jointSet )
+{
+  XMLElement joints, joint;
+  if( !FindElement( jointSet->content, jointSet->contentEnd, "objects", &joints ) ) return true;
+  
+  size_t jointsNumber = 0;
+  for( const char* cursor = joints.content; GetNextChild( cursor, joints.contentEnd, &joint ); cursor = joint.end )
+    jointsNumber++;
+  
+  for( size_t addedJointsNumber = 0; addedJointsNumber < jointsNumber; )
+  {
+    size_t lastAddedJointsNumber = addedJointsNumber;
+    for( const char* cursor = joints.content; GetNextChild( cursor, joints.contentEnd, &joint ); cursor = joint.end )
+    {
+      char parentName[ NAME_MAX_LENGTH ], childName[ NAME_MAX_LENGTH ];
+      SpatialTransform parentOffset, childOffset;
+      if( !LoadJointFrame( &joint, "socket_parent_frame", parentName, &parentOffset ) ) return false;
+      if( !LoadJointFrame( &joint, "socket_child_frame", childName, &childOffset ) ) return false;
+      // Skip joints already added or whose parent body is not added yet
+      int parentBodyIndex = FindBody( device, parentName );
+      if( FindBody( device, childName ) >= 0 || parentBodyIndex < 0 ) continue;
+      
+      XMLElement body;
+      if( !FindNamedElement( bodySet->content, bodySet->contentEnd, "Body", childName, &body ) ) return false;
+      
+      if( !AddJoint( device, &joint, device->bodiesList[ parentBodyIndex ].linkIndex, &parentOffset, &childOffset, &body ) ) return false;
+      addedJointsNumber++;
+    }
+    // Joints left have no path to ground (or form loops)
+    if( addedJointsNumber == lastAddedJointsNumber ) return false;
+  }
+  
+  return true;
+}
+
+// Resolves joint socket frame into its body name and frame offset transform in body
+static bool LoadJointFrame( const XMLElement* joint, const char* socketName, char* bodyName, SpatialTransform* ref_offset )
+{
+  char framePath[ NAME_MAX_LENGTH ] = "";
+  if( !GetText( joint, socketName, framePath, NAME_MAX_LENGTH ) ) return false;
+  
+  double translation[ 3 ] = { 0.0 }, orientation[ 3 ] = { 0.0 };
+  XMLElement frames, frame;
+  if( FindElement( joint->content, joint->contentEnd, "frames", &frames ) && FindNamedElement( frames.content, frames.contentEnd, "PhysicalOffsetFrame", framePath, &frame ) )
+  {
+    GetText( &frame, "socket_parent", framePath, NAME_MAX_LENGTH );
+    GetNumbers( &frame, "translation", translation, 3 );
+    GetNumbers( &frame, "orientation", orientation, 3 );
+  }
+  GetOffsetTransform( translation, orientation, ref_offset );
+  
+  // Frames not defined by the joint are given by their body paths (e.g. "/bodyset/body_0")
+  strcpy( bodyName, ( strrchr( framePath, '/' ) != NULL ) ? strrchr( framePath, '/' ) + 1 : framePath );
+  
+  return true;
+}
+
+// Appends joint elementary transforms as links (one per simulated degree of freedom, others folded into fixed transforms) and child body link
+static bool AddJoint( SimDevice device, const XMLElement* joint, int parentLinkIndex, const SpatialTransform* parentOffset, 
+                      const SpatialTransform* childOffset, const XMLElement* body )
+{
+  const double X_AXIS[ 3 ] = { 1.0, 0.0, 0.0 };
+  const double Z_AXIS[ 3 ] = { 0.0, 0.0, 1.0 };
+  
+  if( FindBody( device, body->id ) >= 0 ) return false;
+  
+  SimCoordinate coordinatesList[ JOINT_COORDINATES_MAX_NUMBER ];
+  size_t coordinatesNumber = 0;
+  XMLElement coordinate;
+  for( const char* cursor = joint->content; FindElement( cursor, joint->contentEnd, "Coordinate", &coordinate ); cursor = coordinate.end )
+  {
+    if( coordinatesNumber == JOINT_COORDINATES_MAX_NUMBER ) return false;
+    SimCoordinate* newCoordinate = &(coordinatesList[ coordinatesNumber++ ]);
+    strncpy( newCoordinate->name, coordinate.id, NAME_MAX_LENGTH - 1 );
+    newCoordinate->name[ NAME_MAX_LENGTH - 1 ] = '\0';
+    newCoordinate->defaultValue = newCoordinate->defaultSpeed = 0.0;
+    GetNumbers( &coordinate, "default_value", &(newCoordinate->defaultValue), 1 );
+    GetNumbers( &coordinate, "default_speed_value", &(newCoordinate->defaultSpeed), 1 );
+    newCoordinate->range[ 0 ] = -HUGE_VAL;
+    newCoordinate->range[ 1 ] = HUGE_VAL;
+    GetNumbers( &coordinate, "range", newCoordinate->range, 2 );
+    newCoordinate->isClamped = GetBool( &coordinate, "clamped", false );
+    newCoordinate->isLocked = GetBool( &coordinate, "locked", false );
+    newCoordinate->freeIndex = -1;
+  }
+  
+  // Elementary transforms: joint coordinate index (-1 for none), slope and offset of linear function of coordinate
+  enum LinkJointType axisTypesList[ JOINT_AXES_MAX_NUMBER ];
+  double axesList[ JOINT_AXES_MAX_NUMBER ][ 3 ];
+  int axisCoordinatesList[ JOINT_AXES_MAX_NUMBER ];
+  double axisSlopesList[ JOINT_AXES_MAX_NUMBER ], axisOffsetsList[ JOINT_AXES_MAX_NUMBER ];
+  size_t axesNumber = 0;
+  if( strcmp( joint->name, "PinJoint" ) == 0 || strcmp( joint->name, "SliderJoint" ) == 0 )
+  {
+    if( coordinatesNumber != 1 ) return false;
+    axisTypesList[ 0 ] = ( strcmp( joint->name, "PinJoint" ) == 0 ) ? JOINT_ROTATION : JOINT_TRANSLATION;
+    memcpy( axesList[ 0 ], ( axisTypesList[ 0 ] == JOINT_ROTATION ) ? Z_AXIS : X_AXIS, 3 * sizeof(double) );
+    axisCoordinatesList[ 0 ] = 0;
+    axisSlopesList[ 0 ] = 1.0;
+    axisOffsetsList[ 0 ] = 0.0;
+    axesNumber = 1;
+  }
+  else if( strcmp( joint->name, "CustomJoint" ) == 0 )
+  {
+    // Translations are applied along parent frame axes, before the ordered rotations
+    const char* AXIS_NAMES[ JOINT_AXES_MAX_NUMBER ] = { "translation1", "translation2", "translation3", "rotation1", "rotation2", "rotation3" };
+    XMLElement spatialTransform, transformAxis;
+    if( !FindElement( joint->content, joint->contentEnd, "SpatialTransform", &spatialTransform ) ) return false;
+    for( size_t axisIndex = 0; axisIndex < JOINT_AXES_MAX_NUMBER; axisIndex++ )
+    {
+      if( !FindNamedElement( spatialTransform.content, spatialTransform.contentEnd, "TransformAxis", AXIS_NAMES[ axisIndex ], &transformAxis ) ) continue;
+      
+      axisTypesList[ axesNumber ] = ( axisIndex < 3 ) ? JOINT_TRANSLATION : JOINT_ROTATION;
+      memset( axesList[ axesNumber ], 0, 3 * sizeof(double) );
+      if( GetNumbers( &transformAxis, "axis", axesList[ axesNumber ], 3 ) != 3 ) continue;
+      double axisNorm = sqrt( axesList[ axesNumber ][ 0 ] * axesList[ axesNumber ][ 0 ] + axesList[ axesNumber ][ 1 ] * axesList[ axesNumber ][ 1 ] 
+                              + axesList[ axesNumber ][ 2 ] * axesList[ axesNumber ][ 2 ] );
+      if( axisNorm == 0.0 ) continue;
+      for( size_t i = 0; i < 3; i++ )
+        axesList[ axesNumber ][ i ] /= axisNorm;
+      
+      char coordinateName[ NAME_MAX_LENGTH ] = "";
+      GetText( &transformAxis, "coordinates", coordinateName, NAME_MAX_LENGTH );
+      axisCoordinatesList[ axesNumber ] = -1;
+      for( size_t coordinateIndex = 0; coordinateIndex < coordinatesNumber; coordinateIndex++ )
+      {
+        if( strcmp( coordinatesList[ coordinateIndex ].name, coordinateName ) == 0 ) axisCoordinatesList[ axesNumber ] = (int) coordinateIndex;
+      }
+      
+      // Linear and constant functions (possibly scaled) are supported. Missing function means identity
+      axisSlopesList[ axesNumber ] = ( axisCoordinatesList[ axesNumber ] >= 0 ) ? 1.0 : 0.0;
+      axisOffsetsList[ axesNumber ] = 0.0;
+      XMLElement function, multiplier, linear, constant;
+      if( FindElement( transformAxis.content, transformAxis.contentEnd, "function", &function ) )
+      {
+        double scale = 1.0, coefficientsList[ 2 ] = { 0.0, 0.0 };
+        if( FindElement( function.content, function.contentEnd, "MultiplierFunction", &multiplier ) )
+        {
+          GetNumbers( &multiplier, "scale", &scale, 1 );
+          function = multiplier;
+        }
+        axisSlopesList[ axesNumber ] = 0.0;
+        if( FindElement( function.content, function.contentEnd, "LinearFunction", &linear ) )
+        {
+          GetNumbers( &linear, "coefficients", coefficientsList, 2 );
+          axisSlopesList[ axesNumber ] = scale * coefficientsList[ 0 ];
+          axisOffsetsList[ axesNumber ] = scale * coefficientsList[ 1 ];
+        }
+        else if( FindElement( function.content, function.contentEnd, "Constant", &constant ) )
+        {
+          GetNumbers( &constant, "value", coefficientsList, 1 );
+          axisOffsetsList[ axesNumber ] = scale * coefficientsList[ 0 ];
+        }
+      }
+      axesNumber++;
+    }
+  }
+  else if( strcmp( joint->name, "WeldJoint" ) != 0 ) return false;
+  
+  SpatialTransform pendingTransform = *parentOffset;
+  for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+  {
+    int jointCoordinateIndex = axisCoordinatesList[ axisIndex ];
+    SimCoordinate* axisCoordinate = ( jointCoordinateIndex >= 0 ) ? &(coordinatesList[ jointCoordinateIndex ]) : NULL;
+    if( axisCoordinate != NULL && !axisCoordinate->isLocked && axisSlopesList[ axisIndex ] != 0.0 )
+    {
+      // Unlocked coordinates become simulated ones on first use
+      if( axisCoordinate->freeIndex < 0 )
+      {
+        axisCoordinate->freeIndex = (int) device->coordinatesNumber;
+        device->coordinatesList = (SimCoordinate*) realloc( device->coordinatesList, ++(device->coordinatesNumber) * sizeof(SimCoordinate) );
+        device->coordinatesList[ axisCoordinate->freeIndex ] = *axisCoordinate;
+      }
+      
+      device->linksList = (SimLink*) realloc( device->linksList, ( device->linksNumber + 1 ) * sizeof(SimLink) );
+      SimLink* newLink = &(device->linksList[ device->linksNumber ]);
+      memset( newLink, 0, sizeof(SimLink) );
+      newLink->parentIndex = parentLinkIndex;
+      newLink->treeTransform = pendingTransform;
+      newLink->jointType = axisTypesList[ axisIndex ];
+      memcpy( newLink->axis, axesList[ axisIndex ], 3 * sizeof(double) );
+      newLink->coordinateIndex = axisCoordinate->freeIndex;
+      newLink->slope = axisSlopesList[ axisIndex ];
+      newLink->offset = axisOffsetsList[ axisIndex ];
+      parentLinkIndex = (int) device->linksNumber++;
+      SetIdentityTransform( &pendingTransform );
+    }
+    else
+    {
+      // Fixed elementary transforms are folded into the next link one
+      double value = axisOffsetsList[ axisIndex ];
+      if( axisCoordinate != NULL ) value += axisSlopesList[ axisIndex ] * axisCoordinate->defaultValue;
+      if( value == 0.0 ) continue;
+      SpatialTransform axisTransform, composedTransform;
+      SetIdentityTransform( &axisTransform );
+      if( axisTypesList[ axisIndex ] == JOINT_ROTATION ) GetAxisRotation( axesList[ axisIndex ], -value, axisTransform.rotation );
+      else
+      {
+        for( size_t i = 0; i < 3; i++ )
+          axisTransform.translation[ i ] = value * axesList[ axisIndex ][ i ];
+      }
+      ComposeTransforms( &pendingTransform, &axisTransform, &composedTransform );
+      pendingTransform = composedTransform;
+    }
+  }
+  
+  // Child body frame link, holding body inertia (center of mass and inertia matrix in body frame)
+  device->linksList = (SimLink*) realloc( device->linksList, ( device->linksNumber + 1 ) * sizeof(SimLink) );
+  SimLink* bodyLink = &(device->linksList[ device->linksNumber ]);
+  memset( bodyLink, 0, sizeof(SimLink) );
+  bodyLink->parentIndex = parentLinkIndex;
+  bodyLink->jointType = JOINT_FIXED;
+  bodyLink->coordinateIndex = -1;
+  SpatialTransform bodyTransform;
+  InvertTransform( childOffset, &bodyTransform );
+  ComposeTransforms( &pendingTransform, &bodyTransform, &(bodyLink->treeTransform) );
+  GetNumbers( body, "mass", &(bodyLink->mass), 1 );
+  GetNumbers( body, "mass_center", bodyLink->massCenter, 3 );
+  double inertiaList[ 6 ] = { 0.0 };
+  if( GetNumbers( body, "inertia", inertiaList, 6 ) == 0 )
+  {
+    const char* INERTIA_NAMES[ 6 ] = { "inertia_xx", "inertia_yy", "inertia_zz", "inertia_xy", "inertia_xz", "inertia_yz" };
+    for( size_t i = 0; i < 6; i++ )
+      GetNumbers( body, INERTIA_NAMES[ i ], &(inertiaList[ i ]), 1 );
+  }
+  double* inertia = bodyLink->inertia;
+  inertia[ 0 ] = inertiaList[ 0 ]; inertia[ 1 ] = inertiaList[ 3 ]; inertia[ 2 ] = inertiaList[ 4 ];
+  inertia[ 3 ] = inertiaList[ 3 ]; inertia[ 4 ] = inertiaList[ 1 ]; inertia[ 5 ] = inertiaList[ 5 ];
+  inertia[ 6 ] = inertiaList[ 4 ]; inertia[ 7 ] = inertiaList[ 5 ]; inertia[ 8 ] = inertiaList[ 2 ];
+  
+  device->bodiesList = (SimBody*) realloc( device->bodiesList, ( device->bodiesNumber + 1 ) * sizeof(SimBody) );
+  strncpy( device->bodiesList[ device->bodiesNumber ].name, body->id, NAME_MAX_LENGTH - 1 );
+  device->bodiesList[ device->bodiesNumber ].name[ NAME_MAX_LENGTH - 1 ] = '\0';
+  device->bodiesList[ device->bodiesNumber++ ].linkIndex = (int) device->linksNumber++;
+  
+  return true;
+}
+
+static int FindBody( SimDevice device, const char* bodyName )
+{
+  for( size_t bodyIndex = 0; bodyIndex < device->bodiesNumber; bodyIndex++ )
+  {
+    if( strcmp( device->bodiesList[ bodyIndex ].name, bodyName ) == 0 ) return (int) bodyIndex;
+  }
+  
+  return -1;
+}
+
+static void ResetState( SimDevice device )
+{
+  for( size_t coordinateIndex = 0; coordinateIndex < device->coordinatesNumber; coordinateIndex++ )
+  {
+    device->positionsList[ coordinateIndex ] = device->coordinatesList[ coordinateIndex ].defaultValue;
+    device->velocitiesList[ coordinateIndex ] = device->coordinatesList[ coordinateIndex ].defaultSpeed;
+    device->accelerationsList[ coordinateIndex ] = 0.0;
+    device->forcesList[ coordinateIndex ] = 0.0;
+  }
+  memset( device->channelsReadList, 0, device->coordinatesNumber * COORDINATE_CHANNELS_NUMBER * sizeof(bool) );
+  device->lastTime = Time_GetExecSeconds();
+}
+
+// Integrates given time interval in substeps no longer than configured ones (real-time catch up is limited)
+static void Simulate( SimDevice device, double duration )
+{
+  memset( device->channelsReadList, 0, device->coordinatesNumber * COORDINATE_CHANNELS_NUMBER * sizeof(bool) );
+  device->lastTime = Time_GetExecSeconds();
+  if( duration <= 0.0 ) return;
+  if( duration > MAX_REALTIME_INTERVAL && device->isRealTime ) duration = MAX_REALTIME_INTERVAL;
+  
+  double maxSubstepTime = device->stepTime / device->substepsNumber;
+  size_t substepsNumber = (size_t) ceil( duration / maxSubstepTime - 1e-9 );
+  if( substepsNumber == 0 ) substepsNumber = 1;
+  for( size_t substepIndex = 0; substepIndex < substepsNumber; substepIndex++ )
+    SimulateStep( device, duration / substepsNumber );
+}
+
+// Semi-implicit Euler step of forward dynamics: H(q) * qdd = tau - C(q,qd), with mass matrix built column by column from inverse dynamics
+static void SimulateStep( SimDevice device, double timeStep )
+{
+  size_t coordinatesNumber = device->coordinatesNumber;
+  
+  UpdateTransforms( device );
+  
+  GetInverseDynamics( device, device->velocitiesList, NULL, true, device->biasForcesList );
+  for( size_t columnIndex = 0; columnIndex < coordinatesNumber; columnIndex++ )
+  {
+    device->unitAccelerationsList[ columnIndex ] = 1.0;
+    GetInverseDynamics( device, NULL, device->unitAccelerationsList, false, device->accelerationsList );
+    device->unitAccelerationsList[ columnIndex ] = 0.0;
+    for( size_t rowIndex = 0; rowIndex < coordinatesNumber; rowIndex++ )
+      device->massMatrix[ rowIndex * coordinatesNumber + columnIndex ] = device->accelerationsList[ rowIndex ];
+    device->massMatrix[ columnIndex * coordinatesNumber + columnIndex ] += device->armature;
+  }
+  
+  for( size_t coordinateIndex = 0; coordinateIndex < coordinatesNumber; coordinateIndex++ )
+  {
+    device->accelerationsList[ coordinateIndex ] = device->forcesList[ coordinateIndex ] - device->biasForcesList[ coordinateIndex ]
+                                                   - device->damping * device->velocitiesList[ coordinateIndex ];
+  }
+  if( !SolveCholesky( device->massMatrix, device->accelerationsList, coordinatesNumber ) )
+    memset( device->accelerationsList, 0, coordinatesNumber * sizeof(double) );
+  
+  for( size_t coordinateIndex = 0; coordinateIndex < coordinatesNumber; coordinateIndex++ )
+  {
+    SimCoordinate* coordinate = &(device->coordinatesList[ coordinateIndex ]);
+    device->velocitiesList[ coordinateIndex ] += device->accelerationsList[ coordinateIndex ] * timeStep;
+    device->positionsList[ coordinateIndex ] += device->velocitiesList[ coordinateIndex ] * timeStep;
+    // Clamped coordinates stop at range limits
+    if( !coordinate->isClamped ) continue;
+    if( device->positionsList[ coordinateIndex ] < coordinate->range[ 0 ] || device->positionsList[ coordinateIndex ] > coordinate->range[ 1 ] )
+    {
+      device->positionsList[ coordinateIndex ] = fmax( coordinate->range[ 0 ], fmin( device->positionsList[ coordinateIndex ], coordinate->range[ 1 ] ) );
+      device->velocitiesList[ coordinateIndex ] = 0.0;
+    }
+  }
+}
+
+// Computes current transforms between consecutive links (joint motion applied after fixed tree transform)
+static void UpdateTransforms( SimDevice device )
+{
+  for( size_t linkIndex = 0; linkIndex < device->linksNumber; linkIndex++ )
+  {
+    SimLink* link = &(device->linksList[ linkIndex ]);
+    link->transform = link->treeTransform;
+    if( link->jointType == JOINT_FIXED ) continue;
+    
+    double value = link->slope * device->positionsList[ link->coordinateIndex ] + link->offset;
+    SpatialTransform jointTransform;
+    SetIdentityTransform( &jointTransform );
+    if( link->jointType == JOINT_ROTATION ) GetAxisRotation( link->axis, -value, jointTransform.rotation );
+    else
+    {
+      for( size_t i = 0; i < 3; i++ )
+        jointTransform.translation[ i ] = value * link->axis[ i ];
+    }
+    ComposeTransforms( &(link->treeTransform), &jointTransform, &(link->transform) );
+  }
+}
+
+// Recursive Newton-Euler algorithm: generalized forces for given coordinate velocities and accelerations (NULL for zero), with optional gravity
+static void GetInverseDynamics( SimDevice device, const double* velocitiesList, const double* accelerationsList, bool hasGravity, double* forcesList )
+{
+  const double ZERO_MOTION[ 6 ] = { 0.0 };
+  // Gravity is accounted for as an upward acceleration of the ground
+  double groundAcceleration[ 6 ] = { 0.0 };
+  for( size_t i = 0; i < 3 && hasGravity; i++ )
+    groundAcceleration[ 3 + i ] = -device->gravity[ i ];
+  
+  for( size_t linkIndex = 0; linkIndex < device->linksNumber; linkIndex++ )
+  {
+    SimLink* link = &(device->linksList[ linkIndex ]);
+    SimLink* parentLink = ( link->parentIndex >= 0 ) ? &(device->linksList[ link->parentIndex ]) : NULL;
+    TransformMotion( &(link->transform), ( parentLink != NULL ) ? parentLink->velocity : ZERO_MOTION, link->velocity );
+    TransformMotion( &(link->transform), ( parentLink != NULL ) ? parentLink->acceleration : groundAcceleration, link->acceleration );
+    
+    if( link->jointType != JOINT_FIXED )
+    {
+      double jointMotion[ 6 ] = { 0.0 };
+      memcpy( jointMotion + ( ( link->jointType == JOINT_ROTATION ) ? 0 : 3 ), link->axis, 3 * sizeof(double) );
+      double speed = ( velocitiesList != NULL ) ? link->slope * velocitiesList[ link->coordinateIndex ] : 0.0;
+      double acceleration = ( accelerationsList != NULL ) ? link->slope * accelerationsList[ link->coordinateIndex ] : 0.0;
+      for( size_t i = 0; i < 6; i++ )
+      {
+        link->velocity[ i ] += jointMotion[ i ] * speed;
+        link->acceleration[ i ] += jointMotion[ i ] * acceleration;
+      }
+      // Velocity product term: v x (S * qd)
+      const double* w = link->velocity;
+      const double* v = link->velocity + 3;
+      const double* s = jointMotion;
+      link->acceleration[ 0 ] += ( w[ 1 ] * s[ 2 ] - w[ 2 ] * s[ 1 ] ) * speed;
+      link->acceleration[ 1 ] += ( w[ 2 ] * s[ 0 ] - w[ 0 ] * s[ 2 ] ) * speed;
+      link->acceleration[ 2 ] += ( w[ 0 ] * s[ 1 ] - w[ 1 ] * s[ 0 ] ) * speed;
+      link->acceleration[ 3 ] += ( w[ 1 ] * s[ 5 ] - w[ 2 ] * s[ 4 ] + v[ 1 ] * s[ 2 ] - v[ 2 ] * s[ 1 ] ) * speed;
+      link->acceleration[ 4 ] += ( w[ 2 ] * s[ 3 ] - w[ 0 ] * s[ 5 ] + v[ 2 ] * s[ 0 ] - v[ 0 ] * s[ 2 ] ) * speed;
+      link->acceleration[ 5 ] += ( w[ 0 ] * s[ 4 ] - w[ 1 ] * s[ 3 ] + v[ 0 ] * s[ 1 ] - v[ 1 ] * s[ 0 ] ) * speed;
+    }
+    
+    // Body force: f = I * a + v x* ( I * v ), with spatial inertia given by mass, center of mass c and rotational inertia about it
+    memset( link->force, 0, 6 * sizeof(double) );
+    if( link->mass == 0.0 ) continue;
+    double momentumList[ 2 ][ 6 ];
+    const double* motionsList[ 2 ] = { link->acceleration, link->velocity };
+    for( size_t motionIndex = 0; motionIndex < 2; motionIndex++ )
+    {
+      const double* w = motionsList[ motionIndex ];
+      const double* c = link->massCenter;
+      const double* I = link->inertia;
+      double* h = momentumList[ motionIndex ];
+      double centerVelocity[ 3 ] = { w[ 3 ] + w[ 1 ] * c[ 2 ] - w[ 2 ] * c[ 1 ], w[ 4 ] + w[ 2 ] * c[ 0 ] - w[ 0 ] * c[ 2 ], 
+                                     w[ 5 ] + w[ 0 ] * c[ 1 ] - w[ 1 ] * c[ 0 ] };
+      for( size_t i = 0; i < 3; i++ )
+      {
+        h[ 3 + i ] = link->mass * centerVelocity[ i ];
+        h[ i ] = I[ 3 * i ] * w[ 0 ] + I[ 3 * i + 1 ] * w[ 1 ] + I[ 3 * i + 2 ] * w[ 2 ];
+      }
+      h[ 0 ] += c[ 1 ] * h[ 5 ] - c[ 2 ] * h[ 4 ];
+      h[ 1 ] += c[ 2 ] * h[ 3 ] - c[ 0 ] * h[ 5 ];
+      h[ 2 ] += c[ 0 ] * h[ 4 ] - c[ 1 ] * h[ 3 ];
+    }
+    const double* w = link->velocity;
+    const double* v = link->velocity + 3;
+    const double* h = momentumList[ 1 ];
+    link->force[ 0 ] = momentumList[ 0 ][ 0 ] + w[ 1 ] * h[ 2 ] - w[ 2 ] * h[ 1 ] + v[ 1 ] * h[ 5 ] - v[ 2 ] * h[ 4 ];
+    link->force[ 1 ] = momentumList[ 0 ][ 1 ] + w[ 2 ] * h[ 0 ] - w[ 0 ] * h[ 2 ] + v[ 2 ] * h[ 3 ] - v[ 0 ] * h[ 5 ];
+    link->force[ 2 ] = momentumList[ 0 ][ 2 ] + w[ 0 ] * h[ 1 ] - w[ 1 ] * h[ 0 ] + v[ 0 ] * h[ 4 ] - v[ 1 ] * h[ 3 ];
+    link->force[ 3 ] = momentumList[ 0 ][ 3 ] + w[ 1 ] * h[ 5 ] - w[ 2 ] * h[ 4 ];
+    link->force[ 4 ] = momentumList[ 0 ][ 4 ] + w[ 2 ] * h[ 3 ] - w[ 0 ] * h[ 5 ];
+    link->force[ 5 ] = momentumList[ 0 ][ 5 ] + w[ 0 ] * h[ 4 ] - w[ 1 ] * h[ 3 ];
+  }
+  
+  memset( forcesList, 0, device->coordinatesNumber * sizeof(double) );
+  for( size_t linkIndex = device->linksNumber; linkIndex > 0; linkIndex-- )
+  {
+    SimLink* link = &(device->linksList[ linkIndex - 1 ]);
+    if( link->jointType != JOINT_FIXED )
+    {
+      const double* f = link->force + ( ( link->jointType == JOINT_ROTATION ) ? 0 : 3 );
+      forcesList[ link->coordinateIndex ] += link->slope * ( link->axis[ 0 ] * f[ 0 ] + link->axis[ 1 ] * f[ 1 ] + link->axis[ 2 ] * f[ 2 ] );
+    }
+    if( link->parentIndex >= 0 ) AddTransposedForce( &(link->transform), link->force, device->linksList[ link->parentIndex ].force );
+  }
+}
+
+// Solves symmetric positive definite system in place (matrix is overwritten with its Cholesky factor, vector with the solution)
+static bool SolveCholesky( double* matrix, double* vector, size_t size )
+{
+  for( size_t columnIndex = 0; columnIndex < size; columnIndex++ )
+  {
+    double pivot = matrix[ columnIndex * size + columnIndex ];
+    for( size_t k = 0; k < columnIndex; k++ )
+      pivot -= matrix[ columnIndex * size + k ] * matrix[ columnIndex * size + k ];
+    if( pivot <= 0.0 ) return false;
+    pivot = sqrt( pivot );
+    matrix[ columnIndex * size + columnIndex ] = pivot;
+    for( size_t rowIndex = columnIndex + 1; rowIndex < size; rowIndex++ )
+    {
+      double value = matrix[ rowIndex * size + columnIndex ];
+      for( size_t k = 0; k < columnIndex; k++ )
+        value -= matrix[ rowIndex * size + k ] * matrix[ columnIndex * size + k ];
+      matrix[ rowIndex * size + columnIndex ] = value / pivot;
+    }
+  }
+  
+  for( size_t rowIndex = 0; rowIndex < size; rowIndex++ )
+  {
+    for( size_t k = 0; k < rowIndex; k++ )
+      vector[ rowIndex ] -= matrix[ rowIndex * size + k ] * vector[ k ];
+    vector[ rowIndex ] /= matrix[ rowIndex * size + rowIndex ];
+  }
+  for( size_t rowIndex = size; rowIndex > 0; rowIndex-- )
+  {
+    for( size_t k = rowIndex; k < size; k++ )
+      vector[ rowIndex - 1 ] -= matrix[ k * size + rowIndex - 1 ] * vector[ k ];
+    vector[ rowIndex - 1 ] /= matrix[ ( rowIndex - 1 ) * size + rowIndex - 1 ];
+  }
+  
+  return true;
+}
+
+static double GetChannelValue( SimDevice device, unsigned int channel )
+{
+  size_t coordinateIndex = channel / COORDINATE_CHANNELS_NUMBER;
+  if( channel % COORDINATE_CHANNELS_NUMBER == POSITION_CHANNEL ) return device->positionsList[ coordinateIndex ];
+  else if( channel % COORDINATE_CHANNELS_NUMBER == VELOCITY_CHANNEL ) return device->velocitiesList[ coordinateIndex ];
+  else if( channel % COORDINATE_CHANNELS_NUMBER == ACCELERATION_CHANNEL ) return device->accelerationsList[ coordinateIndex ];
+  
+  return device->forcesList[ coordinateIndex ];
+}
+
+// Rotation matrix of given angle about unit axis (Rodrigues formula)
+static void GetAxisRotation( const double* axis, double angle, double* rotation )
+{
+  double cosine = cos( angle ), sine = sin( angle );
+  for( size_t i = 0; i < 3; i++ )
+  {
+    for( size_t j = 0; j < 3; j++ )
+      rotation[ 3 * i + j ] = ( 1.0 - cosine ) * axis[ i ] * axis[ j ] + ( ( i == j ) ? cosine : 0.0 );
+  }
+  rotation[ 1 ] -= sine * axis[ 2 ]; rotation[ 2 ] += sine * axis[ 1 ];
+  rotation[ 3 ] += sine * axis[ 2 ]; rotation[ 5 ] -= sine * axis[ 0 ];
+  rotation[ 6 ] -= sine * axis[ 1 ]; rotation[ 7 ] += sine * axis[ 0 ];
+}
+
+static void SetIdentityTransform( SpatialTransform* ref_transform )
+{
+  memset( ref_transform, 0, sizeof(SpatialTransform) );
+  ref_transform->rotation[ 0 ] = ref_transform->rotation[ 4 ] = ref_transform->rotation[ 8 ] = 1.0;
+}
+
+// Transform to frame at given position and body fixed X-Y-Z rotation angles (OpenSim convention)
+static void GetOffsetTransform( const double* translation, const double* orientation, SpatialTransform* ref_transform )
+{
+  const double AXES[ 3 ][ 3 ] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  
+  SetIdentityTransform( ref_transform );
+  memcpy( ref_transform->translation, translation, 3 * sizeof(double) );
+  // Coordinates rotation is the transpose of frame rotation: ( Rx * Ry * Rz )^T = Rz^T * Ry^T * Rx^T
+  for( size_t axisIndex = 0; axisIndex < 3; axisIndex++ )
+  {
+    if( orientation[ axisIndex ] == 0.0 ) continue;
+    double axisRotation[ 9 ], rotation[ 9 ];
+    GetAxisRotation( AXES[ axisIndex ], -orientation[ axisIndex ], axisRotation );
+    for( size_t i = 0; i < 3; i++ )
+    {
+      for( size_t j = 0; j < 3; j++ )
+        rotation[ 3 * i + j ] = axisRotation[ 3 * i ] * ref_transform->rotation[ j ] + axisRotation[ 3 * i + 1 ] * ref_transform->rotation[ 3 + j ] 
+                                + axisRotation[ 3 * i + 2 ] * ref_transform->rotation[ 6 + j ];
+    }
+    memcpy( ref_transform->rotation, rotation, 9 * sizeof(double) );
+  }
+}
+
+// Composition of transform from frame A to B with transform from frame B to C
+static void ComposeTransforms( const SpatialTransform* transformAB, const SpatialTransform* transformBC, SpatialTransform* ref_transformAC )
+{
+  const double* E1 = transformAB->rotation;
+  const double* E2 = transformBC->rotation;
+  for( size_t i = 0; i < 3; i++ )
+  {
+    for( size_t j = 0; j < 3; j++ )
+      ref_transformAC->rotation[ 3 * i + j ] = E2[ 3 * i ] * E1[ j ] + E2[ 3 * i + 1 ] * E1[ 3 + j ] + E2[ 3 * i + 2 ] * E1[ 6 + j ];
+    const double* r = transformBC->translation;
+    ref_transformAC->translation[ i ] = transformAB->translation[ i ] + E1[ i ] * r[ 0 ] + E1[ 3 + i ] * r[ 1 ] + E1[ 6 + i ] * r[ 2 ];
+  }
+}
+
+static void InvertTransform( const SpatialTransform* transform, SpatialTransform* ref_inverse )
+{
+  const double* E = transform->rotation;
+  const double* r = transform->translation;
+  for( size_t i = 0; i < 3; i++ )
+  {
+    for( size_t j = 0; j < 3; j++ )
+      ref_inverse->rotation[ 3 * i + j ] = E[ 3 * j + i ];
+    ref_inverse->translation[ i ] = -( E[ 3 * i ] * r[ 0 ] + E[ 3 * i + 1 ] * r[ 1 ] + E[ 3 * i + 2 ] * r[ 2 ] );
+  }
+}
+
+// Motion vector from parent to child frame coordinates: w' = E * w, v' = E * ( v - r x w )
+static void TransformMotion( const SpatialTransform* transform, const double* motion, double* ref_motion )
+{
+  const double* E = transform->rotation;
+  const double* r = transform->translation;
+  const double* w = motion;
+  double v[ 3 ] = { motion[ 3 ] - ( r[ 1 ] * w[ 2 ] - r[ 2 ] * w[ 1 ] ), motion[ 4 ] - ( r[ 2 ] * w[ 0 ] - r[ 0 ] * w[ 2 ] ), 
+                    motion[ 5 ] - ( r[ 0 ] * w[ 1 ] - r[ 1 ] * w[ 0 ] ) };
+  for( size_t i = 0; i < 3; i++ )
+  {
+    ref_motion[ i ] = E[ 3 * i ] * w[ 0 ] + E[ 3 * i + 1 ] * w[ 1 ] + E[ 3 * i + 2 ] * w[ 2 ];
+    ref_motion[ 3 + i ] = E[ 3 * i ] * v[ 0 ] + E[ 3 * i + 1 ] * v[ 1 ] + E[ 3 * i + 2 ] * v[ 2 ];
+  }
+}
+
+// Adds force vector from child to parent frame coordinates: f' = E^T * f, n' = E^T * n + r x f'
+static void AddTransposedForce( const SpatialTransform* transform, const double* force, double* ref_force )
+{
+  const double* E = transform->rotation;
+  const double* r = transform->translation;
+  double n[ 3 ], f[ 3 ];
+  for( size_t i = 0; i < 3; i++ )
+  {
+    n[ i ] = E[ i ] * force[ 0 ] + E[ 3 + i ] * force[ 1 ] + E[ 6 + i ] * force[ 2 ];
+    f[ i ] = E[ i ] * force[ 3 ] + E[ 3 + i ] * force[ 4 ] + E[ 6 + i ] * force[ 5 ];
+  }
+  ref_force[ 0 ] += n[ 0 ] + r[ 1 ] * f[ 2 ] - r[ 2 ] * f[ 1 ];
+  ref_force[ 1 ] += n[ 1 ] + r[ 2 ] * f[ 0 ] - r[ 0 ] * f[ 2 ];
+  ref_force[ 2 ] += n[ 2 ] + r[ 0 ] * f[ 1 ] - r[ 1 ] * f[ 0 ];
+  for( size_t i = 0; i < 3; i++ )
+    ref_force[ 3 + i ] += f[ i ];
+}
+
+// Finds first element (at any depth) with given tag inside text range
+static bool FindElement( const char* begin, const char* end, const char* tagName, XMLElement* ref_element )
+{
+  size_t tagLength = strlen( tagName );
+  for( const char* cursor = begin; cursor < end; cursor++ )
+  {
+    if( *cursor != '<' ) continue;
+    if( strncmp( cursor, "<!--", 4 ) == 0 )
+    {
+      const char* commentEnd = strstr( cursor, "-->" );
+      if( commentEnd == NULL ) return false;
+      cursor = commentEnd;
+      continue;
+    }
+    if( strncmp( cursor + 1, tagName, tagLength ) != 0 ) continue;
+    char delimiter = cursor[ 1 + tagLength ];
+    if( !isspace( (unsigned char) delimiter ) && delimiter != '>' && delimiter != '/' ) continue;
+    return ( ParseElement( cursor, end, ref_element ) );
+  }
+  
+  return false;
+}
+
+// Finds first element with given tag and name attribute inside text range
+static bool FindNamedElement( const char* begin, const char* end, const char* tagName, const char* id, XMLElement* ref_element )
+{
+  for( const char* cursor = begin; FindElement( cursor, end, tagName, ref_element ); cursor = ref_element->end )
+  {
+    if( strcmp( ref_element->id, id ) == 0 ) return true;
+  }
+  
+  return false;
+}
+
+// Finds next element directly inside text range (skipping comments and declarations)
+static bool GetNextChild( const char* begin, const char* end, XMLElement* ref_element )
+{
+  for( const char* cursor = begin; cursor < end; cursor++ )
+  {
+    if( *cursor != '<' ) continue;
+    if( strncmp( cursor, "<!--", 4 ) == 0 )
+    {
+      const char* commentEnd = strstr( cursor, "-->" );
+      if( commentEnd == NULL ) return false;
+      cursor = commentEnd;
+      continue;
+    }
+    if( cursor[ 1 ] == '/' ) return false;
+    if( cursor[ 1 ] == '!' || cursor[ 1 ] == '?' ) continue;
+    return ( ParseElement( cursor, end, ref_element ) );
+  }
+  
+  return false;
+}
+
+// Gets tag and name attribute of element starting at given position, and its content range (matching nested elements of same tag)
+static bool ParseElement( const char* start, const char* end, XMLElement* ref_element )
+{
+  size_t nameLength = strcspn( start + 1, " \t\r\n/>" );
+  if( nameLength == 0 || nameLength >= NAME_MAX_LENGTH ) return false;
+  strncpy( ref_element->name, start + 1, nameLength );
+  ref_element->name[ nameLength ] = '\0';
+  
+  const char* tagEnd = strchr( start, '>' );
+  if( tagEnd == NULL || tagEnd >= end ) return false;
+  
+  strcpy( ref_element->id, "" );
+  const char* attribute = strstr( start, " name=\"" );
+  if( attribute != NULL && attribute < tagEnd )
+  {
+    attribute += strlen( " name=\"" );
+    size_t idLength = strcspn( attribute, "\"" );
+    if( idLength >= NAME_MAX_LENGTH ) idLength = NAME_MAX_LENGTH - 1;
+    strncpy( ref_element->id, attribute, idLength );
+    ref_element->id[ idLength ] = '\0';
+  }
+  
+  ref_element->content = tagEnd + 1;
+  if( *(tagEnd - 1) == '/' )
+  {
+    ref_element->contentEnd = ref_element->end = tagEnd + 1;
+    return true;
+  }
+  
+  size_t depth = 1;
+  for( const char* cursor = tagEnd + 1; cursor < end; cursor++ )
+  {
+    if( *cursor != '<' ) continue;
+    if( strncmp( cursor, "<!--", 4 ) == 0 )
+    {
+      const char* commentEnd = strstr( cursor, "-->" );
+      if( commentEnd == NULL ) return false;
+      cursor = commentEnd;
+      continue;
+    }
+    bool isClosing = ( cursor[ 1 ] == '/' );
+    const char* cursorName = cursor + ( isClosing ? 2 : 1 );
+    if( strncmp( cursorName, ref_element->name, nameLength ) != 0 || strcspn( cursorName, " \t\r\n/>" ) != nameLength ) continue;
+    const char* cursorTagEnd = strchr( cursor, '>' );
+    if( cursorTagEnd == NULL ) return false;
+    if( isClosing && --depth == 0 )
+    {
+      ref_element->contentEnd = cursor;
+      ref_element->end = cursorTagEnd + 1;
+      return true;
+    }
+    else if( !isClosing && *(cursorTagEnd - 1) != '/' ) depth++;
+    cursor = cursorTagEnd;
+  }
+  
+  return false;
+}
+
+// Parses space separated numbers of first element with given tag inside parent one, returning parsed numbers count
+static size_t GetNumbers( const XMLElement* parent, const char* tagName, double* valuesList, size_t maxValuesNumber )
+{
+  XMLElement element;
+  if( !FindElement( parent->content, parent->contentEnd, tagName, &element ) ) return 0;
+  
+  size_t valuesNumber = 0;
+  const char* cursor = element.content;
+  while( valuesNumber < maxValuesNumber && cursor < element.contentEnd )
+  {
+    char* numberEnd;
+    double value = strtod( cursor, &numberEnd );
+    if( numberEnd == cursor || numberEnd > element.contentEnd ) break;
+    valuesList[ valuesNumber++ ] = value;
+    cursor = numberEnd;
+  }
+  
+  return valuesNumber;
+}
+
+// Copies trimmed text content of first element with given tag inside parent one
+static bool GetText( const XMLElement* parent, const char* tagName, char* buffer, size_t bufferLength )
+{
+  XMLElement element;
+  if( !FindElement( parent->content, parent->contentEnd, tagName, &element ) ) return false;
+  
+  const char* textStart = element.content;
+  const char* textEnd = element.contentEnd;
+  while( textStart < textEnd && isspace( (unsigned char) *textStart ) ) textStart++;
+  while( textEnd > textStart && isspace( (unsigned char) *(textEnd - 1) ) ) textEnd--;
+  size_t textLength = ( (size_t) ( textEnd - textStart ) < bufferLength ) ? (size_t) ( textEnd - textStart ) : bufferLength - 1;
+  strncpy( buffer, textStart, textLength );
+  buffer[ textLength ] = '\0';
+  
+  return true;
+}
+
+static bool GetBool( const XMLElement* parent, const char* tagName, bool defaultValue )
+{
+  char text[ NAME_MAX_LENGTH ];
+  if( !GetText( parent, tagName, text, NAME_MAX_LENGTH ) ) return defaultValue;
+  
+  return ( strcmp( text, "true" ) == 0 );
+}
@@ -0,0 +1,389 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file synthetic.c
+/// @brief Signal input plugin generating deterministic synthetic signals
+///
+/// Serves generated waveforms as input channels (channel N reads the N-th listed signal), sampled at a fixed rate, so that signal processing, 
+/// filtering and multi-sample throughput can be checked with reproducible inputs.
+/// Device configuration string is a space separated list of options and channel signals, in any order:
+/// @code
+/// "[rate=<samples_per_second>] [samples=<samples_number>] [seed=<seed>] [latency=<seconds>] [jitter=<seconds>] [fast] <signal_0> <signal_1> ..."
+/// @endcode
+/// - rate: signal sampling rate (default 1000)
+/// - samples: maximum number of samples returned on each read (default 32). Older due samples are dropped, as on a device buffer overflow
+/// - seed: seed of noise signals and read jitter (default 1)
+/// - latency: time (busy) waited on every read or block transfer, simulating device access (default 0)
+/// - jitter: maximum additional random time waited on every read or block transfer (default 0)
+/// - fast: deliver <samples_number> samples on every read, regardless of elapsed time (default pacing delivers samples due since device reset time)
+///
+/// Each signal is given as its type followed by colon separated parameters (omitted ones take the listed default values):
+/// - sine:<amplitude=1>:<frequency=1>:<phase=0>
+/// - chirp:<amplitude=1>:<start_frequency=0.1>:<end_frequency=10>:<sweep_duration=10> (linear sweep, repeated after each duration)
+/// - square:<amplitude=1>:<frequency=1>:<duty_cycle=0.5>
+/// - step:<amplitude=1>:<step_time=1>
+/// - ramp:<slope=1>:<period=0> (sawtooth for nonzero period)
+/// - noise:<deviation=1>:<mean=0> (gaussian)
+///
+/// Sample values only depend on configuration and sample index (time since reset), so runs are reproducible regardless of read timing. 
+/// Output channels accept and discard written values. Devices are shared among inputs and outputs with equal configuration strings.
+
+
+#include "signal_io/signal_io.h"
+#include "signal_io_extensions.h"
+
+#include "timing/timing.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define DEFAULT_SAMPLING_RATE 1000.0
+#define DEFAULT_MAX_SAMPLES_NUMBER 32
+#define DEFAULT_SEED 1
+#define SIGNAL_PARAMETERS_NUMBER 4
+
+enum SignalType { SIGNAL_SINE, SIGNAL_CHIRP, SIGNAL_SQUARE, SIGNAL_STEP, SIGNAL_RAMP, SIGNAL_NOISE, SIGNAL_TYPES_NUMBER };
+
+const char* SIGNAL_TYPE_NAMES[ SIGNAL_TYPES_NUMBER ] = { "sine", "chirp", "square", "step", "ramp", "noise" };
+const double SIGNAL_DEFAULT_PARAMETERS[ SIGNAL_TYPES_NUMBER ][ SIGNAL_PARAMETERS_NUMBER ] = { { 1.0, 1.0, 0.0, 0.0 }, { 1.0, 0.1, 10.0, 10.0 }, 
+                                                                                             { 1.0, 1.0, 0.5, 0.0 }, { 1.0, 1.0, 0.0, 0.0 }, 
+                                                                                             { 1.0, 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0, 0.0 } };
+
+typedef struct _SyntheticChannel
+{
+  enum SignalType type;
+  double parametersList[ SIGNAL_PARAMETERS_NUMBER ];
+  uint64_t sampleIndex;
+}
+SyntheticChannel;
+
+typedef struct _SyntheticDeviceData
+{
+  char* configString;
+  size_t usersNumber;
+  double samplingRate;
+  size_t maxSamplesNumber;
+  uint64_t seed;
+  uint64_t jitterState;
+  double latency;
+  double jitter;
+  bool isRealTime;
+  double startTime;
+  SyntheticChannel* channelsList;
+  size_t channelsNumber;
+}
+SyntheticDeviceData;
+
+typedef SyntheticDeviceData* SyntheticDevice;
+
+static SyntheticDevice* devicesList = NULL;
+static size_t devicesNumber = 0;
+
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE );
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_BLOCK_INTERFACE );
+
+static SyntheticDevice GetDevice( long int );
+static void DiscardDevice( SyntheticDevice );
+static bool ParseSignal( const char*, SyntheticChannel* );
+static size_t ReadSamples( SyntheticDevice, SyntheticChannel*, uint64_t, double* );
+static double GetSample( SyntheticDevice, size_t, uint64_t );
+static void WaitAccess( SyntheticDevice );
+static uint64_t MixBits( uint64_t );
+
+long int InitDevice( const char* taskConfig )
+{
+  if( taskConfig == NULL ) return SIGNAL_IO_DEVICE_INVALID_ID;
+  
+  for( size_t deviceIndex = 0; deviceIndex < devicesNumber; deviceIndex++ )
+  {
+    if( devicesList[ deviceIndex ] == NULL ) continue;
+    if( strcmp( devicesList[ deviceIndex ]->configString, taskConfig ) == 0 )
+    {
+      devicesList[ deviceIndex ]->usersNumber++;
+      return (long int) deviceIndex;
+    }
+  }
+  
+  SyntheticDevice newDevice = (SyntheticDevice) malloc( sizeof(SyntheticDeviceData) );
+  memset( newDevice, 0, sizeof(SyntheticDeviceData) );
+  newDevice->configString = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( newDevice->configString, taskConfig );
+  newDevice->usersNumber = 1;
+  newDevice->samplingRate = DEFAULT_SAMPLING_RATE;
+  newDevice->maxSamplesNumber = DEFAULT_MAX_SAMPLES_NUMBER;
+  newDevice->seed = DEFAULT_SEED;
+  newDevice->isRealTime = true;
+  
+  bool isConfigValid = true;
+  char* configBuffer = (char*) calloc( strlen( taskConfig ) + 1, sizeof(char) );
+  strcpy( configBuffer, taskConfig );
+  for( char* option = strtok( configBuffer, " " ); option != NULL; option = strtok( NULL, " " ) )
+  {
+    if( strncmp( option, "rate=", 5 ) == 0 ) newDevice->samplingRate = strtod( option + 5, NULL );
+    else if( strncmp( option, "samples=", 8 ) == 0 ) newDevice->maxSamplesNumber = (size_t) strtoul( option + 8, NULL, 10 );
+    else if( strncmp( option, "seed=", 5 ) == 0 ) newDevice->seed = (uint64_t) strtoull( option + 5, NULL, 10 );
+    else if( strncmp( option, "latency=", 8 ) == 0 ) newDevice->latency = strtod( option + 8, NULL );
+    else if( strncmp( option, "jitter=", 7 ) == 0 ) newDevice->jitter = strtod( option + 7, NULL );
+    else if( strcmp( option, "fast" ) == 0 ) newDevice->isRealTime = false;
+    else
+    {
+      newDevice->channelsList = (SyntheticChannel*) realloc( newDevice->channelsList, ( newDevice->channelsNumber + 1 ) * sizeof(SyntheticChannel) );
+      if( !ParseSignal( option, &(newDevice->channelsList[ newDevice->channelsNumber++ ]) ) ) isConfigValid = false;
+    }
+  }
+  free( configBuffer );
+  
+  if( !isConfigValid || newDevice->samplingRate <= 0.0 || newDevice->maxSamplesNumber == 0 || newDevice->channelsNumber == 0 )
+  {
+    DiscardDevice( newDevice );
+    return SIGNAL_IO_DEVICE_INVALID_ID;
+  }
+  
+  newDevice->jitterState = newDevice->seed;
+  newDevice->startTime = Time_GetExecSeconds();
+  
+  size_t deviceIndex = 0;
+  while( deviceIndex < devicesNumber && devicesList[ deviceIndex ] != NULL ) deviceIndex++;
+  if( deviceIndex == devicesNumber ) devicesList = (SyntheticDevice*) realloc( devicesList, ++devicesNumber * sizeof(SyntheticDevice) );
+  devicesList[ deviceIndex ] = newDevice;
+  
+  return (long int) deviceIndex;
+}
+
+void EndDevice( long int taskID )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  if( --(device->usersNumber) > 0 ) return;
+  
+  DiscardDevice( device );
+  devicesList[ taskID ] = NULL;
+}
+
+size_t GetMaxInputSamplesNumber( long int taskID )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return 1;
+  
+  return device->maxSamplesNumber;
+}
+
+size_t Read( long int taskID, unsigned int channel, double* ref_value )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return 0;
+  
+  if( channel >= device->channelsNumber ) return 0;
+  
+  WaitAccess( device );
+  
+  uint64_t dueSamplesNumber = (uint64_t) ( ( Time_GetExecSeconds() - device->startTime ) * device->samplingRate ) + 1;
+  
+  return ReadSamples( device, &(device->channelsList[ channel ]), dueSamplesNumber, ref_value );
+}
+
+bool HasError( long int taskID )
+{
+  return ( GetDevice( taskID ) == NULL );
+}
+
+void Reset( long int taskID )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return;
+  
+  // Signals are restarted for all channels, keeping them synchronized
+  for( size_t channelIndex = 0; channelIndex < device->channelsNumber; channelIndex++ )
+    device->channelsList[ channelIndex ].sampleIndex = 0;
+  device->jitterState = device->seed;
+  device->startTime = Time_GetExecSeconds();
+}
+
+bool CheckInputChannel( long int taskID, unsigned int channel )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  return ( channel < device->channelsNumber );
+}
+
+bool Write( long int taskID, unsigned int channel, double value )
+{
+  return ( GetDevice( taskID ) != NULL );
+}
+
+bool AcquireOutputChannel( long int taskID, unsigned int channel )
+{
+  return ( GetDevice( taskID ) != NULL );
+}
+
+void ReleaseOutputChannel( long int taskID, unsigned int channel )
+{
+  return;
+}
+
+bool ReadChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, double** buffersList, size_t* samplesCountsList )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  // Single device access for the whole transaction, with all channels sampled up to the same time
+  WaitAccess( device );
+  
+  uint64_t dueSamplesNumber = (uint64_t) ( ( Time_GetExecSeconds() - device->startTime ) * device->samplingRate ) + 1;
+  for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
+  {
+    samplesCountsList[ channelIndex ] = 0;
+    if( channelsList[ channelIndex ] >= device->channelsNumber ) continue;
+    SyntheticChannel* channel = &(device->channelsList[ channelsList[ channelIndex ] ]);
+    samplesCountsList[ channelIndex ] = ReadSamples( device, channel, dueSamplesNumber, buffersList[ channelIndex ] );
+  }
+  
+  return true;
+}
+
+bool WriteChannels( long int taskID, const unsigned int* channelsList, size_t channelsNumber, const double* valuesList )
+{
+  SyntheticDevice device = GetDevice( taskID );
+  if( device == NULL ) return false;
+  
+  WaitAccess( device );
+  
+  return true;
+}
+
+
+static SyntheticDevice GetDevice( long int taskID )
+{
+  if( taskID < 0 || (size_t) taskID >= devicesNumber ) return NULL;
+  
+  return devicesList[ taskID ];
+}
+
+static void DiscardDevice( SyntheticDevice device )
+{
+  free( device->channelsList );
+  free( device->configString );
+  free( device );
+}
+
+// Parses "<type>[:<parameter>...]" signal description, filling omitted parameters with type defaults
+static bool ParseSignal( const char* signalString, SyntheticChannel* channel )
+{
+  size_t typeLength = strcspn( signalString, ":" );
+  
+  channel->sampleIndex = 0;
+  for( channel->type = 0; channel->type < SIGNAL_TYPES_NUMBER; channel->type++ )
+  {
+    const char* typeName = SIGNAL_TYPE_NAMES[ channel->type ];
+    if( strlen( typeName ) == typeLength && strncmp( signalString, typeName, typeLength ) == 0 ) break;
+  }
+  if( channel->type == SIGNAL_TYPES_NUMBER ) return false;
+  
+  memcpy( channel->parametersList, SIGNAL_DEFAULT_PARAMETERS[ channel->type ], SIGNAL_PARAMETERS_NUMBER * sizeof(double) );
+  const char* parameterString = signalString + typeLength;
+  for( size_t parameterIndex = 0; parameterIndex < SIGNAL_PARAMETERS_NUMBER && *parameterString == ':'; parameterIndex++ )
+  {
+    char* parameterEnd;
+    double parameter = strtod( parameterString + 1, &parameterEnd );
+    if( parameterEnd != parameterString + 1 ) channel->parametersList[ parameterIndex ] = parameter;
+    parameterString = parameterEnd;
+  }
+  
+  return true;
+}
+
+// Delivers channel samples due up to given sample count (or a full block, without real-time pacing), dropping the ones that do not fit
+static size_t ReadSamples( SyntheticDevice device, SyntheticChannel* channel, uint64_t dueSamplesNumber, double* samplesList )
+{
+  if( !device->isRealTime ) dueSamplesNumber = channel->sampleIndex + device->maxSamplesNumber;
+  
+  if( dueSamplesNumber <= channel->sampleIndex ) return 0;
+  if( dueSamplesNumber - channel->sampleIndex > device->maxSamplesNumber ) channel->sampleIndex = dueSamplesNumber - device->maxSamplesNumber;
+  
+  size_t samplesNumber = 0;
+  size_t channelIndex = (size_t) ( channel - device->channelsList );
+  for( ; channel->sampleIndex < dueSamplesNumber; channel->sampleIndex++ )
+    samplesList[ samplesNumber++ ] = GetSample( device, channelIndex, channel->sampleIndex );
+  
+  return samplesNumber;
+}
+
+static double GetSample( SyntheticDevice device, size_t channelIndex, uint64_t sampleIndex )
+{
+  const SyntheticChannel* channel = &(device->channelsList[ channelIndex ]);
+  const double* parametersList = channel->parametersList;
+  double time = sampleIndex / device->samplingRate;
+  
+  if( channel->type == SIGNAL_SINE ) 
+    return parametersList[ 0 ] * sin( 2 * M_PI * parametersList[ 1 ] * time + parametersList[ 2 ] );
+  else if( channel->type == SIGNAL_CHIRP )
+  {
+    double sweepDuration = ( parametersList[ 3 ] > 0.0 ) ? parametersList[ 3 ] : 1.0;
+    double sweepTime = fmod( time, sweepDuration );
+    double frequencyRate = ( parametersList[ 2 ] - parametersList[ 1 ] ) / sweepDuration;
+    return parametersList[ 0 ] * sin( 2 * M_PI * ( parametersList[ 1 ] * sweepTime + frequencyRate * sweepTime * sweepTime / 2 ) );
+  }
+  else if( channel->type == SIGNAL_SQUARE )
+  {
+    double cyclePhase = parametersList[ 1 ] * time - floor( parametersList[ 1 ] * time );
+    return ( cyclePhase < parametersList[ 2 ] ) ? parametersList[ 0 ] : -parametersList[ 0 ];
+  }
+  else if( channel->type == SIGNAL_STEP ) 
+    return ( time >= parametersList[ 1 ] ) ? parametersList[ 0 ] : 0.0;
+  else if( channel->type == SIGNAL_RAMP ) 
+    return parametersList[ 0 ] * ( ( parametersList[ 1 ] > 0.0 ) ? fmod( time, parametersList[ 1 ] ) : time );
+  
+  // Noise values are hashed from seed, channel and sample index, so that dropped samples do not change following ones (Box-Muller transform)
+  uint64_t sampleBits = MixBits( device->seed ^ MixBits( ( (uint64_t) channelIndex << 48 ) ^ sampleIndex ) );
+  double uniform1 = ( ( sampleBits >> 32 ) + 1.0 ) / 4294967297.0;
+  double uniform2 = ( sampleBits & 0xFFFFFFFF ) / 4294967296.0;
+  return parametersList[ 1 ] + parametersList[ 0 ] * sqrt( -2.0 * log( uniform1 ) ) * cos( 2 * M_PI * uniform2 );
+}
+
+// Busy waits configured device access latency (plus random jitter), as timing functions do not offer sub-millisecond delays
+static void WaitAccess( SyntheticDevice device )
+{
+  double waitTime = device->latency;
+  if( device->jitter > 0.0 )
+  {
+    device->jitterState = MixBits( device->jitterState );
+    waitTime += device->jitter * ( ( device->jitterState >> 11 ) / 9007199254740992.0 );
+  }
+  if( waitTime <= 0.0 ) return;
+  
+  double accessTime = Time_GetExecSeconds();
+  while( Time_GetExecSeconds() - accessTime < waitTime );
+}
+
+// SplitMix64 finalizer, spreading input bits over all output bits
+static uint64_t MixBits( uint64_t value )
+{
+  value += 0x9E3779B97F4A7C15ULL;
+  value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBULL;
+  return value ^ ( value >> 31 );
+}
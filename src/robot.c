@@ -25,6 +25,16 @@
 #include "config_keys.h"
 
 #include "actuator.h"
+#include "trajectory_queue.h"
+#include "triple_buffer.h"
+#include "async_log.h"
+#include "binary_log.h"
+#include "flight_recorder.h"
+#include "config_cache.h"
+#include "device_registry.h"
+#include "alloc_guard.h"
+#include "worker_pool.h"
+#include "trace_points.h"
 
 #include "input.h"
 #include "output.h"
@@ -37,26 +47,52 @@
 #include "linearizer/system_linearizer.h"
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <stdatomic.h>
 
 /////////////////////////////////////////////////////////////////////////////////
 /////                            CONTROL DEVICE                             /////
 /////////////////////////////////////////////////////////////////////////////////
 
+typedef struct _RobotSnapshot
+{
+  unsigned long cycleIndex;
+  double execTime;
+  bool hasJointMeasures;
+  DoFVariables measuresList[];          // Axis measures, followed by joint measures
+}
+RobotSnapshot;
+
 typedef struct _RobotData
 {
   DECLARE_MODULE_INTERFACE_REF( ROBOT_CONTROL_INTERFACE );
+  char* name;
+  char* controllerConfig;
+  char* controllerConfigBuffer;
+  bool isControllerReady;
+  unsigned long loadID;                       // Unique for each loaded robot, so that no reference to another robot has to be kept
+  unsigned long baseLoadID;                   // Robot active on loading (0 for none), whose controller state may be handed over
+  bool hasDevices;
+  bool isPrepared;                            // Devices set up ahead of activation are kept while inactive
   Thread controlThread;
   volatile bool isControlRunning;
   enum ControlState controlState;
   double controlTimeStep;
+  size_t initWorkersNumber;                   // Actuators loaded/enabled at the same time (1 for sequential setup)
   Actuator* actuatorsList;
-  DoFVariables** jointMeasuresList;
+  void* stateBlock;                           // Single allocation holding all state tables below
+  DoFVariables* jointMeasuresTable;
+  DoFVariables* jointSetpointsTable;
+  DoFVariables** jointMeasuresList;           // Views into state tables, for controller plug-ins
   DoFVariables** jointSetpointsList;
   LinearSystem* jointLinearizersList;
   size_t jointsNumber;
+  DoFVariables* axisMeasuresTable;
+  DoFVariables* axisSetpointsTable;
   DoFVariables** axisMeasuresList;
   DoFVariables** axisSetpointsList;
+  TrajectoryQueue* axisTrajectoriesList;
   size_t axesNumber;
   Input* extraInputsList;
   double* extraInputValuesList;
@@ -64,169 +100,770 @@ typedef struct _RobotData
   Output* extraOutputsList;
   double* extraOutputValuesList;
   size_t extraOutputsNumber;
+  TripleBuffer snapshotBuffer;
+  const RobotSnapshot* currentSnapshot;
+  atomic_bool isJointsSnapshotEnabled;
+  unsigned long cycleIndex;
   Log controlLog;
+  bool isTextLogEnabled;
+  bool isLogFileEnabled;
+  BinaryLog controlBinaryLog;
+  bool isBinaryLogEnabled;
+  enum BinaryLogType binaryLogType;
+  enum LogCodecType binaryLogCodec;
+  size_t logPrecision;
+  AsyncLog controlAsyncLog;
+  size_t logBufferLength;
+  enum AsyncLogOverflowPolicy logOverflowPolicy;
+  AsyncLogFilter logFilter;
+  bool hasLogFilter;
+  FlightRecorder flightRecorder;
+  double flightRecorderDuration;
+  size_t flightMissesLimit;
+  unsigned long flightMissesWindow;
+  double* cycleDurationsList;                 // Optional (external) storage of last cycle durations, indexed circularly by cycle
+  size_t cycleDurationsNumber;
 } 
 RobotData;
 
-static RobotData robot;
+// Shared data of actuators loading tasks
+typedef struct _ActuatorsLoad
+{
+  RobotData* robot;
+  RobotData* baseRobot;
+  const char** actuatorNamesList;
+  ConfigSnapshot snapshot;
+}
+ActuatorsLoad;
+
+// Shared data of actuators enabling tasks
+typedef struct _ActuatorsEnable
+{
+  RobotData* robot;
+  bool* enabledList;
+}
+ActuatorsEnable;
+
+static RobotData emptyRobot;
+static atomic_ulong loadsCount = 0;
+static RobotData* activeRobot = &emptyRobot;
 
 
 const double CONTROL_PASS_DEFAULT_INTERVAL = 0.005;
+const size_t AXIS_TRAJECTORY_MAX_POINTS = 256;
+
+#define STATE_TABLE_ALIGNMENT 64              // Cache line size, so that tables written by different threads do not share lines
+
+const char* DOF_VARIABLE_NAMES[] = { "position", "velocity", "acceleration", "force", "stiffness", "damping", "inertia" };
 
 static void* AsyncControl( void* );
 
+static bool InitControl( RobotData*, bool );
+static void EndControl( RobotData*, bool );
+static bool StartControl( RobotData* );
+static bool ResumeControl( RobotData*, RobotData*, bool );
+static void SetupDevices( RobotData*, DataHandle, RobotData* );
+static void ReleaseDevices( RobotData* );
+static void HandOffDevices( RobotData*, RobotData* );
+static void CreateStateBlock( RobotData* );
+static void LoadActuator( void*, size_t );
+static void EnableActuator( void*, size_t );
+
 bool Robot_Init( const char* configName )
+{
+  Robot newRobot = Robot_Load( configName );
+  if( newRobot == NULL ) return false;
+  
+  Robot lastRobot = NULL;
+  bool isActivated = Robot_Swap( newRobot, &lastRobot );
+  Robot_Unload( lastRobot );
+  if( !isActivated ) Robot_Unload( newRobot );
+  
+  return isActivated;
+}
+
+void Robot_End()
+{
+  Robot lastRobot = NULL;
+  (void) Robot_Swap( NULL, &lastRobot );
+  Robot_Unload( lastRobot );
+}
+
+Robot Robot_Load( const char* configName )
 {
   char filePath[ DATA_IO_MAX_PATH_LENGTH ];
 
-  DEBUG_PRINT( "trying to initialize robot %s", configName );
-  
-  bool loadSuccess = false;
+  DEBUG_PRINT( "trying to load robot %s", configName );
   
   sprintf( filePath, KEY_CONFIG "/" KEY_ROBOTS "/%s", configName );
-  DataHandle configuration = DataIO_LoadStorageData( filePath );
-  if( configuration != NULL )
+  // Whole configuration tree (robot and its devices) is recorded to a single snapshot for faster loading
+  ConfigCache_BeginSnapshot( filePath );
+  DataHandle configuration = ConfigCache_Load( filePath );
+  if( configuration == NULL ) 
   {
-    sprintf( filePath, KEY_MODULES "/" KEY_ROBOT_CONTROL "/%s", DataIO_GetStringValue( configuration, "", KEY_CONTROLLER "." KEY_TYPE ) );
-    LOAD_MODULE_IMPLEMENTATION( ROBOT_CONTROL_INTERFACE, filePath, &robot, &loadSuccess );
-    if( loadSuccess )
+    ConfigCache_EndSnapshot( false );
+    return NULL;
+  }
+  
+  Robot newRobot = (Robot) malloc( sizeof(RobotData) );
+  memset( newRobot, 0, sizeof(RobotData) );
+  newRobot->controlThread = THREAD_INVALID_HANDLE;
+  newRobot->loadID = atomic_fetch_add( &loadsCount, 1 ) + 1;
+  newRobot->baseLoadID = activeRobot->loadID;
+  newRobot->name = (char*) calloc( strlen( configName ) + 1, sizeof(char) );
+  strcpy( newRobot->name, configName );
+  
+  bool loadSuccess = false;
+  sprintf( filePath, KEY_MODULES "/" KEY_ROBOT_CONTROL "/%s", DataIO_GetStringValue( configuration, "", KEY_CONTROLLER "." KEY_TYPE ) );
+  LOAD_MODULE_IMPLEMENTATION( ROBOT_CONTROL_INTERFACE, filePath, newRobot, &loadSuccess );
+  if( loadSuccess )
+  {
+    //PRINT_PLUGIN_FUNCTIONS( ROBOT_CONTROL_INTERFACE, newRobot );
+    // Controller is only initialized on activation, as plugin state may be shared with the currently active robot
+    const char* controllerConfigString = DataIO_GetStringValue( configuration, "", KEY_CONTROLLER "." KEY_CONFIG );
+    newRobot->controllerConfig = (char*) calloc( strlen( controllerConfigString ) + 1, sizeof(char) );
+    strcpy( newRobot->controllerConfig, controllerConfigString );
+    newRobot->controlTimeStep = DataIO_GetNumericValue( configuration, CONTROL_PASS_DEFAULT_INTERVAL, KEY_CONTROLLER "." KEY_TIME_STEP );   
+    
+    newRobot->initWorkersNumber = (size_t) DataIO_GetNumericValue( configuration, 1, KEY_INIT_WORKERS );
+    
+    newRobot->jointsNumber = DataIO_GetListSize( configuration, KEY_ACTUATORS );
+    newRobot->actuatorsList = (Actuator*) calloc( newRobot->jointsNumber, sizeof(Actuator) );
+    DEBUG_PRINT( "found %lu actuators", newRobot->jointsNumber );
+    newRobot->extraInputsNumber = DataIO_GetListSize( configuration, KEY_EXTRA_INPUTS );
+    newRobot->extraInputsList = (Input*) calloc( newRobot->extraInputsNumber, sizeof(Input) );
+    newRobot->extraOutputsNumber = DataIO_GetListSize( configuration, KEY_EXTRA_OUTPUTS );
+    newRobot->extraOutputsList = (Output*) calloc( newRobot->extraOutputsNumber, sizeof(Output) );
+    
+    if( DataIO_HasKey( configuration, KEY_LOG ) )
     {
-      //PRINT_PLUGIN_FUNCTIONS( ROBOT_CONTROL_INTERFACE, (&robot) );
-      const char* controllerConfigString = DataIO_GetStringValue( configuration, "", KEY_CONTROLLER "." KEY_CONFIG );
-      DEBUG_PRINT( "loading controller config %s", controllerConfigString ); 
-      if( (loadSuccess = robot.InitController( controllerConfigString )) )
-      {
-        robot.controlTimeStep = DataIO_GetNumericValue( configuration, CONTROL_PASS_DEFAULT_INTERVAL, KEY_CONTROLLER "." KEY_TIME_STEP );   
-        robot.jointsNumber = robot.GetJointsNumber();
-        robot.actuatorsList = (Actuator*) calloc( robot.jointsNumber, sizeof(Actuator) );
-        robot.jointMeasuresList = (DoFVariables**) calloc( robot.jointsNumber, sizeof(DoFVariables*) );
-        robot.jointSetpointsList = (DoFVariables**) calloc( robot.jointsNumber, sizeof(DoFVariables*) );
-        robot.jointLinearizersList = (LinearSystem*) calloc( robot.jointsNumber, sizeof(LinearSystem) );
-        DEBUG_PRINT( "found %lu joints", robot.jointsNumber );
-        for( size_t jointIndex = 0; jointIndex < robot.jointsNumber; jointIndex++ )
-        {
-          const char* actuatorName = DataIO_GetStringValue( configuration, "", KEY_ACTUATORS ".%lu", jointIndex );
-          robot.actuatorsList[ jointIndex ] = Actuator_Init( actuatorName );
-          robot.jointMeasuresList[ jointIndex ] = (DoFVariables*) malloc( sizeof(DoFVariables) );
-          robot.jointSetpointsList[ jointIndex ] = (DoFVariables*) malloc( sizeof(DoFVariables) );
-          robot.jointLinearizersList[ jointIndex ] = SystemLinearizer_CreateSystem( 3, 1, LINEARIZATION_MAX_SAMPLES );
-        }
-
-        robot.axesNumber = robot.GetAxesNumber();
-        robot.axisMeasuresList = (DoFVariables**) calloc( robot.axesNumber, sizeof(DoFVariables*) );
-        robot.axisSetpointsList = (DoFVariables**) calloc( robot.axesNumber, sizeof(DoFVariables*) );
-        DEBUG_PRINT( "found %lu axes", robot.axesNumber );
-        for( size_t axisIndex = 0; axisIndex < robot.axesNumber; axisIndex++ )
-        {
-          robot.axisMeasuresList[ axisIndex ] = (DoFVariables*) malloc( sizeof(DoFVariables) );
-          robot.axisSetpointsList[ axisIndex ] = (DoFVariables*) malloc( sizeof(DoFVariables) );
-        }
-        
-        robot.extraInputsNumber = robot.GetExtraInputsNumber();
-        robot.extraInputsList = (Input*) calloc( robot.extraInputsNumber, sizeof(Input) );
-        for( size_t inputIndex = 0; inputIndex < robot.extraInputsNumber; inputIndex++ )
-          robot.extraInputsList[ inputIndex ] = Input_Init( DataIO_GetSubData( configuration, KEY_EXTRA_INPUTS ".%lu", inputIndex ) );
-        robot.extraInputValuesList = (double*) calloc( robot.extraInputsNumber, sizeof(double) );
-        
-        robot.extraOutputsNumber = robot.GetExtraOutputsNumber();
-        robot.extraOutputsList = (Output*) calloc( robot.extraOutputsNumber, sizeof(Output) );
-        for( size_t outputIndex = 0; outputIndex < robot.extraOutputsNumber; outputIndex++ )
-          robot.extraOutputsList[ outputIndex ] = Output_Init( DataIO_GetSubData( configuration, KEY_EXTRA_OUTPUTS ".%lu", outputIndex ) );
-        robot.extraOutputValuesList = (double*) calloc( robot.extraOutputsNumber, sizeof(double) );
-        
-        if( DataIO_HasKey( configuration, KEY_LOG ) )
-          robot.controlLog = Log_Init( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE ) ? configName : "", 
-                                       (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION ) );
-        
-        DEBUG_PRINT( "robot %s initialized", configName );
-      }
+      size_t logPrecision = (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION );
+      // Binary log columns are only known after controller initialization
+      newRobot->isBinaryLogEnabled = ( strcmp( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_FORMAT ), KEY_BINARY ) == 0 );
+      newRobot->binaryLogType = BinaryLog_GetPrecisionType( logPrecision );
+      newRobot->binaryLogCodec = LogCodec_GetType( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_COMPRESSION ) );
+      newRobot->logPrecision = logPrecision;
+      // Log files are only created on activation, from the thread setting their names (see Log_SetTimeStamp())
+      newRobot->isTextLogEnabled = !newRobot->isBinaryLogEnabled;
+      newRobot->isLogFileEnabled = DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE );
+      newRobot->logBufferLength = (size_t) DataIO_GetNumericValue( configuration, ASYNC_LOG_DEFAULT_BUFFER_LENGTH, KEY_LOG "." KEY_BUFFER_LENGTH );
+      newRobot->logOverflowPolicy = AsyncLog_ParseOverflowPolicy( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_OVERFLOW ) );
+      newRobot->hasLogFilter = AsyncLog_LoadFilter( configuration, &(newRobot->logFilter) );
     }
     
-    DataIO_UnloadData( configuration );
-
-    if( !loadSuccess ) Robot_End();
+    // Buffer size is only known after controller initialization
+    if( DataIO_HasKey( configuration, KEY_FLIGHT_RECORDER ) )
+    {
+      newRobot->flightRecorderDuration = DataIO_GetNumericValue( configuration, FLIGHT_RECORDER_DEFAULT_DURATION, KEY_FLIGHT_RECORDER "." KEY_DURATION );
+      newRobot->flightMissesLimit = (size_t) DataIO_GetNumericValue( configuration, FLIGHT_RECORDER_DEFAULT_MISSES_LIMIT, KEY_FLIGHT_RECORDER "." KEY_DEADLINE_MISSES );
+      newRobot->flightMissesWindow = (unsigned long) DataIO_GetNumericValue( configuration, FLIGHT_RECORDER_DEFAULT_MISSES_WINDOW, KEY_FLIGHT_RECORDER "." KEY_MISSES_WINDOW );
+    }
+    
+    // Devices are set up while the active robot may still be running: unchanged ones are shared with it, and the device registry 
+    // keeps setup calls of plug-ins not declared thread safe from running concurrently with its transfers
+    SetupDevices( newRobot, configuration, activeRobot );
     
-    // testing hack
-    //Robot_Enable();
-    //Robot_SetControlState( CONTROL_OPERATION );
+    DEBUG_PRINT( "robot %s loaded", configName );
   }
   
-  return loadSuccess;
+  ConfigCache_Unload( configuration );
+  ConfigCache_EndSnapshot( loadSuccess );
+  
+  if( !loadSuccess )
+  {
+    Robot_Unload( newRobot );
+    return NULL;
+  }
+  
+  return newRobot;
 }
 
-void Robot_End()
+bool Robot_Prepare( Robot robot )
 {
-  Robot_Disable();
+  if( robot == NULL || robot == &emptyRobot ) return false;
   
-  if( robot.EndController != NULL ) robot.EndController();
+  // Prepared robots may be activated after any other one, so they never take over controllers
+  robot->baseLoadID = 0;
+  robot->isPrepared = true;
+  
+  return true;
+}
+
+void Robot_Unload( Robot robot )
+{
+  if( robot == NULL || robot == &emptyRobot ) return;
   
-  for( size_t jointIndex = 0; jointIndex < robot.jointsNumber; jointIndex++ )
+  if( robot == activeRobot ) 
   {
-    Actuator_End( robot.actuatorsList[ jointIndex ] );
-    free( robot.jointMeasuresList[ jointIndex ] );
-    free( robot.jointSetpointsList[ jointIndex ] );
-    SystemLinearizer_DeleteSystem( robot.jointLinearizersList[ jointIndex ] );
+    Robot lastRobot = NULL;
+    (void) Robot_Swap( NULL, &lastRobot );
   }
-  free( robot.actuatorsList );
-  free( robot.jointMeasuresList );
-  free( robot.jointSetpointsList );
   
-  for( size_t axisIndex = 0; axisIndex < robot.axesNumber; axisIndex++ )
+  EndControl( robot, true );
+  
+  // Robots replaced on Robot_Swap() already released their devices, so that only memory is freed here
+  ReleaseDevices( robot );
+  free( robot->actuatorsList );
+  free( robot->extraInputsList );
+  free( robot->extraOutputsList );
+  
+  free( robot->name );
+  
+  free( robot->controllerConfig );
+  free( robot->controllerConfigBuffer );
+  
+  free( robot );
+}
+
+bool Robot_Swap( Robot newRobot, Robot* ref_lastRobot )
+{
+  Robot lastRobot = ( activeRobot != &emptyRobot ) ? activeRobot : NULL;
+  
+  *ref_lastRobot = NULL;
+  
+  if( newRobot == lastRobot ) return true;
+  
+  // Robots released from a previous activation have no devices left
+  if( newRobot != NULL && !newRobot->hasDevices ) return false;
+  
+  // Controller plug-in state is handed over when reloading the active robot with unchanged controller configuration
+  bool isControllerShared = ( newRobot != NULL && lastRobot != NULL && newRobot->baseLoadID == lastRobot->loadID && lastRobot->isControllerReady
+                              && newRobot->InitController == lastRobot->InitController && strcmp( newRobot->controllerConfig, lastRobot->controllerConfig ) == 0 );
+  // Plug-in modules are only loaded once, so that a controller of the same module is only initialized after the previous one is ended
+  bool isModuleShared = ( newRobot != NULL && lastRobot != NULL && newRobot->InitController == lastRobot->InitController );
+  
+  // Other controllers are initialized while the previous robot keeps running, so that it is left untouched on failures
+  if( newRobot != NULL && !isModuleShared && !InitControl( newRobot, true ) )
   {
-    free( robot.axisMeasuresList[ axisIndex ] );
-    free( robot.axisSetpointsList[ axisIndex ] );
+    DEBUG_PRINT( "failed to initialize controller for robot %p", newRobot );
+    return false;
   }
-  free( robot.axisMeasuresList );
-  free( robot.axisSetpointsList );
-    
-  for( size_t inputIndex = 0; inputIndex < robot.extraInputsNumber; inputIndex++ )
-    Input_End( robot.extraInputsList[ inputIndex ] );
-  if( robot.extraInputsList != NULL ) free( robot.extraInputsList );
-  if( robot.extraInputValuesList != NULL ) free( robot.extraInputValuesList );
   
-  for( size_t outputIndex = 0; outputIndex < robot.extraOutputsNumber; outputIndex++ )
-    Output_End( robot.extraOutputsList[ outputIndex ] );
-  if( robot.extraOutputsList != NULL ) free( robot.extraOutputsList );
-  if( robot.extraOutputValuesList != NULL ) free( robot.extraOutputValuesList );
+  bool wasControlRunning = false;
+  if( lastRobot != NULL )
+  {
+    wasControlRunning = Robot_Disable();
+    if( !isControllerShared ) EndControl( lastRobot, true );
+    activeRobot = &emptyRobot;
+  }
+  
+  if( newRobot == NULL ) 
+  {
+    if( !lastRobot->isPrepared ) ReleaseDevices( lastRobot );
+    *ref_lastRobot = lastRobot;
+    return true;
+  }
+  
+  if( isControllerShared )
+  {
+    DEBUG_PRINT( "handing controller over from robot %p to %p", lastRobot, newRobot );
+    // Plug-in may still reference its (tokenized) configuration string
+    free( newRobot->controllerConfigBuffer );
+    newRobot->controllerConfigBuffer = lastRobot->controllerConfigBuffer;
+    lastRobot->controllerConfigBuffer = NULL;
+    newRobot->controlState = lastRobot->controlState;
+  }
+  
+  if( isModuleShared && !InitControl( newRobot, !isControllerShared ) )
+  {
+    DEBUG_PRINT( "failed to initialize controller for robot %p", newRobot );
+    // Previous robot devices were not handed off yet: only its controller is initialized again, and its control restarted
+    if( !InitControl( lastRobot, true ) )
+    {
+      DEBUG_PRINT( "failed to restore controller for robot %p", lastRobot );
+      if( !lastRobot->isPrepared ) ReleaseDevices( lastRobot );
+      *ref_lastRobot = lastRobot;
+      return false;
+    }
+    activeRobot = lastRobot;
+    if( wasControlRunning && !StartControl( lastRobot ) ) DEBUG_PRINT( "failed to restart control of robot %p", lastRobot );
+    return false;
+  }
+  
+  activeRobot = newRobot;
+  
+  // Previous robot stopped using (possibly shared) devices on a cycle boundary: new one takes over the ones it did not share from a clean state
+  HandOffDevices( newRobot, ( lastRobot != NULL ) ? lastRobot : &emptyRobot );
   
-  Log_End( robot.controlLog );
+  bool isControlResumed = false;
+  if( isControllerShared )
+  {
+    isControlResumed = ResumeControl( newRobot, lastRobot, wasControlRunning );
+    EndControl( lastRobot, false );
+  }
+  
+  // Devices only used by the previous robot are closed before any control thread starts again
+  if( lastRobot != NULL && !lastRobot->isPrepared ) ReleaseDevices( lastRobot );
+  
+  if( isControlResumed )
+  {
+    DEBUG_PRINT( "resuming control of robot %p", newRobot );
+    if( !StartControl( newRobot ) ) DEBUG_PRINT( "failed to resume control of robot %p", newRobot );
+  }
   
-  memset( &robot, 0, sizeof(RobotData) );
+  *ref_lastRobot = lastRobot;
+  return true;
 }
 
-bool Robot_Enable()
-{ 
-  Robot_SetControlState( CONTROL_OFFSET );
+// Robot description JSON string (to be freed by caller) stored on binary files header
+static char* GetMetadataString( RobotData* robot )
+{
+  DataHandle metadata = DataIO_CreateEmptyData();
+  DataIO_SetStringValue( metadata, KEY_ID, robot->name );
+  DataHandle axesList = DataIO_AddList( metadata, KEY_AXES );
+  const char** axisNamesList = robot->GetAxisNamesList();
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+    DataIO_SetStringValue( axesList, NULL, ( axisNamesList != NULL ) ? axisNamesList[ axisIndex ] : "" );
+  DataHandle jointsList = DataIO_AddList( metadata, KEY_JOINTS );
+  const char** jointNamesList = robot->GetJointNamesList();
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+    DataIO_SetStringValue( jointsList, NULL, ( jointNamesList != NULL ) ? jointNamesList[ jointIndex ] : "" );
   
-  for( size_t jointIndex = 0; jointIndex < robot.jointsNumber; jointIndex++ )
+  char* metadataString = DataIO_GetDataString( metadata );
+  DataIO_UnloadData( metadata );
+  
+  return metadataString;
+}
+
+// Adds "<dof_name>.<group>.<variable>" column names for each DoF variable, returning next column index
+static size_t AddDoFColumnNames( char** columnNamesList, size_t columnIndex, const char* dofName, const char* groupName )
+{
+  const size_t DOF_VARIABLES_NUMBER = sizeof(DoFVariables) / sizeof(double);
+  
+  for( size_t variableIndex = 0; variableIndex < DOF_VARIABLES_NUMBER; variableIndex++ )
+  {
+    columnNamesList[ columnIndex ] = (char*) calloc( strlen( dofName ) + strlen( groupName ) + 32, sizeof(char) );
+    sprintf( columnNamesList[ columnIndex++ ], "%s.%s.%s", dofName, groupName, DOF_VARIABLE_NAMES[ variableIndex ] );
+  }
+  
+  return columnIndex;
+}
+
+// Adds extra inputs and outputs column names, returning next column index
+static size_t AddExtraColumnNames( RobotData* robot, char** columnNamesList, size_t columnIndex )
+{
+  for( size_t inputIndex = 0; inputIndex < robot->extraInputsNumber; inputIndex++ )
+  {
+    columnNamesList[ columnIndex ] = (char*) calloc( 32, sizeof(char) );
+    sprintf( columnNamesList[ columnIndex++ ], KEY_EXTRA_INPUTS ".%lu", inputIndex );
+  }
+  for( size_t outputIndex = 0; outputIndex < robot->extraOutputsNumber; outputIndex++ )
   {
-    if( !Actuator_Enable( robot.actuatorsList[ jointIndex ] ) ) return false;
+    columnNamesList[ columnIndex ] = (char*) calloc( 32, sizeof(char) );
+    sprintf( columnNamesList[ columnIndex++ ], KEY_EXTRA_OUTPUTS ".%lu", outputIndex );
   }
   
-  if( !(robot.isControlRunning) )
+  return columnIndex;
+}
+
+// Binary log columns follow LogRobotData() order, with robot description on header
+static BinaryLog CreateBinaryLog( RobotData* robot, size_t columnsNumber )
+{
+  char** columnNamesList = (char**) calloc( columnsNumber, sizeof(char*) );
+  size_t columnIndex = 0;
+  const char** axisNamesList = robot->GetAxisNamesList();
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+  {
+    const char* axisName = ( axisNamesList != NULL ) ? axisNamesList[ axisIndex ] : "";
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, axisName, "setpoint" );
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, axisName, "measure" );
+  }
+  columnIndex = AddExtraColumnNames( robot, columnNamesList, columnIndex );
+  
+  char* metadataString = GetMetadataString( robot );
+  BinaryLog binaryLog = BinaryLog_Create( robot->name, metadataString, columnsNumber, (const char**) columnNamesList, robot->binaryLogType );
+  BinaryLog_SetCompression( binaryLog, robot->binaryLogCodec, robot->logPrecision );
+  free( metadataString );
+  
+  for( columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+    free( columnNamesList[ columnIndex ] );
+  free( columnNamesList );
+  
+  return binaryLog;
+}
+
+// Flight recorder columns follow RecordRobotState() order: cycle timing, joint and axis variables, extra inputs and outputs
+static FlightRecorder CreateFlightRecorder( RobotData* robot )
+{
+  const size_t DOF_VARIABLES_NUMBER = sizeof(DoFVariables) / sizeof(double);
+  const char* CYCLE_COLUMN_NAMES[] = { "cycle.index", "cycle.interval", "cycle.duration" };
+  const size_t CYCLE_COLUMNS_NUMBER = sizeof(CYCLE_COLUMN_NAMES) / sizeof(char*);
+  
+  if( robot->flightRecorderDuration <= 0.0 ) return NULL;
+  
+  size_t rowsNumber = (size_t) ( robot->flightRecorderDuration / robot->controlTimeStep ) + 1;
+  size_t columnsNumber = CYCLE_COLUMNS_NUMBER + 2 * ( robot->jointsNumber + robot->axesNumber ) * DOF_VARIABLES_NUMBER 
+                         + robot->extraInputsNumber + robot->extraOutputsNumber;
+  
+  char** columnNamesList = (char**) calloc( columnsNumber, sizeof(char*) );
+  size_t columnIndex = 0;
+  for( ; columnIndex < CYCLE_COLUMNS_NUMBER; columnIndex++ )
+  {
+    columnNamesList[ columnIndex ] = (char*) calloc( strlen( CYCLE_COLUMN_NAMES[ columnIndex ] ) + 1, sizeof(char) );
+    strcpy( columnNamesList[ columnIndex ], CYCLE_COLUMN_NAMES[ columnIndex ] );
+  }
+  const char** jointNamesList = robot->GetJointNamesList();
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    const char* jointName = ( jointNamesList != NULL ) ? jointNamesList[ jointIndex ] : "";
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, jointName, "measure" );
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, jointName, "setpoint" );
+  }
+  const char** axisNamesList = robot->GetAxisNamesList();
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
   {
-    robot.controlThread = Thread_Start( AsyncControl, &robot, THREAD_JOINABLE );
+    const char* axisName = ( axisNamesList != NULL ) ? axisNamesList[ axisIndex ] : "";
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, axisName, "measure" );
+    columnIndex = AddDoFColumnNames( columnNamesList, columnIndex, axisName, "setpoint" );
+  }
+  columnIndex = AddExtraColumnNames( robot, columnNamesList, columnIndex );
+  
+  char* metadataString = GetMetadataString( robot );
+  FlightRecorder recorder = FlightRecorder_Create( robot->name, metadataString, columnsNumber, (const char**) columnNamesList, rowsNumber, 
+                                                   robot->flightMissesLimit, robot->flightMissesWindow );
+  free( metadataString );
   
-    if( robot.controlThread == THREAD_INVALID_HANDLE ) return false;
+  for( columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+    free( columnNamesList[ columnIndex ] );
+  free( columnNamesList );
+  
+  return recorder;
+}
+
+static bool InitControl( RobotData* robot, bool initController )
+{
+  // Handed over controllers are already initialized (in their current control state)
+  if( initController )
+  {
+    // Plugins may tokenize the configuration string in place, so always pass a fresh copy
+    free( robot->controllerConfigBuffer );
+    robot->controllerConfigBuffer = (char*) calloc( strlen( robot->controllerConfig ) + 1, sizeof(char) );
+    strcpy( robot->controllerConfigBuffer, robot->controllerConfig );
+    DEBUG_PRINT( "loading controller config %s", robot->controllerConfigBuffer ); 
+    if( !robot->InitController( robot->controllerConfigBuffer ) ) return false;
+    robot->controlState = CONTROL_PASSIVE;
   }
   
+  robot->isControllerReady = true;
+  
+  // Joints without configured actuators are kept with a NULL (inactive) actuator
+  size_t jointsNumber = robot->GetJointsNumber();
+  for( size_t jointIndex = jointsNumber; jointIndex < robot->jointsNumber; jointIndex++ )
+    Actuator_End( robot->actuatorsList[ jointIndex ] );
+  robot->actuatorsList = (Actuator*) realloc( robot->actuatorsList, ( jointsNumber + 1 ) * sizeof(Actuator) );
+  for( size_t jointIndex = robot->jointsNumber; jointIndex < jointsNumber; jointIndex++ )
+    robot->actuatorsList[ jointIndex ] = NULL;
+  robot->jointsNumber = jointsNumber;
+  
+  robot->jointLinearizersList = (LinearSystem*) calloc( robot->jointsNumber, sizeof(LinearSystem) );
+  DEBUG_PRINT( "found %lu joints", robot->jointsNumber );
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+    robot->jointLinearizersList[ jointIndex ] = SystemLinearizer_CreateSystem( 3, 1, LINEARIZATION_MAX_SAMPLES );
+
+  robot->axesNumber = robot->GetAxesNumber();
+  robot->axisTrajectoriesList = (TrajectoryQueue*) calloc( robot->axesNumber, sizeof(TrajectoryQueue) );
+  DEBUG_PRINT( "found %lu axes", robot->axesNumber );
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+    robot->axisTrajectoriesList[ axisIndex ] = TrajectoryQueue_Create( AXIS_TRAJECTORY_MAX_POINTS );
+  
+  size_t extraInputsNumber = robot->GetExtraInputsNumber();
+  for( size_t inputIndex = extraInputsNumber; inputIndex < robot->extraInputsNumber; inputIndex++ )
+    Input_End( robot->extraInputsList[ inputIndex ] );
+  robot->extraInputsList = (Input*) realloc( robot->extraInputsList, ( extraInputsNumber + 1 ) * sizeof(Input) );
+  for( size_t inputIndex = robot->extraInputsNumber; inputIndex < extraInputsNumber; inputIndex++ )
+    robot->extraInputsList[ inputIndex ] = NULL;
+  robot->extraInputsNumber = extraInputsNumber;
+  
+  size_t extraOutputsNumber = robot->GetExtraOutputsNumber();
+  for( size_t outputIndex = extraOutputsNumber; outputIndex < robot->extraOutputsNumber; outputIndex++ )
+    Output_End( robot->extraOutputsList[ outputIndex ] );
+  robot->extraOutputsList = (Output*) realloc( robot->extraOutputsList, ( extraOutputsNumber + 1 ) * sizeof(Output) );
+  for( size_t outputIndex = robot->extraOutputsNumber; outputIndex < extraOutputsNumber; outputIndex++ )
+    robot->extraOutputsList[ outputIndex ] = NULL;
+  robot->extraOutputsNumber = extraOutputsNumber;
+  
+  // Tables sizes are only known after controller initialization
+  CreateStateBlock( robot );
+  
+  robot->snapshotBuffer = TripleBuffer_Create( sizeof(RobotSnapshot) + ( robot->axesNumber + robot->jointsNumber ) * sizeof(DoFVariables) );
+  robot->currentSnapshot = (const RobotSnapshot*) TripleBuffer_Acquire( robot->snapshotBuffer, NULL );
+  robot->cycleIndex = 0;
+  
+  // Line length is only known after controller initialization
+  size_t logLineLength = 2 * robot->axesNumber * sizeof(DoFVariables) / sizeof(double) + robot->extraInputsNumber + robot->extraOutputsNumber;
+  if( robot->isBinaryLogEnabled ) robot->controlBinaryLog = CreateBinaryLog( robot, logLineLength );
+  else if( robot->isTextLogEnabled ) robot->controlLog = Log_Init( robot->isLogFileEnabled ? robot->name : "", robot->logPrecision );
+  robot->controlAsyncLog = AsyncLog_Create( robot->name, robot->controlLog, robot->controlBinaryLog, logLineLength, robot->logBufferLength, robot->logOverflowPolicy );
+  if( robot->hasLogFilter ) AsyncLog_SetFilter( robot->controlAsyncLog, &(robot->logFilter) );
+  AsyncLog_SetState( robot->controlAsyncLog, robot->controlState );
+  
+  robot->flightRecorder = CreateFlightRecorder( robot );
+  
   return true;
 }
 
+static void EndControl( RobotData* robot, bool endController )
+{
+  if( !robot->isControllerReady ) return;
+  
+  if( endController ) robot->EndController();
+  robot->isControllerReady = false;
+  
+  AsyncLog_Discard( robot->controlAsyncLog );
+  robot->controlAsyncLog = NULL;
+  BinaryLog_Discard( robot->controlBinaryLog );
+  robot->controlBinaryLog = NULL;
+  Log_End( robot->controlLog );
+  robot->controlLog = NULL;
+  FlightRecorder_Discard( robot->flightRecorder );
+  robot->flightRecorder = NULL;
+  
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+    SystemLinearizer_DeleteSystem( robot->jointLinearizersList[ jointIndex ] );
+  free( robot->jointLinearizersList );
+  
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+    TrajectoryQueue_Discard( robot->axisTrajectoriesList[ axisIndex ] );
+  free( robot->axisTrajectoriesList );
+  robot->axesNumber = 0;
+  
+  free( robot->stateBlock );
+  robot->stateBlock = NULL;
+  
+  TripleBuffer_Discard( robot->snapshotBuffer );
+  robot->snapshotBuffer = NULL;
+  robot->currentSnapshot = NULL;
+}
+
+static size_t AlignTableSize( size_t tableSize )
+{
+  return ( tableSize + STATE_TABLE_ALIGNMENT - 1 ) / STATE_TABLE_ALIGNMENT * STATE_TABLE_ALIGNMENT;
+}
+
+// Allocates contiguous (cache line aligned) tables for all DoF and extra signals state, and the per-DoF pointer views used by controller plug-ins
+static void CreateStateBlock( RobotData* robot )
+{
+  const size_t JOINTS_TABLE_SIZE = AlignTableSize( robot->jointsNumber * sizeof(DoFVariables) );
+  const size_t AXES_TABLE_SIZE = AlignTableSize( robot->axesNumber * sizeof(DoFVariables) );
+  const size_t INPUTS_TABLE_SIZE = AlignTableSize( robot->extraInputsNumber * sizeof(double) );
+  const size_t OUTPUTS_TABLE_SIZE = AlignTableSize( robot->extraOutputsNumber * sizeof(double) );
+  const size_t VIEWS_SIZE = 2 * ( robot->jointsNumber + robot->axesNumber ) * sizeof(DoFVariables*);
+  // Axis setpoints are also written by communication thread, and are kept on separate cache lines by table alignment
+  size_t blockSize = 2 * JOINTS_TABLE_SIZE + 2 * AXES_TABLE_SIZE + INPUTS_TABLE_SIZE + OUTPUTS_TABLE_SIZE + VIEWS_SIZE;
+  
+  // Extra space for manual alignment, as aligned allocation is not portable
+  robot->stateBlock = calloc( 1, blockSize + STATE_TABLE_ALIGNMENT );
+  uint8_t* tablePointer = (uint8_t*) robot->stateBlock;
+  tablePointer += ( STATE_TABLE_ALIGNMENT - (uintptr_t) tablePointer % STATE_TABLE_ALIGNMENT ) % STATE_TABLE_ALIGNMENT;
+  
+  robot->axisSetpointsTable = (DoFVariables*) tablePointer;
+  tablePointer += AXES_TABLE_SIZE;
+  robot->axisMeasuresTable = (DoFVariables*) tablePointer;
+  tablePointer += AXES_TABLE_SIZE;
+  robot->jointMeasuresTable = (DoFVariables*) tablePointer;
+  tablePointer += JOINTS_TABLE_SIZE;
+  robot->jointSetpointsTable = (DoFVariables*) tablePointer;
+  tablePointer += JOINTS_TABLE_SIZE;
+  robot->extraInputValuesList = (double*) tablePointer;
+  tablePointer += INPUTS_TABLE_SIZE;
+  robot->extraOutputValuesList = (double*) tablePointer;
+  tablePointer += OUTPUTS_TABLE_SIZE;
+  
+  DoFVariables** viewsList = (DoFVariables**) tablePointer;
+  robot->jointMeasuresList = viewsList;
+  robot->jointSetpointsList = viewsList + robot->jointsNumber;
+  robot->axisMeasuresList = viewsList + 2 * robot->jointsNumber;
+  robot->axisSetpointsList = viewsList + 2 * robot->jointsNumber + robot->axesNumber;
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    robot->jointMeasuresList[ jointIndex ] = &(robot->jointMeasuresTable[ jointIndex ]);
+    robot->jointSetpointsList[ jointIndex ] = &(robot->jointSetpointsTable[ jointIndex ]);
+  }
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+  {
+    robot->axisMeasuresList[ axisIndex ] = &(robot->axisMeasuresTable[ axisIndex ]);
+    robot->axisSetpointsList[ axisIndex ] = &(robot->axisSetpointsTable[ axisIndex ]);
+  }
+}
+
+static void SetupDevices( RobotData* robot, DataHandle configuration, RobotData* baseRobot )
+{
+  // Independent actuators (and their devices) may be set up in parallel, each one recording its configurations to the robot snapshot
+  ActuatorsLoad actuatorsLoad = { .robot = robot, .baseRobot = baseRobot, .snapshot = ConfigCache_GetSnapshot() };
+  actuatorsLoad.actuatorNamesList = (const char**) calloc( robot->jointsNumber, sizeof(const char*) );
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+    actuatorsLoad.actuatorNamesList[ jointIndex ] = DataIO_GetStringValue( configuration, "", KEY_ACTUATORS ".%lu", jointIndex );
+  WorkerPool_Run( robot->initWorkersNumber, LoadActuator, &actuatorsLoad, robot->jointsNumber );
+  // Errors are reported in joints order, regardless of loading order
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    if( robot->actuatorsList[ jointIndex ] == NULL ) 
+      DEBUG_PRINT( "failed loading actuator %s for joint %lu", actuatorsLoad.actuatorNamesList[ jointIndex ], jointIndex );
+  }
+  free( actuatorsLoad.actuatorNamesList );
+  
+  for( size_t inputIndex = 0; inputIndex < robot->extraInputsNumber; inputIndex++ )
+  {
+    Input baseInput = ( inputIndex < baseRobot->extraInputsNumber ) ? baseRobot->extraInputsList[ inputIndex ] : NULL;
+    robot->extraInputsList[ inputIndex ] = Input_Reload( baseInput, DataIO_GetSubData( configuration, KEY_EXTRA_INPUTS ".%lu", inputIndex ) );
+  }
+  
+  for( size_t outputIndex = 0; outputIndex < robot->extraOutputsNumber; outputIndex++ )
+  {
+    Output baseOutput = ( outputIndex < baseRobot->extraOutputsNumber ) ? baseRobot->extraOutputsList[ outputIndex ] : NULL;
+    robot->extraOutputsList[ outputIndex ] = Output_Reload( baseOutput, DataIO_GetSubData( configuration, KEY_EXTRA_OUTPUTS ".%lu", outputIndex ) );
+  }
+  
+  robot->hasDevices = true;
+}
+
+// Ends (or drops references to shared) actuators and extra inputs/outputs, keeping their lists
+static void ReleaseDevices( RobotData* robot )
+{
+  if( !robot->hasDevices ) return;
+  
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    Actuator_End( robot->actuatorsList[ jointIndex ] );
+    robot->actuatorsList[ jointIndex ] = NULL;
+  }
+  for( size_t inputIndex = 0; inputIndex < robot->extraInputsNumber; inputIndex++ )
+  {
+    Input_End( robot->extraInputsList[ inputIndex ] );
+    robot->extraInputsList[ inputIndex ] = NULL;
+  }
+  for( size_t outputIndex = 0; outputIndex < robot->extraOutputsNumber; outputIndex++ )
+  {
+    Output_End( robot->extraOutputsList[ outputIndex ] );
+    robot->extraOutputsList[ outputIndex ] = NULL;
+  }
+  
+  robot->hasDevices = false;
+}
+
+// Resets devices created or rebuilt for given robot, while the ones reused from the previous robot keep their offsets and state
+static void HandOffDevices( RobotData* robot, RobotData* lastRobot )
+{
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    Actuator lastActuator = ( jointIndex < lastRobot->jointsNumber ) ? lastRobot->actuatorsList[ jointIndex ] : NULL;
+    Actuator_Reset( robot->actuatorsList[ jointIndex ], lastActuator );
+  }
+  
+  for( size_t inputIndex = 0; inputIndex < robot->extraInputsNumber; inputIndex++ )
+  {
+    Input lastInput = ( inputIndex < lastRobot->extraInputsNumber ) ? lastRobot->extraInputsList[ inputIndex ] : NULL;
+    if( robot->extraInputsList[ inputIndex ] != lastInput ) Input_Reset( robot->extraInputsList[ inputIndex ] );
+  }
+  for( size_t outputIndex = 0; outputIndex < robot->extraOutputsNumber; outputIndex++ )
+  {
+    Output lastOutput = ( outputIndex < lastRobot->extraOutputsNumber ) ? lastRobot->extraOutputsList[ outputIndex ] : NULL;
+    if( robot->extraOutputsList[ outputIndex ] != lastOutput ) Output_Reset( robot->extraOutputsList[ outputIndex ] );
+  }
+}
+
+// Checks if control can keep running through reconfiguration, if the handed over controller can continue with all (shared or reloaded) actuators
+static bool ResumeControl( RobotData* robot, RobotData* lastRobot, bool wasControlRunning )
+{
+  bool isResumable = true;
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    if( robot->actuatorsList[ jointIndex ] == NULL ) continue;
+    Actuator baseActuator = ( jointIndex < lastRobot->jointsNumber ) ? lastRobot->actuatorsList[ jointIndex ] : NULL;
+    if( !Actuator_InheritState( robot->actuatorsList[ jointIndex ], baseActuator ) ) isResumable = false;
+  }
+  
+  if( !isResumable )
+  {
+    // Actuators with new devices require going through offset state again
+    DEBUG_PRINT( "robot %p actuators changed: restarting from passive state", robot );
+    robot->SetControlState( CONTROL_PASSIVE );
+    robot->controlState = CONTROL_PASSIVE;
+    AsyncLog_SetState( robot->controlAsyncLog, CONTROL_PASSIVE );
+    return false;
+  }
+  
+  if( !wasControlRunning ) return false;
+  
+  if( robot->axesNumber == lastRobot->axesNumber )
+    memcpy( robot->axisSetpointsTable, lastRobot->axisSetpointsTable, robot->axesNumber * sizeof(DoFVariables) );
+  
+  return true;
+}
+
+static void LoadActuator( void* ref_actuatorsLoad, size_t jointIndex )
+{
+  ActuatorsLoad* actuatorsLoad = (ActuatorsLoad*) ref_actuatorsLoad;
+  RobotData* baseRobot = actuatorsLoad->baseRobot;
+  
+  ConfigSnapshot lastSnapshot = ConfigCache_SetSnapshot( actuatorsLoad->snapshot );
+  Actuator baseActuator = ( jointIndex < baseRobot->jointsNumber ) ? baseRobot->actuatorsList[ jointIndex ] : NULL;
+  actuatorsLoad->robot->actuatorsList[ jointIndex ] = Actuator_Reload( baseActuator, actuatorsLoad->actuatorNamesList[ jointIndex ] );
+  (void) ConfigCache_SetSnapshot( lastSnapshot );
+}
+
+static void EnableActuator( void* ref_actuatorsEnable, size_t jointIndex )
+{
+  ActuatorsEnable* actuatorsEnable = (ActuatorsEnable*) ref_actuatorsEnable;
+  
+  actuatorsEnable->enabledList[ jointIndex ] = Actuator_Enable( actuatorsEnable->robot->actuatorsList[ jointIndex ] );
+}
+
+static bool StartControl( RobotData* robot )
+{
+  ActuatorsEnable actuatorsEnable = { .robot = robot };
+  actuatorsEnable.enabledList = (bool*) calloc( robot->jointsNumber, sizeof(bool) );
+  WorkerPool_Run( robot->initWorkersNumber, EnableActuator, &actuatorsEnable, robot->jointsNumber );
+  // Errors are checked in joints order, regardless of enabling order
+  size_t failedJointIndex = robot->jointsNumber;
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    if( !actuatorsEnable.enabledList[ jointIndex ] ) 
+    {
+      failedJointIndex = jointIndex;
+      break;
+    }
+  }
+  free( actuatorsEnable.enabledList );
+  if( failedJointIndex < robot->jointsNumber )
+  {
+    DEBUG_PRINT( "failed enabling actuator for joint %lu", failedJointIndex );
+    return false;
+  }
+  
+  if( !(robot->isControlRunning) )
+  {
+    robot->controlThread = Thread_Start( AsyncControl, robot, THREAD_JOINABLE );
+  
+    if( robot->controlThread == THREAD_INVALID_HANDLE ) return false;
+  }
+  
+  return true;
+}
+
+bool Robot_Enable()
+{ 
+  if( !activeRobot->isControllerReady ) return false;
+  
+  Robot_SetControlState( CONTROL_OFFSET );
+  
+  return StartControl( activeRobot );
+}
+
 bool Robot_Disable()
 {
-  if( robot.controlThread == THREAD_INVALID_HANDLE ) return false;
+  if( activeRobot->controlThread == THREAD_INVALID_HANDLE ) return false;
   
-  robot.isControlRunning = false;
-  Thread_WaitExit( robot.controlThread, 5000 );
-  robot.controlThread = THREAD_INVALID_HANDLE;
+  activeRobot->isControlRunning = false;
+  Thread_WaitExit( activeRobot->controlThread, 5000 );
+  activeRobot->controlThread = THREAD_INVALID_HANDLE;
   
-  for( size_t jointIndex = 0; jointIndex < robot.jointsNumber; jointIndex++ )
+  for( size_t jointIndex = 0; jointIndex < activeRobot->jointsNumber; jointIndex++ )
   {
     DoFVariables stopSetpoints = { 0.0 };
-    (void) Actuator_SetSetpoints( robot.actuatorsList[ jointIndex ], &stopSetpoints );
+    (void) Actuator_SetSetpoints( activeRobot->actuatorsList[ jointIndex ], &stopSetpoints );
     
-    Actuator_Disable( robot.actuatorsList[ jointIndex ] );
+    Actuator_Disable( activeRobot->actuatorsList[ jointIndex ] );
   }
   
   return true;
@@ -234,25 +871,28 @@ bool Robot_Disable()
 
 bool Robot_SetControlState( enum ControlState newState )
 {
-  if( newState == robot.controlState ) return false;
+  if( !activeRobot->isControllerReady ) return false;
+  
+  if( newState == activeRobot->controlState ) return false;
   
   if( newState >= CONTROL_STATES_NUMBER ) return false;
   
-  robot.SetControlState( newState );
+  activeRobot->SetControlState( newState );
   
-  for( size_t jointIndex = 0; jointIndex < robot.jointsNumber; jointIndex++ )
-    Actuator_SetControlState( robot.actuatorsList[ jointIndex ], newState );
+  for( size_t jointIndex = 0; jointIndex < activeRobot->jointsNumber; jointIndex++ )
+    Actuator_SetControlState( activeRobot->actuatorsList[ jointIndex ], newState );
   
-  robot.controlState = newState;
+  activeRobot->controlState = newState;
+  AsyncLog_SetState( activeRobot->controlAsyncLog, newState );
   
   return true;
 }
 
 const char* Robot_GetJointName( size_t jointIndex )
 {
-  if( jointIndex >= robot.jointsNumber ) return NULL;
+  if( jointIndex >= activeRobot->jointsNumber ) return NULL;
   
-  const char** jointNamesList = robot.GetJointNamesList();
+  const char** jointNamesList = activeRobot->GetJointNamesList();
   
   if( jointNamesList == NULL ) return NULL;
   
@@ -261,9 +901,9 @@ const char* Robot_GetJointName( size_t jointIndex )
 
 const char* Robot_GetAxisName( size_t axisIndex )
 {
-  if( axisIndex >= robot.axesNumber ) return NULL;
+  if( axisIndex >= activeRobot->axesNumber ) return NULL;
   
-  const char** axisNamesList = robot.GetAxisNamesList();
+  const char** axisNamesList = activeRobot->GetAxisNamesList();
   
   if( axisNamesList == NULL ) return NULL;
   
@@ -272,37 +912,95 @@ const char* Robot_GetAxisName( size_t axisIndex )
 
 bool Robot_GetJointMeasures( size_t jointIndex, DoFVariables* ref_measures )
 {
-  if( jointIndex >= robot.jointsNumber ) return false;
+  if( jointIndex >= activeRobot->jointsNumber ) return false;
   
-  *ref_measures = *(robot.jointMeasuresList[ jointIndex ]);
+  *ref_measures = activeRobot->jointMeasuresTable[ jointIndex ];
   
   return true;
 }
 
+bool Robot_UpdateSnapshot( unsigned long* ref_cycleIndex )
+{
+  if( activeRobot->snapshotBuffer == NULL ) return false;
+  
+  bool isNew;
+  activeRobot->currentSnapshot = (const RobotSnapshot*) TripleBuffer_Acquire( activeRobot->snapshotBuffer, &isNew );
+  
+  if( ref_cycleIndex != NULL ) *ref_cycleIndex = activeRobot->currentSnapshot->cycleIndex;
+  
+  return isNew;
+}
+
 bool Robot_GetAxisMeasures( size_t axisIndex, DoFVariables* ref_measures )
 {
-  if( axisIndex >= robot.axesNumber ) return false;
+  if( axisIndex >= activeRobot->axesNumber ) return false;
   
-  *ref_measures = *(robot.axisMeasuresList[ axisIndex ]);
+  *ref_measures = activeRobot->currentSnapshot->measuresList[ axisIndex ];
   
   return true;
 }
 
-void Robot_SetAxisSetpoints( size_t axisIndex, DoFVariables* ref_setpoints )
+const DoFVariables* Robot_GetAxisMeasuresList()
 {
-  if( axisIndex >= robot.axesNumber ) return;
+  if( activeRobot->currentSnapshot == NULL ) return NULL;
   
-  *(robot.axisSetpointsList[ axisIndex ]) = *ref_setpoints;
+  return activeRobot->currentSnapshot->measuresList;
+}
+
+void Robot_SetJointsSnapshot( bool enabled )
+{
+  atomic_store_explicit( &(activeRobot->isJointsSnapshotEnabled), enabled, memory_order_relaxed );
+}
+
+void Robot_SetCycleDurationsBuffer( double* durationsList, size_t durationsNumber )
+{
+  if( activeRobot->controlThread != THREAD_INVALID_HANDLE ) return;
+  
+  activeRobot->cycleDurationsList = ( durationsNumber > 0 ) ? durationsList : NULL;
+  activeRobot->cycleDurationsNumber = durationsNumber;
+}
+
+const DoFVariables* Robot_GetJointMeasuresList()
+{
+  if( activeRobot->currentSnapshot == NULL ) return NULL;
+  
+  if( !activeRobot->currentSnapshot->hasJointMeasures ) return NULL;
+  
+  return activeRobot->currentSnapshot->measuresList + activeRobot->axesNumber;
+}
+
+bool Robot_SetAxisSetpoints( size_t axisIndex, DoFVariables* ref_setpoints )
+{
+  if( axisIndex >= activeRobot->axesNumber ) return false;
+  
+  // Setpoints table is only written by the control thread: new values are passed as a single point already due
+  TrajectoryQueue trajectory = activeRobot->axisTrajectoriesList[ axisIndex ];
+  TrajectoryQueue_Clear( trajectory );
+  return TrajectoryQueue_Push( trajectory, Time_GetExecSeconds(), ref_setpoints );
+}
+
+void Robot_ClearAxisTrajectory( size_t axisIndex )
+{
+  if( axisIndex >= activeRobot->axesNumber ) return;
+  
+  TrajectoryQueue_Clear( activeRobot->axisTrajectoriesList[ axisIndex ] );
+}
+
+bool Robot_EnqueueAxisSetpoints( size_t axisIndex, double timeOffset, DoFVariables* ref_setpoints )
+{
+  if( axisIndex >= activeRobot->axesNumber ) return false;
+  
+  return TrajectoryQueue_Push( activeRobot->axisTrajectoriesList[ axisIndex ], Time_GetExecSeconds() + timeOffset, ref_setpoints );
 }
 
 size_t Robot_GetJointsNumber()
 {
-  return robot.jointsNumber;
+  return activeRobot->jointsNumber;
 }
 
 size_t Robot_GetAxesNumber()
 {
-  return robot.axesNumber;
+  return activeRobot->axesNumber;
 }
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -328,16 +1026,52 @@ void LinearizeDoF( DoFVariables* measures, DoFVariables* setpoints, LinearSystem
   }
 }
 
+void PublishRobotSnapshot( RobotData* robot, double execTime )
+{
+  RobotSnapshot* snapshot = (RobotSnapshot*) TripleBuffer_GetWriteData( robot->snapshotBuffer );
+  
+  snapshot->cycleIndex = ++(robot->cycleIndex);
+  snapshot->execTime = execTime;
+  memcpy( snapshot->measuresList, robot->axisMeasuresTable, robot->axesNumber * sizeof(DoFVariables) );
+  // Joint measures are only copied while some reader requested them
+  snapshot->hasJointMeasures = atomic_load_explicit( &(robot->isJointsSnapshotEnabled), memory_order_relaxed );
+  if( snapshot->hasJointMeasures ) 
+    memcpy( snapshot->measuresList + robot->axesNumber, robot->jointMeasuresTable, robot->jointsNumber * sizeof(DoFVariables) );
+  
+  TripleBuffer_Publish( robot->snapshotBuffer );
+}
+
 void LogRobotData( RobotData* robot, double execTime )
 {
-  Log_EnterNewLine( robot->controlLog, execTime );
+  if( !AsyncLog_EnterNewLine( robot->controlAsyncLog, execTime ) ) return;
     for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
     {
-      Log_RegisterList( robot->controlLog, sizeof(DoFVariables)/sizeof(double), (double*) robot->axisSetpointsList[ axisIndex ] );
-      Log_RegisterList( robot->controlLog, sizeof(DoFVariables)/sizeof(double), (double*) robot->axisMeasuresList[ axisIndex ] );
+      AsyncLog_RegisterList( robot->controlAsyncLog, sizeof(DoFVariables)/sizeof(double), (double*) &(robot->axisSetpointsTable[ axisIndex ]) );
+      AsyncLog_RegisterList( robot->controlAsyncLog, sizeof(DoFVariables)/sizeof(double), (double*) &(robot->axisMeasuresTable[ axisIndex ]) );
     }
-    Log_RegisterList( robot->controlLog, robot->extraInputsNumber, robot->extraInputValuesList );
-    Log_RegisterList( robot->controlLog, robot->extraOutputsNumber, robot->extraOutputValuesList );
+    AsyncLog_RegisterList( robot->controlAsyncLog, robot->extraInputsNumber, robot->extraInputValuesList );
+    AsyncLog_RegisterList( robot->controlAsyncLog, robot->extraOutputsNumber, robot->extraOutputValuesList );
+  AsyncLog_EndLine( robot->controlAsyncLog );
+}
+
+void RecordRobotState( RobotData* robot, double execTime, double cycleInterval, double cycleDuration )
+{
+  if( !FlightRecorder_EnterNewRow( robot->flightRecorder, execTime ) ) return;
+  const double cycleValuesList[] = { (double) robot->cycleIndex, cycleInterval, cycleDuration };
+  FlightRecorder_RegisterList( robot->flightRecorder, sizeof(cycleValuesList) / sizeof(double), cycleValuesList );
+  for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
+  {
+    FlightRecorder_RegisterList( robot->flightRecorder, sizeof(DoFVariables) / sizeof(double), (double*) &(robot->jointMeasuresTable[ jointIndex ]) );
+    FlightRecorder_RegisterList( robot->flightRecorder, sizeof(DoFVariables) / sizeof(double), (double*) &(robot->jointSetpointsTable[ jointIndex ]) );
+  }
+  for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+  {
+    FlightRecorder_RegisterList( robot->flightRecorder, sizeof(DoFVariables) / sizeof(double), (double*) &(robot->axisMeasuresTable[ axisIndex ]) );
+    FlightRecorder_RegisterList( robot->flightRecorder, sizeof(DoFVariables) / sizeof(double), (double*) &(robot->axisSetpointsTable[ axisIndex ]) );
+  }
+  FlightRecorder_RegisterList( robot->flightRecorder, robot->extraInputsNumber, robot->extraInputValuesList );
+  FlightRecorder_RegisterList( robot->flightRecorder, robot->extraOutputsNumber, robot->extraOutputValuesList );
+  FlightRecorder_EndRow( robot->flightRecorder );
 }
 
 static void* AsyncControl( void* ref_robot )
@@ -350,40 +1084,62 @@ static void* AsyncControl( void* ref_robot )
   
   DEBUG_PRINT( "starting to run control for robot %p on thread %lx", robot, Thread_GetID );
   
+  // Trace samples buffer is acquired before entering control cycles, which should only use memory preallocated by control initialization 
+  // (checked on allocation guard builds)
+  TracePoints_AttachThread();
+  AllocGuard_Enter( "AsyncControl" );
+  
   while( robot->isControlRunning )
   {
     elapsedTime = Time_GetExecSeconds() - execTime;
+    double cycleInterval = elapsedTime;
     
     execTime = Time_GetExecSeconds();
     
+    // Group all devices input reads and output writes of this cycle
+    DeviceRegistry_BeginTransfers();
+    
     for( size_t inputIndex = 0; inputIndex < robot->extraInputsNumber; inputIndex++ )
       robot->extraInputValuesList[ inputIndex ] = Input_Update( robot->extraInputsList[ inputIndex ] );
     robot->SetExtraInputsList( robot->extraInputValuesList );
     
     for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
-      (void) Actuator_GetMeasures( robot->actuatorsList[ jointIndex ], robot->jointMeasuresList[ jointIndex ], elapsedTime );
+      (void) Actuator_GetMeasures( robot->actuatorsList[ jointIndex ], &(robot->jointMeasuresTable[ jointIndex ]), elapsedTime );
 
     if( robot->controlState == CONTROL_OPERATION || robot->controlState == CONTROL_CALIBRATION )
     {
       for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
-        LinearizeDoF( robot->jointMeasuresList[ jointIndex ], robot->jointSetpointsList[ jointIndex ], robot->jointLinearizersList[ jointIndex ] );
+        LinearizeDoF( &(robot->jointMeasuresTable[ jointIndex ]), &(robot->jointSetpointsTable[ jointIndex ]), robot->jointLinearizersList[ jointIndex ] );
     }
 
+    for( size_t axisIndex = 0; axisIndex < robot->axesNumber; axisIndex++ )
+      (void) TrajectoryQueue_Pop( robot->axisTrajectoriesList[ axisIndex ], execTime, &(robot->axisSetpointsTable[ axisIndex ]) );
+
     robot->RunControlStep( robot->jointMeasuresList, robot->axisMeasuresList, robot->jointSetpointsList, robot->axisSetpointsList, elapsedTime );
 
     for( size_t jointIndex = 0; jointIndex < robot->jointsNumber; jointIndex++ )
-      (void) Actuator_SetSetpoints( robot->actuatorsList[ jointIndex ], robot->jointSetpointsList[ jointIndex ] );
+      (void) Actuator_SetSetpoints( robot->actuatorsList[ jointIndex ], &(robot->jointSetpointsTable[ jointIndex ]) );
 
     robot->GetExtraOutputsList( robot->extraOutputValuesList );
     for( size_t outputIndex = 0; outputIndex < robot->extraOutputsNumber; outputIndex++ )
       Output_Update( robot->extraOutputsList[ outputIndex ], robot->extraOutputValuesList[ outputIndex ] );
     
+    DeviceRegistry_EndTransfers();
+    
+    PublishRobotSnapshot( robot, execTime );
+    
     LogRobotData( robot, execTime );
     
     elapsedTime = Time_GetExecSeconds() - execTime;
+    RecordRobotState( robot, execTime, cycleInterval, elapsedTime );
+    if( robot->cycleDurationsList != NULL ) robot->cycleDurationsList[ robot->cycleIndex % robot->cycleDurationsNumber ] = elapsedTime;
+    if( elapsedTime > robot->controlTimeStep ) FlightRecorder_RegisterDeadlineMiss( robot->flightRecorder, robot->cycleIndex );
     if( elapsedTime < robot->controlTimeStep ) Time_Delay( (unsigned long) ( 1000 * ( robot->controlTimeStep - elapsedTime ) ) );
     //DEBUG_PRINT( "step time for robot %p: before delay=%.5fs, after delay=%.5fs", robot, elapsedTime, Time_GetExecSeconds() - execTime );
   }
   
+  AllocGuard_Exit();
+  TracePoints_DetachThread();
+  
   return NULL;
 }
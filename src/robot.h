@@ -25,7 +25,7 @@
 ///
 /// Interface for configurable robot control. Specific underlying implementation (plug-in) and further configuration are defined as explained in @ref robot_config.
 /// A robot works with 2 sets of coordinates: axes (read-write) and joints (read-only). For a detailed explanation, see @ref joint_axis_rationale.
-/// Even if RobotSystem handles one robot at a time, this code supports multiple robots for reusage in different applications.
+/// Even if RobotSystem controls one (active) robot at a time, other robots can be loaded in parallel (e.g. from a worker thread) and swapped in when ready.
 
 /// @page robot_config Robot Configuration
 /// The robot-level configuration (see [Configuration Levels](https://github.com/EESC-MKGroup/RobotSystem-Lite#robot-multi-level-configuration) is read using the [data I/O interface](https://labdin.github.io/Data-IO-Interface/data__io_8h.html). Configuration of listed joint actuators is loaded recursively (as described in @ref actuator_config)
@@ -44,6 +44,8 @@
 ///     "<actuator_1_id>",          // Actuator string identifier (configuration file name)
 ///     "<actuator_2_id>", ...      
 ///   ],
+///   "init_workers": 1,            // [o] Maximum number of actuators loaded and enabled at the same time. Devices of signal I/O plug-ins not declared 
+///                                 //     thread safe (see device_registry.h) are still set up one at a time
 ///   "extra_inputs": [             // [o] Additional inputs configuration (as for inputs in sensor configuration)
 ///     {
 ///       "interface": { ... },
@@ -56,9 +58,27 @@
 ///     }, ...
 ///   ]
 ///   "log": {                      // [o] Set logging of axis setpoint/measurement and extra input/output numeric data over time
+///     "format": "text",             // [o] Log format: "text" or "binary" (columnar file with header and time index, see @ref binary_log_format)
 ///     "to_file": false,             // [o] Save data logging to <log_dir>/[<user_name>-]<robot_name>-<time_stamp>.log, to log file 
-///                                   //     Default value will set terminal logging
-///     "precision": 3                // [o] Decimal precision for logged numeric values
+///                                   //     Default value will set terminal logging (binary logs are always saved to .blog file)
+///     "precision": 3,               // [o] Decimal precision for logged numeric values (binary logs use single precision values up to 6)
+///     "compression": "none",        // [o] Binary log column compression: "none", "delta" (quantized to given precision) or "xor" (lossless), as in log_codec.h
+///     "buffer_length": 1024,        // [o] Number of lines buffered for the (asynchronous) log writer
+///     "overflow": "drop_newest",    // [o] Lines dropped when buffer is full: "drop_newest" or "drop_oldest"
+///     "decimation": 1,              // [o] Number of control cycles combined into each logged line
+///     "aggregation": "last",        // [o] Combination of decimated values: "last", "mean", "min" or "max"
+///     "trigger": {                  // [o] Log only while all given conditions hold
+///       "state": "operation",         // [o] Required robot control state: "passive", "offset", "calibration", "preprocessing" or "operation"
+///       "value": 3,                   // [o] Index of logged value (in line order: axis setpoints and measures, extra inputs and outputs) checked against thresholds
+///       "above": 10.0,                // [o] Minimum (exclusive) checked value
+///       "below": 100.0,               // [o] Maximum (exclusive) checked value
+///       "pre_trigger": 0              // [o] Number of (decimated) lines preceding trigger activation that are also logged
+///     }
+///   },
+///   "flight_recorder": {          // [o] Keep last control cycles data (timing, joint and axis measures/setpoints, extra inputs/outputs) in memory, see flight_recorder.h
+///     "duration": 5.0,              // [o] Length of kept history, in seconds (rows number is duration/time_step)
+///     "deadline_misses": 10,        // [o] Number of cycles running longer than time step, inside window, that trigger a history dump (0 disables)
+///     "misses_window": 100          // [o] Deadline misses window length, in cycles
 ///   }
 /// }
 /// @endcode
@@ -71,15 +91,53 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+typedef struct _RobotData RobotData;    ///< Single robot internal data structure
+typedef RobotData* Robot;               ///< Opaque reference to robot internal data structure
+
                   
-/// @brief Creates and initializes robot data structure based on given information                                              
+/// @brief Loads robot configuration and initializes it as the active robot (equivalent to Robot_Load() followed by Robot_Swap())                                              
 /// @param[in] configPathName path to robot configuration, as explained at @ref robot_config
 /// @return true on successful initialization, false otherwise
 bool Robot_Init( const char* configPathName );
 
-/// @brief Deallocates internal data of given robot                        
+/// @brief Deactivates and deallocates internal data of active robot                        
 void Robot_End();
 
+/// @brief Creates robot data structure, loads its configuration and plugin, and sets up its devices, without affecting the active robot (safe to call from a worker thread, but not concurrently with Robot_Swap())
+///
+/// Devices (actuators, with their sensors and motors, and extra inputs/outputs) whose configuration did not change are shared with the active robot instead of created again, 
+/// so that reloading a configuration only rebuilds what was actually modified. The active robot may keep running meanwhile, as setup calls of signal I/O plug-ins 
+/// not declared thread safe are serialized with its transfers (see device_registry.h)
+/// @param[in] configPathName path to robot configuration, as explained at @ref robot_config
+/// @return reference/pointer to newly loaded (inactive) robot data structure (NULL on errors)
+Robot Robot_Load( const char* configPathName );
+
+/// @brief Keeps devices of given (inactive) loaded robot while it is not in use, so that it may be activated again without loading
+///
+/// Prepared robots may be activated after any other one, so they are always activated with a newly initialized controller. 
+/// Controller and control data (state tables, trajectory queues and logs) are still initialized on activation, as plugin state may be shared with the active robot
+/// @param[in] robot reference to loaded robot
+/// @return true if robot is prepared, false if given robot is invalid
+bool Robot_Prepare( Robot robot );
+
+/// @brief Deactivates the currently active robot and initializes the controller of given one in its place (must be called from the thread calling other Robot_* functions)
+///
+/// Controllers of another plug-in are initialized before the current robot is stopped, and of the same plug-in (only loaded once) after its controller is ended. 
+/// On failures, the current robot is kept active (with its controller initialized again, if needed) and running if it was. Only then devices created or rebuilt 
+/// for given robot are reset (as they may be shared with the previous robot), and devices of the previous robot (if not prepared) released, before control starts again.
+///
+/// When given robot was loaded from the currently active one with the same controller configuration, the controller plug-in state is handed over instead of reinitialized, 
+/// and control keeps running (in the same state) if all reloaded actuators share the previous sensors and motors
+/// @param[in] robot reference to loaded robot (NULL to only deactivate current one)
+/// @param[out] ref_lastRobot pointer to reference where robot no longer in use (previously active one, if any) is stored. Even on failures, the previous robot is 
+/// stored here (deactivated) if its controller could not be initialized again. Robots are never unloaded here
+/// @return true if given robot is active, false on failures, when given robot is not activated (and still owned by caller)
+bool Robot_Swap( Robot robot, Robot* ref_lastRobot );
+
+/// @brief Deallocates internal data of given (inactive) robot, ending its remaining devices
+/// @param[in] robot reference to loaded robot (ignored if NULL)
+void Robot_Unload( Robot robot );
+
 /// @brief Initializes (if not running) update/operation thread for the given robot
 /// @return true if control state was changed, false otherwise
 bool Robot_Enable();
@@ -109,16 +167,52 @@ const char* Robot_GetAxisName( size_t axisIndex );
 /// @return true on if new values were acquired, false otherwise
 bool Robot_GetJointMeasures( size_t jointIndex, DoFVariables* ref_measures );
 
-/// @brief Gets current value of specified axis measurements (see @ref joint_axis_rationale)          
+/// @brief Acquires latest consistent state snapshot published by the control thread, read by subsequent Robot_GetAxisMeasures() calls
+/// @param[out] ref_cycleIndex pointer to variable where index of control cycle in which snapshot was taken will be stored (ignored if NULL)
+/// @return true if a new snapshot was published since last call, false otherwise
+bool Robot_UpdateSnapshot( unsigned long* ref_cycleIndex );
+
+/// @brief Gets value of specified axis measurements from current state snapshot (see @ref joint_axis_rationale)          
 /// @param[in] axisIndex index of robot axis (in the order listed on robot's configuration)
 /// @param[out] ref_measures pointer/reference to variables structure where values will be stored
 /// @return true on if new values were acquired, false otherwise
 bool Robot_GetAxisMeasures( size_t axisIndex, DoFVariables* ref_measures );
 
-/// @brief Sets value of specified setpoint for given axis       
+/// @brief Gets measurements of all axes from current state snapshot (see Robot_UpdateSnapshot())
+/// @return pointer to list of Robot_GetAxesNumber() axis measurements, valid until next snapshot update (NULL if no robot is loaded)
+const DoFVariables* Robot_GetAxisMeasuresList();
+
+/// @brief Enables or disables copying of joint measurements to published state snapshots (disabled by default, to spare control thread work)
+/// @param[in] enabled true if joint measurements should be included in following snapshots, false otherwise
+void Robot_SetJointsSnapshot( bool enabled );
+
+/// @brief Sets storage for the duration of each following control cycle (e.g. for benchmarking). Ignored while control is running
+/// @param[in] durationsList preallocated list where cycle durations (in seconds) are stored, indexed by cycle index modulo durationsNumber (NULL disables)
+/// @param[in] durationsNumber length of durationsList
+void Robot_SetCycleDurationsBuffer( double* durationsList, size_t durationsNumber );
+
+/// @brief Gets measurements of all joints from current state snapshot (see Robot_UpdateSnapshot() and Robot_SetJointsSnapshot())
+/// @return pointer to list of Robot_GetJointsNumber() joint measurements, valid until next snapshot update (NULL if snapshot does not include joints)
+const DoFVariables* Robot_GetJointMeasuresList();
+
+/// @brief Sets value of specified setpoint for given axis, discarding its pending trajectory setpoints
+///
+/// New setpoints are scheduled as a single trajectory point already due, so that only the control thread writes the setpoints table (applied on its next cycle)
 /// @param[in] axisIndex index of robot axis (in the order listed on robot's configuration)
 /// @param[in] ref_setpoints pointer/reference to variables structure with the new setpoints
-void Robot_SetAxisSetpoints( size_t axisIndex, DoFVariables* ref_setpoints );
+/// @return true if setpoints were scheduled, false on invalid axis or trajectory buffer still full of points not yet skipped by the control thread
+bool Robot_SetAxisSetpoints( size_t axisIndex, DoFVariables* ref_setpoints );
+
+/// @brief Discards pending (not yet due) trajectory setpoints for given axis
+/// @param[in] axisIndex index of robot axis (in the order listed on robot's configuration)
+void Robot_ClearAxisTrajectory( size_t axisIndex );
+
+/// @brief Schedules future setpoints for given axis, applied by the control thread in the first cycle after they become due
+/// @param[in] axisIndex index of robot axis (in the order listed on robot's configuration)
+/// @param[in] timeOffset delay (in seconds, from current time) after which setpoints should be applied
+/// @param[in] ref_setpoints pointer/reference to variables structure with the future setpoints
+/// @return true if setpoints were scheduled, false on invalid axis or full trajectory buffer
+bool Robot_EnqueueAxisSetpoints( size_t axisIndex, double timeOffset, DoFVariables* ref_setpoints );
 
 /// @brief Calls underlying (plugin) implementation to get number of joint degrees-of-freedom for given robot        
 /// @return number of joint degrees-of-freedom
@@ -23,6 +23,9 @@
 #include "sensor.h"
 
 #include "input.h"
+#include "trace_points.h"
+#include "async_log.h"
+#include "config_cache.h"
 
 #include "tinyexpr/tinyexpr.h"
 
@@ -34,6 +37,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,6 +52,11 @@ struct _SensorData
   te_variable* inputVariables;
   te_expr* transformFunction;
   Log log;
+  AsyncLog asyncLog;
+  TracePoint tracePoint;
+  char* name;
+  char* configString;
+  atomic_size_t referencesCount;
 };
 
 Sensor Sensor_Init( const char* configName )
@@ -55,11 +64,15 @@ Sensor Sensor_Init( const char* configName )
   char filePath[ DATA_IO_MAX_PATH_LENGTH ];
   DEBUG_PRINT( "trying to create sensor %s", configName );
   sprintf( filePath, KEY_CONFIG "/" KEY_SENSORS "/%s", configName );
-  DataHandle configuration = DataIO_LoadStorageData( filePath );
+  DataHandle configuration = ConfigCache_Load( filePath );
   if( configuration == NULL ) return NULL;
   //DEBUG_PRINT( "sensor configuration found on data handle %p", configuration );
   Sensor newSensor = (Sensor) malloc( sizeof(SensorData) );
-  memset( newSensor, 0, sizeof(SensorData) );  
+  memset( newSensor, 0, sizeof(SensorData) );
+  newSensor->name = (char*) calloc( strlen( configName ) + 1, sizeof(char) );
+  strcpy( newSensor->name, configName );
+  newSensor->configString = DataIO_GetDataString( configuration );
+  atomic_init( &(newSensor->referencesCount), 1 );  
   
   bool loadSuccess = true;
   DEBUG_PRINT( "inputs number: %lu", DataIO_GetListSize( configuration, KEY_INPUTS ) );
@@ -70,7 +83,6 @@ Sensor Sensor_Init( const char* configName )
   for( size_t inputIndex = 0; inputIndex < newSensor->inputsNumber; inputIndex++ )
   {
     newSensor->inputsList[ inputIndex ] = Input_Init( DataIO_GetSubData( configuration, KEY_INPUTS ".%lu", inputIndex ) );
-    Input_Reset( newSensor->inputsList[ inputIndex ] );
     loadSuccess = ! Input_HasError( newSensor->inputsList[ inputIndex ] );
     DEBUG_PRINT( "loading input %lu success: %s", inputIndex, loadSuccess ? "true" : "false" );
     newSensor->inputVariables[ inputIndex ].name = INPUT_VARIABLE_NAMES[ inputIndex ];
@@ -82,11 +94,28 @@ Sensor Sensor_Init( const char* configName )
   newSensor->transformFunction = te_compile( transformExpression, newSensor->inputVariables, newSensor->inputsNumber, &expressionError );
   if( expressionError > 0 ) loadSuccess = false;
   DEBUG_PRINT( "transform function: out= %s (error: %d)", transformExpression, expressionError );    
-  if( DataIO_HasKey( configuration, KEY_LOG ) )
+  // Logged on every reading, so it must be explicitly enabled
+  if( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_ENABLED ) )
+  {
     newSensor->log = Log_Init( DataIO_GetBooleanValue( configuration, false, KEY_LOG "." KEY_FILE ) ? configName : "", 
                                (size_t) DataIO_GetNumericValue( configuration, 3, KEY_LOG "." KEY_PRECISION ) );
+    // Inputs followed by output
+    newSensor->asyncLog = AsyncLog_Create( configName, newSensor->log, NULL, newSensor->inputsNumber + 1, 
+                                           (size_t) DataIO_GetNumericValue( configuration, ASYNC_LOG_DEFAULT_BUFFER_LENGTH, KEY_LOG "." KEY_BUFFER_LENGTH ),
+                                           AsyncLog_ParseOverflowPolicy( DataIO_GetStringValue( configuration, "", KEY_LOG "." KEY_OVERFLOW ) ) );
+    AsyncLogFilter logFilter;
+    if( AsyncLog_LoadFilter( configuration, &logFilter ) ) 
+    {
+      // Devices have no control state to be checked
+      if( logFilter.triggerState >= 0 ) DEBUG_PRINT( "log trigger state ignored for %s", configName );
+      logFilter.triggerState = -1;
+      AsyncLog_SetFilter( newSensor->asyncLog, &logFilter );
+    }
+  }
   
-  DataIO_UnloadData( configuration );
+  newSensor->tracePoint = TracePoint_Register( KEY_SENSORS, configName );
+  
+  ConfigCache_Unload( configuration );
   //DEBUG_PRINT( "loading success: %s", loadSuccess ? "true" : "false" );
   if( !loadSuccess )
   {
@@ -97,10 +126,34 @@ Sensor Sensor_Init( const char* configName )
   return newSensor;
 }
 
+bool Sensor_HasConfig( Sensor sensor, const char* configName )
+{
+  char filePath[ DATA_IO_MAX_PATH_LENGTH ];
+  
+  if( sensor == NULL ) return false;
+  
+  if( strcmp( sensor->name, configName ) != 0 ) return false;
+  
+  sprintf( filePath, KEY_CONFIG "/" KEY_SENSORS "/%s", configName );
+  return ConfigCache_HasData( filePath, sensor->configString );
+}
+
+Sensor Sensor_Reload( Sensor baseSensor, const char* configName )
+{
+  if( !Sensor_HasConfig( baseSensor, configName ) ) return Sensor_Init( configName );
+  
+  DEBUG_PRINT( "reusing sensor %s", configName );
+  atomic_fetch_add( &(baseSensor->referencesCount), 1 );
+  
+  return baseSensor;
+}
+
 void Sensor_End( Sensor sensor )
 {
   if( sensor == NULL ) return;
   
+  if( atomic_fetch_sub( &(sensor->referencesCount), 1 ) > 1 ) return;
+  
   for( size_t inputIndex = 0; inputIndex < sensor->inputsNumber; inputIndex++ )
     Input_End( sensor->inputsList[ inputIndex ] );
   free( sensor->inputsList );
@@ -109,8 +162,14 @@ void Sensor_End( Sensor sensor )
   
   if( sensor->transformFunction != NULL ) te_free( sensor->transformFunction );
   
+  AsyncLog_Discard( sensor->asyncLog );
   Log_End( sensor->log );
   
+  TracePoint_Unregister( sensor->tracePoint );
+  
+  free( sensor->name );
+  free( sensor->configString );
+  
   free( sensor );
 }
 
@@ -122,14 +181,26 @@ double Sensor_Update( Sensor sensor )
     sensor->inputValuesList[ inputIndex ] = Input_Update( sensor->inputsList[ inputIndex ] );
    
   double sensorOutput = te_eval( sensor->transformFunction );
-  //if( sensor->inputsNumber > 1 ) DEBUG_PRINT( "in0=%.5f, in1=%.5f, out=%.5f", sensor->inputValuesList[ 0 ], sensor->inputValuesList[ 1 ], sensorOutput );
-  //Log_EnterNewLine( sensor->log, Time_GetExecSeconds() );
-  //Log_RegisterList( sensor->log, sensor->inputsNumber, sensor->inputValuesList );
-  //Log_RegisterValues( sensor->log, 1, sensorOutput ); 
+  // Raw inputs followed by transformed output
+  TRACE_POINT( sensor->tracePoint, sensor->inputsNumber, sensor->inputValuesList, 1, sensorOutput );
+  if( sensor->asyncLog != NULL && AsyncLog_EnterNewLine( sensor->asyncLog, Time_GetExecSeconds() ) )
+  {
+    AsyncLog_RegisterList( sensor->asyncLog, sensor->inputsNumber, sensor->inputValuesList );
+    AsyncLog_RegisterList( sensor->asyncLog, 1, &sensorOutput );
+    AsyncLog_EndLine( sensor->asyncLog );
+  }
   
   return sensorOutput;
 }
 
+void Sensor_Reset( Sensor sensor )
+{
+  if( sensor == NULL ) return;
+  
+  for( size_t inputIndex = 0; inputIndex < sensor->inputsNumber; inputIndex++ )
+    Input_Reset( sensor->inputsList[ inputIndex ] );
+}
+
 void SetState( Sensor sensor, enum SigProcState newProcessingState )
 {
   if( sensor == NULL ) return;
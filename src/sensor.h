@@ -51,9 +51,20 @@
 ///   "output": "in0",                          // [o] String with math expression for conversion from sensor inputs to output (like "tanh( in0 - in1 )")
 ///                                             //     Possible operations are the ones supported by TinyExpr library: https://codeplea.com/tinyexpr
 ///   "log": {                                  // [o] Set logging of inputs and measurement numeric data over time
+///     "enabled": false,                         // [o] Log every reading (disabled by default, as readings happen on every control cycle)
 ///     "to_file": false,                         // [o] Save data logging to <log_dir>/[<user_name>-]<sensor_name>-<time_stamp>.log, to log file 
 ///                                               //     Default value will set terminal logging
-///     "precision": 3                            // [o] Decimal precision for logged numeric values
+///     "precision": 3,                           // [o] Decimal precision for logged numeric values
+///     "buffer_length": 1024,                    // [o] Number of lines buffered for the (asynchronous) log writer
+///     "overflow": "drop_newest",                // [o] Lines dropped when buffer is full: "drop_newest" or "drop_oldest"
+///     "decimation": 1,                          // [o] Number of readings combined into each logged line
+///     "aggregation": "last",                    // [o] Combination of decimated values: "last", "mean", "min" or "max"
+///     "trigger": {                              // [o] Log only while logged value is inside thresholds
+///       "value": 0,                               // [o] Index of logged value (inputs followed by output) checked against thresholds ("state" is ignored)
+///       "above": 10.0,                            // [o] Minimum (exclusive) checked value
+///       "below": 100.0,                           // [o] Maximum (exclusive) checked value
+///       "pre_trigger": 0                          // [o] Number of (decimated) lines preceding trigger activation that are also logged
+///     }
 ///   }
 /// }
 /// @endcode
@@ -74,7 +85,19 @@ typedef SensorData* Sensor;               ///< Opaque reference to sensor intern
 /// @return reference/pointer to newly created and initialized sensor data structure
 Sensor Sensor_Init( const char* configName );
 
-/// @brief Deallocates internal data of given sensor                        
+/// @brief Checks whether given sensor was created from the current contents of specified configuration
+/// @param[in] sensor reference to sensor
+/// @param[in] configName name of file containing configuration parameters, as explained at @ref sensor_config
+/// @return true if configuration is unchanged since sensor creation, false otherwise
+bool Sensor_HasConfig( Sensor sensor, const char* configName );
+
+/// @brief Gets sensor for given configuration, sharing given (possibly running) sensor instead if its configuration is unchanged (see Sensor_HasConfig())
+/// @param[in] baseSensor reference to existing sensor (ignored if NULL)
+/// @param[in] configName name of file containing configuration parameters, as explained at @ref sensor_config
+/// @return reference to shared base sensor (keeping its offset and processing state), or to newly created sensor (NULL on errors)
+Sensor Sensor_Reload( Sensor baseSensor, const char* configName );
+
+/// @brief Releases given sensor reference, deallocating its internal data if no longer shared
 /// @param[in] sensor reference to sensor
 void Sensor_End( Sensor sensor );
 
@@ -24,13 +24,31 @@
 /// @brief RobotSystem-Lite clients request/receive interface
 ///
 /// Messages transporting online update values for robot DoFs ([axes or joints](https://github.com/EESC-MKGroup/Robot-Control-Interface#the-jointaxis-rationale)) control variables should arrive as quickly as possible, and there is no advantage in resending lost packets, as their validity is short in time. 
-/// Thereby, these messages are exchanged with RobotSystem-Lite through lower-latency UDP sockets, on port 50001 for axes and 50002 for joints. 
+/// Thereby, these messages are exchanged with RobotSystem-Lite through lower-latency UDP sockets, on port 50001 (joint measurements, when enabled with ROBOT_REQ_STREAM_JOINTS, share the same connection). 
 /// Measurements for both axes and joints go from the main application to its clients, axes setpoints go in the opposite direction. 
 /// Messages consist of byte and [single precision floating-point](https://en.wikipedia.org/wiki/Single-precision_floating-point_format) arrays (to prevent string parsing overhead), with data organized like:
 ///
 /// DoFs number | Index 1 | Position | Velocity |  Force  | Acceleration | Inertia | Damping | Stiffness | Index 2 | ...
 /// :---------: | :-----: | :------: | :------: | :-----: | :----------: | :-----: | :-----: | :-------: | :-----: | :-:
 ///    1 byte   | 1 byte  | 4 bytes  | 4 bytes  | 4 bytes |   4 bytes    | 4 bytes | 4 bytes |  4 bytes  | 1 byte  | ...
+///
+/// Setpoint messages may also carry trajectory chunks: batches of future setpoints for a single axis, buffered by the server and applied at control cycle resolution.
+/// A trajectory block is marked by the DOF_TRAJECTORY_BLOCK_FLAG bit on its index byte, followed by the number of points and, for each point, its time offset (in seconds, from message arrival) and DoF values.
+/// Each trajectory block replaces the pending points of its axis, as does a regular setpoint block:
+///
+/// DoFs number | Index 1 + flag | Points number | Time offset | Position | ... | Stiffness | Time offset | Position | ... | Index 2 | ...
+/// :---------: | :------------: | :-----------: | :---------: | :------: | :-: | :-------: | :---------: | :------: | :-: | :-----: | :-:
+///    1 byte   |     1 byte     |    1 byte     |   4 bytes   | 4 bytes  | ... |  4 bytes  |   4 bytes   | 4 bytes  | ... | 1 byte  | ...
+///
+/// The single message format above holds up to 17 DoFs. Robots with more DoFs use extended frames, split in fragments (separate messages) identified by a zero first byte (never a valid DoFs number).
+/// All fragments of a frame share the same frame ID (the control cycle index, for measurements), so that receivers reassemble and apply only complete and consistent frames.
+/// Extended blocks use 2-byte indexes, with DOF_EXTENDED_TRAJECTORY_BLOCK_FLAG marking trajectory chunks (laid out as above):
+///
+/// Marker (0) | Frame ID | Fragment index | Fragments number | Blocks number | Index 1 | Position | ... | Stiffness | Index 2 | ...
+/// :--------: | :------: | :------------: | :--------------: | :-----------: | :-----: | :------: | :-: | :-------: | :-----: | :-:
+///   1 byte   | 4 bytes  |     1 byte     |      1 byte      |    1 byte     | 2 bytes | 4 bytes  | ... |  4 bytes  | 2 bytes | ...
+///
+/// Joint measurements are always sent as extended frames, identified by a DOF_JOINTS_FRAME_MARKER first byte instead (so that they can be filtered/subscribed separately), and use the control cycle index of the axis frame sent in the same update as frame ID.
 
 
 #ifndef SHARED_DOF_VARIABLES_H
@@ -41,4 +59,13 @@ enum RobotDoFVariable { DOF_POSITION, DOF_VELOCITY, DOF_FORCE, DOF_ACCELERATION,
 
 #define DOF_DATA_BLOCK_SIZE DOF_FLOATS_NUMBER * sizeof(float)   ///< Size in bytes of all floating-point values for a single DoF update message
 
+#define DOF_TRAJECTORY_BLOCK_FLAG 0x80                                      ///< Index byte bit marking a setpoints block as a trajectory chunk
+#define DOF_TRAJECTORY_POINT_SIZE ( sizeof(float) + DOF_DATA_BLOCK_SIZE )   ///< Size in bytes of a single time-stamped trajectory point
+
+#define DOF_EXTENDED_FRAME_MARKER 0x00                ///< First byte of extended (fragmented) frame messages
+#define DOF_JOINTS_FRAME_MARKER 0xFF                  ///< First byte of extended frame messages carrying joint measurements
+#define DOF_EXTENDED_HEADER_SIZE 8                    ///< Size in bytes of extended frame header (marker, frame ID, fragment index, fragments number and blocks number)
+#define DOF_EXTENDED_INDEX_SIZE 2                     ///< Size in bytes of DoF index on extended frame blocks
+#define DOF_EXTENDED_TRAJECTORY_BLOCK_FLAG 0x8000     ///< Extended index bit marking a setpoints block as a trajectory chunk
+
 #endif // SHARED_DOF_VARIABLES_H
@@ -1,70 +1,93 @@
-////////////////////////////////////////////////////////////////////////////////
-//                                                                            //
-//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
-//                                                                            //
-//  This file is part of RobotSystem-Lite.                                    //
-//                                                                            //
-//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
-//  it under the terms of the GNU Lesser General Public License as published  //
-//  by the Free Software Foundation, either version 3 of the License, or      //
-//  (at your option) any later version.                                       //
-//                                                                            //
-//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
-//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
-//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
-//  GNU Lesser General Public License for more details.                       //
-//                                                                            //
-//  You should have received a copy of the GNU Lesser General Public License  //
-//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
-//                                                                            //
-////////////////////////////////////////////////////////////////////////////////
-
-
-/// @file shared_robot_control.h
-/// @brief RobotSystem-Lite clients request/receive interface
-///
-/// Messages requesting state changes or information about the robot are sent by clients occasionally and their arrival should be as guaranteed as possible. Therefore, these messages are transmitted to the server through TCP sockets, on port 50000.
-
-
-#ifndef SHARED_ROBOT_CONTROL_H
-#define SHARED_ROBOT_CONTROL_H
-
-/// Single byte codes used in request/receive messages for robot state/configuration control
-enum RobotControlCode { 
-       /// Request information about available robot configurations
-       ROBOT_REQ_LIST_CONFIGS = 1,
-       /// Reply code for ROBOT_REQ_LIST_CONFIGS. Followed, in the same message, by a JSON-format string like:
-       /// @code
-       /// { "robots":[ "<available_robot1_name>", "<available_robot2_name>", :"<available_robot3_name>" ] }
-       /// @endcode
-        ROBOT_REP_CONFIGS_LISTED = ROBOT_REQ_LIST_CONFIGS,
-       /// Request information about current robot configuration, its available [axes and joints](https://github.com/EESC-MKGroup/Robot-Control-Interface#the-jointaxis-rationale))
-       ROBOT_REQ_GET_CONFIG,
-       /// Reply code for ROBOT_REQ_GET_CONFIG. Followed, in the same message, by a JSON-format string like:
-       /// @code
-       /// { "id":"<robot_name>", "axes":[ "<axis1_name>", "<axis2_name>" ], "joints":[ "<joint1_name>", "<joint2_name>" ] }
-       /// @endcode
-       ROBOT_REP_GOT_CONFIG = ROBOT_REQ_GET_CONFIG,
-       ROBOT_REQ_SET_CONFIG,                            ///< Request setting new @ref robot_config, reloading all parameters. Must be followed, in the same message, by a string with the new @ref robot_config name
-       ROBOT_REP_CONFIG_SET = ROBOT_REQ_SET_CONFIG,     ///< Confirmation reply to ROBOT_REQ_SET_CONFIG. Followed by the same JSON string type as in ROBOT_REP_GOT_CONFIG
-       ROBOT_REQ_SET_USER,                              ///< Request setting new user/folder name for [data logging](https://github.com/EESC-MKGroup/Simple-Data-Logging). Must be followed, in the same message, by a string with the name
-       ROBOT_REP_USER_SET = ROBOT_REQ_SET_USER,         ///< Confirmation reply to ROBOT_REQ_SET_USER
-       ROBOT_REQ_DISABLE,                               ///< Request turning off the robot and stopping its control thread
-       ROBOT_REP_DISABLED = ROBOT_REQ_DISABLE,          ///< Confirmation reply to ROBOT_REQ_DISABLE
-       ROBOT_REQ_ENABLE,                                ///< Request turning on the robot and starting its control thread
-       ROBOT_REP_ENABLED = ROBOT_REQ_ENABLE,            ///< Confirmation reply to ROBOT_REQ_ENABLE
-       ROBOT_REQ_PASSIVATE,                             ///< Request setting robot to a fully compliant control state (passed on to control implementation)
-       ROBOT_REP_PASSIVE = ROBOT_REQ_PASSIVATE,         ///< Confirmation reply to ROBOT_REQ_PASSIVATE
-       ROBOT_REQ_OFFSET,                                ///< Request setting robot to offset measurement state (passed on to control implementation)
-       ROBOT_REP_OFFSETTING = ROBOT_REQ_OFFSET,         ///< Confirmation reply to ROBOT_REQ_OFFSET
-       ROBOT_REQ_CALIBRATE,                             ///< Request setting robot to motion range measurement state (passed on to control implementation)
-       ROBOT_REP_CALIBRATING = ROBOT_REQ_CALIBRATE,     ///< Confirmation reply to ROBOT_REQ_CALIBRATE
-       ROBOT_REQ_OPERATE,                               ///< Request setting robot to normal operation state (passed on to control implementation)
-       ROBOT_REP_OPERATING = ROBOT_REQ_OPERATE,         ///< Confirmation reply to ROBOT_REQ_OPERATE
-       ROBOT_REQ_PREPROCESS,                            ///< Request setting robot to implementation-specific pre-operation state (passed on to control implementation)
-       ROBOT_REP_PREPROCESSING = ROBOT_REQ_PREPROCESS,  ///< Confirmation reply to ROBOT_REQ_PREPROCESS
-       ROBOT_REQ_RESET,                                 ///< Clear errors and calibration values for the robot of corresponding index
-       ROBOT_REP_ERROR = ROBOT_REQ_RESET                ///< Robot error/failure signal, can come before ROBOT_REQ_RESET
-};
-
-#endif // SHARED_ROBOT_CONTROL_H
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file shared_robot_control.h
+/// @brief RobotSystem-Lite clients request/receive interface
+///
+/// Messages requesting state changes or information about the robot are sent by clients occasionally and their arrival should be as guaranteed as possible. Therefore, these messages are transmitted to the server through TCP sockets, on port 50000.
+
+
+#ifndef SHARED_ROBOT_CONTROL_H
+#define SHARED_ROBOT_CONTROL_H
+
+/// Single byte codes used in request/receive messages for robot state/configuration control
+enum RobotControlCode { 
+       /// Request information about available robot configurations. May be followed, in the same message, by a string with the listed configuration category 
+       /// ("robots", "actuators", "sensors" or "motors"). Robot configurations are listed for missing or unknown categories
+       ROBOT_REQ_LIST_CONFIGS = 1,
+       /// Reply code for ROBOT_REQ_LIST_CONFIGS. Followed, in the same message, by a JSON-format string like:
+       /// @code
+       /// { "robots":[ "<available_robot1_name>", "<available_robot2_name>", :"<available_robot3_name>" ] }
+       /// @endcode
+       /// (with the requested category as key). Listings are cached and only rebuilt when the configuration directories change (see config_listing.h)
+        ROBOT_REP_CONFIGS_LISTED = ROBOT_REQ_LIST_CONFIGS,
+       /// Request information about current robot configuration, its available [axes and joints](https://github.com/EESC-MKGroup/Robot-Control-Interface#the-jointaxis-rationale))
+       ROBOT_REQ_GET_CONFIG,
+       /// Reply code for ROBOT_REQ_GET_CONFIG. Followed, in the same message, by a JSON-format string like:
+       /// @code
+       /// { "id":"<robot_name>", "axes":[ "<axis1_name>", "<axis2_name>" ], "joints":[ "<joint1_name>", "<joint2_name>" ] }
+       /// @endcode
+       ROBOT_REP_GOT_CONFIG = ROBOT_REQ_GET_CONFIG,
+       ROBOT_REQ_SET_CONFIG,                            ///< Request setting new @ref robot_config, reloading all parameters in background (standby configurations are switched to immediately). Must be followed, in the same message, by a string with the new @ref robot_config name
+       ROBOT_REP_CONFIG_SET = ROBOT_REQ_SET_CONFIG,     ///< Confirmation reply to ROBOT_REQ_SET_CONFIG. Followed by the same JSON string type as in ROBOT_REP_GOT_CONFIG
+       ROBOT_REQ_SET_USER,                              ///< Request setting new user/folder name for [data logging](https://github.com/EESC-MKGroup/Simple-Data-Logging). Must be followed, in the same message, by a string with the name
+       ROBOT_REP_USER_SET = ROBOT_REQ_SET_USER,         ///< Confirmation reply to ROBOT_REQ_SET_USER
+       ROBOT_REQ_DISABLE,                               ///< Request turning off the robot and stopping its control thread
+       ROBOT_REP_DISABLED = ROBOT_REQ_DISABLE,          ///< Confirmation reply to ROBOT_REQ_DISABLE
+       ROBOT_REQ_ENABLE,                                ///< Request turning on the robot and starting its control thread
+       ROBOT_REP_ENABLED = ROBOT_REQ_ENABLE,            ///< Confirmation reply to ROBOT_REQ_ENABLE
+       ROBOT_REQ_PASSIVATE,                             ///< Request setting robot to a fully compliant control state (passed on to control implementation)
+       ROBOT_REP_PASSIVE = ROBOT_REQ_PASSIVATE,         ///< Confirmation reply to ROBOT_REQ_PASSIVATE
+       ROBOT_REQ_OFFSET,                                ///< Request setting robot to offset measurement state (passed on to control implementation)
+       ROBOT_REP_OFFSETTING = ROBOT_REQ_OFFSET,         ///< Confirmation reply to ROBOT_REQ_OFFSET
+       ROBOT_REQ_CALIBRATE,                             ///< Request setting robot to motion range measurement state (passed on to control implementation)
+       ROBOT_REP_CALIBRATING = ROBOT_REQ_CALIBRATE,     ///< Confirmation reply to ROBOT_REQ_CALIBRATE
+       ROBOT_REQ_OPERATE,                               ///< Request setting robot to normal operation state (passed on to control implementation)
+       ROBOT_REP_OPERATING = ROBOT_REQ_OPERATE,         ///< Confirmation reply to ROBOT_REQ_OPERATE
+       ROBOT_REQ_PREPROCESS,                            ///< Request setting robot to implementation-specific pre-operation state (passed on to control implementation)
+       ROBOT_REP_PREPROCESSING = ROBOT_REQ_PREPROCESS,  ///< Confirmation reply to ROBOT_REQ_PREPROCESS
+       ROBOT_REQ_RESET,                                 ///< Clear errors and calibration values for the robot of corresponding index
+       ROBOT_REP_ERROR = ROBOT_REQ_RESET,               ///< Robot error/failure signal, can come before ROBOT_REQ_RESET
+       /// Reply to ROBOT_REQ_SET_CONFIG while a new @ref robot_config is being loaded in background (current robot keeps running until it is ready). 
+       /// Followed, in the same message, by a string with the name of the @ref robot_config being loaded. Completion can be checked with ROBOT_REQ_GET_CONFIG, which always replies with the active configuration
+       ROBOT_REP_CONFIG_LOADING,
+       ROBOT_REQ_STREAM_JOINTS,                         ///< Request enabling/disabling joint measurements stream on the data connection (see shared_dof_variables.h), for all connected clients. Must be followed, in the same message, by a byte (0 disables, any other value enables)
+       ROBOT_REP_JOINTS_STREAM_SET = ROBOT_REQ_STREAM_JOINTS, ///< Confirmation reply to ROBOT_REQ_STREAM_JOINTS. Followed by a byte with the resulting stream state (0 for disabled, 1 for enabled)
+       /// Request enabling/disabling raw samples tracing of a single sensor or motor (see trace_points.h). Must be followed, in the same message, by a byte (0 disables, any other value enables) 
+       /// and a string with the device name, like "sensors/<sensor_name>" or "motors/<motor_name>". Traced samples are saved to <log_dir>/[<user_name>-]<category>-<name>-trace-<time_stamp>.log
+       ROBOT_REQ_TRACE,
+       /// Confirmation reply to ROBOT_REQ_TRACE. Followed by a byte with the resulting tracing state (0 for disabled, 1 for enabled). 
+       /// A 0x00 reply code is sent instead if no loaded device matches the name or trace points were disabled at compile time
+       ROBOT_REP_TRACE_SET = ROBOT_REQ_TRACE,
+       ROBOT_REQ_DUMP_STATE,                            ///< Request saving the in-memory history of the current robot (see flight_recorder.h) to a binary log file
+       ROBOT_REP_STATE_DUMPED = ROBOT_REQ_DUMP_STATE,   ///< Confirmation reply to ROBOT_REQ_DUMP_STATE. Followed by a byte with the number of written files (0x00 reply code if robot has no flight recorder)
+       /// Request line counters of all running asynchronous logs (see async_log.h), to check for lines dropped while the robot is running
+       ROBOT_REQ_GET_LOG_STATS,
+       /// Reply code for ROBOT_REQ_GET_LOG_STATS. Followed, in the same message, by a JSON-format string like:
+       /// @code
+       /// { "<log1_name>":{ "written":<lines>, "dropped_new":<lines>, "dropped_old":<lines>, "truncated":<lines> }, "<log2_name>":{ ... } }
+       /// @endcode
+       /// (with robot and device configuration names as keys). Logs that don't fit in the message are left out
+       ROBOT_REP_GOT_LOG_STATS = ROBOT_REQ_GET_LOG_STATS
+};
+
+#endif // SHARED_ROBOT_CONTROL_H
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+/// @file signal_io_extensions.h
+/// @brief Optional signal I/O plug-in interfaces
+///
+/// Extends the [Signal I/O](https://github.com/EESC-MKGroup/Signal-IO-Interface) plug-in interface with functions that implementations may also export. 
+/// Plug-ins only need this header (and signal_io/signal_io.h) to implement them, without depending on application internals. 
+/// Their use by the application is described in device_registry.h.
+///
+/// Block transfer functions read or write many channels of a device in a single transaction. ReadChannels() is called at most once per control cycle 
+/// (transfers block) for each device, so that implementations may advance their state (e.g. simulation time) on it. 
+/// Per-channel Read() calls only happen outside of transfers blocks.
+
+
+#ifndef SIGNAL_IO_EXTENSIONS_H
+#define SIGNAL_IO_EXTENSIONS_H
+
+#include "signal_io/signal_io.h"
+
+/// Optional whole-device transfer functions of signal I/O plug-ins
+#define SIGNAL_IO_BLOCK_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( bool, Interface, ReadChannels, long int, const unsigned int*, size_t, double**, size_t* ) \
+        INIT_FUNCTION( bool, Interface, WriteChannels, long int, const unsigned int*, size_t, const double* )
+
+/// Optional concurrency information function of signal I/O plug-ins
+#define SIGNAL_IO_CONCURRENCY_INTERFACE( Interface, INIT_FUNCTION ) \
+        INIT_FUNCTION( bool, Interface, IsThreadSafe, void )
+
+
+#endif // SIGNAL_IO_EXTENSIONS_H
@@ -1,331 +1,693 @@
-////////////////////////////////////////////////////////////////////////////////
-//                                                                            //
-//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
-//                                                                            //
-//  This file is part of RobotSystem-Lite.                                    //
-//                                                                            //
-//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
-//  it under the terms of the GNU Lesser General Public License as published  //
-//  by the Free Software Foundation, either version 3 of the License, or      //
-//  (at your option) any later version.                                       //
-//                                                                            //
-//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
-//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
-//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
-//  GNU Lesser General Public License for more details.                       //
-//                                                                            //
-//  You should have received a copy of the GNU Lesser General Public License  //
-//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
-//                                                                            //
-////////////////////////////////////////////////////////////////////////////////
-
-
-#include "system.h"
-
-#include "ipc/interface/ipc.h"
-
-#include "shared_robot_control.h"
-#include "shared_dof_variables.h"
-
-#include "robot.h"
-
-#include "data_io/interface/data_io.h"
-
-#include "debug/data_logging.h"
-#include "timing/timing.h" 
-
-#include "config_keys.h"
-
-#include <stdlib.h>
-#include <string.h>
-#include <stdint.h>
-#include <stdio.h>
-#ifdef _CVI_DLL_
-#define chdir( dirName )
-#include "getopt.h"
-#elif WIN32
-#include <dirent.h>
-#include "getopt.h"
-#define chdir _chdir
-#else
-#include <unistd.h>
-#include <dirent.h>
-#include <getopt.h>
-#endif
-
-const unsigned long NETWORK_UPDATE_MIN_INTERVAL_MS = 20;
-static unsigned long lastUpdateTimeMS = 0;
-static unsigned long lastNetworkUpdateElapsedTimeMS = NETWORK_UPDATE_MIN_INTERVAL_MS;
-
-
-bool robotInitialized = false;
-size_t axesNumber = 0, jointsNumber = 0;
-
-DataHandle robotConfig = NULL;
-
-IPCConnection robotEventsConnection = NULL;
-IPCConnection robotAxesConnection = NULL;
-
-
-void ListRobotConfigs( char*, size_t );
-DataHandle ReloadRobotConfig( const char* );
-void GetRobotConfigString( DataHandle, char*, size_t );
-
-
-bool System_Init( const int argc, const char** argv )
-{
-  DEBUG_PRINT( "Starting Robot Control at time %g", Time_GetExecSeconds() );
-  
-  const char* rootDirectory = ".";
-  const char* connectionAddress = NULL;
-  const char* logDirectory = "./" KEY_LOGS "/";
-  const char* robotConfigName = NULL;
-  
-  static struct option longOptions[] =
-  {
-    { "help", no_argument, NULL, 'h' },
-    { "root", required_argument, NULL, 'r' },
-    { "log", required_argument, NULL, 'l' },
-    { "addr", required_argument, NULL, 'a' },
-    { "config", required_argument, NULL, 'c' },
-    { NULL, 0, NULL, 0 }
-  };
-  
-  int optionChar;
-  int optionIndex;
-  while( (optionChar = getopt_long( argc, (char* const*) argv, "hr:l:a:c:", longOptions, &optionIndex )) != -1 )
-  {
-    DEBUG_PRINT( "option %s(%c) set with argument %s", longOptions[ optionIndex ].name, optionChar, optarg );
-    if( optionChar == 'h' )
-    {
-      printf( "usage: %s [--root <root_dir>] [--addr <connection_address>] [--log <log_dir>] [--config <robot_name>]\n", argv[ 0 ] );
-      return false;
-    }
-    else if( optionChar == 'r' ) rootDirectory = optarg;
-    else if( optionChar == 'l' ) logDirectory = optarg;
-    else if( optionChar == 'a' ) connectionAddress = optarg;
-    else if( optionChar == 'c' ) robotConfigName = optarg;
-  }
-  
-  const char* connectionHost = connectionAddress;
-  char* connectionChannel = ( connectionAddress != NULL ) ? strrchr( connectionAddress, ':' ) : NULL;
-  if( connectionChannel != NULL ) *(connectionChannel++) = '\0';
-  robotEventsConnection = IPC_OpenConnection( IPC_REP, connectionHost, connectionChannel );
-  robotAxesConnection = IPC_OpenConnection( IPC_SERVER, connectionHost, connectionChannel );
-  
-  Log_SetDirectory( logDirectory );
-
-  chdir( rootDirectory );
-  DEBUG_PRINT( "loading robot configuration from %s", robotConfigName );
-  robotConfig = ReloadRobotConfig( robotConfigName );
-
-  lastUpdateTimeMS = Time_GetExecMilliseconds();
-  
-  return true;
-}
-
-void System_End()
-{
-  DEBUG_PRINT( "Ending Robot Control at time %g", Time_GetExecSeconds() );
-
-  IPC_CloseConnection( robotEventsConnection ); DEBUG_PRINT( "closing events connection %p", robotEventsConnection );
-  IPC_CloseConnection( robotAxesConnection ); DEBUG_PRINT( "closing data connection %p", robotAxesConnection );
-
-  DataIO_UnloadData( robotConfig ); DEBUG_PRINT( "unloading robot config %p", robotConfig );
-
-  Robot_End();
-  
-  DEBUG_PRINT( "Robot Control ended at time %g", Time_GetExecSeconds() );
-}
-
-void UpdateEvents()
-{
-  static Byte messageBuffer[ IPC_MAX_MESSAGE_LENGTH ];
-
-  Byte* messageIn = (Byte*) messageBuffer;
-  while( IPC_ReadMessage( robotEventsConnection, messageIn ) ) 
-  {
-    Byte robotCommand = (Byte) *(messageIn++);    
-    DEBUG_PRINT( "received robot command: %u (data: %s)", robotCommand, messageIn );
-    Byte* messageOut = (Byte*) messageBuffer;
-    if( robotCommand == ROBOT_REQ_LIST_CONFIGS ) 
-    {
-      messageOut[ 0 ] = ROBOT_REP_CONFIGS_LISTED;
-      ListRobotConfigs( (char*) ( messageOut + 1 ), IPC_MAX_MESSAGE_LENGTH - 1 );
-    }
-    else if( robotCommand == ROBOT_REQ_GET_CONFIG ) 
-    {
-      messageOut[ 0 ] = ROBOT_REP_GOT_CONFIG;
-      GetRobotConfigString( robotConfig, (char*) ( messageOut + 1 ), IPC_MAX_MESSAGE_LENGTH - 1 );
-    }
-    else if( robotCommand == ROBOT_REQ_SET_CONFIG )
-    {
-      char* robotName = (char*) messageIn;
-      DEBUG_PRINT( "robot config %s set", robotName );
-      robotConfig = ReloadRobotConfig( robotName );
-      messageOut[ 0 ] = ROBOT_REP_CONFIG_SET;
-      GetRobotConfigString( robotConfig, (char*) ( messageOut + 1 ), IPC_MAX_MESSAGE_LENGTH - 1 );
-    }
-    else 
-    {
-      if( robotCommand == ROBOT_REQ_SET_USER )
-      {
-        char* userName = (char*) messageIn;
-        DEBUG_PRINT( "new user name: %s", userName );
-        Log_SetBaseName( userName );
-        messageOut[ 0 ] = ROBOT_REP_USER_SET;
-      }
-      else if( robotCommand == ROBOT_REQ_DISABLE ) messageOut[ 0 ] = Robot_Disable() ? ROBOT_REP_DISABLED : 0x00;
-      else if( robotCommand == ROBOT_REQ_ENABLE ) messageOut[ 0 ] = Robot_Enable() ? ROBOT_REP_ENABLED : 0x00;
-      else if( robotCommand == ROBOT_REQ_PASSIVATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_PASSIVE ) ? ROBOT_REP_PASSIVE : 0x00;
-      else if( robotCommand == ROBOT_REQ_OFFSET ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_OFFSET ) ? ROBOT_REP_OFFSETTING : 0x00;
-      else if( robotCommand == ROBOT_REQ_CALIBRATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_CALIBRATION ) ? ROBOT_REP_CALIBRATING : 0x00;
-      else if( robotCommand == ROBOT_REQ_PREPROCESS ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_PREPROCESSING ) ? ROBOT_REP_PREPROCESSING : 0x00;
-      else if( robotCommand == ROBOT_REQ_OPERATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_OPERATION ) ? ROBOT_REP_OPERATING : 0x00;
-      memset( messageOut + 1, 0, IPC_MAX_MESSAGE_LENGTH - 1 );
-    }
-    DEBUG_PRINT( "sending robot state: %u", messageOut[ 0 ] );
-    IPC_WriteMessage( robotEventsConnection, messageOut );
-  }   
-}
-
-bool UpdateAxes( unsigned long lastNetworkUpdateElapsedTimeMS )
-{
-  static Byte message[ IPC_MAX_MESSAGE_LENGTH ];
-
-  Byte* messageIn = (Byte*) message;
-  while( IPC_ReadMessage( robotAxesConnection, messageIn ) ) 
-  {
-    size_t setpointBlocksNumber = (size_t) *(messageIn++);
-    //DEBUG_PRINT( "received message for %lu axes", setpointBlocksNumber );
-    for( size_t setpointBlockIndex = 0; setpointBlockIndex < setpointBlocksNumber; setpointBlockIndex++ )
-    {
-      size_t axisIndex = (size_t) *(messageIn++);
-      
-      if( axisIndex >= axesNumber ) continue;      
-      
-      float* axisSetpointsList = (float*) messageIn;
-      DoFVariables axisSetpoints = { .position = axisSetpointsList[ DOF_POSITION ], .velocity = axisSetpointsList[ DOF_VELOCITY ],
-                                     .acceleration = axisSetpointsList[ DOF_ACCELERATION ], .force = axisSetpointsList[ DOF_FORCE ],
-                                     .inertia = axisSetpointsList[ DOF_INERTIA ],
-                                     .damping = axisSetpointsList[ DOF_DAMPING ], .stiffness = axisSetpointsList[ DOF_STIFFNESS ] };
-      //if( axisIndex == 0 ) DEBUG_PRINT( "setpoints: p: %.3f - v: %.3f", axisSetpoints.position, axisSetpoints.velocity );
-      Robot_SetAxisSetpoints( axisIndex, &axisSetpoints );
-
-      messageIn += DOF_DATA_BLOCK_SIZE;
-    }
-  }
-  
-  memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
-  size_t axisdataOffset = 1;
-  for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
-  {    
-    DoFVariables axisMeasures = { 0 };
-    if( Robot_GetAxisMeasures( axisIndex, &axisMeasures ) )
-    {
-      message[ 0 ]++;
-      message[ axisdataOffset++ ] = (Byte) axisIndex;
-      
-      float* axisMeasuresList = (float*) ( message + axisdataOffset );
-      
-      axisMeasuresList[ DOF_POSITION ] = (float) axisMeasures.position;
-      axisMeasuresList[ DOF_VELOCITY ] = (float) axisMeasures.velocity;
-      axisMeasuresList[ DOF_ACCELERATION ] = (float) axisMeasures.acceleration;
-      axisMeasuresList[ DOF_FORCE ] = (float) axisMeasures.force;
-      axisMeasuresList[ DOF_INERTIA ] = (float) axisMeasures.inertia;
-      axisMeasuresList[ DOF_DAMPING ] = (float) axisMeasures.damping;
-      axisMeasuresList[ DOF_STIFFNESS ] = (float) axisMeasures.stiffness;
-      //if( axisIndex == 0 ) DEBUG_PRINT( "measures: p: %+.5f, v: %+.5f, f: %+.5f", axisMeasuresList[ DOF_POSITION ], axisMeasuresList[ DOF_VELOCITY ], axisMeasuresList[ DOF_FORCE ] );
-      axisdataOffset += DOF_DATA_BLOCK_SIZE;
-    }
-  }
-  
-  if( message[ 0 ] > 0 && lastNetworkUpdateElapsedTimeMS >= NETWORK_UPDATE_MIN_INTERVAL_MS )
-  {
-    //DEBUG_PRINT( "sending measures from %lu axes", message[ 0 ] );
-    IPC_WriteMessage( robotAxesConnection, (const Byte*) message );
-    return true;
-  }
-  
-  return false;
-}
-
-void System_Update()
-{
-  unsigned long lastUpdateElapsedTimeMS = Time_GetExecMilliseconds() - lastUpdateTimeMS;
-  lastUpdateTimeMS = Time_GetExecMilliseconds();
-  
-  UpdateEvents();
-  
-  lastNetworkUpdateElapsedTimeMS += lastUpdateElapsedTimeMS;
-  if( UpdateAxes( lastNetworkUpdateElapsedTimeMS ) )
-    lastNetworkUpdateElapsedTimeMS = 0;
-}
-
-
-void ListRobotConfigs( char* sharedRobotsString, size_t bufferSize )
-{
-  DataHandle robotsList = DataIO_CreateEmptyData();
-  
-  DataHandle sharedRobotsList = DataIO_AddList( robotsList, KEY_ROBOTS );
-  DEBUG_PRINT( "searching robots config in: %s", "./" KEY_CONFIG "/" KEY_ROBOTS "/" );
-  const char** dataList = DataIO_ListStorageDataEntries( "./" KEY_CONFIG "/" KEY_ROBOTS "/" );
-  for( size_t dataIndex = 0; dataList[ dataIndex ] != NULL; dataIndex++ )
-    DataIO_SetStringValue( sharedRobotsList, NULL, dataList[ dataIndex ] );
-  
-  char* robotsListString = DataIO_GetDataString( robotsList );
-  DEBUG_PRINT( "robots info string: %s", robotsListString );
-  strncpy( sharedRobotsString, robotsListString, bufferSize );
-  free( robotsListString );
-  
-  DataIO_UnloadData( robotsList );
-}
-
-DataHandle ReloadRobotConfig( const char* robotName )
-{ 
-  DataHandle robotConfig = DataIO_CreateEmptyData();
-  
-  if( robotName != NULL )
-  {     
-    Log_SetTimeStamp();
-    
-    if( robotInitialized ) Robot_End();
-    
-    if( (robotInitialized = Robot_Init( robotName )) )
-    {
-      DataIO_SetStringValue( robotConfig, KEY_ID, robotName );   
-      
-      DataHandle sharedJointsList = DataIO_AddList( robotConfig, KEY_JOINTS );
-      DataHandle sharedAxesList = DataIO_AddList( robotConfig, KEY_AXES );
-      
-      axesNumber = Robot_GetAxesNumber(); 
-
-      for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
-      {
-        const char* axisName = Robot_GetAxisName( axisIndex );
-        if( axisName != NULL ) DataIO_SetStringValue( sharedAxesList, NULL, axisName );
-      }
-      
-      jointsNumber = Robot_GetJointsNumber();
-
-      for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
-      {
-        const char* jointName = Robot_GetJointName( jointIndex );
-        if( jointName != NULL ) DataIO_SetStringValue( sharedJointsList, NULL, jointName );
-      }
-    }
-  }
-  
-  return robotConfig;
-}
-
-void GetRobotConfigString( DataHandle robotConfig, char* sharedControlsString, size_t bufferSize )
-{
-  if( sharedControlsString != NULL )
-  {
-    char* robotConfigString = DataIO_GetDataString( robotConfig );
-    DEBUG_PRINT( "robots info string: %s", robotConfigString );
-    strncpy( sharedControlsString, robotConfigString, bufferSize );
-    free( robotConfigString );
-  }
-}
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "system.h"
+
+#include "ipc/interface/ipc.h"
+
+#include "shared_robot_control.h"
+#include "shared_dof_variables.h"
+
+#include "robot.h"
+#include "dof_frames.h"
+#include "binary_log.h"
+#include "async_log.h"
+#include "trace_points.h"
+#include "flight_recorder.h"
+#include "config_cache.h"
+#include "config_listing.h"
+#include "device_registry.h"
+#include "alloc_guard.h"
+
+#include "data_io/interface/data_io.h"
+
+#include "debug/data_logging.h"
+#include "threads/threads.h"
+#include "timing/timing.h" 
+
+#include "config_keys.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#ifdef _CVI_DLL_
+#define chdir( dirName )
+#include "getopt.h"
+#elif WIN32
+#include <dirent.h>
+#include "getopt.h"
+#define chdir _chdir
+#else
+#include <unistd.h>
+#include <dirent.h>
+#include <getopt.h>
+#endif
+
+const unsigned long NETWORK_UPDATE_MIN_INTERVAL_MS = 20;
+static unsigned long lastUpdateTimeMS = 0;
+static unsigned long lastNetworkUpdateElapsedTimeMS = NETWORK_UPDATE_MIN_INTERVAL_MS;
+
+
+size_t axesNumber = 0, jointsNumber = 0;
+// Data connection messages are sent to all clients, so joint measures streaming is shared by them (last request from any client applies)
+bool isSharedJointsStreamEnabled = false;
+
+DataHandle robotConfig = NULL;
+
+// Robot configurations are loaded (and replaced ones unloaded) by a worker thread, while the current robot keeps being served
+typedef struct _RobotLoadJob
+{
+  char robotName[ IPC_MAX_MESSAGE_LENGTH ];
+  Robot loadedRobot;
+  Robot unloadedRobot;
+  atomic_bool isDone;
+}
+RobotLoadJob;
+
+static RobotLoadJob robotLoadJob = { .robotName = "" };
+static Thread robotLoadThread = THREAD_INVALID_HANDLE;
+static bool isRobotLoading = false;
+static char pendingRobotName[ IPC_MAX_MESSAGE_LENGTH ] = "";
+static Robot pendingUnloadRobot = NULL;
+
+// Preloaded (inactive) robot configurations, activated without loading when requested
+typedef struct _StandbyRobot
+{
+  char* robotName;
+  Robot robot;
+}
+StandbyRobot;
+
+static StandbyRobot* standbyRobotsList = NULL;
+static size_t standbyRobotsNumber = 0;
+
+IPCConnection robotEventsConnection = NULL;
+IPCConnection robotAxesConnection = NULL;
+
+DoFFrameAssembler setpointsAssembler = NULL;
+static size_t totalDroppedSetpointsNumber = 0;
+
+
+bool ActivateRobot( Robot, const char*, Robot* );
+void RequestRobotLoad( const char* );
+void UpdateRobotLoad();
+void GetRobotConfigString( DataHandle, char*, size_t );
+void LoadStandbyRobots( const char* );
+void UnloadStandbyRobots();
+StandbyRobot* FindStandbyRobot( const char* );
+bool ActivateStandbyRobot( const char* );
+Robot ReleaseRobot( Robot );
+
+
+bool System_Init( const int argc, const char** argv )
+{
+  DEBUG_PRINT( "Starting Robot Control at time %g", Time_GetExecSeconds() );
+  
+  const char* rootDirectory = ".";
+  const char* connectionAddress = NULL;
+  const char* logDirectory = "./" KEY_LOGS "/";
+  const char* robotConfigName = NULL;
+  const char* standbyConfigNames = NULL;
+  
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "root", required_argument, NULL, 'r' },
+    { "log", required_argument, NULL, 'l' },
+    { "addr", required_argument, NULL, 'a' },
+    { "config", required_argument, NULL, 'c' },
+    { "guard", required_argument, NULL, 'g' },
+    { "standby", required_argument, NULL, 's' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  int optionChar;
+  int optionIndex;
+  while( (optionChar = getopt_long( argc, (char* const*) argv, "hr:l:a:c:g:s:", longOptions, &optionIndex )) != -1 )
+  {
+    DEBUG_PRINT( "option %s(%c) set with argument %s", longOptions[ optionIndex ].name, optionChar, optarg );
+    if( optionChar == 'h' )
+    {
+      printf( "usage: %s [--root <root_dir>] [--addr <connection_address>] [--log <log_dir>] [--config <robot_name>] [--guard <report|abort>[,syscalls]] [--standby <robot_name>[,<robot_name>...]]\n", argv[ 0 ] );
+      return false;
+    }
+    else if( optionChar == 'r' ) rootDirectory = optarg;
+    else if( optionChar == 'l' ) logDirectory = optarg;
+    else if( optionChar == 'a' ) connectionAddress = optarg;
+    else if( optionChar == 'c' ) robotConfigName = optarg;
+    else if( optionChar == 'g' ) AllocGuard_Init( optarg );
+    else if( optionChar == 's' ) standbyConfigNames = optarg;
+  }
+  
+  const char* connectionHost = connectionAddress;
+  char* connectionChannel = ( connectionAddress != NULL ) ? strrchr( connectionAddress, ':' ) : NULL;
+  if( connectionChannel != NULL ) *(connectionChannel++) = '\0';
+  robotEventsConnection = IPC_OpenConnection( IPC_REP, connectionHost, connectionChannel );
+  robotAxesConnection = IPC_OpenConnection( IPC_SERVER, connectionHost, connectionChannel );
+  setpointsAssembler = DoFFrame_CreateAssembler();
+  
+  Log_SetDirectory( logDirectory );
+  BinaryLog_SetDirectory( logDirectory );
+
+  chdir( rootDirectory );
+  
+  TracePoints_Init();
+  FlightRecorder_Init();
+  ConfigCache_Init();
+  ConfigListing_Init();
+  DeviceRegistry_Init();
+  DEBUG_PRINT( "loading robot configuration from %s", robotConfigName );
+  // Initial configuration is loaded synchronously, as there is nothing to serve meanwhile
+  if( robotConfigName != NULL ) 
+  {
+    Log_SetTimeStamp();
+    BinaryLog_SetTimeStamp();
+  }
+  robotConfig = DataIO_CreateEmptyData();
+  Robot initialRobot = ( robotConfigName != NULL ) ? Robot_Load( robotConfigName ) : NULL;
+  Robot lastRobot = NULL;
+  if( !ActivateRobot( initialRobot, robotConfigName, &lastRobot ) ) Robot_Unload( initialRobot );
+  // Standby configurations are set up after the active one, sharing its signal I/O devices
+  if( standbyConfigNames != NULL ) LoadStandbyRobots( standbyConfigNames );
+
+  lastUpdateTimeMS = Time_GetExecMilliseconds();
+  
+  return true;
+}
+
+void System_End()
+{
+  DEBUG_PRINT( "Ending Robot Control at time %g", Time_GetExecSeconds() );
+
+  IPC_CloseConnection( robotEventsConnection ); DEBUG_PRINT( "closing events connection %p", robotEventsConnection );
+  IPC_CloseConnection( robotAxesConnection ); DEBUG_PRINT( "closing data connection %p", robotAxesConnection );
+  DoFFrame_DiscardAssembler( setpointsAssembler );
+  
+  if( isRobotLoading )
+  {
+    DEBUG_PRINT( "waiting for robot %s loading to finish", robotLoadJob.robotName );
+    while( !atomic_load( &(robotLoadJob.isDone) ) ) Time_Delay( NETWORK_UPDATE_MIN_INTERVAL_MS );
+    if( robotLoadThread != THREAD_INVALID_HANDLE ) Thread_WaitExit( robotLoadThread, 5000 );
+    Robot_Unload( robotLoadJob.loadedRobot );
+  }
+  Robot_Unload( pendingUnloadRobot );
+
+  DataIO_UnloadData( robotConfig ); DEBUG_PRINT( "unloading robot config %p", robotConfig );
+
+  // Active robot is only unloaded here if it is not a standby one
+  Robot lastRobot = NULL;
+  (void) Robot_Swap( NULL, &lastRobot );
+  Robot_Unload( ReleaseRobot( lastRobot ) );
+  UnloadStandbyRobots();
+  
+  TracePoints_End();
+  
+  FlightRecorder_End();
+  
+  ConfigCache_End();
+  
+  ConfigListing_End();
+  
+  DeviceRegistry_End();
+  
+  DEBUG_PRINT( "Robot Control ended at time %g", Time_GetExecSeconds() );
+}
+
+void System_HandleFault( void )
+{
+  FlightRecorder_DumpOnFault( "fault" );
+}
+
+void UpdateEvents()
+{
+  static Byte messageBuffer[ IPC_MAX_MESSAGE_LENGTH ];
+
+  Byte* messageIn = (Byte*) messageBuffer;
+  while( IPC_ReadMessage( robotEventsConnection, messageBuffer ) ) 
+  {
+    messageIn = (Byte*) messageBuffer;
+    Byte robotCommand = (Byte) *(messageIn++);    
+    DEBUG_PRINT( "received robot command: %u (data: %s)", robotCommand, messageIn );
+    Byte* messageOut = (Byte*) messageBuffer;
+    if( robotCommand == ROBOT_REQ_LIST_CONFIGS ) 
+    {
+      // Requests without (known) category list robot configurations, as before categories were added
+      messageIn[ IPC_MAX_MESSAGE_LENGTH - 2 ] = '\0';
+      const char* category = ConfigListing_HasCategory( (const char*) messageIn ) ? (const char*) messageIn : KEY_ROBOTS;
+      const char* listString = ConfigListing_GetString( category );
+      messageOut[ 0 ] = ROBOT_REP_CONFIGS_LISTED;
+      strncpy( (char*) ( messageOut + 1 ), ( listString != NULL ) ? listString : "", IPC_MAX_MESSAGE_LENGTH - 1 );
+    }
+    else if( robotCommand == ROBOT_REQ_GET_CONFIG || robotCommand == ROBOT_REQ_SET_CONFIG ) 
+    {
+      if( robotCommand == ROBOT_REQ_SET_CONFIG )
+      {
+        char* robotName = (char*) messageIn;
+        robotName[ IPC_MAX_MESSAGE_LENGTH - 2 ] = '\0';
+        DEBUG_PRINT( "robot config %s requested", robotName );
+        RequestRobotLoad( robotName );
+      }
+      
+      // Configuration requests always get the active robot description, even while another one is loading
+      const char* loadingRobotName = ( pendingRobotName[ 0 ] != '\0' ) ? pendingRobotName : robotLoadJob.robotName;
+      if( robotCommand == ROBOT_REQ_SET_CONFIG && isRobotLoading && loadingRobotName[ 0 ] != '\0' )
+      {
+        memset( messageOut, 0, IPC_MAX_MESSAGE_LENGTH );
+        messageOut[ 0 ] = ROBOT_REP_CONFIG_LOADING;
+        strncpy( (char*) ( messageOut + 1 ), loadingRobotName, IPC_MAX_MESSAGE_LENGTH - 2 );
+      }
+      else
+      {
+        messageOut[ 0 ] = ( robotCommand == ROBOT_REQ_SET_CONFIG ) ? ROBOT_REP_CONFIG_SET : ROBOT_REP_GOT_CONFIG;
+        GetRobotConfigString( robotConfig, (char*) ( messageOut + 1 ), IPC_MAX_MESSAGE_LENGTH - 1 );
+      }
+    }
+    else if( robotCommand == ROBOT_REQ_STREAM_JOINTS )
+    {
+      isSharedJointsStreamEnabled = ( messageIn[ 0 ] != 0x00 );
+      DEBUG_PRINT( "joints stream %s for all clients", isSharedJointsStreamEnabled ? "enabled" : "disabled" );
+      Robot_SetJointsSnapshot( isSharedJointsStreamEnabled );
+      memset( messageOut, 0, IPC_MAX_MESSAGE_LENGTH );
+      messageOut[ 0 ] = ROBOT_REP_JOINTS_STREAM_SET;
+      messageOut[ 1 ] = isSharedJointsStreamEnabled ? 1 : 0;
+    }
+    else if( robotCommand == ROBOT_REQ_TRACE )
+    {
+      bool enable = ( messageIn[ 0 ] != 0x00 );
+      char* deviceName = (char*) ( messageIn + 1 );
+      deviceName[ IPC_MAX_MESSAGE_LENGTH - 3 ] = '\0';
+      size_t tracesNumber = TracePoints_SetEnabled( deviceName, enable );
+      memset( messageOut, 0, IPC_MAX_MESSAGE_LENGTH );
+      messageOut[ 0 ] = ( tracesNumber > 0 ) ? ROBOT_REP_TRACE_SET : 0x00;
+      messageOut[ 1 ] = enable ? 1 : 0;
+    }
+    else if( robotCommand == ROBOT_REQ_GET_LOG_STATS )
+    {
+      memset( messageOut, 0, IPC_MAX_MESSAGE_LENGTH );
+      messageOut[ 0 ] = ROBOT_REP_GOT_LOG_STATS;
+      (void) AsyncLog_GetStatsString( (char*) ( messageOut + 1 ), IPC_MAX_MESSAGE_LENGTH - 1 );
+    }
+    else if( robotCommand == ROBOT_REQ_DUMP_STATE )
+    {
+      size_t dumpsNumber = ( FlightRecorder_FreezeAll( "request" ) > 0 ) ? FlightRecorder_DumpPending() : 0;
+      memset( messageOut, 0, IPC_MAX_MESSAGE_LENGTH );
+      messageOut[ 0 ] = ( dumpsNumber > 0 ) ? ROBOT_REP_STATE_DUMPED : 0x00;
+      messageOut[ 1 ] = (Byte) dumpsNumber;
+    }
+    else 
+    {
+      if( robotCommand == ROBOT_REQ_SET_USER )
+      {
+        char* userName = (char*) messageIn;
+        DEBUG_PRINT( "new user name: %s", userName );
+        Log_SetBaseName( userName );
+        BinaryLog_SetBaseName( userName );
+        messageOut[ 0 ] = ROBOT_REP_USER_SET;
+      }
+      else if( robotCommand == ROBOT_REQ_DISABLE ) messageOut[ 0 ] = Robot_Disable() ? ROBOT_REP_DISABLED : 0x00;
+      else if( robotCommand == ROBOT_REQ_ENABLE ) messageOut[ 0 ] = Robot_Enable() ? ROBOT_REP_ENABLED : 0x00;
+      else if( robotCommand == ROBOT_REQ_PASSIVATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_PASSIVE ) ? ROBOT_REP_PASSIVE : 0x00;
+      else if( robotCommand == ROBOT_REQ_OFFSET ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_OFFSET ) ? ROBOT_REP_OFFSETTING : 0x00;
+      else if( robotCommand == ROBOT_REQ_CALIBRATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_CALIBRATION ) ? ROBOT_REP_CALIBRATING : 0x00;
+      else if( robotCommand == ROBOT_REQ_PREPROCESS ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_PREPROCESSING ) ? ROBOT_REP_PREPROCESSING : 0x00;
+      else if( robotCommand == ROBOT_REQ_OPERATE ) messageOut[ 0 ] = Robot_SetControlState( CONTROL_OPERATION ) ? ROBOT_REP_OPERATING : 0x00;
+      memset( messageOut + 1, 0, IPC_MAX_MESSAGE_LENGTH - 1 );
+    }
+    DEBUG_PRINT( "sending robot state: %u", messageOut[ 0 ] );
+    IPC_WriteMessage( robotEventsConnection, messageOut );
+  }   
+}
+
+// Returns number of valid setpoints that could not be scheduled
+size_t ReadSetpointBlocks( const Byte* message )
+{
+  const Byte* messageEnd = message + IPC_MAX_MESSAGE_LENGTH;
+  
+  bool isExtended = ( message[ 0 ] == DOF_EXTENDED_FRAME_MARKER );
+  size_t setpointBlocksNumber = (size_t) ( isExtended ? message[ DOF_EXTENDED_HEADER_SIZE - 1 ] : message[ 0 ] );
+  const Byte* messageIn = message + ( isExtended ? DOF_EXTENDED_HEADER_SIZE : 1 );
+  //DEBUG_PRINT( "received message for %lu axes", setpointBlocksNumber );
+  size_t droppedSetpointsNumber = 0;
+  for( size_t setpointBlockIndex = 0; setpointBlockIndex < setpointBlocksNumber; setpointBlockIndex++ )
+  {
+    size_t axisIndex;
+    bool isTrajectory;
+    if( isExtended )
+    {
+      if( messageIn + DOF_EXTENDED_INDEX_SIZE > messageEnd ) break;
+      uint16_t extendedIndex;
+      memcpy( &extendedIndex, messageIn, DOF_EXTENDED_INDEX_SIZE );
+      isTrajectory = ( extendedIndex & DOF_EXTENDED_TRAJECTORY_BLOCK_FLAG );
+      axisIndex = (size_t) ( extendedIndex & ~DOF_EXTENDED_TRAJECTORY_BLOCK_FLAG );
+      messageIn += DOF_EXTENDED_INDEX_SIZE;
+    }
+    else
+    {
+      if( messageIn >= messageEnd ) break;
+      isTrajectory = ( *messageIn & DOF_TRAJECTORY_BLOCK_FLAG );
+      axisIndex = (size_t) ( *messageIn & ~DOF_TRAJECTORY_BLOCK_FLAG );
+      messageIn++;
+    }
+    
+    if( isTrajectory )
+    {
+      if( messageIn >= messageEnd ) break;
+      size_t trajectoryPointsNumber = (size_t) *(messageIn++);
+      if( messageIn + trajectoryPointsNumber * DOF_TRAJECTORY_POINT_SIZE > messageEnd ) break;
+      
+      Robot_ClearAxisTrajectory( axisIndex );
+      for( size_t pointIndex = 0; pointIndex < trajectoryPointsNumber; pointIndex++ )
+      {
+        float timeOffset;
+        memcpy( &timeOffset, messageIn, sizeof(float) );
+        DoFVariables axisSetpoints;
+        DoFFrame_ReadBlock( messageIn + sizeof(float), &axisSetpoints );
+        if( !Robot_EnqueueAxisSetpoints( axisIndex, (double) timeOffset, &axisSetpoints ) ) droppedSetpointsNumber++;
+        messageIn += DOF_TRAJECTORY_POINT_SIZE;
+      }
+    }
+    else
+    {
+      if( messageIn + DOF_DATA_BLOCK_SIZE > messageEnd ) break;
+      
+      DoFVariables axisSetpoints;
+      DoFFrame_ReadBlock( messageIn, &axisSetpoints );
+      //if( axisIndex == 0 ) DEBUG_PRINT( "setpoints: p: %.3f - v: %.3f", axisSetpoints.position, axisSetpoints.velocity );
+      if( !Robot_SetAxisSetpoints( axisIndex, &axisSetpoints ) ) droppedSetpointsNumber++;
+      
+      messageIn += DOF_DATA_BLOCK_SIZE;
+    }
+  }
+  
+  return droppedSetpointsNumber;
+}
+
+bool UpdateAxes( unsigned long lastNetworkUpdateElapsedTimeMS )
+{
+  static Byte message[ IPC_MAX_MESSAGE_LENGTH ];
+
+  size_t droppedSetpointsNumber = 0;
+  while( IPC_ReadMessage( robotAxesConnection, message ) ) 
+  {
+    // Fragmented setpoint frames are only applied when complete
+    if( message[ 0 ] == DOF_EXTENDED_FRAME_MARKER )
+    {
+      if( DoFFrame_AddFragment( setpointsAssembler, message ) )
+      {
+        size_t fragmentsNumber = DoFFrame_GetAssembledFragmentsNumber( setpointsAssembler );
+        for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+          droppedSetpointsNumber += ReadSetpointBlocks( DoFFrame_GetFragment( setpointsAssembler, fragmentIndex ) );
+      }
+    }
+    else if( message[ 0 ] != DOF_JOINTS_FRAME_MARKER ) droppedSetpointsNumber += ReadSetpointBlocks( message );
+  }
+  
+  if( droppedSetpointsNumber > 0 )
+  {
+    totalDroppedSetpointsNumber += droppedSetpointsNumber;
+    DEBUG_PRINT( "%lu setpoints dropped on full trajectory buffers (total: %lu)", droppedSetpointsNumber, totalDroppedSetpointsNumber );
+  }
+  
+  unsigned long cycleIndex = 0;
+  (void) Robot_UpdateSnapshot( &cycleIndex );
+  
+  const DoFVariables* axisMeasuresList = Robot_GetAxisMeasuresList();
+  if( axesNumber > 0 && axisMeasuresList != NULL && lastNetworkUpdateElapsedTimeMS >= NETWORK_UPDATE_MIN_INTERVAL_MS )
+  {
+    size_t fragmentsNumber = DoFFrame_GetFragmentsNumber( axesNumber );
+    //DEBUG_PRINT( "sending measures from %lu axes in %lu messages", axesNumber, fragmentsNumber );
+    for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+    {
+      memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+      (void) DoFFrame_WriteFragment( message, axisMeasuresList, axesNumber, (uint32_t) cycleIndex, fragmentIndex );
+      IPC_WriteMessage( robotAxesConnection, (const Byte*) message );
+    }
+    
+    // Joint frames share the axes frame ID, so that clients can match both
+    const DoFVariables* jointMeasuresList = Robot_GetJointMeasuresList();
+    if( isSharedJointsStreamEnabled && jointsNumber > 0 && jointMeasuresList != NULL )
+    {
+      fragmentsNumber = DoFFrame_GetExtendedFragmentsNumber( jointsNumber );
+      for( size_t fragmentIndex = 0; fragmentIndex < fragmentsNumber; fragmentIndex++ )
+      {
+        memset( message, 0, IPC_MAX_MESSAGE_LENGTH * sizeof(Byte) );
+        (void) DoFFrame_WriteExtendedFragment( message, DOF_JOINTS_FRAME_MARKER, jointMeasuresList, jointsNumber, (uint32_t) cycleIndex, fragmentIndex );
+        IPC_WriteMessage( robotAxesConnection, (const Byte*) message );
+      }
+    }
+    return true;
+  }
+  
+  return false;
+}
+
+void System_Update()
+{
+  unsigned long lastUpdateElapsedTimeMS = Time_GetExecMilliseconds() - lastUpdateTimeMS;
+  lastUpdateTimeMS = Time_GetExecMilliseconds();
+  
+  UpdateRobotLoad();
+  
+  UpdateEvents();
+  
+  TracePoints_Flush();
+  
+  (void) FlightRecorder_DumpPending();
+  
+  lastNetworkUpdateElapsedTimeMS += lastUpdateElapsedTimeMS;
+  if( UpdateAxes( lastNetworkUpdateElapsedTimeMS ) )
+    lastNetworkUpdateElapsedTimeMS = 0;
+}
+
+
+// Gets robot no longer in use (to be released by caller) and returns false if given robot could not be activated (and should be released too)
+bool ActivateRobot( Robot newRobot, const char* robotName, Robot* ref_lastRobot )
+{ 
+  bool isActivated = Robot_Swap( newRobot, ref_lastRobot );
+  // Failed swap keeps previous robot (and its description) active, unless it could not be restored either
+  if( !isActivated && *ref_lastRobot == NULL ) return false;
+  
+  DataIO_UnloadData( robotConfig );
+  robotConfig = DataIO_CreateEmptyData();
+  
+  axesNumber = jointsNumber = 0;
+  Robot_SetJointsSnapshot( isSharedJointsStreamEnabled );
+  
+  if( isActivated && newRobot != NULL )
+  {     
+    DataIO_SetStringValue( robotConfig, KEY_ID, robotName );   
+    
+    DataHandle sharedJointsList = DataIO_AddList( robotConfig, KEY_JOINTS );
+    DataHandle sharedAxesList = DataIO_AddList( robotConfig, KEY_AXES );
+    
+    axesNumber = Robot_GetAxesNumber(); 
+    // Measure frames cannot hold more DoFs, so they are not sent at all instead of being truncated
+    if( axesNumber > DOF_FRAME_MAX_DOFS ) DEBUG_PRINT( "robot %s axes number (%lu) exceeds frames limit (%lu): measures will not be sent", robotName, axesNumber, DOF_FRAME_MAX_DOFS );
+
+    for( size_t axisIndex = 0; axisIndex < axesNumber; axisIndex++ )
+    {
+      const char* axisName = Robot_GetAxisName( axisIndex );
+      if( axisName != NULL ) DataIO_SetStringValue( sharedAxesList, NULL, axisName );
+    }
+    
+    jointsNumber = Robot_GetJointsNumber();
+    if( jointsNumber > DOF_FRAME_MAX_DOFS ) DEBUG_PRINT( "robot %s joints number (%lu) exceeds frames limit (%lu): joint measures will not be sent", robotName, jointsNumber, DOF_FRAME_MAX_DOFS );
+
+    for( size_t jointIndex = 0; jointIndex < jointsNumber; jointIndex++ )
+    {
+      const char* jointName = Robot_GetJointName( jointIndex );
+      if( jointName != NULL ) DataIO_SetStringValue( sharedJointsList, NULL, jointName );
+    }
+  }
+  
+  return isActivated;
+}
+
+static void* AsyncLoadRobot( void* ref_job )
+{
+  RobotLoadJob* job = (RobotLoadJob*) ref_job;
+  
+  Robot_Unload( job->unloadedRobot );
+  
+  job->loadedRobot = ( job->robotName[ 0 ] != '\0' ) ? Robot_Load( job->robotName ) : NULL;
+  DEBUG_PRINT( "robot %s loaded in background: %p", job->robotName, job->loadedRobot );
+  
+  atomic_store_explicit( &(job->isDone), true, memory_order_release );
+  
+  return NULL;
+}
+
+static void StartRobotLoadJob()
+{
+  // Standby configurations are not loaded again, but only activated after pending unloading is done
+  bool isStandby = ( FindStandbyRobot( pendingRobotName ) != NULL );
+  strcpy( robotLoadJob.robotName, isStandby ? "" : pendingRobotName );
+  if( !isStandby ) pendingRobotName[ 0 ] = '\0';
+  robotLoadJob.loadedRobot = NULL;
+  robotLoadJob.unloadedRobot = pendingUnloadRobot;
+  pendingUnloadRobot = NULL;
+  atomic_store( &(robotLoadJob.isDone), false );
+  
+  if( robotLoadJob.robotName[ 0 ] != '\0' ) 
+  {
+    Log_SetTimeStamp();
+    BinaryLog_SetTimeStamp();
+  }
+  
+  isRobotLoading = true;
+  robotLoadThread = Thread_Start( AsyncLoadRobot, &robotLoadJob, THREAD_JOINABLE );
+  if( robotLoadThread == THREAD_INVALID_HANDLE ) 
+  {
+    DEBUG_PRINT( "failed to start loading thread for robot %s", robotLoadJob.robotName );
+    (void) AsyncLoadRobot( &robotLoadJob );
+  }
+}
+
+void RequestRobotLoad( const char* robotName )
+{
+  // Only the latest requested configuration is loaded after the one in progress
+  strncpy( pendingRobotName, robotName, IPC_MAX_MESSAGE_LENGTH - 1 );
+  
+  if( isRobotLoading ) return;
+  
+  if( ActivateStandbyRobot( pendingRobotName ) ) pendingRobotName[ 0 ] = '\0';
+  if( pendingUnloadRobot != NULL || pendingRobotName[ 0 ] != '\0' ) StartRobotLoadJob();
+}
+
+void UpdateRobotLoad()
+{
+  if( !isRobotLoading ) return;
+  
+  if( !atomic_load_explicit( &(robotLoadJob.isDone), memory_order_acquire ) ) return;
+  
+  if( robotLoadThread != THREAD_INVALID_HANDLE ) Thread_WaitExit( robotLoadThread, 5000 );
+  robotLoadThread = THREAD_INVALID_HANDLE;
+  isRobotLoading = false;
+  
+  if( robotLoadJob.loadedRobot != NULL )
+  {
+    // Superseded configurations are discarded without activation
+    Robot lastRobot = NULL;
+    if( pendingRobotName[ 0 ] != '\0' ) pendingUnloadRobot = robotLoadJob.loadedRobot;
+    else if( ActivateRobot( robotLoadJob.loadedRobot, robotLoadJob.robotName, &lastRobot ) ) pendingUnloadRobot = ReleaseRobot( lastRobot );
+    else
+    {
+      // Failed configurations are unloaded in background, and a previous robot that could not be restored either (rare) right away
+      pendingUnloadRobot = robotLoadJob.loadedRobot;
+      Robot_Unload( ReleaseRobot( lastRobot ) );
+    }
+    robotLoadJob.loadedRobot = NULL;
+  }
+  robotLoadJob.robotName[ 0 ] = '\0';
+  
+  if( pendingUnloadRobot == NULL && ActivateStandbyRobot( pendingRobotName ) ) pendingRobotName[ 0 ] = '\0';
+  if( pendingUnloadRobot != NULL || pendingRobotName[ 0 ] != '\0' ) StartRobotLoadJob();
+}
+
+void GetRobotConfigString( DataHandle robotConfig, char* sharedControlsString, size_t bufferSize )
+{
+  if( sharedControlsString != NULL )
+  {
+    char* robotConfigString = DataIO_GetDataString( robotConfig );
+    DEBUG_PRINT( "robots info string: %s", robotConfigString );
+    strncpy( sharedControlsString, robotConfigString, bufferSize );
+    free( robotConfigString );
+  }
+}
+
+void LoadStandbyRobots( const char* robotNamesString )
+{
+  char* robotNames = (char*) calloc( strlen( robotNamesString ) + 1, sizeof(char) );
+  strcpy( robotNames, robotNamesString );
+  
+  for( char* robotName = strtok( robotNames, "," ); robotName != NULL; robotName = strtok( NULL, "," ) )
+  {
+    DEBUG_PRINT( "preloading standby robot %s", robotName );
+    Robot standbyRobot = Robot_Load( robotName );
+    if( standbyRobot == NULL ) continue;
+    // Devices are kept for fast activation
+    if( !Robot_Prepare( standbyRobot ) )
+    {
+      Robot_Unload( standbyRobot );
+      continue;
+    }
+    
+    standbyRobotsList = (StandbyRobot*) realloc( standbyRobotsList, ( standbyRobotsNumber + 1 ) * sizeof(StandbyRobot) );
+    standbyRobotsList[ standbyRobotsNumber ].robotName = (char*) calloc( strlen( robotName ) + 1, sizeof(char) );
+    strcpy( standbyRobotsList[ standbyRobotsNumber ].robotName, robotName );
+    standbyRobotsList[ standbyRobotsNumber ].robot = standbyRobot;
+    standbyRobotsNumber++;
+  }
+  
+  free( robotNames );
+}
+
+void UnloadStandbyRobots()
+{
+  for( size_t standbyIndex = 0; standbyIndex < standbyRobotsNumber; standbyIndex++ )
+  {
+    Robot_Unload( standbyRobotsList[ standbyIndex ].robot );
+    free( standbyRobotsList[ standbyIndex ].robotName );
+  }
+  free( standbyRobotsList );
+  standbyRobotsList = NULL;
+  standbyRobotsNumber = 0;
+}
+
+StandbyRobot* FindStandbyRobot( const char* robotName )
+{
+  for( size_t standbyIndex = 0; standbyIndex < standbyRobotsNumber; standbyIndex++ )
+  {
+    if( strcmp( standbyRobotsList[ standbyIndex ].robotName, robotName ) == 0 ) return &(standbyRobotsList[ standbyIndex ]);
+  }
+  
+  return NULL;
+}
+
+bool ActivateStandbyRobot( const char* robotName )
+{
+  StandbyRobot* standbyRobot = FindStandbyRobot( robotName );
+  if( standbyRobot == NULL ) return false;
+  
+  DEBUG_PRINT( "switching to standby robot %s", robotName );
+  Log_SetTimeStamp();
+  BinaryLog_SetTimeStamp();
+  // Failed activations keep the standby robot loaded, and the previous one active (if it could be restored)
+  Robot lastRobot = NULL;
+  (void) ActivateRobot( standbyRobot->robot, robotName, &lastRobot );
+  pendingUnloadRobot = ReleaseRobot( lastRobot );
+  
+  return true;
+}
+
+// Gets robot to be unloaded after deactivation (NULL for standby robots, that are kept loaded)
+Robot ReleaseRobot( Robot robot )
+{
+  for( size_t standbyIndex = 0; standbyIndex < standbyRobotsNumber; standbyIndex++ )
+  {
+    if( standbyRobotsList[ standbyIndex ].robot == robot ) return NULL;
+  }
+  
+  return robot;
+}
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Runs the control loop of a robot configuration (e.g. virtual_robot, with DummyIO devices and SimpleJoint controller) for a given time, 
+/// checking for memory allocations (and optionally blocking calls) on the control thread (see alloc_guard.h).
+/// Usage: HotPathCheck [--root <root_dir>] [--config <robot_name>] [--time <seconds>] [--guard <report|abort>[,syscalls]]
+/// Exit status is non-zero if robot could not be enabled, or if any violation was reported.
+
+#include "robot.h"
+#include "alloc_guard.h"
+#include "trace_points.h"
+#include "flight_recorder.h"
+#include "config_cache.h"
+#include "device_registry.h"
+
+#include "timing/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef WIN32
+#include "getopt.h"
+#include <direct.h>
+#define chdir _chdir
+#else
+#include <getopt.h>
+#include <unistd.h>
+#endif
+
+
+int main( int argc, char* argv[] )
+{
+  const char* rootDirectory = ".";
+  const char* robotConfigName = "virtual_robot";
+  const char* guardMode = "report";
+  double runTime = 5.0;
+  
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "root", required_argument, NULL, 'r' },
+    { "config", required_argument, NULL, 'c' },
+    { "time", required_argument, NULL, 't' },
+    { "guard", required_argument, NULL, 'g' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  int optionChar;
+  while( (optionChar = getopt_long( argc, argv, "hr:c:t:g:", longOptions, NULL )) != -1 )
+  {
+    if( optionChar == 'r' ) rootDirectory = optarg;
+    else if( optionChar == 'c' ) robotConfigName = optarg;
+    else if( optionChar == 't' ) runTime = strtod( optarg, NULL );
+    else if( optionChar == 'g' ) guardMode = optarg;
+    else
+    {
+      printf( "usage: %s [--root <root_dir>] [--config <robot_name>] [--time <seconds>] [--guard <report|abort>[,syscalls]]\n", argv[ 0 ] );
+      return ( optionChar == 'h' ) ? 0 : -1;
+    }
+  }
+  
+#ifndef ENABLE_ALLOCATION_GUARD
+  fprintf( stderr, "built without ENABLE_ALLOCATION_GUARD: allocations will not be checked\n" );
+#endif
+  AllocGuard_Init( guardMode );
+  
+  if( chdir( rootDirectory ) != 0 )
+  {
+    fprintf( stderr, "could not access root directory %s\n", rootDirectory );
+    return -1;
+  }
+  
+  // Same registries as the control application (see system.c), so that robots are loaded the same way
+  TracePoints_Init();
+  FlightRecorder_Init();
+  ConfigCache_Init();
+  DeviceRegistry_Init();
+  
+  bool isLoaded = Robot_Init( robotConfigName );
+  if( !isLoaded ) fprintf( stderr, "could not load robot %s\n", robotConfigName );
+  
+  bool isEnabled = isLoaded && Robot_Enable();
+  if( isEnabled )
+  {
+    // Go through all control states handled by the control loop
+    Robot_SetControlState( CONTROL_OFFSET );
+    Time_Delay( (unsigned long) ( 250 * runTime ) );
+    Robot_SetControlState( CONTROL_CALIBRATION );
+    Time_Delay( (unsigned long) ( 250 * runTime ) );
+    Robot_SetControlState( CONTROL_OPERATION );
+    Time_Delay( (unsigned long) ( 500 * runTime ) );
+    Robot_Disable();
+  }
+  else if( isLoaded ) fprintf( stderr, "could not enable robot %s\n", robotConfigName );
+  
+  Robot_End();
+  
+  TracePoints_End();
+  FlightRecorder_End();
+  ConfigCache_End();
+  DeviceRegistry_End();
+  
+  size_t violationsCount = AllocGuard_GetViolationsCount();
+  printf( "robot %s control loop ran for %g s: %lu allocation guard violations\n", robotConfigName, runTime, (unsigned long) violationsCount );
+  
+  return ( isEnabled && violationsCount == 0 ) ? 0 : -1;
+}
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Converts binary columnar logs (see binary_log.h) back to the text data log format (time stamp followed by tab-separated values, one line per row).
+/// Usage: LogConverter [--precision <decimals>] [--from <time>] [--to <time>] [--info] <input.blog> [<output.log>]
+/// With --info, only header metadata, column names and rows number are printed. Time range limits use the file time index.
+
+#include "binary_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#ifdef WIN32
+#include "getopt.h"
+#else
+#include <getopt.h>
+#endif
+
+
+int main( int argc, char* argv[] )
+{
+  int precision = 3;
+  double initialTime = -DBL_MAX, finalTime = DBL_MAX;
+  bool isInfoOnly = false;
+  
+  static struct option longOptions[] =
+  {
+    { "help", no_argument, NULL, 'h' },
+    { "precision", required_argument, NULL, 'p' },
+    { "from", required_argument, NULL, 'f' },
+    { "to", required_argument, NULL, 't' },
+    { "info", no_argument, NULL, 'i' },
+    { NULL, 0, NULL, 0 }
+  };
+  
+  int optionChar;
+  while( (optionChar = getopt_long( argc, argv, "hp:f:t:i", longOptions, NULL )) != -1 )
+  {
+    if( optionChar == 'p' ) precision = atoi( optarg );
+    else if( optionChar == 'f' ) initialTime = strtod( optarg, NULL );
+    else if( optionChar == 't' ) finalTime = strtod( optarg, NULL );
+    else if( optionChar == 'i' ) isInfoOnly = true;
+    else
+    {
+      printf( "usage: %s [--precision <decimals>] [--from <time>] [--to <time>] [--info] <input.blog> [<output.log>]\n", argv[ 0 ] );
+      return ( optionChar == 'h' ) ? 0 : -1;
+    }
+  }
+  
+  if( optind >= argc )
+  {
+    fprintf( stderr, "no input file given\n" );
+    return -1;
+  }
+  
+  BinaryLogReader reader = BinaryLog_OpenReader( argv[ optind ] );
+  if( reader == NULL )
+  {
+    fprintf( stderr, "could not read binary log %s\n", argv[ optind ] );
+    return -1;
+  }
+  
+  size_t columnsNumber = BinaryLog_GetReaderColumnsNumber( reader );
+  size_t rowsNumber = BinaryLog_GetRowsNumber( reader );
+  
+  if( isInfoOnly )
+  {
+    printf( "metadata: %s\nrows: %lu\ncolumns: %lu\n", BinaryLog_GetMetadata( reader ), rowsNumber, columnsNumber );
+    for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+      printf( "  %lu: %s\n", columnIndex, BinaryLog_GetColumnName( reader, columnIndex ) );
+    BinaryLog_CloseReader( reader );
+    return 0;
+  }
+  
+  FILE* outputFile = ( optind + 1 < argc ) ? fopen( argv[ optind + 1 ], "w" ) : stdout;
+  if( outputFile == NULL )
+  {
+    fprintf( stderr, "could not create output file %s\n", argv[ optind + 1 ] );
+    BinaryLog_CloseReader( reader );
+    return -1;
+  }
+  
+  double* valuesList = (double*) calloc( columnsNumber, sizeof(double) );
+  double timeStamp;
+  for( size_t rowIndex = BinaryLog_FindRow( reader, initialTime ); BinaryLog_ReadRow( reader, rowIndex, &timeStamp, valuesList ); rowIndex++ )
+  {
+    if( timeStamp > finalTime ) break;
+    
+    fprintf( outputFile, "%.*f", precision, timeStamp );
+    for( size_t columnIndex = 0; columnIndex < columnsNumber; columnIndex++ )
+      fprintf( outputFile, "\t%.*f", precision, valuesList[ columnIndex ] );
+    fprintf( outputFile, "\n" );
+  }
+  free( valuesList );
+  
+  if( outputFile != stdout ) fclose( outputFile );
+  
+  BinaryLog_CloseReader( reader );
+  
+  return 0;
+}
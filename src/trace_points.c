@@ -0,0 +1,348 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "trace_points.h"
+
+#include "debug/data_logging.h"
+#include "threads/thread_locks.h"
+#include "timing/timing.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec( thread )
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+#define TRACE_POINTS_MAX_NUMBER 256
+#define TRACE_NAME_MAX_LENGTH 128
+#define TRACE_LOG_PRECISION 6
+
+#define KEY_SLOT_MASK 0xFFFF
+#define KEY_GENERATION_SHIFT 16
+
+typedef struct _TracePointEntry
+{
+  TracePointData data;
+  char name[ TRACE_NAME_MAX_LENGTH ];
+  unsigned int generation;
+  bool isUsed;
+  Log log;
+}
+TracePointEntry;
+
+typedef struct _TraceSample
+{
+  double timeStamp;
+  unsigned int key;
+  unsigned int valuesNumber;
+  double valuesList[ TRACE_POINT_MAX_VALUES ];
+}
+TraceSample;
+
+// Single producer (owner thread) and single consumer (flushing thread) ring
+typedef struct _TraceBuffer
+{
+  TraceSample samplesList[ TRACE_BUFFER_LENGTH ];
+  atomic_size_t readIndex;
+  size_t reportedDropsNumber;
+  char producerPadding[ CACHE_LINE_SIZE ];      // Keep producer and consumer indexes on separate cache lines
+  atomic_size_t writeIndex;
+  atomic_size_t droppedSamplesNumber;
+  atomic_bool isAttached;                       // Buffers of ended threads are reused by the next attached ones
+  struct _TraceBuffer* next;
+}
+TraceBuffer;
+
+static TracePointEntry pointsList[ TRACE_POINTS_MAX_NUMBER ];
+static ThreadLock registryLock = NULL;
+
+static TraceBuffer* _Atomic buffersList = NULL;
+static atomic_uint buffersGeneration = 0;          // Changed when all buffers are deallocated, so that other threads stop using their own
+static THREAD_LOCAL TraceBuffer* threadBuffer = NULL;
+static THREAD_LOCAL unsigned int threadBufferGeneration = 0;
+static atomic_size_t unattachedSamplesNumber = 0;     // Recorded from threads without buffer
+static size_t reportedUnattachedNumber = 0;
+
+// Returned when no registry slot is available: never enabled
+static TracePointData disabledPoint = { .isEnabled = false, .key = UINT_MAX };
+
+static TraceBuffer* AcquireThreadBuffer( void );
+static void FlushBuffer( TraceBuffer* );
+
+
+void TracePoints_Init( void )
+{
+  if( registryLock != NULL ) return;
+  
+  memset( pointsList, 0, sizeof(pointsList) );
+  for( size_t pointIndex = 0; pointIndex < TRACE_POINTS_MAX_NUMBER; pointIndex++ )
+    atomic_init( &(pointsList[ pointIndex ].data.isEnabled), false );
+  
+  registryLock = ThreadLock_Create();
+}
+
+void TracePoints_End( void )
+{
+  if( registryLock == NULL ) return;
+  
+  TracePoints_Flush();
+  
+  ThreadLock_Aquire( registryLock );
+  for( size_t pointIndex = 0; pointIndex < TRACE_POINTS_MAX_NUMBER; pointIndex++ )
+  {
+    atomic_store( &(pointsList[ pointIndex ].data.isEnabled), false );
+    Log_End( pointsList[ pointIndex ].log );
+    pointsList[ pointIndex ].log = NULL;
+    pointsList[ pointIndex ].isUsed = false;
+  }
+  ThreadLock_Release( registryLock );
+  
+  // All trace points are disabled, so no other thread should still be recording to its buffer. 
+  // Their (thread local) references are only invalidated by generation, as they cannot be cleared from here
+  atomic_fetch_add( &buffersGeneration, 1 );
+  TraceBuffer* buffer = atomic_exchange( &buffersList, NULL );
+  while( buffer != NULL )
+  {
+    TraceBuffer* nextBuffer = buffer->next;
+    free( buffer );
+    buffer = nextBuffer;
+  }
+  threadBuffer = NULL;
+  atomic_store( &unattachedSamplesNumber, 0 );
+  reportedUnattachedNumber = 0;
+  
+  ThreadLock_Discard( registryLock );
+  registryLock = NULL;
+}
+
+TracePoint TracePoint_Register( const char* category, const char* name )
+{
+  if( registryLock == NULL ) return &disabledPoint;
+  
+  TracePoint newPoint = &disabledPoint;
+  
+  ThreadLock_Aquire( registryLock );
+  for( size_t pointIndex = 0; pointIndex < TRACE_POINTS_MAX_NUMBER; pointIndex++ )
+  {
+    TracePointEntry* entry = &(pointsList[ pointIndex ]);
+    if( entry->isUsed ) continue;
+    
+    entry->isUsed = true;
+    snprintf( entry->name, TRACE_NAME_MAX_LENGTH, "%s/%s", category, name );
+    entry->data.key = (unsigned int) pointIndex | ( ( entry->generation & KEY_SLOT_MASK ) << KEY_GENERATION_SHIFT );
+    atomic_store( &(entry->data.isEnabled), false );
+    newPoint = &(entry->data);
+    break;
+  }
+  ThreadLock_Release( registryLock );
+  
+  if( newPoint == &disabledPoint ) DEBUG_PRINT( "no trace point slot left for %s/%s", category, name );
+  
+  return newPoint;
+}
+
+void TracePoint_Unregister( TracePoint point )
+{
+  if( point == NULL || point == &disabledPoint || registryLock == NULL ) return;
+  
+  TracePointEntry* entry = (TracePointEntry*) point;
+  
+  ThreadLock_Aquire( registryLock );
+  atomic_store( &(entry->data.isEnabled), false );
+  entry->isUsed = false;
+  entry->generation++;      // Pending samples with older key are discarded on flush
+  Log_End( entry->log );
+  entry->log = NULL;
+  ThreadLock_Release( registryLock );
+}
+
+void TracePoints_AttachThread( void )
+{
+  if( registryLock == NULL ) return;
+  
+  unsigned int generation = atomic_load_explicit( &buffersGeneration, memory_order_acquire );
+  if( threadBuffer != NULL && threadBufferGeneration == generation ) return;
+  
+  threadBuffer = AcquireThreadBuffer();
+  threadBufferGeneration = generation;
+}
+
+void TracePoints_DetachThread( void )
+{
+  unsigned int generation = atomic_load_explicit( &buffersGeneration, memory_order_acquire );
+  if( threadBuffer != NULL && threadBufferGeneration == generation ) atomic_store_explicit( &(threadBuffer->isAttached), false, memory_order_release );
+  
+  threadBuffer = NULL;
+}
+
+void TracePoint_Record( TracePoint point, size_t listSize, const double* valuesList, size_t valuesNumber, ... )
+{
+  if( point == NULL ) return;
+  
+  // Never allocates: buffers are only acquired by TracePoints_AttachThread()
+  unsigned int generation = atomic_load_explicit( &buffersGeneration, memory_order_acquire );
+  if( threadBuffer == NULL || threadBufferGeneration != generation ) 
+  {
+    atomic_fetch_add_explicit( &unattachedSamplesNumber, 1, memory_order_relaxed );
+    return;
+  }
+  TraceBuffer* buffer = threadBuffer;
+  
+  size_t writeIndex = atomic_load_explicit( &(buffer->writeIndex), memory_order_relaxed );
+  if( writeIndex - atomic_load_explicit( &(buffer->readIndex), memory_order_acquire ) >= TRACE_BUFFER_LENGTH )
+  {
+    atomic_fetch_add_explicit( &(buffer->droppedSamplesNumber), 1, memory_order_relaxed );
+    return;
+  }
+  
+  TraceSample* sample = &(buffer->samplesList[ writeIndex % TRACE_BUFFER_LENGTH ]);
+  sample->timeStamp = Time_GetExecSeconds();
+  sample->key = point->key;
+  
+  size_t sampleValuesNumber = 0;
+  for( size_t valueIndex = 0; valueIndex < listSize && sampleValuesNumber < TRACE_POINT_MAX_VALUES; valueIndex++ )
+    sample->valuesList[ sampleValuesNumber++ ] = valuesList[ valueIndex ];
+  
+  va_list extraValues;
+  va_start( extraValues, valuesNumber );
+  for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+  {
+    double value = va_arg( extraValues, double );
+    if( sampleValuesNumber < TRACE_POINT_MAX_VALUES ) sample->valuesList[ sampleValuesNumber++ ] = value;
+  }
+  va_end( extraValues );
+  sample->valuesNumber = (unsigned int) sampleValuesNumber;
+  
+  atomic_store_explicit( &(buffer->writeIndex), writeIndex + 1, memory_order_release );
+}
+
+size_t TracePoints_SetEnabled( const char* pathName, bool enable )
+{
+  if( pathName == NULL || registryLock == NULL ) return 0;
+  
+  size_t matchesNumber = 0;
+  
+#ifdef ENABLE_TRACE_POINTS
+  
+  ThreadLock_Aquire( registryLock );
+  for( size_t pointIndex = 0; pointIndex < TRACE_POINTS_MAX_NUMBER; pointIndex++ )
+  {
+    TracePointEntry* entry = &(pointsList[ pointIndex ]);
+    if( !entry->isUsed || strcmp( entry->name, pathName ) != 0 ) continue;
+    
+    if( enable && entry->log == NULL )
+    {
+      char logName[ TRACE_NAME_MAX_LENGTH + 8 ];
+      snprintf( logName, sizeof(logName), "%s-trace", entry->name );
+      for( char* separator = strchr( logName, '/' ); separator != NULL; separator = strchr( separator, '/' ) )
+        *separator = '-';
+      entry->log = Log_Init( logName, TRACE_LOG_PRECISION );
+    }
+    
+    atomic_store( &(entry->data.isEnabled), enable );
+    matchesNumber++;
+  }
+  ThreadLock_Release( registryLock );
+  
+  DEBUG_PRINT( "trace point %s %s (%zu matches)", pathName, enable ? "enabled" : "disabled", matchesNumber );
+#else
+  DEBUG_PRINT( "trace points not available for %s (disabled at compile time)", pathName );
+#endif
+  
+  return matchesNumber;
+}
+
+void TracePoints_Flush( void )
+{
+  if( registryLock == NULL ) return;
+  
+  ThreadLock_Aquire( registryLock );
+  for( TraceBuffer* buffer = atomic_load( &buffersList ); buffer != NULL; buffer = buffer->next )
+    FlushBuffer( buffer );
+  
+  size_t unattachedNumber = atomic_load_explicit( &unattachedSamplesNumber, memory_order_relaxed );
+  if( unattachedNumber != reportedUnattachedNumber )
+  {
+    DEBUG_PRINT( "%zu samples dropped from threads without trace buffer", unattachedNumber - reportedUnattachedNumber );
+    reportedUnattachedNumber = unattachedNumber;
+  }
+  ThreadLock_Release( registryLock );
+}
+
+
+static TraceBuffer* AcquireThreadBuffer( void )
+{
+  // Buffers are never removed from the list before TracePoints_End(), so it may be walked without lock
+  for( TraceBuffer* buffer = atomic_load( &buffersList ); buffer != NULL; buffer = buffer->next )
+  {
+    bool isAttached = false;
+    if( atomic_compare_exchange_strong( &(buffer->isAttached), &isAttached, true ) ) return buffer;
+  }
+  
+  TraceBuffer* newBuffer = (TraceBuffer*) malloc( sizeof(TraceBuffer) );
+  memset( newBuffer, 0, sizeof(TraceBuffer) );
+  atomic_init( &(newBuffer->readIndex), 0 );
+  atomic_init( &(newBuffer->writeIndex), 0 );
+  atomic_init( &(newBuffer->droppedSamplesNumber), 0 );
+  atomic_init( &(newBuffer->isAttached), true );
+  
+  // Lock-free push, so that recording threads never wait on registry lock
+  newBuffer->next = atomic_load( &buffersList );
+  while( !atomic_compare_exchange_weak( &buffersList, &(newBuffer->next), newBuffer ) );
+  
+  return newBuffer;
+}
+
+// Called with registry lock held
+static void FlushBuffer( TraceBuffer* buffer )
+{
+  size_t readIndex = atomic_load_explicit( &(buffer->readIndex), memory_order_relaxed );
+  size_t writeIndex = atomic_load_explicit( &(buffer->writeIndex), memory_order_acquire );
+  
+  for( ; readIndex != writeIndex; readIndex++ )
+  {
+    TraceSample* sample = &(buffer->samplesList[ readIndex % TRACE_BUFFER_LENGTH ]);
+    TracePointEntry* entry = &(pointsList[ ( sample->key & KEY_SLOT_MASK ) % TRACE_POINTS_MAX_NUMBER ]);
+    if( !entry->isUsed || entry->data.key != sample->key || entry->log == NULL ) continue;
+    
+    Log_EnterNewLine( entry->log, sample->timeStamp );
+    Log_RegisterList( entry->log, sample->valuesNumber, sample->valuesList );
+  }
+  
+  atomic_store_explicit( &(buffer->readIndex), readIndex, memory_order_release );
+  
+  size_t droppedSamplesNumber = atomic_load_explicit( &(buffer->droppedSamplesNumber), memory_order_relaxed );
+  if( droppedSamplesNumber != buffer->reportedDropsNumber )
+  {
+    DEBUG_PRINT( "trace buffer %p: %zu samples dropped on full ring", buffer, droppedSamplesNumber - buffer->reportedDropsNumber );
+    buffer->reportedDropsNumber = droppedSamplesNumber;
+  }
+}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file trace_points.h
+/// @brief Run-time switchable trace points for raw signal samples
+///
+/// Trace points are placed at per-sample sites (like sensor and motor updates) that are too frequent for regular logging. 
+/// They can be removed at compile time (building without ENABLE_TRACE_POINTS definition), and otherwise cost a single predictable branch while disabled.
+/// When a trace point is enabled (e.g. on client request, see shared_robot_control.h), its samples are copied to a preallocated ring buffer owned by the calling thread 
+/// (acquired with TracePoints_AttachThread(), e.g. when control starts, so that recording never allocates memory: samples from other threads are dropped and counted), 
+/// and later written by TracePoints_Flush() to a [data log](https://github.com/EESC-MKGroup/Simple-Data-Logging) file named <log_dir>/[<user_name>-]<category>-<name>-trace-<time_stamp>.log
+
+
+#ifndef TRACE_POINTS_H
+#define TRACE_POINTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define TRACE_POINT_MAX_VALUES 8          ///< Maximum number of values recorded per trace point sample (extra values are discarded)
+#define TRACE_BUFFER_LENGTH 4096          ///< Number of sample slots in each thread ring buffer
+
+/// Trace point data visible for inline checking of run-time state. Remaining information is kept in trace points registry
+typedef struct _TracePointData
+{
+  atomic_bool isEnabled;      ///< Run-time switch, only read (relaxed) on trace point sites
+  unsigned int key;           ///< Registry slot and generation identifier
+}
+TracePointData;
+
+typedef TracePointData* TracePoint;     ///< Reference to single trace point data structure
+
+
+#ifdef ENABLE_TRACE_POINTS
+  #ifdef __GNUC__
+    #define TRACE_UNLIKELY( condition ) __builtin_expect( !!(condition), 0 )
+  #else
+    #define TRACE_UNLIKELY( condition ) (condition)
+  #endif
+  /// Records values list followed by given number of extra values to given trace point, if enabled
+  #define TRACE_POINT( point, listSize, valuesList, valuesNumber, ... ) \
+    do { if( TRACE_UNLIKELY( atomic_load_explicit( &((point)->isEnabled), memory_order_relaxed ) ) ) TracePoint_Record( (point), (listSize), (valuesList), (valuesNumber), __VA_ARGS__ ); } while( 0 )
+#else
+  #define TRACE_POINT( point, listSize, valuesList, valuesNumber, ... ) do {} while( 0 )
+#endif
+
+
+/// @brief Initializes trace points registry (not thread safe, call before any trace point registration)
+void TracePoints_Init( void );
+
+/// @brief Writes pending samples, closes trace logs and deallocates all trace points registry and thread buffers data
+void TracePoints_End( void );
+
+/// @brief Adds named trace point to registry, initially disabled (thread safe)
+/// @param[in] category trace point group name (e.g. "sensors" or "motors")
+/// @param[in] name trace point name, usually its device configuration name
+/// @return reference to newly registered trace point (never NULL: an always disabled placeholder is returned when registry is full or not initialized)
+TracePoint TracePoint_Register( const char* category, const char* name );
+
+/// @brief Removes trace point from registry, discarding its pending samples (thread safe)
+/// @param[in] point reference to trace point
+void TracePoint_Unregister( TracePoint point );
+
+/// @brief Acquires a ring buffer for samples recorded by calling thread, reusing buffers of detached threads before allocating a new one (not real-time safe)
+void TracePoints_AttachThread( void );
+
+/// @brief Releases ring buffer of calling thread for reuse, keeping its pending samples until next flush (call before thread exits)
+void TracePoints_DetachThread( void );
+
+/// @brief Copies single sample to calling thread ring buffer (use TRACE_POINT() macro on time critical sites). Samples are dropped when calling thread is not attached
+/// @param[in] point reference to trace point
+/// @param[in] listSize number of values in valuesList
+/// @param[in] valuesList values to be recorded first (might be NULL if listSize is 0)
+/// @param[in] valuesNumber number of extra values passed as variable arguments (type double)
+void TracePoint_Record( TracePoint point, size_t listSize, const double* valuesList, size_t valuesNumber, ... );
+
+/// @brief Enables/disables all registered trace points matching given name
+/// @param[in] pathName trace point name, in the form "<category>/<name>" (like "sensors/ankle_encoder")
+/// @param[in] enable true to start recording samples, false to stop
+/// @return number of affected trace points (0 if none is found or trace points were disabled at compile time)
+size_t TracePoints_SetEnabled( const char* pathName, bool enable );
+
+/// @brief Writes pending samples of all thread buffers to corresponding trace logs (call periodically from non real-time thread)
+void TracePoints_Flush( void );
+
+
+#endif // TRACE_POINTS_H
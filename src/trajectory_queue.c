@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "trajectory_queue.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct _TrajectoryPoint
+{
+  double time;
+  DoFVariables setpoints;
+}
+TrajectoryPoint;
+
+struct _TrajectoryQueueData
+{
+  TrajectoryPoint* pointsList;
+  size_t lengthMask;
+  atomic_size_t readIndex;
+  atomic_size_t writeIndex;
+  atomic_size_t discardIndex;
+};
+
+
+TrajectoryQueue TrajectoryQueue_Create( size_t maxLength )
+{
+  size_t length = 1;
+  while( length < maxLength ) length *= 2;
+  
+  TrajectoryQueue newQueue = (TrajectoryQueue) malloc( sizeof(TrajectoryQueueData) );
+  memset( newQueue, 0, sizeof(TrajectoryQueueData) );
+  
+  newQueue->pointsList = (TrajectoryPoint*) calloc( length, sizeof(TrajectoryPoint) );
+  newQueue->lengthMask = length - 1;
+  atomic_init( &(newQueue->readIndex), 0 );
+  atomic_init( &(newQueue->writeIndex), 0 );
+  atomic_init( &(newQueue->discardIndex), 0 );
+  
+  return newQueue;
+}
+
+void TrajectoryQueue_Discard( TrajectoryQueue queue )
+{
+  if( queue == NULL ) return;
+  
+  free( queue->pointsList );
+  
+  free( queue );
+}
+
+bool TrajectoryQueue_Push( TrajectoryQueue queue, double time, const DoFVariables* ref_setpoints )
+{
+  if( queue == NULL ) return false;
+  
+  size_t writeIndex = atomic_load_explicit( &(queue->writeIndex), memory_order_relaxed );
+  // Discarded points still occupy their slots until the consumer skips them, so free space only depends on consumer position
+  size_t readIndex = atomic_load_explicit( &(queue->readIndex), memory_order_acquire );
+  if( writeIndex - readIndex > queue->lengthMask ) return false;
+  
+  TrajectoryPoint* point = &(queue->pointsList[ writeIndex & queue->lengthMask ]);
+  point->time = time;
+  point->setpoints = *ref_setpoints;
+  
+  atomic_store_explicit( &(queue->writeIndex), writeIndex + 1, memory_order_release );
+  
+  return true;
+}
+
+void TrajectoryQueue_Clear( TrajectoryQueue queue )
+{
+  if( queue == NULL ) return;
+  
+  size_t writeIndex = atomic_load_explicit( &(queue->writeIndex), memory_order_relaxed );
+  atomic_store_explicit( &(queue->discardIndex), writeIndex, memory_order_release );
+}
+
+bool TrajectoryQueue_Pop( TrajectoryQueue queue, double currentTime, DoFVariables* ref_setpoints )
+{
+  if( queue == NULL ) return false;
+  
+  size_t readIndex = atomic_load_explicit( &(queue->readIndex), memory_order_relaxed );
+  size_t discardIndex = atomic_load_explicit( &(queue->discardIndex), memory_order_acquire );
+  size_t writeIndex = atomic_load_explicit( &(queue->writeIndex), memory_order_acquire );
+  // Skip discarded points, releasing their slots even when no point is due
+  if( discardIndex > readIndex ) readIndex = discardIndex;
+  
+  bool isUpdated = false;
+  while( readIndex < writeIndex )
+  {
+    TrajectoryPoint* point = &(queue->pointsList[ readIndex & queue->lengthMask ]);
+    if( point->time > currentTime ) break;
+    *ref_setpoints = point->setpoints;
+    isUpdated = true;
+    readIndex++;
+  }
+  
+  atomic_store_explicit( &(queue->readIndex), readIndex, memory_order_release );
+  
+  return isUpdated;
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file trajectory_queue.h
+/// @brief Time-stamped setpoints buffering functions
+///
+/// Lock-free single-producer/single-consumer queue of future DoF setpoints. Points are pushed by the communication thread (see shared_dof_variables.h)
+/// and consumed by the control thread, that applies the most recent point already due at each control cycle.
+
+
+#ifndef TRAJECTORY_QUEUE_H
+#define TRAJECTORY_QUEUE_H
+
+#include "robot_control/robot_control.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct _TrajectoryQueueData TrajectoryQueueData;    ///< Single trajectory queue internal data structure
+typedef TrajectoryQueueData* TrajectoryQueue;               ///< Opaque reference to trajectory queue internal data structure
+
+
+/// @brief Creates and initializes trajectory queue data structure
+/// @param[in] maxLength maximum number of pending points (rounded up to a power of 2)
+/// @return reference/pointer to newly created trajectory queue data structure
+TrajectoryQueue TrajectoryQueue_Create( size_t maxLength );
+
+/// @brief Deallocates internal data of given trajectory queue
+/// @param[in] queue reference to trajectory queue
+void TrajectoryQueue_Discard( TrajectoryQueue queue );
+
+/// @brief Adds setpoints to be applied at given time (producer side)
+/// @param[in] queue reference to trajectory queue
+/// @param[in] time absolute execution time (as in Time_GetExecSeconds()) at which setpoints become due
+/// @param[in] ref_setpoints pointer/reference to variables structure with the new setpoints
+/// @return true if point was added, false if queue is full
+bool TrajectoryQueue_Push( TrajectoryQueue queue, double time, const DoFVariables* ref_setpoints );
+
+/// @brief Marks all points currently pending in the queue as discarded (producer side)
+/// @param[in] queue reference to trajectory queue
+void TrajectoryQueue_Clear( TrajectoryQueue queue );
+
+/// @brief Removes all points already due, keeping the most recent of them (consumer side)
+/// @param[in] queue reference to trajectory queue
+/// @param[in] currentTime current execution time (as in Time_GetExecSeconds())
+/// @param[out] ref_setpoints pointer/reference to variables structure where the latest due setpoints will be stored
+/// @return true if any point was due and ref_setpoints was updated, false otherwise
+bool TrajectoryQueue_Pop( TrajectoryQueue queue, double currentTime, DoFVariables* ref_setpoints );
+
+
+#endif // TRAJECTORY_QUEUE_H
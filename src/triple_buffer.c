@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "triple_buffer.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE_SIZE 64
+
+#define BLOCK_INDEX_MASK 0x3
+#define BLOCK_NEW_FLAG 0x4
+
+struct _TripleBufferData
+{
+  unsigned char* blocksBuffer;
+  unsigned char* blocksData;
+  size_t blockSize;
+  unsigned int writeIndex;
+  unsigned int readIndex;
+  atomic_uint sharedIndex;
+};
+
+
+TripleBuffer TripleBuffer_Create( size_t dataSize )
+{
+  TripleBuffer newBuffer = (TripleBuffer) malloc( sizeof(TripleBufferData) );
+  memset( newBuffer, 0, sizeof(TripleBufferData) );
+  
+  // Keep blocks on separate cache lines, as they are used by different threads
+  newBuffer->blockSize = ( ( dataSize + CACHE_LINE_SIZE - 1 ) / CACHE_LINE_SIZE ) * CACHE_LINE_SIZE;
+  if( newBuffer->blockSize == 0 ) newBuffer->blockSize = CACHE_LINE_SIZE;
+  // Blocks start is aligned manually, as aligned allocation functions are not available on every platform
+  newBuffer->blocksBuffer = (unsigned char*) calloc( 3 * newBuffer->blockSize + CACHE_LINE_SIZE - 1, sizeof(unsigned char) );
+  uintptr_t blocksAddress = ( (uintptr_t) newBuffer->blocksBuffer + CACHE_LINE_SIZE - 1 ) & ~( (uintptr_t) CACHE_LINE_SIZE - 1 );
+  newBuffer->blocksData = (unsigned char*) blocksAddress;
+  
+  newBuffer->writeIndex = 0;
+  atomic_init( &(newBuffer->sharedIndex), 1 );
+  newBuffer->readIndex = 2;
+  
+  return newBuffer;
+}
+
+void TripleBuffer_Discard( TripleBuffer buffer )
+{
+  if( buffer == NULL ) return;
+  
+  free( buffer->blocksBuffer );
+  
+  free( buffer );
+}
+
+void* TripleBuffer_GetWriteData( TripleBuffer buffer )
+{
+  if( buffer == NULL ) return NULL;
+  
+  return buffer->blocksData + buffer->writeIndex * buffer->blockSize;
+}
+
+void TripleBuffer_Publish( TripleBuffer buffer )
+{
+  if( buffer == NULL ) return;
+  
+  unsigned int lastSharedIndex = atomic_exchange_explicit( &(buffer->sharedIndex), buffer->writeIndex | BLOCK_NEW_FLAG, memory_order_acq_rel );
+  buffer->writeIndex = lastSharedIndex & BLOCK_INDEX_MASK;
+}
+
+const void* TripleBuffer_Acquire( TripleBuffer buffer, bool* ref_isNew )
+{
+  if( buffer == NULL ) return NULL;
+  
+  bool isNew = ( atomic_load_explicit( &(buffer->sharedIndex), memory_order_relaxed ) & BLOCK_NEW_FLAG );
+  if( isNew )
+  {
+    unsigned int lastSharedIndex = atomic_exchange_explicit( &(buffer->sharedIndex), buffer->readIndex, memory_order_acq_rel );
+    buffer->readIndex = lastSharedIndex & BLOCK_INDEX_MASK;
+  }
+  
+  if( ref_isNew != NULL ) *ref_isNew = isNew;
+  
+  return buffer->blocksData + buffer->readIndex * buffer->blockSize;
+}
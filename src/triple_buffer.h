@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file triple_buffer.h
+/// @brief Lock-free state snapshot exchange functions
+///
+/// Wait-free single-writer/single-reader triple buffer. The writer (e.g. control thread) fills a private block and publishes it with a single atomic exchange,
+/// and the reader (e.g. communication thread) always acquires the latest complete block, without ever blocking or being blocked by the writer.
+
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct _TripleBufferData TripleBufferData;    ///< Single triple buffer internal data structure
+typedef TripleBufferData* TripleBuffer;               ///< Opaque reference to triple buffer internal data structure
+
+
+/// @brief Creates and initializes triple buffer data structure, with zeroed data blocks
+/// @param[in] dataSize size in bytes of each data block
+/// @return reference/pointer to newly created triple buffer data structure
+TripleBuffer TripleBuffer_Create( size_t dataSize );
+
+/// @brief Deallocates internal data of given triple buffer
+/// @param[in] buffer reference to triple buffer
+void TripleBuffer_Discard( TripleBuffer buffer );
+
+/// @brief Gets data block currently owned by the writer (writer side)
+/// @param[in] buffer reference to triple buffer
+/// @return pointer to writable data block (NULL on errors)
+void* TripleBuffer_GetWriteData( TripleBuffer buffer );
+
+/// @brief Makes current writer data block available to the reader, switching writer to another block (writer side)
+/// @param[in] buffer reference to triple buffer
+void TripleBuffer_Publish( TripleBuffer buffer );
+
+/// @brief Gets latest published data block (reader side)
+/// @param[in] buffer reference to triple buffer
+/// @param[out] ref_isNew pointer to flag set to true if a block was published since last call (ignored if NULL)
+/// @return pointer to read-only data block, valid until next call (NULL on errors)
+const void* TripleBuffer_Acquire( TripleBuffer buffer, bool* ref_isNew );
+
+
+#endif // TRIPLE_BUFFER_H
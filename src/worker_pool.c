@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+#include "worker_pool.h"
+
+#include "threads/threads.h"
+#include "timing/timing.h"
+#include "debug/data_logging.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+typedef struct _WorkerPoolData
+{
+  WorkerTask task;
+  void* tasksData;
+  size_t tasksNumber;
+  atomic_size_t nextTaskIndex;
+  atomic_size_t finishedTasksNumber;
+}
+WorkerPoolData;
+
+static void* RunTasks( void* );
+
+
+void WorkerPool_Run( size_t workersNumber, WorkerTask task, void* tasksData, size_t tasksNumber )
+{
+  if( task == NULL || tasksNumber == 0 ) return;
+  
+  if( workersNumber > tasksNumber ) workersNumber = tasksNumber;
+  
+  WorkerPoolData pool = { .task = task, .tasksData = tasksData, .tasksNumber = tasksNumber };
+  atomic_init( &(pool.nextTaskIndex), 0 );
+  atomic_init( &(pool.finishedTasksNumber), 0 );
+  
+  // Calling thread is also a worker
+  size_t threadsNumber = ( workersNumber > 1 ) ? workersNumber - 1 : 0;
+  Thread* threadsList = (Thread*) calloc( threadsNumber, sizeof(Thread) );
+  for( size_t threadIndex = 0; threadIndex < threadsNumber; threadIndex++ )
+    threadsList[ threadIndex ] = Thread_Start( RunTasks, &pool, THREAD_JOINABLE );
+  
+  (void) RunTasks( &pool );
+  
+  // Setup tasks may block for longer than any thread exit timeout
+  while( atomic_load( &(pool.finishedTasksNumber) ) < tasksNumber ) Time_Delay( 1 );
+  
+  for( size_t threadIndex = 0; threadIndex < threadsNumber; threadIndex++ )
+  {
+    if( threadsList[ threadIndex ] != THREAD_INVALID_HANDLE ) Thread_WaitExit( threadsList[ threadIndex ], 5000 );
+  }
+  free( threadsList );
+}
+
+static void* RunTasks( void* ref_pool )
+{
+  WorkerPoolData* pool = (WorkerPoolData*) ref_pool;
+  
+  size_t taskIndex;
+  while( (taskIndex = atomic_fetch_add( &(pool->nextTaskIndex), 1 )) < pool->tasksNumber )
+  {
+    pool->task( pool->tasksData, taskIndex );
+    atomic_fetch_add( &(pool->finishedTasksNumber), 1 );
+  }
+  
+  return NULL;
+}
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2020 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of RobotSystem-Lite.                                    //
+//                                                                            //
+//  RobotSystem-Lite is free software: you can redistribute it and/or modify  //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  RobotSystem-Lite is distributed in the hope that it will be useful,       //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with RobotSystem-Lite. If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file worker_pool.h
+/// @brief Parallel execution of independent setup tasks
+///
+/// Runs a list of independent tasks (e.g. actuators initialization, where each device setup may block for a long time) on a number of worker threads, 
+/// including the calling one, returning only after all tasks are finished. Tasks store their own results (indexed by task), so that errors can be 
+/// checked in task order afterwards.
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stddef.h>
+
+/// Function performing a single task
+/// @param[in] tasksData pointer to data shared by all tasks of a run
+/// @param[in] taskIndex index of task to be performed
+typedef void (*WorkerTask)( void* tasksData, size_t taskIndex );
+
+
+/// @brief Runs given number of tasks, with each worker taking the next pending task until all are done
+/// @param[in] workersNumber maximum number of tasks performed at the same time (tasks are run sequentially on calling thread if 1 or less)
+/// @param[in] task function performing each task
+/// @param[in] tasksData pointer to data passed to all tasks
+/// @param[in] tasksNumber number of tasks to be performed (with indexes 0 to tasksNumber - 1)
+void WorkerPool_Run( size_t workersNumber, WorkerTask task, void* tasksData, size_t tasksNumber );
+
+
+#endif // WORKER_POOL_H